@@ -0,0 +1,57 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : crc32.h
+ * Author             : typetrade
+ * Version            : V1.0.0
+ * Date               : 2026/10/17
+ * Description        : Standard (zlib) CRC-32 over bytes, on the CRC unit.
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+#ifndef __CRC32_H
+#define __CRC32_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "debug.h"
+
+/* 1: whole words go through the CRC unit. 0: everything in software
+ * (slice-by-4), for builds without the unit or its host model. */
+#ifndef CRC32_HW
+#define CRC32_HW                   1
+#endif
+
+/* Who holds the CRC unit, see CRC32_UnitAcquire */
+typedef enum
+{
+    CRC32_UNIT_FREE = 0,
+    CRC32_UNIT_CPU,             /* Written by the CPU, word by word */
+    CRC32_UNIT_DMA,             /* Written by a DMA channel */
+    CRC32_UNIT_BUSY             /* Not acquired: a DMA stream was interrupted */
+} CRC32_UnitOwner;
+
+/* Running CRC-32 of one stream. Any number of streams may be open at a
+ * time; each keeps its own state and loads it into the unit per call. */
+typedef struct
+{
+    uint32_t State;             /* Reflected CRC register, ~CRC */
+    uint32_t Length;            /* Bytes fed so far */
+} CRC32_CtxTypeDef;
+
+CRC32_UnitOwner CRC32_UnitAcquire(CRC32_UnitOwner Mode, uint32_t *Saved);
+void            CRC32_UnitRelease(CRC32_UnitOwner Prev, uint32_t Saved);
+void            CRC32_UnitLoad(uint32_t State);
+
+void     CRC32_Init(CRC32_CtxTypeDef *Ctx);
+void     CRC32_Feed(CRC32_CtxTypeDef *Ctx, const void *Data, uint32_t Length);
+uint32_t CRC32_Final(const CRC32_CtxTypeDef *Ctx);
+
+uint32_t CRC32_Calc(const void *Data, uint32_t Length);
+uint32_t CRC32_Update(uint32_t Crc, const void *Data, uint32_t Length);
+uint32_t CRC32_Update_Soft(uint32_t Crc, const void *Data, uint32_t Length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __CRC32_H */
@@ -0,0 +1,474 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : dma_copy.c
+ * Author             : typetrade
+ * Version            : V1.0.0
+ * Date               : 2026/10/17
+ * Description        : Asynchronous memcpy/memset on DMA1 memory-to-memory
+ *                      channels. DMA_Copy_Init takes DMA_COPY_CHANNELS
+ *                      channels from the channel manager (dma_chan.h) and
+ *                      holds them; submitted jobs wait in a queue for a
+ *                      free one of them. Each channel runs one job at a time,
+ *                      in transfers of at most 65535 items, the next one
+ *                      started from its transfer complete interrupt, as is
+ *                      the next queued job once a job is done. Jobs start
+ *                      in submission order but may run side by side on
+ *                      different channels: submit a job that depends on
+ *                      another from the callback of the first.
+ *                      Items are words when Dst and Src are equally
+ *                      aligned (any Dst for a fill), else halfwords or
+ *                      bytes; the CPU copies the 0 to 3 bytes before the
+ *                      first and after the last whole item when the job
+ *                      starts. Copies run at DMA_Priority_Low, behind
+ *                      peripheral channels.
+ *                      The DMA moves one item per few bus cycles: a CPU
+ *                      memcpy is as fast or faster, the gain is the CPU
+ *                      time freed meanwhile (Flash_Bench_DmaCopy).
+ *                      Submit from the main loop or from a completion
+ *                      callback. DMA_Copy_Sync/DMA_Fill_Sync wait polling
+ *                      the flags, so they also work with interrupts off.
+ *                      Built with SIM_HOST the manager's handlers are
+ *                      driven by the host DMA model (HOST/DmaCopy).
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+#include <string.h>
+#include "dma_copy.h"
+#include "dma_chan.h"
+
+#if(DMA_COPY_CHANNELS < 1 || DMA_COPY_CHANNELS > DMA_CHAN_COUNT)
+#error "DMA_COPY_CHANNELS must be 1 to 7"
+#endif
+
+/* Items per transfer, DMA_SetCurrDataCounter limit */
+#define DMA_COPY_MAX_ITEMS         ((uint32_t)0xFFFF)
+
+#define DMA_COPY_QUEUE_MASK        (DMA_COPY_QUEUE_LEN - 1)
+
+/* Registers of the channel in slot k */
+#define DMA_COPY_CH(k)             DMA_Chan_Regs(dma_copy_chan[k])
+
+#define DMA_COPY_CFGR              (DMA_M2M_Enable | DMA_Priority_Low | DMA_MemoryInc_Enable | \
+                                    DMA_DIR_PeripheralSRC | DMA_IT_TE | DMA_IT_TC)
+
+/* One channel and the job it runs */
+typedef struct
+{
+    DMA_CopyJobTypeDef Job;
+    uint32_t           Dst;      /* Next transfer: destination */
+    uint32_t           Src;      /* Next transfer: source, or &Pattern */
+    uint32_t           Left;     /* Bytes not yet handed to the DMA */
+    uint32_t           Pattern;  /* Fill value, four times */
+    uint32_t           Cfgr;     /* CFGR of the job's transfers, EN clear */
+    uint8_t            Size;     /* Item size, bytes */
+    uint8_t            Busy;
+} DMA_CopyChTypeDef;
+
+/* Job queue: Submit advances tail, dispatch advances head */
+static DMA_CopyJobTypeDef dma_copy_queue[DMA_COPY_QUEUE_LEN];
+static volatile uint8_t   dma_copy_head = 0;
+static volatile uint8_t   dma_copy_tail = 0;
+static DMA_CopyChTypeDef  dma_copy_ch[DMA_COPY_CHANNELS];
+static uint8_t            dma_copy_chan[DMA_COPY_CHANNELS];  /* Channel held by slot k, or 0 */
+static volatile uint8_t   dma_copy_running = 0;  /* Channels with a job */
+static uint8_t            dma_copy_masked = 0;   /* dma_copy_irq_off depth */
+
+/*********************************************************************
+ * @fn      dma_copy_irq_off
+ *
+ * @brief   Keeps the engine's channel interrupts out; nests.
+ *
+ * @return  none
+ */
+static void dma_copy_irq_off(void)
+{
+#ifndef SIM_HOST
+    uint8_t k;
+
+    if(dma_copy_masked++ == 0)
+    {
+        for(k = 0; k < DMA_COPY_CHANNELS; k++){
+            if(dma_copy_chan[k])
+                NVIC_DisableIRQ((IRQn_Type)(DMA1_Channel1_IRQn + dma_copy_chan[k] - 1));
+        }
+    }
+#endif
+}
+
+/*********************************************************************
+ * @fn      dma_copy_irq_on
+ *
+ * @brief   Undoes dma_copy_irq_off.
+ *
+ * @return  none
+ */
+static void dma_copy_irq_on(void)
+{
+#ifndef SIM_HOST
+    uint8_t k;
+
+    if(--dma_copy_masked == 0)
+    {
+        for(k = 0; k < DMA_COPY_CHANNELS; k++){
+            if(dma_copy_chan[k])
+                NVIC_EnableIRQ((IRQn_Type)(DMA1_Channel1_IRQn + dma_copy_chan[k] - 1));
+        }
+    }
+#endif
+}
+
+/*********************************************************************
+ * @fn      dma_copy_transfer
+ *
+ * @brief   Starts the next transfer of the job in slot k.
+ *
+ * @return  none
+ */
+static void dma_copy_transfer(uint8_t k)
+{
+    DMA_CopyChTypeDef   *c = &dma_copy_ch[k];
+    DMA_Channel_TypeDef *ch = DMA_COPY_CH(k);
+    uint32_t             n = c->Left;
+
+    if(n > DMA_COPY_MAX_ITEMS * c->Size)
+        n = DMA_COPY_MAX_ITEMS * c->Size;
+
+    ch->CFGR = 0;
+    ch->PADDR = c->Src;
+    ch->MADDR = c->Dst;
+    ch->CNTR = n / c->Size;
+    ch->CFGR = c->Cfgr | 1;
+
+    if(c->Job.Op == DMA_COPY_OP_COPY)
+        c->Src += n;
+    c->Dst += n;
+    c->Left -= n;
+}
+
+/*********************************************************************
+ * @fn      dma_copy_begin
+ *
+ * @brief   Starts Job in slot k: the unaligned ends by CPU, the
+ *          first transfer of the rest.
+ *
+ * @return  1 if a transfer runs, 0 if the CPU did the whole job.
+ */
+static uint8_t dma_copy_begin(uint8_t k, const DMA_CopyJobTypeDef *Job)
+{
+    DMA_CopyChTypeDef *c = &dma_copy_ch[k];
+    uint32_t           dst = (uint32_t)(uintptr_t)Job->Dst, src, head, body, tail;
+
+    c->Job = *Job;
+    c->Pattern = Job->Value * (uint32_t)0x01010101;
+    if(Job->Op == DMA_COPY_OP_COPY)
+    {
+        src = (uint32_t)(uintptr_t)Job->Src;
+        c->Size = ((dst ^ src) & 3) == 0 ? 4 : ((dst ^ src) & 1) == 0 ? 2 : 1;
+    }
+    else
+    {
+        src = (uint32_t)(uintptr_t)&c->Pattern;
+        c->Size = 4;
+    }
+
+    head = (0 - dst) & (c->Size - 1);
+    if(head > Job->Length)
+        head = Job->Length;
+    body = (Job->Length - head) & ~(uint32_t)(c->Size - 1);
+    tail = Job->Length - head - body;
+
+    if(Job->Op == DMA_COPY_OP_COPY)
+    {
+        memcpy((uint8_t *)Job->Dst, Job->Src, head);
+        memcpy((uint8_t *)Job->Dst + head + body, (const uint8_t *)Job->Src + head + body, tail);
+        src += head;
+        c->Cfgr = DMA_COPY_CFGR | DMA_PeripheralInc_Enable;
+    }
+    else
+    {
+        memset(Job->Dst, Job->Value, head);
+        memset((uint8_t *)Job->Dst + head + body, Job->Value, tail);
+        c->Cfgr = DMA_COPY_CFGR;
+    }
+    c->Cfgr |= c->Size == 4 ? DMA_PeripheralDataSize_Word | DMA_MemoryDataSize_Word :
+               c->Size == 2 ? DMA_PeripheralDataSize_HalfWord | DMA_MemoryDataSize_HalfWord :
+                              DMA_PeripheralDataSize_Byte | DMA_MemoryDataSize_Byte;
+    c->Dst = dst + head;
+    c->Src = src;
+    c->Left = body;
+    if(body == 0)
+        return 0;
+
+    dma_copy_transfer(k);
+    return 1;
+}
+
+/*********************************************************************
+ * @fn      dma_copy_dispatch
+ *
+ * @brief   Starts queued jobs on the free channels. Jobs the CPU did
+ *          entirely complete here.
+ *
+ * @return  none
+ */
+static void dma_copy_dispatch(void)
+{
+    DMA_CopyJobTypeDef job;
+    uint8_t            k;
+
+    for(k = 0; k < DMA_COPY_CHANNELS && dma_copy_head != dma_copy_tail; k++){
+        if(dma_copy_chan[k] == 0 || dma_copy_ch[k].Busy)
+            continue;
+
+        /* The slot may be reused by a Submit from the callback */
+        job = dma_copy_queue[dma_copy_head & DMA_COPY_QUEUE_MASK];
+        dma_copy_head++;
+        dma_copy_ch[k].Busy = 1;
+        dma_copy_running++;
+        if(dma_copy_begin(k, &job))
+            continue;
+
+        dma_copy_ch[k].Busy = 0;
+        dma_copy_running--;
+        if(job.Callback)
+            job.Callback(job.Context, SUCCESS);
+        k--;  /* Channel k is free again */
+    }
+}
+
+/*********************************************************************
+ * @fn      dma_copy_irq
+ *
+ * @brief   Channel handler of slot Context: on transfer complete or
+ *          error starts the next transfer, or ends the job and starts
+ *          the next one.
+ *
+ * @return  none
+ */
+static void dma_copy_irq(void *Context, uint32_t Flags)
+{
+    uint8_t            k = (uint8_t)(uintptr_t)Context;
+    DMA_CopyChTypeDef *c = &dma_copy_ch[k];
+    DMA_CopyCallback   callback;
+    ErrorStatus        status = SUCCESS;
+
+    if(!c->Busy || !(Flags & (DMA_CHAN_TC | DMA_CHAN_TE)))
+        return;
+
+    if(Flags & DMA_CHAN_TE)
+        status = ERROR;
+    else if(c->Left)
+    {
+        dma_copy_transfer(k);
+        return;
+    }
+
+    DMA_COPY_CH(k)->CFGR = 0;
+    callback = c->Job.Callback;
+    c->Busy = 0;
+    dma_copy_running--;
+    if(callback)
+        callback(c->Job.Context, status);
+    dma_copy_dispatch();
+}
+
+/*********************************************************************
+ * @fn      DMA_Copy_Init
+ *
+ * @brief   Empties the job queue and takes DMA_COPY_CHANNELS
+ *          memory-to-memory channels, or as many as are free.
+ *
+ * @return  SUCCESS, or ERROR if no channel was free.
+ */
+ErrorStatus DMA_Copy_Init(void)
+{
+    uint8_t k;
+
+    DMA_Copy_DeInit();
+    dma_copy_head = 0;
+    dma_copy_tail = 0;
+    dma_copy_running = 0;
+    memset(dma_copy_ch, 0, sizeof(dma_copy_ch));
+    for(k = 0; k < DMA_COPY_CHANNELS; k++){
+        dma_copy_chan[k] = DMA_Chan_Alloc(DMA_REQ_MEM2MEM, dma_copy_irq, (void *)(uintptr_t)k);
+    }
+    /* Allocated unmasked: leave the nesting count at zero */
+    dma_copy_masked = 0;
+
+    return dma_copy_chan[0] ? SUCCESS : ERROR;
+}
+
+/*********************************************************************
+ * @fn      DMA_Copy_DeInit
+ *
+ * @brief   Gives the engine's channels back to the manager. Jobs still
+ *          queued or running are dropped without their callbacks.
+ *
+ * @return  none
+ */
+void DMA_Copy_DeInit(void)
+{
+    uint8_t k;
+
+    for(k = 0; k < DMA_COPY_CHANNELS; k++){
+        if(dma_copy_chan[k])
+            DMA_Chan_Free(dma_copy_chan[k]);
+        dma_copy_chan[k] = 0;
+        dma_copy_ch[k].Busy = 0;
+    }
+    dma_copy_head = dma_copy_tail;
+    dma_copy_running = 0;
+}
+
+/*********************************************************************
+ * @fn      DMA_Copy_Submit
+ *
+ * @brief   Queues a copy of Job and starts it if a channel is free. A
+ *          job the CPU does entirely (under one item) completes, and
+ *          its callback runs, before this returns.
+ *
+ * @param   Job - job descriptor.
+ *
+ * @return  SUCCESS - queued.
+ *          ERROR - queue full, no buffer, or the engine holds no channel.
+ */
+ErrorStatus DMA_Copy_Submit(const DMA_CopyJobTypeDef *Job)
+{
+    if(Job->Length && (Job->Dst == NULL || (Job->Op == DMA_COPY_OP_COPY && Job->Src == NULL)))
+        return ERROR;
+    if(dma_copy_chan[0] == 0)
+        return ERROR;
+
+    dma_copy_irq_off();
+    if((uint8_t)(dma_copy_tail - dma_copy_head) >= DMA_COPY_QUEUE_LEN)
+    {
+        dma_copy_irq_on();
+        return ERROR;
+    }
+    dma_copy_queue[dma_copy_tail & DMA_COPY_QUEUE_MASK] = *Job;
+    dma_copy_tail++;
+    dma_copy_dispatch();
+    dma_copy_irq_on();
+
+    return SUCCESS;
+}
+
+/*********************************************************************
+ * @fn      DMA_Copy_Pending
+ *
+ * @brief   Number of jobs queued or running.
+ *
+ * @return  0 once every job completed.
+ */
+uint8_t DMA_Copy_Pending(void)
+{
+    return (uint8_t)(dma_copy_tail - dma_copy_head) + dma_copy_running;
+}
+
+/*********************************************************************
+ * @fn      DMA_Copy_Poll
+ *
+ * @brief   Does the work of the channel interrupts whose flags are set,
+ *          for callers waiting with interrupts off.
+ *
+ * @return  none
+ */
+void DMA_Copy_Poll(void)
+{
+    uint8_t k;
+
+    dma_copy_irq_off();
+    for(k = 0; k < DMA_COPY_CHANNELS; k++){
+        if(dma_copy_ch[k].Busy)
+            DMA_Chan_Service(dma_copy_chan[k]);
+    }
+    dma_copy_irq_on();
+}
+
+/*********************************************************************
+ * @fn      dma_copy_sync_done
+ *
+ * @brief   Callback of the synchronous jobs.
+ *
+ * @return  none
+ */
+static void dma_copy_sync_done(void *Context, ErrorStatus Status)
+{
+    *(volatile uint8_t *)Context = Status == SUCCESS ? 1 : 2;
+}
+
+/*********************************************************************
+ * @fn      dma_copy_sync
+ *
+ * @brief   Runs Job behind the jobs queued before it and waits for it.
+ *
+ * @return  SUCCESS, or ERROR on a DMA transfer error.
+ */
+static ErrorStatus dma_copy_sync(DMA_CopyJobTypeDef *Job)
+{
+    volatile uint8_t done = 0;
+
+    if(dma_copy_chan[0] == 0)
+        return ERROR;
+    Job->Callback = dma_copy_sync_done;
+    Job->Context = (void *)&done;
+    while(DMA_Copy_Submit(Job) != SUCCESS)
+    {
+        DMA_Copy_Poll();
+    }
+    while(!done)
+    {
+        DMA_Copy_Poll();
+    }
+    return done == 1 ? SUCCESS : ERROR;
+}
+
+/*********************************************************************
+ * @fn      DMA_Copy_Sync
+ *
+ * @brief   memcpy through the engine. Main loop only.
+ *
+ * @param   Dst - destination.
+ *          Src - source, not overlapping Dst.
+ *          Length - bytes.
+ *
+ * @return  SUCCESS, or ERROR on a DMA transfer error, no buffer or no
+ *          channel.
+ */
+ErrorStatus DMA_Copy_Sync(void *Dst, const void *Src, uint32_t Length)
+{
+    DMA_CopyJobTypeDef job;
+
+    if(Length && (Dst == NULL || Src == NULL))
+        return ERROR;
+    job.Op = DMA_COPY_OP_COPY;
+    job.Dst = Dst;
+    job.Src = Src;
+    job.Length = Length;
+    job.Value = 0;
+    return dma_copy_sync(&job);
+}
+
+/*********************************************************************
+ * @fn      DMA_Fill_Sync
+ *
+ * @brief   memset through the engine. Main loop only.
+ *
+ * @param   Dst - destination.
+ *          Value - byte to store.
+ *          Length - bytes.
+ *
+ * @return  SUCCESS, or ERROR on a DMA transfer error, no buffer or no
+ *          channel.
+ */
+ErrorStatus DMA_Fill_Sync(void *Dst, uint8_t Value, uint32_t Length)
+{
+    DMA_CopyJobTypeDef job;
+
+    if(Length && Dst == NULL)
+        return ERROR;
+    job.Op = DMA_COPY_OP_FILL;
+    job.Dst = Dst;
+    job.Src = NULL;
+    job.Length = Length;
+    job.Value = Value;
+    return dma_copy_sync(&job);
+}
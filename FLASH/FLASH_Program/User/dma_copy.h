@@ -0,0 +1,64 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : dma_copy.h
+ * Author             : typetrade
+ * Version            : V1.0.0
+ * Date               : 2026/10/17
+ * Description        : Asynchronous memcpy/memset on DMA1 memory-to-memory
+ *                      channels.
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+#ifndef __DMA_COPY_H
+#define __DMA_COPY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "debug.h"
+
+/* Memory-to-memory channels the engine takes from the channel manager
+ * (dma_chan.h) and holds, 1 to 7 */
+#ifndef DMA_COPY_CHANNELS
+#define DMA_COPY_CHANNELS          2
+#endif
+
+/* Jobs that can wait for a channel, power of two */
+#define DMA_COPY_QUEUE_LEN         8
+
+/* Job kinds */
+typedef enum
+{
+    DMA_COPY_OP_COPY = 0,          /* memcpy(Dst, Src, Length) */
+    DMA_COPY_OP_FILL               /* memset(Dst, Value, Length) */
+} DMA_CopyOpTypeDef;
+
+/* Completion callback, runs in the channel interrupt handler (or in
+ * DMA_Copy_Poll): Status is ERROR after a DMA transfer error */
+typedef void (*DMA_CopyCallback)(void *Context, ErrorStatus Status);
+
+/* Job descriptor. The queue keeps a copy of it; the buffers must stay
+ * valid until the callback ran. */
+typedef struct
+{
+    DMA_CopyOpTypeDef Op;
+    void             *Dst;
+    const void       *Src;         /* DMA_COPY_OP_COPY; must not overlap Dst */
+    uint32_t          Length;      /* Bytes */
+    uint8_t           Value;       /* DMA_COPY_OP_FILL */
+    DMA_CopyCallback  Callback;    /* May be NULL */
+    void             *Context;     /* Passed to Callback */
+} DMA_CopyJobTypeDef;
+
+ErrorStatus DMA_Copy_Init(void);
+void        DMA_Copy_DeInit(void);
+ErrorStatus DMA_Copy_Submit(const DMA_CopyJobTypeDef *Job);
+uint8_t     DMA_Copy_Pending(void);
+void        DMA_Copy_Poll(void);
+ErrorStatus DMA_Copy_Sync(void *Dst, const void *Src, uint32_t Length);
+ErrorStatus DMA_Fill_Sync(void *Dst, uint8_t Value, uint32_t Length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __DMA_COPY_H */
@@ -0,0 +1,417 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : eeprom_cache.c
+ * Author             : typetrade
+ * Version            : V1.0.0
+ * Date               : 2026/10/17
+ * Description        : RAM write-back cache of 256B pages in front of the
+ *                      EEPROM emulation area.
+ *                      EEPROM_Cache_Read/Write take the same StartAddr
+ *                      offsets as EEPROM_READ/EEPROM_WRITE, but writes
+ *                      overwrite in place: no EEPROM_ERASE is needed.
+ *                      Writes land in RAM, repeated writes to a page
+ *                      coalesce, and a dirty page costs one fast erase and
+ *                      one fast program when it is written back: on
+ *                      EEPROM_Cache_Sync, when it stayed dirty for
+ *                      EEPROM_CACHE_TIMEOUT_MS (EEPROM_Cache_Tick), or
+ *                      when its slot is needed for another page (least
+ *                      recently used first). Reads are served from RAM
+ *                      when the page is cached.
+ *                      EEPROM_Cache_Init also puts the cache in front of
+ *                      EEPROM_READ, EEPROM_WRITE and EEPROM_ERASE
+ *                      (EEPROM_SetHook), which then work on
+ *                      EEPROM_CACHE_BASE too: EEPROM_READ sees cached
+ *                      pages, EEPROM_WRITE is EEPROM_Cache_Write on whole
+ *                      words, and EEPROM_ERASE drops the cached pages of
+ *                      the 4K pages it erases, dirty or not.
+ *                      Writes not yet synced are lost on reset.
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+#include <string.h>
+#include "eeprom_cache.h"
+#include "flash_write.h"
+
+#define EEPROM_CACHE_PAGE_MASK     ((uint32_t)(EEPROM_CACHE_PAGE_SIZE - 1))
+
+/* One cached page */
+typedef struct
+{
+    uint32_t Page;          /* Flash address */
+    uint32_t DirtySince;    /* Time of the first write not written back */
+    uint32_t Used;          /* LRU stamp */
+    uint8_t  Valid;
+    uint8_t  Dirty;
+    uint32_t Data[EEPROM_CACHE_PAGE_SIZE / 4];
+} EEPROM_CacheSlotTypeDef;
+
+static EEPROM_CacheSlotTypeDef  ec_slot[EEPROM_CACHE_PAGES];
+static uint32_t                 ec_now = 0;
+static uint32_t                 ec_stamp = 0;
+static EEPROM_CacheStatsTypeDef ec_stats;
+
+/*********************************************************************
+ * @fn      ec_lookup
+ *
+ * @brief   Finds the slot caching Page.
+ *
+ * @return  Slot, NULL on a miss.
+ */
+static EEPROM_CacheSlotTypeDef *ec_lookup(uint32_t Page)
+{
+    uint8_t i;
+
+    for(i = 0; i < EEPROM_CACHE_PAGES; i++){
+        if(ec_slot[i].Valid && ec_slot[i].Page == Page)
+        {
+            ec_slot[i].Used = ++ec_stamp;
+            return &ec_slot[i];
+        }
+    }
+    return NULL;
+}
+
+/*********************************************************************
+ * @fn      ec_flush
+ *
+ * @brief   Writes a dirty slot back with one erase + program.
+ *
+ * @return  FLASH Status.
+ */
+static FLASH_Status ec_flush(EEPROM_CacheSlotTypeDef *Slot)
+{
+    FLASH_Status status;
+
+    if(!Slot->Valid || !Slot->Dirty)
+        return FLASH_COMPLETE;
+
+    status = FLASH_Write(Slot->Page, Slot->Data, EEPROM_CACHE_PAGE_SIZE);
+    if(status == FLASH_COMPLETE)
+    {
+        Slot->Dirty = 0;
+        ec_stats.Flushes++;
+    }
+    return status;
+}
+
+/*********************************************************************
+ * @fn      ec_load
+ *
+ * @brief   Gives Page a slot, evicting the least recently used one.
+ *
+ * @param   Page - flash page address.
+ *          Fill - 1 to copy the page contents in, 0 when the caller
+ *            overwrites all of it.
+ *          Slot - receives the slot.
+ *
+ * @return  FLASH Status of the eviction write-back.
+ */
+static FLASH_Status ec_load(uint32_t Page, uint8_t Fill, EEPROM_CacheSlotTypeDef **Slot)
+{
+    EEPROM_CacheSlotTypeDef *s = &ec_slot[0];
+    FLASH_Status             status;
+    uint8_t                  i;
+
+    for(i = 0; i < EEPROM_CACHE_PAGES; i++){
+        if(!ec_slot[i].Valid)
+        {
+            s = &ec_slot[i];
+            break;
+        }
+        if(ec_slot[i].Used < s->Used)
+            s = &ec_slot[i];
+    }
+
+    if(s->Valid)
+    {
+        status = ec_flush(s);
+        if(status != FLASH_COMPLETE)
+            return status;
+        ec_stats.Evictions++;
+    }
+
+    s->Page = Page;
+    s->Valid = 1;
+    s->Dirty = 0;
+    s->Used = ++ec_stamp;
+    if(Fill)
+        memcpy(s->Data, (const void *)Page, EEPROM_CACHE_PAGE_SIZE);
+
+    *Slot = s;
+    return FLASH_COMPLETE;
+}
+
+/*********************************************************************
+ * @fn      ec_range
+ *
+ * @brief   Checks that [StartAddr, StartAddr + Length) is inside the area.
+ *
+ * @return  1 if it is.
+ */
+static uint8_t ec_range(uint32_t StartAddr, uint32_t Length)
+{
+    return StartAddr <= EEPROM_CACHE_AREA && Length <= EEPROM_CACHE_AREA - StartAddr;
+}
+
+/*********************************************************************
+ * @fn      ec_read
+ *
+ * @brief   Reads from the flash at Addr, or from RAM for cached pages.
+ *
+ * @return  none
+ */
+static void ec_read(uint32_t Addr, uint8_t *Dst, uint32_t Length)
+{
+    EEPROM_CacheSlotTypeDef *s;
+    uint32_t                 offset, n;
+
+    while(Length)
+    {
+        offset = Addr & EEPROM_CACHE_PAGE_MASK;
+        n = EEPROM_CACHE_PAGE_SIZE - offset;
+        if(n > Length)
+            n = Length;
+
+        s = ec_lookup(Addr - offset);
+        if(s)
+        {
+            memcpy(Dst, (const uint8_t *)s->Data + offset, n);
+            ec_stats.ReadHits++;
+        }
+        else
+        {
+            memcpy(Dst, (const void *)Addr, n);
+            ec_stats.ReadMisses++;
+        }
+
+        Addr += n;
+        Dst += n;
+        Length -= n;
+    }
+}
+
+/*********************************************************************
+ * @fn      ec_write
+ *
+ * @brief   Writes into the cache, loading the pages it does not hold.
+ *
+ * @return  FLASH_COMPLETE or the status of an eviction write-back.
+ */
+static FLASH_Status ec_write(uint32_t Addr, const uint8_t *Src, uint32_t Length)
+{
+    EEPROM_CacheSlotTypeDef *s;
+    FLASH_Status             status;
+    uint32_t                 offset, n;
+
+    while(Length)
+    {
+        offset = Addr & EEPROM_CACHE_PAGE_MASK;
+        n = EEPROM_CACHE_PAGE_SIZE - offset;
+        if(n > Length)
+            n = Length;
+
+        s = ec_lookup(Addr - offset);
+        if(s == NULL)
+        {
+            status = ec_load(Addr - offset, n != EEPROM_CACHE_PAGE_SIZE, &s);
+            if(status != FLASH_COMPLETE)
+                return status;
+        }
+
+        memcpy((uint8_t *)s->Data + offset, Src, n);
+        if(s->Dirty)
+        {
+            ec_stats.Coalesced++;
+        }
+        else
+        {
+            s->Dirty = 1;
+            s->DirtySince = ec_now;
+        }
+        ec_stats.Writes++;
+
+        Addr += n;
+        Src += n;
+        Length -= n;
+    }
+    return FLASH_COMPLETE;
+}
+
+/*********************************************************************
+ * @fn      ec_hook_read
+ *
+ * @brief   EEPROM_READ through the cache.
+ *
+ * @return  FLASH_COMPLETE, FLASH_ERROR_PG outside the area.
+ */
+static FLASH_Status ec_hook_read(uint32_t StartAddr, void *Buffer, uint32_t Length)
+{
+    return EEPROM_Cache_Read(StartAddr, Buffer, Length);
+}
+
+/*********************************************************************
+ * @fn      ec_hook_write
+ *
+ * @brief   EEPROM_WRITE through the cache: whole words, as EEPROM_WRITE,
+ *          written back with the pages they land in.
+ *
+ * @return  FLASH_COMPLETE, FLASH_ERROR_PG outside the area, or the
+ *          status of an eviction write-back.
+ */
+static FLASH_Status ec_hook_write(uint32_t StartAddr, void *Buffer, uint32_t Length)
+{
+    Length = (Length + 3) & ~(uint32_t)3;
+    if(!ec_range(StartAddr, Length))
+        return FLASH_ERROR_PG;
+
+    ec_stats.EepromWrites++;
+    return ec_write(EEPROM_CACHE_BASE + StartAddr, (const uint8_t *)Buffer, Length);
+}
+
+/*********************************************************************
+ * @fn      ec_hook_erase
+ *
+ * @brief   EEPROM_ERASE through the cache: drops the cached pages of the
+ *          4K pages covering the range, whose RAM copy would overwrite
+ *          the erase, then erases those 4K pages.
+ *
+ * @return  FLASH_COMPLETE, FLASH_ERROR_PG outside the area, or the
+ *          status of the failing erase.
+ */
+static FLASH_Status ec_hook_erase(uint32_t StartAddr, uint32_t Length)
+{
+    FLASH_Status status = FLASH_COMPLETE;
+    uint32_t     start, end, addr;
+    uint8_t      i;
+
+    if(!ec_range(StartAddr, Length))
+        return FLASH_ERROR_PG;
+
+    start = EEPROM_CACHE_BASE + (StartAddr & ~(uint32_t)0xFFF);
+    end = (EEPROM_CACHE_BASE + StartAddr + Length + 0xFFF) & ~(uint32_t)0xFFF;
+    for(i = 0; i < EEPROM_CACHE_PAGES; i++){
+        if(ec_slot[i].Valid && ec_slot[i].Page >= start && ec_slot[i].Page < end)
+        {
+            ec_slot[i].Valid = 0;
+            ec_stats.Dropped++;
+        }
+    }
+
+    for(addr = start; addr < end && status == FLASH_COMPLETE; addr += 4096){
+        status = FLASH_ErasePage(addr);
+    }
+    return status;
+}
+
+static const EEPROM_HookTypeDef ec_hook = {ec_hook_read, ec_hook_write, ec_hook_erase};
+
+/*********************************************************************
+ * @fn      EEPROM_Cache_Init
+ *
+ * @brief   Drops every cached page without writing it back, and puts
+ *          the cache in front of EEPROM_READ/EEPROM_WRITE/EEPROM_ERASE.
+ *
+ * @return  none
+ */
+void EEPROM_Cache_Init(void)
+{
+    memset(ec_slot, 0, sizeof(ec_slot));
+    memset(&ec_stats, 0, sizeof(ec_stats));
+    ec_stamp = 0;
+    EEPROM_SetHook(&ec_hook);
+}
+
+/*********************************************************************
+ * @fn      EEPROM_Cache_Read
+ *
+ * @brief   Reads EEPROM data, from RAM for cached pages.
+ *
+ * @param   StartAddr - offset in the EEPROM area.
+ *          Buffer - destination.
+ *          Length - bytes.
+ *
+ * @return  FLASH_COMPLETE, FLASH_ERROR_PG outside the area.
+ */
+FLASH_Status EEPROM_Cache_Read(uint32_t StartAddr, void *Buffer, uint32_t Length)
+{
+    if(!ec_range(StartAddr, Length))
+        return FLASH_ERROR_PG;
+
+    ec_read(EEPROM_CACHE_BASE + StartAddr, (uint8_t *)Buffer, Length);
+    return FLASH_COMPLETE;
+}
+
+/*********************************************************************
+ * @fn      EEPROM_Cache_Write
+ *
+ * @brief   Writes EEPROM data into the cache. Pages are written back
+ *          later, see EEPROM_Cache_Sync and EEPROM_Cache_Tick.
+ *
+ * @param   StartAddr - offset in the EEPROM area.
+ *          Buffer - source.
+ *          Length - bytes.
+ *
+ * @return  FLASH_COMPLETE, FLASH_ERROR_PG outside the area, or the
+ *          status of an eviction write-back.
+ */
+FLASH_Status EEPROM_Cache_Write(uint32_t StartAddr, const void *Buffer, uint32_t Length)
+{
+    if(!ec_range(StartAddr, Length))
+        return FLASH_ERROR_PG;
+
+    return ec_write(EEPROM_CACHE_BASE + StartAddr, (const uint8_t *)Buffer, Length);
+}
+
+/*********************************************************************
+ * @fn      EEPROM_Cache_Sync
+ *
+ * @brief   Writes every dirty page back.
+ *
+ * @return  FLASH_COMPLETE or the status of the first failing page.
+ */
+FLASH_Status EEPROM_Cache_Sync(void)
+{
+    FLASH_Status status = FLASH_COMPLETE;
+    uint8_t      i;
+
+    for(i = 0; i < EEPROM_CACHE_PAGES && status == FLASH_COMPLETE; i++){
+        status = ec_flush(&ec_slot[i]);
+    }
+    return status;
+}
+
+/*********************************************************************
+ * @fn      EEPROM_Cache_Tick
+ *
+ * @brief   Advances the cache clock and writes back pages dirty for
+ *          EEPROM_CACHE_TIMEOUT_MS. Call it from the main loop.
+ *
+ * @param   Now_ms - free-running millisecond time, may wrap.
+ *
+ * @return  FLASH_COMPLETE or the status of the first failing page.
+ */
+FLASH_Status EEPROM_Cache_Tick(uint32_t Now_ms)
+{
+    FLASH_Status status = FLASH_COMPLETE;
+    uint8_t      i;
+
+    ec_now = Now_ms;
+    for(i = 0; i < EEPROM_CACHE_PAGES && status == FLASH_COMPLETE; i++){
+        if(ec_slot[i].Valid && ec_slot[i].Dirty && Now_ms - ec_slot[i].DirtySince >= EEPROM_CACHE_TIMEOUT_MS)
+        {
+            status = ec_flush(&ec_slot[i]);
+            ec_stats.Timeouts++;
+        }
+    }
+    return status;
+}
+
+/*********************************************************************
+ * @fn      EEPROM_Cache_GetStats
+ *
+ * @brief   Copies the cache counters.
+ *
+ * @return  none
+ */
+void EEPROM_Cache_GetStats(EEPROM_CacheStatsTypeDef *Stats)
+{
+    *Stats = ec_stats;
+}
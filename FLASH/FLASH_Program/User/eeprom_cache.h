@@ -0,0 +1,76 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : eeprom_cache.h
+ * Author             : typetrade
+ * Version            : V1.0.0
+ * Date               : 2026/10/17
+ * Description        : RAM write-back cache of 256B pages in front of the
+ *                      EEPROM emulation area.
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+#ifndef __EEPROM_CACHE_H
+#define __EEPROM_CACHE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "debug.h"
+
+/* EEPROM emulation area. Once EEPROM_Cache_Init ran, EEPROM_READ,
+ * EEPROM_WRITE and EEPROM_ERASE use it too, in place of EEPROM_ADDRESS
+ * of ch32v20x_flash.c. The D6 default is the last 8K of the 64K parts,
+ * the D8/D8W one the vendor area. */
+#if defined(CH32V20x_D8) || defined(CH32V20x_D8W)
+#ifndef EEPROM_CACHE_BASE
+#define EEPROM_CACHE_BASE          ((uint32_t)0x08070000)
+#endif
+#ifndef EEPROM_CACHE_AREA
+#define EEPROM_CACHE_AREA          ((uint32_t)0x00010000)
+#endif
+#else
+#ifndef EEPROM_CACHE_BASE
+#define EEPROM_CACHE_BASE          ((uint32_t)0x0800E000)
+#endif
+#ifndef EEPROM_CACHE_AREA
+#define EEPROM_CACHE_AREA          ((uint32_t)0x00002000)
+#endif
+#endif
+
+/* Cached pages: 4 x 256B fits the 10K RAM parts */
+#ifndef EEPROM_CACHE_PAGES
+#define EEPROM_CACHE_PAGES         4
+#endif
+
+/* A dirty page is written back after this long, see EEPROM_Cache_Tick */
+#ifndef EEPROM_CACHE_TIMEOUT_MS
+#define EEPROM_CACHE_TIMEOUT_MS    1000
+#endif
+
+#define EEPROM_CACHE_PAGE_SIZE     256
+
+/* Counters */
+typedef struct
+{
+    uint32_t ReadHits;      /* Read chunks served from RAM */
+    uint32_t ReadMisses;    /* Read chunks served from flash */
+    uint32_t Writes;        /* Write chunks */
+    uint32_t Coalesced;     /* Write chunks landing on an already dirty page */
+    uint32_t Flushes;       /* Pages written back (one erase + program each) */
+    uint32_t Evictions;     /* Pages dropped to make room */
+    uint32_t Timeouts;      /* Write-backs started by EEPROM_Cache_Tick */
+    uint32_t EepromWrites;  /* EEPROM_WRITE calls, taken as EEPROM_Cache_Write */
+    uint32_t Dropped;       /* Cached pages dropped by EEPROM_ERASE */
+} EEPROM_CacheStatsTypeDef;
+
+void         EEPROM_Cache_Init(void);
+FLASH_Status EEPROM_Cache_Read(uint32_t StartAddr, void *Buffer, uint32_t Length);
+FLASH_Status EEPROM_Cache_Write(uint32_t StartAddr, const void *Buffer, uint32_t Length);
+FLASH_Status EEPROM_Cache_Sync(void);
+FLASH_Status EEPROM_Cache_Tick(uint32_t Now_ms);
+void         EEPROM_Cache_GetStats(EEPROM_CacheStatsTypeDef *Stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __EEPROM_CACHE_H */
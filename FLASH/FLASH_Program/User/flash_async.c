@@ -0,0 +1,300 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : flash_async.c
+ * Author             : typetrade
+ * Version            : V1.0.0
+ * Date               : 2026/10/17
+ * Description        : Interrupt-driven FLASH erase/program job queue.
+ *                      A job is started from FLASH_Async_Submit when the
+ *                      controller is idle, every following step is started
+ *                      from FLASH_IRQHandler on the end-of-operation (EOP)
+ *                      or error interrupt, so the main loop only pays for
+ *                      starting operations instead of polling BSY.
+ *
+ *                      Notes:
+ *                      - Unlock the controller (FLASH_Unlock, or
+ *                        FLASH_Unlock_Fast for the fast jobs) before
+ *                        submitting, and do not call the blocking
+ *                        ch32v20x_flash.c functions while jobs are pending.
+ *                      - Above 100MHz keep HCLK divided by 2 until the
+ *                        queue is empty, see main.c.
+ *                      - The core stalls on any fetch or read of the
+ *                        array while it is busy, whatever the address
+ *                        (see __HIGH_CODE). Submit, Pending and the
+ *                        handler path are RAM resident; main loop code
+ *                        only makes progress during a job when it is
+ *                        __HIGH_CODE too and keeps its data in RAM.
+ *                        Callbacks run between jobs, from flash.
+ *                      Built with SIM_HOST the handler is driven by the
+ *                      host FLASH simulator (HOST/FlashAsync).
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+#include "flash_async.h"
+
+#ifdef SIM_HOST
+#include "sim_flash.h"
+#endif
+
+/* FLASH Control Register bits, as in ch32v20x_flash.c */
+#define CR_PG_Set                  ((uint32_t)0x00000001)
+#define CR_PER_Set                 ((uint32_t)0x00000002)
+#define CR_STRT_Set                ((uint32_t)0x00000040)
+#define CR_PAGE_PG                 ((uint32_t)0x00010000)
+#define CR_PAGE_ER                 ((uint32_t)0x00020000)
+#define CR_BER32                   ((uint32_t)0x00040000)
+#define CR_BER64                   ((uint32_t)0x00080000)
+#define CR_PG_STRT                 ((uint32_t)0x00200000)
+#define CR_OP_Mask                 (CR_PG_Set | CR_PER_Set | CR_PAGE_PG | CR_PAGE_ER | CR_BER32 | CR_BER64)
+
+/* FLASH Status Register bits */
+#define SR_BSY                     ((uint32_t)0x00000001)
+#define SR_WR_BSY                  ((uint32_t)0x00000002)
+#define SR_FLAG_Mask               (FLASH_FLAG_EOP | FLASH_FLAG_PGERR | FLASH_FLAG_WRPRTERR)
+
+#define FLASH_JOB_QUEUE_MASK       (FLASH_JOB_QUEUE_LEN - 1)
+
+/* Submit and the handler share the queue: keep the FLASH interrupt out while
+ * the main loop touches it. The simulator only raises it between steps. */
+#ifdef SIM_HOST
+#define FLASH_ASYNC_IRQ_OFF()
+#define FLASH_ASYNC_IRQ_ON()
+#else
+#define FLASH_ASYNC_IRQ_OFF()      NVIC_DisableIRQ(FLASH_IRQn)
+#define FLASH_ASYNC_IRQ_ON()       NVIC_EnableIRQ(FLASH_IRQn)
+#endif
+
+#ifndef SIM_HOST
+void FLASH_IRQHandler(void) __attribute__((interrupt("WCH-Interrupt-fast")));
+#endif
+
+/* Job queue: Submit advances tail, the handler advances head */
+static FLASH_JobTypeDef flash_job_queue[FLASH_JOB_QUEUE_LEN];
+static volatile uint8_t flash_job_head = 0;
+static volatile uint8_t flash_job_tail = 0;
+static volatile uint8_t flash_job_active = 0;
+static uint32_t         flash_job_done = 0; /* Bytes programmed of the running FLASH_JOB_PROGRAM */
+
+/*********************************************************************
+ * @fn      flash_job_halfword
+ *
+ * @brief   Starts programming the next halfword of a FLASH_JOB_PROGRAM job.
+ *
+ * @param   Job - running job.
+ *
+ * @return  none
+ */
+static __HIGH_CODE void flash_job_halfword(const FLASH_JobTypeDef *Job)
+{
+    const uint8_t *p = (const uint8_t *)Job->Buffer + flash_job_done;
+
+    *(__IO uint16_t *)(Job->Address + flash_job_done) = (uint16_t)(p[0] | (p[1] << 8));
+}
+
+/*********************************************************************
+ * @fn      flash_job_start
+ *
+ * @brief   Starts the job at the head of the queue. Completion is reported
+ *          by the EOP or error interrupt.
+ *
+ * @return  none
+ */
+static __HIGH_CODE void flash_job_start(void)
+{
+    const FLASH_JobTypeDef *job = &flash_job_queue[flash_job_head & FLASH_JOB_QUEUE_MASK];
+    const uint32_t         *pbuf;
+    uint32_t                address;
+    uint8_t                 size;
+
+    FLASH->STATR = SR_FLAG_Mask;
+
+    switch(job->Op)
+    {
+        case FLASH_JOB_ERASE_PAGE:
+            FLASH->CTLR |= CR_PER_Set;
+            FLASH->ADDR = job->Address;
+            FLASH->CTLR |= CR_STRT_Set;
+            break;
+
+        case FLASH_JOB_PROGRAM:
+            flash_job_done = 0;
+            FLASH->CTLR |= CR_PG_Set;
+            flash_job_halfword(job);
+            break;
+
+        case FLASH_JOB_ERASE_PAGE_FAST:
+            FLASH->CTLR |= CR_PAGE_ER;
+            FLASH->ADDR = job->Address;
+            FLASH->CTLR |= CR_STRT_Set;
+            break;
+
+        case FLASH_JOB_ERASE_32K_FAST:
+            FLASH->CTLR |= CR_BER32;
+            FLASH->ADDR = job->Address;
+            FLASH->CTLR |= CR_STRT_Set;
+            break;
+
+        case FLASH_JOB_ERASE_64K_FAST:
+            FLASH->CTLR |= CR_BER64;
+            FLASH->ADDR = job->Address;
+            FLASH->CTLR |= CR_STRT_Set;
+            break;
+
+        case FLASH_JOB_PROGRAM_PAGE_FAST:
+            /* Loading the page buffer takes a few us, only PG_STRT is long */
+            address = job->Address;
+            pbuf = (const uint32_t *)job->Buffer;
+            FLASH->CTLR |= CR_PAGE_PG;
+            for(size = 64; size; size--){
+                *(__IO uint32_t *)address = *pbuf++;
+                address += 4;
+                while(FLASH->STATR & SR_WR_BSY);
+            }
+            FLASH->CTLR |= CR_PG_STRT;
+            break;
+    }
+}
+
+/*********************************************************************
+ * @fn      FLASH_Async_Init
+ *
+ * @brief   Empties the job queue and enables the FLASH interrupt. The EOP
+ *          and error sources are only enabled while jobs are pending.
+ *
+ * @return  none
+ */
+void FLASH_Async_Init(void)
+{
+    FLASH_ASYNC_IRQ_OFF();
+    FLASH_ITConfig(FLASH_IT_EOP | FLASH_IT_ERROR, DISABLE);
+    flash_job_head = 0;
+    flash_job_tail = 0;
+    flash_job_active = 0;
+#ifdef SIM_HOST
+    SIM_FLASH_SetIRQHandler(FLASH_IRQHandler);
+#endif
+    FLASH_ASYNC_IRQ_ON();
+}
+
+/*********************************************************************
+ * @fn      FLASH_Async_Submit
+ *
+ * @brief   Queues a copy of Job and starts it if the controller is idle.
+ *          May be called from a completion callback.
+ *
+ * @param   Job - job descriptor.
+ *
+ * @return  SUCCESS - queued.
+ *          ERROR - queue full, or address/length/buffer misaligned.
+ */
+__HIGH_CODE ErrorStatus FLASH_Async_Submit(const FLASH_JobTypeDef *Job)
+{
+    uint32_t align;
+
+    switch(Job->Op)
+    {
+        case FLASH_JOB_ERASE_PAGE:        align = 0xFFF;   break;
+        case FLASH_JOB_PROGRAM:           align = 0x1;     break;
+        case FLASH_JOB_ERASE_PAGE_FAST:   align = 0xFF;    break;
+        case FLASH_JOB_ERASE_32K_FAST:    align = 0x7FFF;  break;
+        case FLASH_JOB_ERASE_64K_FAST:    align = 0xFFFF;  break;
+        case FLASH_JOB_PROGRAM_PAGE_FAST: align = 0xFF;    break;
+        default:                          return ERROR;
+    }
+    if(Job->Address & align)
+        return ERROR;
+    if(Job->Op == FLASH_JOB_PROGRAM && (Job->Length == 0 || (Job->Length & 1) || Job->Buffer == NULL))
+        return ERROR;
+    if(Job->Op == FLASH_JOB_PROGRAM_PAGE_FAST && (Job->Buffer == NULL || ((uintptr_t)Job->Buffer & 3)))
+        return ERROR;
+
+    FLASH_ASYNC_IRQ_OFF();
+    if((uint8_t)(flash_job_tail - flash_job_head) >= FLASH_JOB_QUEUE_LEN)
+    {
+        FLASH_ASYNC_IRQ_ON();
+        return ERROR;
+    }
+    flash_job_queue[flash_job_tail & FLASH_JOB_QUEUE_MASK] = *Job;
+    flash_job_tail++;
+    if(!flash_job_active)
+    {
+        flash_job_active = 1;
+        FLASH_ITConfig(FLASH_IT_EOP | FLASH_IT_ERROR, ENABLE);
+        flash_job_start();
+    }
+    FLASH_ASYNC_IRQ_ON();
+
+    return SUCCESS;
+}
+
+/*********************************************************************
+ * @fn      FLASH_Async_Pending
+ *
+ * @brief   Number of jobs queued or running.
+ *
+ * @return  0 once every job completed.
+ */
+__HIGH_CODE uint8_t FLASH_Async_Pending(void)
+{
+    return (uint8_t)(flash_job_tail - flash_job_head);
+}
+
+/*********************************************************************
+ * @fn      FLASH_IRQHandler
+ *
+ * @brief   This function handles FLASH exception: finishes the running
+ *          step, reports completed jobs and starts the next one.
+ *
+ * @return  none
+ */
+__HIGH_CODE void FLASH_IRQHandler(void)
+{
+    const FLASH_JobTypeDef *job;
+    FLASH_JobCallback       callback;
+    void                   *context;
+    FLASH_Status            status = FLASH_COMPLETE;
+    uint32_t                statr = FLASH->STATR;
+
+    if(statr & SR_BSY)
+        return;
+
+    FLASH->STATR = SR_FLAG_Mask;
+    if(!flash_job_active)
+    {
+        FLASH_ITConfig(FLASH_IT_EOP | FLASH_IT_ERROR, DISABLE);
+        return;
+    }
+
+    job = &flash_job_queue[flash_job_head & FLASH_JOB_QUEUE_MASK];
+    if(statr & FLASH_FLAG_WRPRTERR)
+        status = FLASH_ERROR_WRP;
+    else if(statr & FLASH_FLAG_PGERR)
+        status = FLASH_ERROR_PG;
+
+    if(status == FLASH_COMPLETE && job->Op == FLASH_JOB_PROGRAM)
+    {
+        flash_job_done += 2;
+        if(flash_job_done < job->Length)
+        {
+            flash_job_halfword(job);
+            return;
+        }
+    }
+
+    FLASH->CTLR &= ~CR_OP_Mask;
+
+    /* The slot may be reused by a Submit from the callback */
+    callback = job->Callback;
+    context = job->Context;
+    flash_job_head++;
+    if(callback)
+        callback(context, status);
+
+    if(flash_job_head != flash_job_tail)
+    {
+        flash_job_start();
+    }
+    else
+    {
+        flash_job_active = 0;
+        FLASH_ITConfig(FLASH_IT_EOP | FLASH_IT_ERROR, DISABLE);
+    }
+}
@@ -0,0 +1,57 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : flash_async.h
+ * Author             : typetrade
+ * Version            : V1.0.0
+ * Date               : 2026/10/17
+ * Description        : Interrupt-driven FLASH erase/program job queue.
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+#ifndef __FLASH_ASYNC_H
+#define __FLASH_ASYNC_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "debug.h"
+
+/* Jobs that can be queued, power of two */
+#define FLASH_JOB_QUEUE_LEN        8
+
+/* Job kinds */
+typedef enum
+{
+    FLASH_JOB_ERASE_PAGE = 0,      /* Standard 4K page erase, needs FLASH_Unlock */
+    FLASH_JOB_PROGRAM,             /* Standard halfword program of Length bytes, needs FLASH_Unlock */
+    FLASH_JOB_ERASE_PAGE_FAST,     /* Fast 256B page erase, needs FLASH_Unlock_Fast */
+    FLASH_JOB_ERASE_32K_FAST,      /* Fast 32K block erase, needs FLASH_Unlock_Fast */
+    FLASH_JOB_ERASE_64K_FAST,      /* Fast 64K block erase, needs FLASH_Unlock_Fast */
+    FLASH_JOB_PROGRAM_PAGE_FAST    /* Fast 256B page program, needs FLASH_Unlock_Fast */
+} FLASH_JobOpTypeDef;
+
+/* Completion callback, runs in FLASH_IRQHandler: Status is FLASH_COMPLETE,
+ * FLASH_ERROR_PG or FLASH_ERROR_WRP */
+typedef void (*FLASH_JobCallback)(void *Context, FLASH_Status Status);
+
+/* Job descriptor. The queue keeps a copy of it, Buffer must stay valid
+ * until the callback ran. */
+typedef struct
+{
+    FLASH_JobOpTypeDef Op;
+    uint32_t           Address;   /* Page/block address, aligned to its size */
+    const void        *Buffer;    /* Data for the program jobs */
+    uint32_t           Length;    /* FLASH_JOB_PROGRAM: bytes, even */
+    FLASH_JobCallback  Callback;  /* May be NULL */
+    void              *Context;   /* Passed to Callback */
+} FLASH_JobTypeDef;
+
+void        FLASH_Async_Init(void);
+ErrorStatus FLASH_Async_Submit(const FLASH_JobTypeDef *Job);
+uint8_t     FLASH_Async_Pending(void);
+void        FLASH_IRQHandler(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __FLASH_ASYNC_H */
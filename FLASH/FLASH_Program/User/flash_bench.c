@@ -0,0 +1,589 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : flash_bench.c
+ * Author             : typetrade
+ * Version            : V1.0.0
+ * Date               : 2026/10/17
+ * Description        : Flash programming/erase throughput benchmark.
+ *                      Every programming API is timed with mcycle at each
+ *                      SYSCLK_FREQ_* setting of system_ch32v20x.c, with and
+ *                      without the HCLK/2 step, and reported as CSV.
+ *                      Built with SIM_HOST the same harness runs against the
+ *                      host FLASH simulator (HOST/Makefile, target bench).
+ *                      On the target a second table shows the instruction
+ *                      fetch stall: how long a call takes while a fast page
+ *                      erase runs, into flash and into .highcode RAM,
+ *                      a third compares the post-program checks: the
+ *                      CPU compare loop against the CRC/DMA verification
+ *                      of flash_verify.c, and a fourth memcpy against the
+ *                      DMA copy engine of dma_copy.c.
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+#include <string.h>
+#include "flash_bench.h"
+#include "flash_session.h"
+#include "flash_verify.h"
+#include "dma_copy.h"
+
+#ifdef SIM_HOST
+#include "sim_flash.h"
+#endif
+
+/* Flash Control/Status Register bits */
+#define CR_STRT_Set                ((uint32_t)0x00000040)
+#define CR_PAGE_ER                 ((uint32_t)0x00020000)
+#define SR_BSY                     ((uint32_t)0x00000001)
+#define SR_WRPRTERR                ((uint32_t)0x00000010)
+
+/* Benchmarked API */
+typedef struct
+{
+    const char *Name;
+    uint32_t    Bytes;                  /* Bytes erased or programmed per call */
+    uint16_t    Samples;
+    void (*Prepare)(void);
+    FLASH_Status (*Op)(uint32_t Index);
+} BENCH_ApiTypeDef;
+
+/* SYSCLK_FREQ_* options of system_ch32v20x.c */
+static const uint32_t bench_sysclk[] = {
+    HSE_VALUE, 24000000, 48000000, 56000000, 72000000, 96000000, 120000000, 144000000
+};
+
+static uint32_t bench_buf[64];
+static uint32_t bench_cyc[BENCH_SAMPLES];
+static uint32_t bench_hclk;
+
+/*********************************************************************
+ * @fn      bench_cycles
+ *
+ * @brief   Core cycle counter (mcycle, or simulated time on the host).
+ *
+ * @return  Cycle count.
+ */
+static uint32_t bench_cycles(void)
+{
+#ifdef SIM_HOST
+    return (uint32_t)(SIM_GetTime_ns() * bench_hclk / 1000000000ULL);
+#else
+    return __get_MCYCLE();
+#endif
+}
+
+/*********************************************************************
+ * @fn      bench_set_clock
+ *
+ * @brief   Switches SYSCLK to SysClk (HSE, or HSE * PLL) and applies the
+ *          HCLK/2 step, then re-initializes delay and printf.
+ *
+ * @return  0 when the clock could be set.
+ */
+static int bench_set_clock(uint32_t SysClk, uint8_t HclkDiv2)
+{
+#ifdef SIM_HOST
+    SIM_FLASH_TimingTypeDef t;
+
+    SystemCoreClock = SysClk;
+    bench_hclk = HclkDiv2 ? SysClk / 2 : SysClk;
+
+    /* One STATR poll costs about 12 HCLK cycles */
+    SIM_FLASH_GetTiming(&t);
+    t.SIM_RegAccess = (uint32_t)(12000000000ULL / bench_hclk);
+    SIM_FLASH_SetTiming(&t);
+    return 0;
+#else
+    static const uint32_t pllmul[19] = {
+        0, 0, RCC_PLLMul_2, RCC_PLLMul_3, RCC_PLLMul_4, RCC_PLLMul_5, RCC_PLLMul_6,
+        RCC_PLLMul_7, RCC_PLLMul_8, RCC_PLLMul_9, RCC_PLLMul_10, RCC_PLLMul_11,
+        RCC_PLLMul_12, RCC_PLLMul_13, RCC_PLLMul_14, RCC_PLLMul_15, RCC_PLLMul_16,
+        0, RCC_PLLMul_18
+    };
+    uint32_t mul = SysClk / HSE_VALUE;
+
+    /* Queued printf output must leave at the old clock */
+    USART_Printf_Flush();
+
+#if defined(CH32V20x_D8) || defined(CH32V20x_D8W)
+    /* The 32MHz HSE goes through PLLXTPRE on these parts, keep the build clock */
+    if(SysClk != SystemCoreClock)
+        return -1;
+#else
+    if(SysClk != HSE_VALUE && (mul > 18 || pllmul[mul] == 0 || mul * HSE_VALUE != SysClk))
+        return -1;
+
+    RCC_HCLKConfig(RCC_SYSCLK_Div1);
+    RCC_HSEConfig(RCC_HSE_ON);
+    if(RCC_WaitForHSEStartUp() != SUCCESS)
+        return -1;
+    RCC_SYSCLKConfig(RCC_SYSCLKSource_HSE);
+    while(RCC_GetSYSCLKSource() != 0x04);
+    RCC_PLLCmd(DISABLE);
+
+    if(SysClk != HSE_VALUE)
+    {
+        RCC_PLLConfig(RCC_PLLSource_HSE_Div1, pllmul[mul]);
+        RCC_PLLCmd(ENABLE);
+        while(RCC_GetFlagStatus(RCC_FLAG_PLLRDY) == RESET);
+        RCC_SYSCLKConfig(RCC_SYSCLKSource_PLLCLK);
+        while(RCC_GetSYSCLKSource() != 0x08);
+    }
+    SystemCoreClockUpdate();
+#endif
+
+    RCC_HCLKConfig(HclkDiv2 ? RCC_SYSCLK_Div2 : RCC_SYSCLK_Div1);
+    bench_hclk = HclkDiv2 ? SystemCoreClock / 2 : SystemCoreClock;
+    Delay_Init();
+    USART_Printf_Init(115200);
+    return 0;
+#endif
+}
+
+/* Preparation steps, not timed */
+static void bench_erase_4k(void)
+{
+    FLASH_ErasePage(BENCH_FLASH_ADDR);
+}
+
+static void bench_erase_32k(void)
+{
+    FLASH_EraseBlock_32K_Fast(BENCH_FLASH_ADDR);
+}
+
+static void bench_none(void)
+{
+}
+
+/* Timed operations */
+static FLASH_Status bench_halfword(uint32_t Index)
+{
+    return FLASH_ProgramHalfWord(BENCH_FLASH_ADDR + 2 * Index, 0xAAAA);
+}
+
+static FLASH_Status bench_word(uint32_t Index)
+{
+    return FLASH_ProgramWord(BENCH_FLASH_ADDR + 4 * Index, 0x5555AAAA);
+}
+
+static FLASH_Status bench_page_fast(uint32_t Index)
+{
+    FLASH_ProgramPage_Fast(BENCH_FLASH_ADDR + 256 * Index, bench_buf);
+    return FLASH_GetStatus();
+}
+
+static FLASH_Status bench_erase_page(uint32_t Index)
+{
+    return FLASH_ErasePage(BENCH_FLASH_ADDR + 4096 * (Index & 7));
+}
+
+static FLASH_Status bench_erase_page_fast(uint32_t Index)
+{
+    FLASH_ErasePage_Fast(BENCH_FLASH_ADDR + 256 * Index);
+    return FLASH_GetStatus();
+}
+
+static FLASH_Status bench_erase_32k_fast(uint32_t Index)
+{
+    (void)Index;
+    FLASH_EraseBlock_32K_Fast(BENCH_FLASH_ADDR);
+    return FLASH_GetStatus();
+}
+
+#ifdef BENCH_BLOCK64_ADDR
+static FLASH_Status bench_erase_64k_fast(uint32_t Index)
+{
+    (void)Index;
+    FLASH_EraseBlock_64K_Fast(BENCH_BLOCK64_ADDR);
+    return FLASH_GetStatus();
+}
+#endif
+
+static const BENCH_ApiTypeDef bench_api[] = {
+    {"FLASH_ProgramHalfWord",      2,     BENCH_SAMPLES, bench_erase_4k,  bench_halfword},
+    {"FLASH_ProgramWord",          4,     BENCH_SAMPLES, bench_erase_4k,  bench_word},
+    {"FLASH_ProgramPage_Fast",     256,   BENCH_SAMPLES, bench_erase_32k, bench_page_fast},
+    {"FLASH_ErasePage",            4096,  8,             bench_none,      bench_erase_page},
+    {"FLASH_ErasePage_Fast",       256,   BENCH_SAMPLES, bench_none,      bench_erase_page_fast},
+    {"FLASH_EraseBlock_32K_Fast",  32768, 4,             bench_none,      bench_erase_32k_fast},
+#ifdef BENCH_BLOCK64_ADDR
+    {"FLASH_EraseBlock_64K_Fast",  65536, 2,             bench_none,      bench_erase_64k_fast},
+#endif
+};
+
+#ifndef SIM_HOST
+/* Call targets for the fetch stall table */
+static volatile uint32_t bench_probe_count;
+
+static __attribute__((noinline)) void bench_probe_flash(void)
+{
+    bench_probe_count++;
+}
+
+static __HIGH_CODE void bench_probe_ram(void)
+{
+    bench_probe_count++;
+}
+
+/*********************************************************************
+ * @fn      bench_fetch_stall
+ *
+ * @brief   Starts a fast page erase and times one call to Probe while
+ *          it runs. Runs from RAM so that only Probe can stall.
+ *
+ * @param   Cycles - HCLK cycles of the call.
+ *
+ * @return  FLASH_COMPLETE, or FLASH_ERROR_WRP if the erase was refused.
+ */
+static __HIGH_CODE FLASH_Status bench_fetch_stall(uint32_t Address, void (*Probe)(void), uint32_t *Cycles)
+{
+    uint32_t t0, t1, statr;
+
+    FLASH->CTLR |= CR_PAGE_ER;
+    FLASH->ADDR = Address;
+    FLASH->CTLR |= CR_STRT_Set;
+    __asm volatile("csrr %0, mcycle" : "=r"(t0));
+    Probe();
+    __asm volatile("csrr %0, mcycle" : "=r"(t1));
+    while((statr = FLASH->STATR) & SR_BSY);
+    FLASH->CTLR &= ~CR_PAGE_ER;
+    FLASH->STATR = SR_WRPRTERR;
+    *Cycles = t1 - t0;
+    return (statr & SR_WRPRTERR) ? FLASH_ERROR_WRP : FLASH_COMPLETE;
+}
+#endif
+
+/*********************************************************************
+ * @fn      bench_sort
+ *
+ * @brief   Insertion sort of the sample buffer.
+ *
+ * @return  none
+ */
+static void bench_sort(uint32_t *buf, uint16_t n)
+{
+    uint16_t i, j;
+    uint32_t v;
+
+    for(i = 1; i < n; i++){
+        v = buf[i];
+        for(j = i; j > 0 && buf[j - 1] > v; j--){
+            buf[j] = buf[j - 1];
+        }
+        buf[j] = v;
+    }
+}
+
+/*********************************************************************
+ * @fn      bench_ns
+ *
+ * @brief   Converts HCLK cycles to nanoseconds.
+ *
+ * @return  Nanoseconds.
+ */
+static uint64_t bench_ns(uint64_t cycles)
+{
+    return cycles * 1000000000ULL / bench_hclk;
+}
+
+/*********************************************************************
+ * @fn      bench_print_us
+ *
+ * @brief   Prints a nanosecond value as microseconds with 3 decimals
+ *          (newlib-nano printf has no %f).
+ *
+ * @return  none
+ */
+static void bench_print_us(uint64_t ns)
+{
+    printf(",%lu.%03lu", (unsigned long)(ns / 1000), (unsigned long)(ns % 1000));
+}
+
+/*********************************************************************
+ * @fn      bench_api_run
+ *
+ * @brief   Times one API and prints its CSV row.
+ *
+ * @return  none
+ */
+static void bench_api_run(const BENCH_ApiTypeDef *api, uint32_t SysClk, uint8_t HclkDiv2)
+{
+    uint64_t total = 0;
+    uint32_t t0, errors = 0;
+    uint16_t i, p99;
+
+    api->Prepare();
+    for(i = 0; i < api->Samples; i++){
+        t0 = bench_cycles();
+        if(api->Op(i) != FLASH_COMPLETE)
+            errors++;
+        bench_cyc[i] = bench_cycles() - t0;
+        total += bench_cyc[i];
+        FLASH_ClearFlag(FLASH_FLAG_EOP | FLASH_FLAG_PGERR | FLASH_FLAG_WRPRTERR);
+    }
+    bench_sort(bench_cyc, api->Samples);
+    p99 = (uint16_t)((api->Samples * 99 + 99) / 100 - 1);
+
+    printf("%s,%lu,%lu,%u,%lu,%u,%lu", api->Name, (unsigned long)SysClk, (unsigned long)bench_hclk,
+           HclkDiv2 ? 2 : 1, (unsigned long)api->Bytes, api->Samples, (unsigned long)errors);
+    bench_print_us(bench_ns(total) / api->Samples);
+    bench_print_us(bench_ns(bench_cyc[0]));
+    bench_print_us(bench_ns(bench_cyc[api->Samples - 1]));
+    bench_print_us(bench_ns(bench_cyc[p99]));
+    printf(",%lu\n", total ? (unsigned long)((uint64_t)api->Bytes * api->Samples * bench_hclk / total) : 0UL);
+}
+
+/*********************************************************************
+ * @fn      Flash_Bench_RunClock
+ *
+ * @brief   Runs every API at one clock setting.
+ *
+ * @param   SysClk - SYSCLK frequency in Hz.
+ *          HclkDiv2 - 1 to run the flash operations at HCLK = SYSCLK/2.
+ *
+ * @return  none
+ */
+void Flash_Bench_RunClock(uint32_t SysClk, uint8_t HclkDiv2)
+{
+    uint16_t i;
+
+#ifndef SIM_HOST
+    /* Flash must not be operated with HCLK above 100MHz, see main.c */
+    if(!HclkDiv2 && SysClk > 100000000)
+    {
+        printf("# %lu Hz without HCLK/2 skipped: HCLK above 100MHz\n", (unsigned long)SysClk);
+        return;
+    }
+#endif
+    if(bench_set_clock(SysClk, HclkDiv2) != 0)
+    {
+        printf("# %lu Hz not reachable from HSE, skipped\n", (unsigned long)SysClk);
+        return;
+    }
+
+#ifndef SIM_HOST
+    __disable_irq();
+#endif
+    FLASH_Unlock_Fast();
+    for(i = 0; i < sizeof(bench_api) / sizeof(bench_api[0]); i++){
+        bench_api_run(&bench_api[i], SysClk, HclkDiv2);
+    }
+    FLASH_Lock_Fast();
+#ifndef SIM_HOST
+    __enable_irq();
+#endif
+}
+
+/*********************************************************************
+ * @fn      Flash_Bench_FetchStall
+ *
+ * @brief   Prints the fetch stall table at the current clock: a call into
+ *          flash waits for the erase to end, a call into RAM does not, and
+ *          neither would a RAM-resident interrupt handler. The erases run
+ *          in a flash session, at HCLK/2 above 100MHz; refused erases are
+ *          counted in the errors column and left out of min and max.
+ *
+ * @return  none
+ */
+void Flash_Bench_FetchStall(void)
+{
+#ifndef SIM_HOST
+    static const char *const where[2] = {"flash", "ram"};
+    void (*const probe[2])(void) = {bench_probe_flash, bench_probe_ram};
+    uint32_t min, max, cyc, errors;
+    uint16_t i, p;
+
+    FLASH_Session_Enter();
+    bench_hclk = SystemCoreClock;
+    printf("probe,location,hclk_hz,samples,errors,min_us,max_us\n");
+    __disable_irq();
+    FLASH_Unlock_Fast();
+    for(p = 0; p < 2; p++){
+        min = 0xFFFFFFFF;
+        max = 0;
+        errors = 0;
+        for(i = 0; i < BENCH_SAMPLES; i++){
+            if(bench_fetch_stall(BENCH_FLASH_ADDR + 256 * i, probe[p], &cyc) != FLASH_COMPLETE)
+            {
+                errors++;
+                continue;
+            }
+            if(cyc < min)
+                min = cyc;
+            if(cyc > max)
+                max = cyc;
+        }
+        if(errors == BENCH_SAMPLES)
+            min = 0;
+        printf("call_during_FLASH_ErasePage_Fast,%s,%lu,%u,%lu", where[p], (unsigned long)bench_hclk, BENCH_SAMPLES,
+               (unsigned long)errors);
+        bench_print_us(bench_ns(min));
+        bench_print_us(bench_ns(max));
+        printf("\n");
+    }
+    FLASH_Lock_Fast();
+    __enable_irq();
+    FLASH_Session_Exit();
+#endif
+}
+
+/*********************************************************************
+ * @fn      Flash_Bench_Verify
+ *
+ * @brief   Prints the verification table at the current clock, over 32K
+ *          programmed with the 256B benchmark page: the CPU word compare
+ *          loop main.c used, FLASH_Verify page by page (the RAM copy is
+ *          only one page) and FLASH_VerifyCRC over the whole range.
+ *
+ * @return  none
+ */
+void Flash_Bench_Verify(void)
+{
+#ifndef SIM_HOST
+    static const char *const method[3] = {"cpu_compare", "FLASH_Verify", "FLASH_VerifyCRC"};
+    uint32_t cyc[3], crc, t0, errors[3] = {0, 0, 0};
+    uint16_t i, j, m;
+
+    FLASH_Session_Enter();
+    __disable_irq();
+    FLASH_Unlock_Fast();
+    FLASH_EraseBlock_32K_Fast(BENCH_FLASH_ADDR);
+    for(i = 0; i < 128; i++){
+        FLASH_ProgramPage_Fast(BENCH_FLASH_ADDR + 256 * i, bench_buf);
+    }
+    FLASH_Lock_Fast();
+    FLASH_Session_Exit();
+
+    /* Expected CRC of the range, the buffer 128 times */
+    RCC_AHBPeriphClockCmd(RCC_AHBPeriph_CRC, ENABLE);
+    CRC_ResetDR();
+    for(i = 0; i < 128; i++){
+        crc = CRC_CalcBlockCRC(bench_buf, 64);
+    }
+
+    bench_hclk = SystemCoreClock;
+    t0 = bench_cycles();
+    for(i = 0; i < 128; i++){
+        for(j = 0; j < 64; j++){
+            if(*(__IO uint32_t *)(BENCH_FLASH_ADDR + 256 * i + 4 * j) != bench_buf[j])
+                errors[0]++;
+        }
+    }
+    cyc[0] = bench_cycles() - t0;
+
+    t0 = bench_cycles();
+    for(i = 0; i < 128; i++){
+        if(FLASH_Verify(BENCH_FLASH_ADDR + 256 * i, bench_buf, 256, NULL) != FLASH_VERIFY_OK)
+            errors[1]++;
+    }
+    cyc[1] = bench_cycles() - t0;
+
+    t0 = bench_cycles();
+    if(FLASH_VerifyCRC(BENCH_FLASH_ADDR, 32768, crc) != FLASH_VERIFY_OK)
+        errors[2]++;
+    cyc[2] = bench_cycles() - t0;
+    __enable_irq();
+
+    printf("verify,method,hclk_hz,bytes,errors,us,bytes_per_s\n");
+    for(m = 0; m < 3; m++){
+        printf("verify,%s,%lu,32768,%lu", method[m], (unsigned long)bench_hclk, (unsigned long)errors[m]);
+        bench_print_us(bench_ns(cyc[m]));
+        printf(",%lu\n", cyc[m] ? (unsigned long)(32768ULL * bench_hclk / cyc[m]) : 0UL);
+    }
+#endif
+}
+
+/*********************************************************************
+ * @fn      Flash_Bench_DmaCopy
+ *
+ * @brief   Prints the copy table at the current clock, RAM to RAM, 16B
+ *          to BENCH_COPY_MAX: memcpy, DMA_Copy_Sync, and the CPU time of
+ *          DMA_Copy_Submit alone, which is what an asynchronous copy
+ *          costs the caller. Each figure is the mean of 8 copies.
+ *
+ * @return  none
+ */
+void Flash_Bench_DmaCopy(void)
+{
+#ifndef SIM_HOST
+    static uint32_t          copy_src[BENCH_COPY_MAX / 4], copy_dst[BENCH_COPY_MAX / 4];
+    static const char *const method[3] = {"memcpy", "DMA_Copy_Sync", "DMA_Copy_Submit"};
+    DMA_CopyJobTypeDef       job;
+    uint32_t                 cyc[3], len, t0, errors;
+    uint16_t                 i, m;
+
+    for(i = 0; i < BENCH_COPY_MAX / 4; i++){
+        copy_src[i] = i * 0x9E3779B9;
+    }
+    memset(&job, 0, sizeof(job));
+    job.Op = DMA_COPY_OP_COPY;
+    job.Dst = copy_dst;
+    job.Src = copy_src;
+
+    bench_hclk = SystemCoreClock;
+    DMA_Copy_Init();
+    __disable_irq();
+    printf("copy,method,hclk_hz,bytes,errors,us,bytes_per_s\n");
+    for(len = 16; len <= BENCH_COPY_MAX; len *= 2){
+        job.Length = len;
+
+        t0 = bench_cycles();
+        for(i = 0; i < 8; i++){
+            memcpy(copy_dst, copy_src, len);
+        }
+        cyc[0] = bench_cycles() - t0;
+
+        t0 = bench_cycles();
+        for(i = 0; i < 8; i++){
+            DMA_Copy_Sync(copy_dst, copy_src, len);
+        }
+        cyc[1] = bench_cycles() - t0;
+
+        cyc[2] = 0;
+        for(i = 0; i < 8; i++){
+            t0 = bench_cycles();
+            DMA_Copy_Submit(&job);
+            cyc[2] += bench_cycles() - t0;
+            while(DMA_Copy_Pending())
+            {
+                DMA_Copy_Poll();
+            }
+        }
+
+        errors = memcmp(copy_dst, copy_src, len) != 0;
+        for(m = 0; m < 3; m++){
+            printf("copy,%s,%lu,%lu,%lu", method[m], (unsigned long)bench_hclk, (unsigned long)len, (unsigned long)errors);
+            bench_print_us(bench_ns(cyc[m] / 8));
+            printf(",%lu\n", cyc[m] ? (unsigned long)(8ULL * len * bench_hclk / cyc[m]) : 0UL);
+        }
+    }
+    __enable_irq();
+#endif
+}
+
+/*********************************************************************
+ * @fn      Flash_Bench_Run
+ *
+ * @brief   Runs the benchmark at every SYSCLK_FREQ_* setting, with and
+ *          without the HCLK/2 step, and restores the build clock.
+ *
+ * @return  none
+ */
+void Flash_Bench_Run(void)
+{
+    uint32_t sysclk = SystemCoreClock;
+    uint16_t i;
+    uint8_t  div2;
+
+    for(i = 0; i < 64; i++){
+        bench_buf[i] = i;
+    }
+
+    printf("api,sysclk_hz,hclk_hz,hclk_div,bytes_per_op,samples,errors,us_per_op,min_us,max_us,p99_us,bytes_per_s\n");
+    for(i = 0; i < sizeof(bench_sysclk) / sizeof(bench_sysclk[0]); i++){
+        for(div2 = 0; div2 < 2; div2++){
+            Flash_Bench_RunClock(bench_sysclk[i], div2);
+        }
+    }
+    bench_set_clock(sysclk, 0);
+    Flash_Bench_FetchStall();
+    Flash_Bench_Verify();
+    Flash_Bench_DmaCopy();
+}
@@ -0,0 +1,49 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : flash_bench.h
+ * Author             : typetrade
+ * Version            : V1.0.0
+ * Date               : 2026/10/17
+ * Description        : Flash programming/erase throughput benchmark.
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+#ifndef __FLASH_BENCH_H
+#define __FLASH_BENCH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "debug.h"
+
+/* Benchmark area: 32K..64K, the same area Flash_Test_Fast uses */
+#define BENCH_FLASH_ADDR           ((uint32_t)0x08008000)
+
+/* 64K block erase needs a block that holds no code */
+#if defined(SIM_HOST) || defined(CH32V20x_D8) || defined(CH32V20x_D8W)
+#define BENCH_BLOCK64_ADDR         ((uint32_t)0x08010000)
+#endif
+
+/* Samples kept per API, sized for the 10K RAM parts */
+#define BENCH_SAMPLES              32
+
+/* Largest copy of the DMA copy table; source and destination take twice
+ * that of RAM */
+#if defined(CH32V20x_D8W)
+#define BENCH_COPY_MAX             8192
+#elif defined(CH32V20x_D8)
+#define BENCH_COPY_MAX             4096
+#else
+#define BENCH_COPY_MAX             1024
+#endif
+
+void Flash_Bench_Run(void);
+void Flash_Bench_RunClock(uint32_t SysClk, uint8_t HclkDiv2);
+void Flash_Bench_FetchStall(void);
+void Flash_Bench_Verify(void);
+void Flash_Bench_DmaCopy(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __FLASH_BENCH_H */
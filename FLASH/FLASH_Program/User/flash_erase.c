@@ -0,0 +1,385 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : flash_erase.c
+ * Author             : typetrade
+ * Version            : V1.0.0
+ * Date               : 2026/10/17
+ * Description        : Erase planner: covers an address range with the
+ *                      fastest mix of 64K/32K/4K/256B erase operations.
+ *                      The operations nest (every block is aligned to its
+ *                      size), so walking the range from the bottom and
+ *                      taking at each address the largest aligned block
+ *                      that fits, unless its pieces are cheaper in the
+ *                      timing table, gives the minimum total time and
+ *                      never touches a byte outside the range.
+ *                      With the blank check enabled
+ *                      (FLASH_Erase_BlankCheckCmd) a unit that already
+ *                      reads erased is not erased again. Data that happens
+ *                      to equal the erased pattern is skipped as well, so
+ *                      the check is opt-in; programming over such cells is
+ *                      caught by the read-back of the write paths.
+ *                      Above 100MHz keep HCLK divided by 2 while erasing,
+ *                      see main.c.
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+#include <string.h>
+#include "flash_erase.h"
+
+/* FLASH Control Register bits */
+#define CR_LOCK_Set                ((uint32_t)0x00000080)
+
+/* Erased word, see the note in main.c: erased cells do not read 0xFF */
+#define FLASH_ERASED_WORD          ((uint32_t)0xE339E339)
+
+/* Block size of each operation */
+static const uint32_t flash_erase_size[FLASH_ERASE_OP_NUM] = {
+    65536, 32768, 4096, 256
+};
+
+/* Typical erase time of each operation in us. Nominal numbers, replace
+ * them with measured ones (flash_bench.c) through FLASH_Erase_SetTiming. */
+static uint32_t flash_erase_time[FLASH_ERASE_OP_NUM] = {
+    12000, 9600, 4800, 2400
+};
+
+/* Cheapest way to erase one block of each size: the operation itself, or
+ * its pieces of the next smaller size */
+static uint32_t flash_erase_best[FLASH_ERASE_OP_NUM] = {
+    12000, 9600, 4800, 2400
+};
+
+static uint8_t                 flash_erase_blank_check = 0;
+static FLASH_EraseStatsTypeDef flash_erase_stats;
+
+/*********************************************************************
+ * @fn      flash_erase_next
+ *
+ * @brief   Picks the erase operation starting at Address.
+ *
+ * @param   Address - current address, 256B aligned.
+ *          End - end of the range (exclusive).
+ *
+ * @return  Operation to run at Address.
+ */
+static FLASH_EraseOpTypeDef flash_erase_next(uint32_t Address, uint32_t End)
+{
+    uint32_t op;
+
+    for(op = FLASH_ERASE_64K; op < FLASH_ERASE_256B; op++){
+        if((Address & (flash_erase_size[op] - 1)) == 0 &&
+           End - Address >= flash_erase_size[op] &&
+           flash_erase_time[op] <= flash_erase_best[op])
+            break;
+    }
+    return (FLASH_EraseOpTypeDef)op;
+}
+
+/*********************************************************************
+ * @fn      flash_erase_check
+ *
+ * @brief   Validates a range: 256B aligned and inside the main array.
+ *
+ * @return  1 if the range can be planned.
+ */
+static uint8_t flash_erase_check(uint32_t Address, uint32_t Length)
+{
+    uint32_t end = FLASH_ERASE_END;
+
+    if(((Address | Length) & (FLASH_ERASE_MIN_SIZE - 1)) != 0)
+        return 0;
+    if(Address < FLASH_ERASE_START || Address >= end || Length > end - Address)
+        return 0;
+    return 1;
+}
+
+/*********************************************************************
+ * @fn      FLASH_Erase_End
+ *
+ * @brief   End of the main array: FLASH_ERASE_START plus the flash size
+ *          in the ESIG flash capacity register, FLASH_ERASE_DEFAULT_SIZE
+ *          if it reads blank.
+ *
+ * @return  First address past the main array.
+ */
+uint32_t FLASH_Erase_End(void)
+{
+    uint16_t kb = *(const uint16_t *)FLASH_ESIG_FLACAP;
+
+    if(kb == 0 || kb == 0xFFFF)
+        return FLASH_ERASE_START + FLASH_ERASE_DEFAULT_SIZE;
+    return FLASH_ERASE_START + (uint32_t)kb * 1024;
+}
+
+/*********************************************************************
+ * @fn      FLASH_Erase_IsBlank
+ *
+ * @brief   Word-wide blank check against the erased pattern 0xe339e339.
+ *
+ * @param   Address - start, word aligned.
+ *          Length - bytes, multiple of 16.
+ *
+ * @return  1 if the whole range reads erased, 0 if not or if it leaves
+ *          the main array.
+ */
+uint8_t FLASH_Erase_IsBlank(uint32_t Address, uint32_t Length)
+{
+    const uint32_t *p = (const uint32_t *)Address;
+    const uint32_t *end = (const uint32_t *)(Address + Length);
+    uint32_t        top = FLASH_ERASE_END;
+
+    if(Address < FLASH_ERASE_START || Address > top || Length > top - Address)
+        return 0;
+
+    while(p < end)
+    {
+        if(((p[0] ^ FLASH_ERASED_WORD) | (p[1] ^ FLASH_ERASED_WORD) |
+            (p[2] ^ FLASH_ERASED_WORD) | (p[3] ^ FLASH_ERASED_WORD)) != 0)
+            return 0;
+        p += 4;
+    }
+    return 1;
+}
+
+/*********************************************************************
+ * @fn      FLASH_Erase_BlankCheckCmd
+ *
+ * @brief   Enables or disables skipping units that already read erased.
+ *
+ * @param   NewState - ENABLE or DISABLE (default).
+ *
+ * @return  none
+ */
+void FLASH_Erase_BlankCheckCmd(FunctionalState NewState)
+{
+    flash_erase_blank_check = (NewState != DISABLE);
+}
+
+/*********************************************************************
+ * @fn      FLASH_Erase_GetStats
+ *
+ * @brief   Copies the erase counters.
+ *
+ * @return  none
+ */
+void FLASH_Erase_GetStats(FLASH_EraseStatsTypeDef *Stats)
+{
+    *Stats = flash_erase_stats;
+}
+
+/*********************************************************************
+ * @fn      FLASH_Erase_ClearStats
+ *
+ * @brief   Clears the erase counters.
+ *
+ * @return  none
+ */
+void FLASH_Erase_ClearStats(void)
+{
+    memset(&flash_erase_stats, 0, sizeof(flash_erase_stats));
+}
+
+/*********************************************************************
+ * @fn      FLASH_Erase_Unit
+ *
+ * @brief   Runs one erase operation, or skips it when the blank check is
+ *          enabled and the unit already reads erased. Fast mode must be
+ *          unlocked.
+ *
+ * @param   Op - operation.
+ *          Address - unit address, aligned to the operation size.
+ *
+ * @return  FLASH Status.
+ */
+FLASH_Status FLASH_Erase_Unit(FLASH_EraseOpTypeDef Op, uint32_t Address)
+{
+    FLASH_Status status;
+
+    if(flash_erase_blank_check && FLASH_Erase_IsBlank(Address, flash_erase_size[Op]))
+    {
+        flash_erase_stats.Skipped[Op]++;
+        flash_erase_stats.SavedTime_us += flash_erase_time[Op];
+        return FLASH_COMPLETE;
+    }
+
+    FLASH_ClearFlag(FLASH_FLAG_EOP | FLASH_FLAG_PGERR | FLASH_FLAG_WRPRTERR);
+    switch(Op)
+    {
+        case FLASH_ERASE_64K:
+            FLASH_EraseBlock_64K_Fast(Address);
+            status = FLASH_GetBank1Status();
+            break;
+
+        case FLASH_ERASE_32K:
+            FLASH_EraseBlock_32K_Fast(Address);
+            status = FLASH_GetBank1Status();
+            break;
+
+        case FLASH_ERASE_4K:
+            status = FLASH_ErasePage(Address);
+            break;
+
+        default:
+            FLASH_ErasePage_Fast(Address);
+            status = FLASH_GetBank1Status();
+            break;
+    }
+    flash_erase_stats.Erased[Op]++;
+
+    return status;
+}
+
+/*********************************************************************
+ * @fn      FLASH_Erase_OpSize
+ *
+ * @brief   Bytes erased by one operation.
+ *
+ * @return  Block size.
+ */
+uint32_t FLASH_Erase_OpSize(FLASH_EraseOpTypeDef Op)
+{
+    return (Op < FLASH_ERASE_OP_NUM) ? flash_erase_size[Op] : 0;
+}
+
+/*********************************************************************
+ * @fn      FLASH_Erase_OpTime
+ *
+ * @brief   Time of one operation in the timing table.
+ *
+ * @return  Time in us.
+ */
+uint32_t FLASH_Erase_OpTime(FLASH_EraseOpTypeDef Op)
+{
+    return (Op < FLASH_ERASE_OP_NUM) ? flash_erase_time[Op] : 0;
+}
+
+/*********************************************************************
+ * @fn      FLASH_Erase_SetTiming
+ *
+ * @brief   Replaces the erase time table the planner optimises for.
+ *
+ * @param   Time_us - time of each FLASH_EraseOpTypeDef in us.
+ *
+ * @return  none
+ */
+void FLASH_Erase_SetTiming(const uint32_t Time_us[FLASH_ERASE_OP_NUM])
+{
+    uint32_t op, pieces;
+
+    for(op = FLASH_ERASE_OP_NUM; op-- > 0;){
+        flash_erase_time[op] = Time_us[op];
+        flash_erase_best[op] = Time_us[op];
+        if(op + 1 < FLASH_ERASE_OP_NUM)
+        {
+            pieces = (flash_erase_size[op] / flash_erase_size[op + 1]) * flash_erase_best[op + 1];
+            if(pieces < flash_erase_best[op])
+                flash_erase_best[op] = pieces;
+        }
+    }
+}
+
+/*********************************************************************
+ * @fn      FLASH_Erase_Plan
+ *
+ * @brief   Computes the erase operations covering exactly
+ *          [Address, Address + Length).
+ *
+ * @param   Address - range start, 256B aligned.
+ *          Length - range length, multiple of 256B.
+ *          Steps - receives up to MaxSteps operations, may be NULL to only
+ *            count them.
+ *          MaxSteps - capacity of Steps.
+ *
+ * @return  Number of operations in the plan (may exceed MaxSteps), 0 for
+ *          an empty or invalid range.
+ */
+uint32_t FLASH_Erase_Plan(uint32_t Address, uint32_t Length, FLASH_EraseStepTypeDef *Steps, uint32_t MaxSteps)
+{
+    FLASH_EraseOpTypeDef op;
+    uint32_t             end = Address + Length;
+    uint32_t             n = 0;
+
+    if(!flash_erase_check(Address, Length))
+        return 0;
+
+    while(Address < end)
+    {
+        op = flash_erase_next(Address, end);
+        if(Steps && n < MaxSteps)
+        {
+            Steps[n].Op = op;
+            Steps[n].Address = Address;
+        }
+        n++;
+        Address += flash_erase_size[op];
+    }
+
+    return n;
+}
+
+/*********************************************************************
+ * @fn      FLASH_Erase_EstimateTime
+ *
+ * @brief   Estimated time FLASH_EraseRange takes for a range, from the
+ *          timing table.
+ *
+ * @param   Address - range start, 256B aligned.
+ *          Length - range length, multiple of 256B.
+ *
+ * @return  Time in us, 0 for an empty or invalid range.
+ */
+uint32_t FLASH_Erase_EstimateTime(uint32_t Address, uint32_t Length)
+{
+    FLASH_EraseOpTypeDef op;
+    uint32_t             end = Address + Length;
+    uint32_t             time = 0;
+
+    if(!flash_erase_check(Address, Length))
+        return 0;
+
+    while(Address < end)
+    {
+        op = flash_erase_next(Address, end);
+        time += flash_erase_time[op];
+        Address += flash_erase_size[op];
+    }
+
+    return time;
+}
+
+/*********************************************************************
+ * @fn      FLASH_EraseRange
+ *
+ * @brief   Erases exactly [Address, Address + Length) following the plan.
+ *          Unlocks fast mode itself and locks the controller again if it
+ *          was locked on entry.
+ *
+ * @param   Address - range start, 256B aligned.
+ *          Length - range length, multiple of 256B.
+ *
+ * @return  FLASH_COMPLETE, FLASH_ERROR_PG for an invalid range, or the
+ *          status of the first failing operation.
+ */
+FLASH_Status FLASH_EraseRange(uint32_t Address, uint32_t Length)
+{
+    FLASH_EraseOpTypeDef op;
+    FLASH_Status         status = FLASH_COMPLETE;
+    uint32_t             end = Address + Length;
+    uint8_t              locked;
+
+    if(!flash_erase_check(Address, Length))
+        return FLASH_ERROR_PG;
+
+    locked = (FLASH->CTLR & CR_LOCK_Set) != 0;
+    FLASH_Unlock_Fast();
+
+    while(Address < end && status == FLASH_COMPLETE)
+    {
+        op = flash_erase_next(Address, end);
+        status = FLASH_Erase_Unit(op, Address);
+        Address += flash_erase_size[op];
+    }
+
+    if(locked)
+        FLASH_Lock_Fast();
+
+    return status;
+}
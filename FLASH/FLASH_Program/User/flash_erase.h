@@ -0,0 +1,80 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : flash_erase.h
+ * Author             : typetrade
+ * Version            : V1.0.0
+ * Date               : 2026/10/17
+ * Description        : Erase planner: covers an address range with the
+ *                      fastest mix of 64K/32K/4K/256B erase operations.
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+#ifndef __FLASH_ERASE_H
+#define __FLASH_ERASE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "debug.h"
+
+/* Main array bounds the planner accepts. The end is the flash size of
+ * the part, from the ESIG flash capacity register (in KB). */
+#define FLASH_ERASE_START          ((uint32_t)0x08000000)
+#define FLASH_ERASE_END            FLASH_Erase_End()
+
+#define FLASH_ESIG_FLACAP          ((uint32_t)0x1FFFF7E0)
+
+/* Flash size when ESIG reads blank */
+#ifndef FLASH_ERASE_DEFAULT_SIZE
+#if defined(CH32V20x_D8) || defined(CH32V20x_D8W)
+#define FLASH_ERASE_DEFAULT_SIZE   ((uint32_t)0x00020000)
+#else
+#define FLASH_ERASE_DEFAULT_SIZE   ((uint32_t)0x00010000)
+#endif
+#endif
+
+/* Finest erase granularity, ranges must be aligned to it */
+#define FLASH_ERASE_MIN_SIZE       ((uint32_t)256)
+
+/* Erase operations, largest first */
+typedef enum
+{
+    FLASH_ERASE_64K = 0,   /* FLASH_EraseBlock_64K_Fast */
+    FLASH_ERASE_32K,       /* FLASH_EraseBlock_32K_Fast */
+    FLASH_ERASE_4K,        /* FLASH_ErasePage */
+    FLASH_ERASE_256B,      /* FLASH_ErasePage_Fast */
+    FLASH_ERASE_OP_NUM
+} FLASH_EraseOpTypeDef;
+
+/* Erase counters */
+typedef struct
+{
+    uint32_t Erased[FLASH_ERASE_OP_NUM];   /* Operations run */
+    uint32_t Skipped[FLASH_ERASE_OP_NUM];  /* Operations skipped by the blank check */
+    uint32_t SavedTime_us;                 /* Timing table time of the skipped operations */
+} FLASH_EraseStatsTypeDef;
+
+/* One planned erase */
+typedef struct
+{
+    FLASH_EraseOpTypeDef Op;
+    uint32_t             Address;
+} FLASH_EraseStepTypeDef;
+
+uint32_t     FLASH_Erase_Plan(uint32_t Address, uint32_t Length, FLASH_EraseStepTypeDef *Steps, uint32_t MaxSteps);
+uint32_t     FLASH_Erase_EstimateTime(uint32_t Address, uint32_t Length);
+FLASH_Status FLASH_EraseRange(uint32_t Address, uint32_t Length);
+void         FLASH_Erase_SetTiming(const uint32_t Time_us[FLASH_ERASE_OP_NUM]);
+uint32_t     FLASH_Erase_OpSize(FLASH_EraseOpTypeDef Op);
+uint32_t     FLASH_Erase_OpTime(FLASH_EraseOpTypeDef Op);
+FLASH_Status FLASH_Erase_Unit(FLASH_EraseOpTypeDef Op, uint32_t Address);
+uint8_t      FLASH_Erase_IsBlank(uint32_t Address, uint32_t Length);
+uint32_t     FLASH_Erase_End(void);
+void         FLASH_Erase_BlankCheckCmd(FunctionalState NewState);
+void         FLASH_Erase_GetStats(FLASH_EraseStatsTypeDef *Stats);
+void         FLASH_Erase_ClearStats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __FLASH_ERASE_H */
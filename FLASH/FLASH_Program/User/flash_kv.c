@@ -0,0 +1,734 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : flash_kv.c
+ * Author             : typetrade
+ * Version            : V1.0.0
+ * Date               : 2026/10/17
+ * Description        : Log-structured, wear-levelled key-value store over a
+ *                      set of 256B fast pages.
+ *                      Layout of a page:
+ *                        +0  magic (FLASH_KV_PAGE_MAGIC), programmed last
+ *                        +4  sequence number, programmed first
+ *                        +8  its complement, programmed second
+ *                        +12 reclaimed mark: live records copied out
+ *                        +14 copied mark: a reclaim's copies all landed
+ *                        +16 records, appended in order
+ *                      Layout of a record, word aligned:
+ *                        +0  key | length << 16 (bit 15 of length: deleted)
+ *                        +4  value, padded to a word
+ *                        -4  CRC-16 of key, length and value | commit << 16
+ *                      The length is programmed first, so the size of a
+ *                      record torn by a reset is known and the record is
+ *                      skipped; the commit halfword is programmed last. The
+ *                      newest record of a key wins; the RAM index holds
+ *                      its address.
+ *                      Pages fill in sequence order and one page is always
+ *                      kept erased: when the writer takes it, the oldest
+ *                      page has its live records copied over and is erased.
+ *                      Every page is reclaimed in turn, so erases spread
+ *                      evenly. The reserve page only receives copies until
+ *                      the oldest page is erased, so a reset in between
+ *                      leaves no erased page at mount. Once the copies
+ *                      are done the reserve page gets its copied mark and
+ *                      the oldest page its reclaimed mark, then the erase
+ *                      starts. Mount erases marked pages, and with no
+ *                      erased page left it erases the oldest page if the
+ *                      newest one has its copied mark (a reset tore the
+ *                      erase, the oldest page may hold anything), the
+ *                      newest page otherwise (the copies were not
+ *                      finished, the originals are still in place). A
+ *                      header whose sequence number and complement do
+ *                      not match is garbage.
+ *                      Small updates only program halfwords. Above 100MHz
+ *                      keep HCLK divided by 2 while writing, see main.c.
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+#include <string.h>
+#include "flash_kv.h"
+#include "flash_erase.h"
+
+/* FLASH Control Register bits */
+#define CR_LOCK_Set                ((uint32_t)0x00000080)
+
+/* Erased word, see the note in main.c */
+#define FLASH_ERASED_WORD          ((uint32_t)0xE339E339)
+
+#define FLASH_KV_PAGE_MAGIC        ((uint32_t)0x4B560002) /* "KV", layout 2 */
+#define FLASH_KV_PAGE_HDR          16
+#define FLASH_KV_RECLAIMED_OFF     12
+#define FLASH_KV_COPIED_OFF        14
+#define FLASH_KV_MARK              ((uint16_t)0x0000)
+#define FLASH_KV_ERASED_HALF       ((uint16_t)0xE339)
+#define FLASH_KV_REC_OVERHEAD      8
+#define FLASH_KV_LEN_DELETED       ((uint16_t)0x8000)
+#define FLASH_KV_LEN_MASK          ((uint16_t)0x7FFF)
+#define FLASH_KV_COMMIT            ((uint16_t)0xA55A)
+
+#define FLASH_KV_REC_SIZE(len)     (FLASH_KV_REC_OVERHEAD + (((uint32_t)(len) + 3) & ~(uint32_t)3))
+
+/* Record parse results */
+#define FLASH_KV_REC_END           0 /* Erased space follows */
+#define FLASH_KV_REC_VALID         1 /* Committed record */
+#define FLASH_KV_REC_TORN          2 /* Record without a valid commit, skipped */
+#define FLASH_KV_REC_BAD           3 /* Unparsable, the rest of the page is unusable */
+
+/* RAM index entry */
+typedef struct
+{
+    uint16_t Key;
+    uint16_t Length;
+    uint32_t Addr;          /* Record header */
+} FLASH_KV_EntryTypeDef;
+
+static FLASH_KV_ConfigTypeDef kv_cfg;
+static uint8_t                kv_mounted = 0;
+static FLASH_KV_EntryTypeDef  kv_index[FLASH_KV_MAX_KEYS];
+static uint16_t               kv_keys = 0;
+static uint32_t               kv_seq[FLASH_KV_MAX_PAGES]; /* 0: page erased */
+static uint32_t               kv_last_seq = 0;
+static int16_t                kv_head = -1;               /* Page appended to */
+static uint32_t               kv_head_off = 0;
+static FLASH_KV_StatsTypeDef  kv_stats;
+
+/*********************************************************************
+ * @fn      kv_page
+ *
+ * @brief   Address of page Page of the store.
+ *
+ * @return  Page address.
+ */
+static uint32_t kv_page(uint16_t Page)
+{
+    return kv_cfg.Base + (uint32_t)Page * FLASH_KV_PAGE_SIZE;
+}
+
+/*********************************************************************
+ * @fn      kv_blank
+ *
+ * @brief   Checks that Length bytes at Address, both word aligned, read
+ *          erased.
+ *
+ * @return  1 if erased.
+ */
+static uint8_t kv_blank(uint32_t Address, uint32_t Length)
+{
+    for(; Length; Length -= 4, Address += 4){
+        if(*(const uint32_t *)Address != FLASH_ERASED_WORD)
+            return 0;
+    }
+    return 1;
+}
+
+/*********************************************************************
+ * @fn      kv_crc
+ *
+ * @brief   CRC-16/CCITT over the record header word and the value.
+ *
+ * @return  CRC.
+ */
+static uint16_t kv_crc(uint32_t Header, const uint8_t *Data, uint16_t Length)
+{
+    uint16_t crc = 0xFFFF;
+    uint32_t i;
+    uint8_t  b, bit;
+
+    for(i = 0; i < 4u + Length; i++){
+        b = (i < 4) ? (uint8_t)(Header >> (8 * i)) : Data[i - 4];
+        crc ^= (uint16_t)b << 8;
+        for(bit = 0; bit < 8; bit++){
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+/*********************************************************************
+ * @fn      kv_record
+ *
+ * @brief   Parses the record at Address with Room bytes left in its page.
+ *
+ * @return  FLASH_KV_REC_xxx; Header and Size are set for VALID and TORN.
+ */
+static uint8_t kv_record(uint32_t Address, uint32_t Room, uint32_t *Header, uint32_t *Size)
+{
+    uint32_t w, trailer;
+    uint16_t len;
+
+    if(Room < FLASH_KV_REC_OVERHEAD)
+        return FLASH_KV_REC_END;
+
+    w = *(const uint32_t *)Address;
+    if(w == FLASH_ERASED_WORD)
+        return FLASH_KV_REC_END;
+
+    len = (uint16_t)(w >> 16) & FLASH_KV_LEN_MASK;
+    if(len > FLASH_KV_MAX_VALUE || ((w >> 16) & FLASH_KV_LEN_DELETED && len != 0))
+        return FLASH_KV_REC_BAD;
+    if(FLASH_KV_REC_SIZE(len) > Room)
+        return FLASH_KV_REC_BAD;
+
+    *Header = w;
+    *Size = FLASH_KV_REC_SIZE(len);
+    trailer = *(const uint32_t *)(Address + *Size - 4);
+    if((uint16_t)(trailer >> 16) != FLASH_KV_COMMIT ||
+       (uint16_t)trailer != kv_crc(w, (const uint8_t *)(Address + 4), len))
+        return FLASH_KV_REC_TORN;
+
+    return FLASH_KV_REC_VALID;
+}
+
+/*********************************************************************
+ * @fn      kv_find
+ *
+ * @brief   Looks Key up in the RAM index.
+ *
+ * @return  Entry number, -1 if absent.
+ */
+static int16_t kv_find(uint16_t Key)
+{
+    uint16_t i;
+
+    for(i = 0; i < kv_keys; i++){
+        if(kv_index[i].Key == Key)
+            return (int16_t)i;
+    }
+    return -1;
+}
+
+/*********************************************************************
+ * @fn      kv_index_set
+ *
+ * @brief   Applies a committed record to the RAM index.
+ *
+ * @return  FLASH_KV_NO_SPACE if the index is full.
+ */
+static FLASH_KV_Status kv_index_set(uint32_t Header, uint32_t Addr)
+{
+    uint16_t key = (uint16_t)Header;
+    uint16_t lenfield = (uint16_t)(Header >> 16);
+    int16_t  e = kv_find(key);
+
+    if(lenfield & FLASH_KV_LEN_DELETED)
+    {
+        if(e >= 0)
+            kv_index[e] = kv_index[--kv_keys];
+        return FLASH_KV_OK;
+    }
+    if(e < 0)
+    {
+        if(kv_keys >= FLASH_KV_MAX_KEYS)
+            return FLASH_KV_NO_SPACE;
+        e = (int16_t)kv_keys++;
+        kv_index[e].Key = key;
+    }
+    kv_index[e].Length = lenfield;
+    kv_index[e].Addr = Addr;
+    return FLASH_KV_OK;
+}
+
+/*********************************************************************
+ * @fn      kv_program
+ *
+ * @brief   Programs the halfword Data at Address.
+ *
+ * @return  FLASH_KV_OK or FLASH_KV_FLASH_ERROR.
+ */
+static FLASH_KV_Status kv_program(uint32_t Address, uint16_t Data)
+{
+    if(FLASH_ProgramHalfWord(Address, Data) != FLASH_COMPLETE || *(__IO uint16_t *)Address != Data)
+        return FLASH_KV_FLASH_ERROR;
+    return FLASH_KV_OK;
+}
+
+/*********************************************************************
+ * @fn      kv_erase
+ *
+ * @brief   Erases page Page and marks it free.
+ *
+ * @return  FLASH_KV_OK or FLASH_KV_FLASH_ERROR.
+ */
+static FLASH_KV_Status kv_erase(uint16_t Page)
+{
+    kv_seq[Page] = 0;
+    kv_stats.Erases++;
+    if(FLASH_Erase_Unit(FLASH_ERASE_256B, kv_page(Page)) != FLASH_COMPLETE)
+        return FLASH_KV_FLASH_ERROR;
+    return FLASH_KV_OK;
+}
+
+/*********************************************************************
+ * @fn      kv_open
+ *
+ * @brief   Makes the erased page Page the page appended to.
+ *
+ * @return  FLASH_KV_OK or FLASH_KV_FLASH_ERROR.
+ */
+static FLASH_KV_Status kv_open(uint16_t Page)
+{
+    uint32_t        addr = kv_page(Page);
+    uint32_t        seq = kv_last_seq + 1;
+    FLASH_KV_Status st;
+
+    if(seq == FLASH_ERASED_WORD || seq == 0)
+        seq++;
+
+    kv_seq[Page] = seq;
+    kv_last_seq = seq;
+    kv_head = (int16_t)Page;
+    kv_head_off = FLASH_KV_PAGE_SIZE;
+
+    st = kv_program(addr + 4, (uint16_t)seq);
+    if(st == FLASH_KV_OK)
+        st = kv_program(addr + 6, (uint16_t)(seq >> 16));
+    if(st == FLASH_KV_OK)
+        st = kv_program(addr + 8, (uint16_t)~seq);
+    if(st == FLASH_KV_OK)
+        st = kv_program(addr + 10, (uint16_t)(~seq >> 16));
+    if(st == FLASH_KV_OK)
+        st = kv_program(addr, (uint16_t)FLASH_KV_PAGE_MAGIC);
+    if(st == FLASH_KV_OK)
+        st = kv_program(addr + 2, (uint16_t)(FLASH_KV_PAGE_MAGIC >> 16));
+    if(st == FLASH_KV_OK)
+        kv_head_off = FLASH_KV_PAGE_HDR;
+
+    return st;
+}
+
+/*********************************************************************
+ * @fn      kv_append
+ *
+ * @brief   Appends a record to the head page, which must have room, and
+ *          points the index at it.
+ *
+ * @param   Header - key | length field << 16.
+ *          Data - value, may be in flash.
+ *
+ * @return  FLASH_KV_Status.
+ */
+static FLASH_KV_Status kv_append(uint32_t Header, const uint8_t *Data)
+{
+    uint16_t        len = (uint16_t)(Header >> 16) & FLASH_KV_LEN_MASK;
+    uint32_t        size = FLASH_KV_REC_SIZE(len);
+    uint32_t        addr = kv_page((uint16_t)kv_head) + kv_head_off;
+    uint16_t        crc = kv_crc(Header, Data, len);
+    FLASH_KV_Status st;
+    uint32_t        i;
+
+    kv_head_off += size;
+
+    st = kv_program(addr + 2, (uint16_t)(Header >> 16));
+    if(st == FLASH_KV_OK)
+        st = kv_program(addr, (uint16_t)Header);
+    for(i = 0; i < len && st == FLASH_KV_OK; i += 2){
+        st = kv_program(addr + 4 + i, (uint16_t)(Data[i] | ((i + 1 < len) ? Data[i + 1] << 8 : 0xFF00)));
+    }
+    if(st == FLASH_KV_OK)
+        st = kv_program(addr + size - 4, crc);
+    if(st == FLASH_KV_OK)
+        st = kv_program(addr + size - 2, FLASH_KV_COMMIT);
+    if(st == FLASH_KV_OK)
+        st = kv_index_set(Header, addr);
+
+    return st;
+}
+
+/*********************************************************************
+ * @fn      kv_free_pages
+ *
+ * @brief   Counts the erased pages.
+ *
+ * @return  Number of free pages.
+ */
+static uint16_t kv_free_pages(void)
+{
+    uint16_t p, n = 0;
+
+    for(p = 0; p < kv_cfg.Pages; p++){
+        if(kv_seq[p] == 0)
+            n++;
+    }
+    return n;
+}
+
+/*********************************************************************
+ * @fn      kv_next_free
+ *
+ * @brief   First erased page after the head, in circular order.
+ *
+ * @return  Page number, -1 if none.
+ */
+static int16_t kv_next_free(void)
+{
+    uint16_t i, p;
+
+    for(i = 1; i <= kv_cfg.Pages; i++){
+        p = (uint16_t)((kv_head + i + kv_cfg.Pages) % kv_cfg.Pages);
+        if(kv_seq[p] == 0)
+            return (int16_t)p;
+    }
+    return -1;
+}
+
+/*********************************************************************
+ * @fn      kv_gc
+ *
+ * @brief   Reclaims the oldest page: copies its live records to the head
+ *          page, marks both pages, then erases it.
+ *
+ * @return  FLASH_KV_Status.
+ */
+static FLASH_KV_Status kv_gc(void)
+{
+    FLASH_KV_Status st = FLASH_KV_OK;
+    uint32_t        base, off, header, size;
+    uint16_t        p;
+    int16_t         oldest = -1;
+    int16_t         e;
+    uint8_t         r;
+
+    for(p = 0; p < kv_cfg.Pages; p++){
+        if(kv_seq[p] != 0 && (int16_t)p != kv_head && (oldest < 0 || kv_seq[p] < kv_seq[oldest]))
+            oldest = (int16_t)p;
+    }
+    if(oldest < 0)
+        return FLASH_KV_OK;
+
+    base = kv_page((uint16_t)oldest);
+    for(off = FLASH_KV_PAGE_HDR; st == FLASH_KV_OK; off += size){
+        r = kv_record(base + off, FLASH_KV_PAGE_SIZE - off, &header, &size);
+        if(r == FLASH_KV_REC_END || r == FLASH_KV_REC_BAD)
+            break;
+        if(r != FLASH_KV_REC_VALID)
+            continue;
+        e = kv_find((uint16_t)header);
+        if(e < 0 || kv_index[e].Addr != base + off)
+            continue;
+        if(kv_head_off + size > FLASH_KV_PAGE_SIZE)
+            return FLASH_KV_NO_SPACE;
+        st = kv_append(header, (const uint8_t *)(base + off + 4));
+        kv_stats.Relocated++;
+    }
+
+    if(st == FLASH_KV_OK)
+        st = kv_program(kv_page((uint16_t)kv_head) + FLASH_KV_COPIED_OFF, FLASH_KV_MARK);
+    if(st == FLASH_KV_OK)
+        st = kv_program(base + FLASH_KV_RECLAIMED_OFF, FLASH_KV_MARK);
+    if(st == FLASH_KV_OK)
+    {
+        st = kv_erase((uint16_t)oldest);
+        kv_stats.GcRuns++;
+    }
+    return st;
+}
+
+/*********************************************************************
+ * @fn      kv_reserve
+ *
+ * @brief   Makes room for Size bytes in the head page, opening the next
+ *          erased page and reclaiming the oldest one when the reserve
+ *          page gets used.
+ *
+ * @return  FLASH_KV_Status.
+ */
+static FLASH_KV_Status kv_reserve(uint32_t Size)
+{
+    FLASH_KV_Status st;
+    uint32_t        live = Size;
+    uint16_t        i, free;
+    int16_t         p;
+
+    for(i = 0; i < kv_keys; i++){
+        live += FLASH_KV_REC_SIZE(kv_index[i].Length);
+    }
+    if(live > (uint32_t)(kv_cfg.Pages - 1) * (FLASH_KV_PAGE_SIZE - FLASH_KV_PAGE_HDR))
+        return FLASH_KV_NO_SPACE;
+
+    for(i = 0; i < 2 * kv_cfg.Pages; i++){
+        if(kv_head >= 0 && kv_head_off + Size <= FLASH_KV_PAGE_SIZE)
+            return FLASH_KV_OK;
+
+        free = kv_free_pages();
+        p = kv_next_free();
+        if(p < 0)
+            return FLASH_KV_NO_SPACE;
+        st = kv_open((uint16_t)p);
+        if(st == FLASH_KV_OK && free == 1)
+            st = kv_gc();
+        if(st != FLASH_KV_OK)
+            return st;
+    }
+    return FLASH_KV_NO_SPACE;
+}
+
+/*********************************************************************
+ * @fn      kv_check
+ *
+ * @brief   Validates a store location.
+ *
+ * @return  1 if usable.
+ */
+static uint8_t kv_check(const FLASH_KV_ConfigTypeDef *Config)
+{
+    if(Config == NULL || (Config->Base & (FLASH_KV_PAGE_SIZE - 1)) != 0)
+        return 0;
+    if(Config->Pages < 2 || Config->Pages > FLASH_KV_MAX_PAGES)
+        return 0;
+    if(Config->Base < FLASH_ERASE_START ||
+       Config->Base + (uint32_t)Config->Pages * FLASH_KV_PAGE_SIZE > FLASH_ERASE_END)
+        return 0;
+    return 1;
+}
+
+/*********************************************************************
+ * @fn      FLASH_KV_Mount
+ *
+ * @brief   Scans the store, erases garbage left by a reset, finishes or
+ *          undoes an interrupted reclaim and builds the RAM index. Blank
+ *          flash mounts as an empty store.
+ *
+ * @param   Config - store location.
+ *
+ * @return  FLASH_KV_Status.
+ */
+FLASH_KV_Status FLASH_KV_Mount(const FLASH_KV_ConfigTypeDef *Config)
+{
+    FLASH_KV_Status st = FLASH_KV_OK;
+    uint32_t        base, off, header, size, seq, prev = 0;
+    uint16_t        p;
+    int16_t         next, oldest;
+    uint8_t         locked, r;
+
+    kv_mounted = 0;
+    if(!kv_check(Config))
+        return FLASH_KV_INVALID;
+
+    kv_cfg = *Config;
+    kv_keys = 0;
+    kv_last_seq = 0;
+    kv_head = -1;
+    kv_head_off = 0;
+    memset(kv_seq, 0, sizeof(kv_seq));
+    memset(&kv_stats, 0, sizeof(kv_stats));
+
+    locked = (FLASH->CTLR & CR_LOCK_Set) != 0;
+    FLASH_Unlock_Fast();
+
+    /* Classify pages, reclaimed ones are erased */
+    for(p = 0; p < kv_cfg.Pages && st == FLASH_KV_OK; p++){
+        base = kv_page(p);
+        seq = *(const uint32_t *)(base + 4);
+        if(*(const uint32_t *)base == FLASH_KV_PAGE_MAGIC && seq != FLASH_ERASED_WORD && seq != 0 &&
+           *(const uint32_t *)(base + 8) == ~seq &&
+           *(const uint16_t *)(base + FLASH_KV_RECLAIMED_OFF) == FLASH_KV_ERASED_HALF)
+        {
+            kv_seq[p] = seq;
+            if(kv_seq[p] > kv_last_seq)
+                kv_last_seq = kv_seq[p];
+        }
+        else if(!kv_blank(base, FLASH_KV_PAGE_SIZE))
+        {
+            st = kv_erase(p);
+        }
+    }
+
+    /* Reset during a reclaim: with the copies all in the newest page,
+     * finish the erase of the oldest page, else drop the copies and let
+     * the next write redo the reclaim */
+    if(st == FLASH_KV_OK && kv_free_pages() == 0)
+    {
+        next = 0;
+        oldest = 0;
+        for(p = 1; p < kv_cfg.Pages; p++){
+            if(kv_seq[p] > kv_seq[next])
+                next = (int16_t)p;
+            if(kv_seq[p] < kv_seq[oldest])
+                oldest = (int16_t)p;
+        }
+        if(*(const uint16_t *)(kv_page((uint16_t)next) + FLASH_KV_COPIED_OFF) != FLASH_KV_ERASED_HALF)
+            next = oldest;
+        st = kv_erase((uint16_t)next);
+    }
+
+    /* Replay pages oldest first, the last one is the head */
+    while(st == FLASH_KV_OK)
+    {
+        next = -1;
+        for(p = 0; p < kv_cfg.Pages; p++){
+            if(kv_seq[p] > prev && (next < 0 || kv_seq[p] < kv_seq[next]))
+                next = (int16_t)p;
+        }
+        if(next < 0)
+            break;
+        prev = kv_seq[next];
+        base = kv_page((uint16_t)next);
+
+        for(off = FLASH_KV_PAGE_HDR; ; off += size){
+            r = kv_record(base + off, FLASH_KV_PAGE_SIZE - off, &header, &size);
+            if(r == FLASH_KV_REC_END)
+            {
+                if(!kv_blank(base + off, FLASH_KV_PAGE_SIZE - off))
+                    off = FLASH_KV_PAGE_SIZE;
+                break;
+            }
+            if(r == FLASH_KV_REC_BAD)
+            {
+                off = FLASH_KV_PAGE_SIZE;
+                break;
+            }
+            if(r == FLASH_KV_REC_VALID && kv_index_set(header, base + off) != FLASH_KV_OK)
+                st = FLASH_KV_NO_SPACE;
+        }
+        kv_head = next;
+        kv_head_off = off;
+    }
+
+    if(locked)
+        FLASH_Lock_Fast();
+
+    if(st == FLASH_KV_OK)
+        kv_mounted = 1;
+    return st;
+}
+
+/*********************************************************************
+ * @fn      FLASH_KV_Format
+ *
+ * @brief   Erases every page of the store and mounts it empty.
+ *
+ * @param   Config - store location.
+ *
+ * @return  FLASH_KV_Status.
+ */
+FLASH_KV_Status FLASH_KV_Format(const FLASH_KV_ConfigTypeDef *Config)
+{
+    FLASH_Status status;
+
+    if(!kv_check(Config))
+        return FLASH_KV_INVALID;
+
+    status = FLASH_EraseRange(Config->Base, (uint32_t)Config->Pages * FLASH_KV_PAGE_SIZE);
+    if(status != FLASH_COMPLETE)
+        return FLASH_KV_FLASH_ERROR;
+
+    return FLASH_KV_Mount(Config);
+}
+
+/*********************************************************************
+ * @fn      FLASH_KV_Write
+ *
+ * @brief   Stores Length bytes under Key. Writing the value already
+ *          stored programs nothing.
+ *
+ * @param   Key - any 16-bit key.
+ *          Data - value.
+ *          Length - 0..FLASH_KV_MAX_VALUE.
+ *
+ * @return  FLASH_KV_Status.
+ */
+FLASH_KV_Status FLASH_KV_Write(uint16_t Key, const void *Data, uint16_t Length)
+{
+    FLASH_KV_Status st;
+    int16_t         e;
+    uint8_t         locked;
+
+    if(!kv_mounted || Length > FLASH_KV_MAX_VALUE || (Data == NULL && Length != 0))
+        return FLASH_KV_INVALID;
+
+    e = kv_find(Key);
+    if(e >= 0 && kv_index[e].Length == Length && memcmp((const void *)(kv_index[e].Addr + 4), Data, Length) == 0)
+    {
+        kv_stats.Unchanged++;
+        return FLASH_KV_OK;
+    }
+    if(e < 0 && kv_keys >= FLASH_KV_MAX_KEYS)
+        return FLASH_KV_NO_SPACE;
+
+    locked = (FLASH->CTLR & CR_LOCK_Set) != 0;
+    FLASH_Unlock_Fast();
+
+    st = kv_reserve(FLASH_KV_REC_SIZE(Length));
+    if(st == FLASH_KV_OK)
+    {
+        st = kv_append(Key | ((uint32_t)Length << 16), (const uint8_t *)Data);
+        kv_stats.Writes++;
+    }
+
+    if(locked)
+        FLASH_Lock_Fast();
+
+    return st;
+}
+
+/*********************************************************************
+ * @fn      FLASH_KV_Read
+ *
+ * @brief   Copies the value of Key, up to Size bytes.
+ *
+ * @param   Key - key.
+ *          Data - destination.
+ *          Size - capacity of Data.
+ *          Length - receives the full value length, may be NULL.
+ *
+ * @return  FLASH_KV_OK or FLASH_KV_NOT_FOUND.
+ */
+FLASH_KV_Status FLASH_KV_Read(uint16_t Key, void *Data, uint16_t Size, uint16_t *Length)
+{
+    int16_t e;
+
+    if(!kv_mounted)
+        return FLASH_KV_INVALID;
+
+    e = kv_find(Key);
+    if(e < 0)
+        return FLASH_KV_NOT_FOUND;
+
+    memcpy(Data, (const void *)(kv_index[e].Addr + 4), (Size < kv_index[e].Length) ? Size : kv_index[e].Length);
+    if(Length)
+        *Length = kv_index[e].Length;
+
+    return FLASH_KV_OK;
+}
+
+/*********************************************************************
+ * @fn      FLASH_KV_Delete
+ *
+ * @brief   Removes Key by appending a deletion record.
+ *
+ * @return  FLASH_KV_Status.
+ */
+FLASH_KV_Status FLASH_KV_Delete(uint16_t Key)
+{
+    FLASH_KV_Status st;
+    uint8_t         locked;
+
+    if(!kv_mounted)
+        return FLASH_KV_INVALID;
+    if(kv_find(Key) < 0)
+        return FLASH_KV_NOT_FOUND;
+
+    locked = (FLASH->CTLR & CR_LOCK_Set) != 0;
+    FLASH_Unlock_Fast();
+
+    st = kv_reserve(FLASH_KV_REC_OVERHEAD);
+    if(st == FLASH_KV_OK)
+        st = kv_append(Key | ((uint32_t)FLASH_KV_LEN_DELETED << 16), NULL);
+
+    if(locked)
+        FLASH_Lock_Fast();
+
+    return st;
+}
+
+/*********************************************************************
+ * @fn      FLASH_KV_GetStats
+ *
+ * @brief   Copies the store counters.
+ *
+ * @return  none
+ */
+void FLASH_KV_GetStats(FLASH_KV_StatsTypeDef *Stats)
+{
+    kv_stats.Keys = kv_keys;
+    kv_stats.FreePages = kv_mounted ? kv_free_pages() : 0;
+    kv_stats.HeadFree = (kv_head >= 0) ? FLASH_KV_PAGE_SIZE - kv_head_off : 0;
+    *Stats = kv_stats;
+}
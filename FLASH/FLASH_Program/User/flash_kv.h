@@ -0,0 +1,75 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : flash_kv.h
+ * Author             : typetrade
+ * Version            : V1.0.0
+ * Date               : 2026/10/17
+ * Description        : Log-structured, wear-levelled key-value store over a
+ *                      set of 256B fast pages.
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+#ifndef __FLASH_KV_H
+#define __FLASH_KV_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "debug.h"
+
+/* RAM index size: keys that can be live at the same time */
+#ifndef FLASH_KV_MAX_KEYS
+#define FLASH_KV_MAX_KEYS          32
+#endif
+
+/* Largest number of pages a store may span */
+#ifndef FLASH_KV_MAX_PAGES
+#define FLASH_KV_MAX_PAGES         64
+#endif
+
+#define FLASH_KV_PAGE_SIZE         256
+
+/* Largest value: one record per page after the page and record headers */
+#define FLASH_KV_MAX_VALUE         (FLASH_KV_PAGE_SIZE - 16 - 8)
+
+/* Result codes */
+typedef enum
+{
+    FLASH_KV_OK = 0,
+    FLASH_KV_NOT_FOUND,     /* No live record for the key */
+    FLASH_KV_NO_SPACE,      /* Index full, or live data fills every page */
+    FLASH_KV_INVALID,       /* Bad argument, or store not mounted */
+    FLASH_KV_FLASH_ERROR    /* Erase or program failed */
+} FLASH_KV_Status;
+
+/* Store location: Pages consecutive 256B pages from Base */
+typedef struct
+{
+    uint32_t Base;          /* 256B aligned */
+    uint16_t Pages;         /* 2..FLASH_KV_MAX_PAGES, one is kept free for garbage collection */
+} FLASH_KV_ConfigTypeDef;
+
+/* Counters since mount */
+typedef struct
+{
+    uint16_t Keys;          /* Live keys */
+    uint16_t FreePages;     /* Erased pages, including the reserve */
+    uint32_t HeadFree;      /* Bytes left in the page being appended to */
+    uint32_t Writes;        /* Records appended for callers */
+    uint32_t Unchanged;     /* Writes skipped, value already stored */
+    uint32_t GcRuns;        /* Pages reclaimed */
+    uint32_t Relocated;     /* Live records copied by the reclaims */
+    uint32_t Erases;        /* Page erases, including garbage found at mount */
+} FLASH_KV_StatsTypeDef;
+
+FLASH_KV_Status FLASH_KV_Mount(const FLASH_KV_ConfigTypeDef *Config);
+FLASH_KV_Status FLASH_KV_Format(const FLASH_KV_ConfigTypeDef *Config);
+FLASH_KV_Status FLASH_KV_Write(uint16_t Key, const void *Data, uint16_t Length);
+FLASH_KV_Status FLASH_KV_Read(uint16_t Key, void *Data, uint16_t Size, uint16_t *Length);
+FLASH_KV_Status FLASH_KV_Delete(uint16_t Key);
+void            FLASH_KV_GetStats(FLASH_KV_StatsTypeDef *Stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __FLASH_KV_H */
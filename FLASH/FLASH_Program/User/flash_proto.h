@@ -0,0 +1,86 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : flash_proto.h
+ * Author             : typetrade
+ * Version            : V1.0.0
+ * Date               : 2026/10/17
+ * Description        : Wire format of the UART flash programming protocol,
+ *                      shared by the device (flash_service.c) and the host
+ *                      client (HOST/FlashProg).
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+#ifndef __FLASH_PROTO_H
+#define __FLASH_PROTO_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "cobs.h"
+
+/* A frame is COBS (cobs.h) of a message followed by the CRC-32 (zlib,
+ * little endian) of the message, ended by a 0 byte. Messages are laid
+ * out as FLASH_ProtoMsgTypeDef, little endian.
+ *
+ * Requests carry a sequence number, replies echo it. The device runs the
+ * requests in sequence order and replies to each when it is done; up to
+ * FLASH_PROTO_WINDOW WRITE requests may be outstanding, so the next pages
+ * arrive while one is programmed. A frame failing its CRC is dropped,
+ * and so is every request after it until the sender, missing a reply,
+ * sends them again from there (go-back-N); a request the device already
+ * ran gets its reply again without running twice. */
+
+/* Message sizes: a request is the header (up to Address) and the
+ * arguments of its command, a reply is always FLASH_PROTO_REPLY_SIZE */
+#define FLASH_PROTO_HDR_SIZE       8
+#define FLASH_PROTO_PAGE_SIZE      256
+#define FLASH_PROTO_REPLY_SIZE     16
+#define FLASH_PROTO_MSG_MAX        (FLASH_PROTO_HDR_SIZE + FLASH_PROTO_PAGE_SIZE)
+#define FLASH_PROTO_FRAME_MAX      COBS_ENCODED_MAX(FLASH_PROTO_MSG_MAX + 4)
+
+/* WRITE requests outstanding, a power of 2 */
+#define FLASH_PROTO_WINDOW         4
+
+/* Commands, replies have FLASH_PROTO_REPLY set */
+#define FLASH_PROTO_SYNC           0x00 /* Starts the sequence at Seq + 1. Reply: Address = first
+                                           writable byte, Arg[0] = end, Arg[1] = window */
+#define FLASH_PROTO_ERASE          0x01 /* Address, Arg[0] = length, 256B multiples */
+#define FLASH_PROTO_WRITE          0x02 /* Address, Data = one 256B page, erased before */
+#define FLASH_PROTO_VERIFY         0x03 /* Address, Arg[0] = length, Arg[1] = CRC, 4B multiples.
+                                           Reply: Arg[1] = CRC of the flash */
+#define FLASH_PROTO_REBOOT         0x04 /* Resets the device after the reply */
+#define FLASH_PROTO_REPLY          0x80
+
+/* VERIFY CRC: CRC-32/MPEG-2 of the range read as little-endian words,
+ * as the CRC unit computes it (flash_verify.h) */
+
+/* Reply status */
+typedef enum
+{
+    FLASH_PROTO_OK = 0,
+    FLASH_PROTO_ERR_CMD,        /* Unknown command or wrong request length */
+    FLASH_PROTO_ERR_RANGE,      /* Misaligned, or outside the writable range */
+    FLASH_PROTO_ERR_FLASH,      /* Erase or program failed */
+    FLASH_PROTO_ERR_MISMATCH,   /* VERIFY: the CRC differs */
+    FLASH_PROTO_ERR_BUSY        /* VERIFY: CRC unit or DMA busy, try again */
+} FLASH_ProtoStatus;
+
+typedef struct
+{
+    uint8_t  Seq;               /* Request sequence number, echoed */
+    uint8_t  Cmd;               /* FLASH_PROTO_xxx */
+    uint8_t  Status;            /* Replies: FLASH_ProtoStatus */
+    uint8_t  Reserved;
+    uint32_t Address;
+    union
+    {
+        uint32_t Arg[2];
+        uint8_t  Data[FLASH_PROTO_PAGE_SIZE];
+    } u;
+} FLASH_ProtoMsgTypeDef;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __FLASH_PROTO_H */
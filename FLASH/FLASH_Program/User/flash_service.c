@@ -0,0 +1,332 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : flash_service.c
+ * Author             : typetrade
+ * Version            : V1.0.0
+ * Date               : 2026/10/17
+ * Description        : Flash programming over the UART: the device side of
+ *                      the flash_proto.h protocol, polled from the main
+ *                      loop.
+ *                      Frames come in through uart_rx.h: the COBS decoder
+ *                      reads the spans of the receive ring in place and
+ *                      stops at each frame end, the request runs, and its
+ *                      reply goes out before the next frame is decoded.
+ *                      ERASE goes through FLASH_EraseRange (the planner's
+ *                      64K/32K/4K/256B mix), WRITE is one
+ *                      FLASH_ProgramPage_Fast straight from the decode
+ *                      buffer, VERIFY is FLASH_CRC_Calc (CRC unit fed by
+ *                      DMA) compared with the CRC sent.
+ *                      Programming a page blocks the CPU for its 1.2ms,
+ *                      but not the RX DMA: the pages the sender's window
+ *                      let it send meanwhile are already in the ring when
+ *                      the reply leaves, so reception overlaps programming
+ *                      and the link idles only if the sender runs out of
+ *                      window. The ring must hold the window less the
+ *                      page being programmed (checked below).
+ *                      Above 100MHz open a FLASH_Session before
+ *                      FLASH_Service_Init and keep it while the service
+ *                      runs: the USART baud rate is derived from the clock
+ *                      at Init, and must not change under the line.
+ *                      Built with SIM_HOST it runs against the host models
+ *                      (HOST/ProtoLoop), with the HOST/FlashProg client.
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+#include <string.h>
+#include "flash_service.h"
+#include "flash_verify.h"
+#include "crc32.h"
+#include "uart_rx.h"
+
+#if(FLASH_PROTO_WINDOW - 1) * FLASH_PROTO_FRAME_MAX > UART_RX_BUF_SIZE
+#error "UART_RX_BUF_SIZE cannot hold the FLASH_PROTO_WINDOW frames in flight"
+#endif
+
+/* Decoded frame: message and CRC. Words, so WRITE data is aligned for
+ * FLASH_ProgramPage_Fast. */
+static uint32_t                  service_rx[(FLASH_PROTO_MSG_MAX + 4 + 3) / 4];
+static uint8_t                   service_tx[COBS_ENCODED_MAX(FLASH_PROTO_REPLY_SIZE + 4)];
+static COBS_DecoderTypeDef       service_dec;
+/* Last replies by sequence number, sent again for duplicates */
+static FLASH_ProtoMsgTypeDef     service_reply[FLASH_PROTO_WINDOW];
+static uint8_t                   service_expect;
+static uint8_t                   service_reboot;
+static uint32_t                  service_lost;
+static FLASH_ServiceStatsTypeDef service_stats;
+
+/*********************************************************************
+ * @fn      service_end
+ *
+ * @brief   End of the service range, cut to the end of the part's flash.
+ *
+ * @return  First address past the range.
+ */
+static uint32_t service_end(void)
+{
+    uint32_t end = FLASH_ERASE_END;
+
+    return (FLASH_SERVICE_END < end) ? FLASH_SERVICE_END : end;
+}
+
+/*********************************************************************
+ * @fn      service_range
+ *
+ * @brief   Checks a request range: aligned, within the service range.
+ *
+ * @return  1 if valid.
+ */
+static uint8_t service_range(uint32_t Address, uint32_t Length, uint32_t Align)
+{
+    uint32_t end = service_end();
+
+    return Length != 0 && ((Address | Length) & (Align - 1)) == 0 && Address >= FLASH_SERVICE_START &&
+           Address < end && Length <= end - Address;
+}
+
+/*********************************************************************
+ * @fn      service_send
+ *
+ * @brief   Sends a reply frame.
+ *
+ * @return  none
+ */
+static void service_send(const FLASH_ProtoMsgTypeDef *Reply)
+{
+    uint32_t msg[FLASH_PROTO_REPLY_SIZE / 4 + 1];
+
+    memcpy(msg, Reply, FLASH_PROTO_REPLY_SIZE);
+    msg[FLASH_PROTO_REPLY_SIZE / 4] = CRC32_Calc(msg, FLASH_PROTO_REPLY_SIZE);
+    UART_Tx_Write(service_tx, COBS_Encode(msg, sizeof(msg), service_tx));
+}
+
+/*********************************************************************
+ * @fn      service_run
+ *
+ * @brief   Runs a request.
+ *
+ * @param   Req - request.
+ *          Length - request length, CRC excluded.
+ *          Reply - its reply, header filled in.
+ *
+ * @return  Reply status.
+ */
+static FLASH_ProtoStatus service_run(const FLASH_ProtoMsgTypeDef *Req, uint32_t Length, FLASH_ProtoMsgTypeDef *Reply)
+{
+    switch(Req->Cmd)
+    {
+        case FLASH_PROTO_SYNC:
+            if(Length != FLASH_PROTO_HDR_SIZE)
+                return FLASH_PROTO_ERR_CMD;
+            Reply->Address = FLASH_SERVICE_START;
+            Reply->u.Arg[0] = service_end();
+            Reply->u.Arg[1] = FLASH_PROTO_WINDOW;
+            return FLASH_PROTO_OK;
+
+        case FLASH_PROTO_ERASE:
+            if(Length != FLASH_PROTO_HDR_SIZE + 4)
+                return FLASH_PROTO_ERR_CMD;
+            Reply->u.Arg[0] = Req->u.Arg[0];
+            if(!service_range(Req->Address, Req->u.Arg[0], FLASH_ERASE_MIN_SIZE))
+                return FLASH_PROTO_ERR_RANGE;
+            if(FLASH_EraseRange(Req->Address, Req->u.Arg[0]) != FLASH_COMPLETE)
+                return FLASH_PROTO_ERR_FLASH;
+            return FLASH_PROTO_OK;
+
+        case FLASH_PROTO_WRITE:
+            if(Length != FLASH_PROTO_HDR_SIZE + FLASH_PROTO_PAGE_SIZE)
+                return FLASH_PROTO_ERR_CMD;
+            if(!service_range(Req->Address, FLASH_PROTO_PAGE_SIZE, FLASH_PROTO_PAGE_SIZE))
+                return FLASH_PROTO_ERR_RANGE;
+            FLASH_ClearFlag(FLASH_FLAG_EOP | FLASH_FLAG_PGERR | FLASH_FLAG_WRPRTERR);
+            FLASH_ProgramPage_Fast(Req->Address, (uint32_t *)Req->u.Data);
+            service_stats.PagesWritten++;
+            if(FLASH_GetBank1Status() != FLASH_COMPLETE)
+                return FLASH_PROTO_ERR_FLASH;
+            return FLASH_PROTO_OK;
+
+        case FLASH_PROTO_VERIFY:
+            if(Length != FLASH_PROTO_HDR_SIZE + 8)
+                return FLASH_PROTO_ERR_CMD;
+            Reply->u.Arg[0] = Req->u.Arg[0];
+            if(!service_range(Req->Address, Req->u.Arg[0], 4))
+                return FLASH_PROTO_ERR_RANGE;
+            switch(FLASH_CRC_Calc(Req->Address, Req->u.Arg[0], &Reply->u.Arg[1]))
+            {
+                case FLASH_VERIFY_OK:
+                    return Reply->u.Arg[1] == Req->u.Arg[1] ? FLASH_PROTO_OK : FLASH_PROTO_ERR_MISMATCH;
+                case FLASH_VERIFY_BUSY:
+                    return FLASH_PROTO_ERR_BUSY;
+                default:
+                    return FLASH_PROTO_ERR_FLASH;
+            }
+
+        case FLASH_PROTO_REBOOT:
+            if(Length != FLASH_PROTO_HDR_SIZE)
+                return FLASH_PROTO_ERR_CMD;
+            service_reboot = 1;
+            return FLASH_PROTO_OK;
+
+        default:
+            return FLASH_PROTO_ERR_CMD;
+    }
+}
+
+/*********************************************************************
+ * @fn      service_frame
+ *
+ * @brief   Handles a decoded frame: checks it, runs the request in
+ *          sequence, replies.
+ *
+ * @param   Length - frame length, CRC included.
+ *
+ * @return  none
+ */
+static void service_frame(uint32_t Length)
+{
+    const FLASH_ProtoMsgTypeDef *req = (const FLASH_ProtoMsgTypeDef *)service_rx;
+    FLASH_ProtoMsgTypeDef       *reply;
+    uint32_t                     crc;
+    uint8_t                      d;
+
+    if(Length < FLASH_PROTO_HDR_SIZE + 4)
+    {
+        service_stats.BadFrames++;
+        return;
+    }
+    Length -= 4;
+    memcpy(&crc, (const uint8_t *)service_rx + Length, 4);
+    if(CRC32_Calc(service_rx, Length) != crc)
+    {
+        service_stats.BadFrames++;
+        return;
+    }
+
+    if(req->Cmd == FLASH_PROTO_SYNC)
+    {
+        service_expect = req->Seq;
+        memset(service_reply, 0, sizeof(service_reply));
+    }
+    reply = &service_reply[req->Seq & (FLASH_PROTO_WINDOW - 1)];
+    d = (uint8_t)(req->Seq - service_expect);
+    if(d != 0)
+    {
+        /* One of the last FLASH_PROTO_WINDOW: its reply was lost */
+        if(d >= (uint8_t)-FLASH_PROTO_WINDOW && reply->Seq == req->Seq && reply->Cmd == (req->Cmd | FLASH_PROTO_REPLY))
+        {
+            service_stats.Duplicates++;
+            service_send(reply);
+        }
+        else
+        {
+            service_stats.OutOfOrder++;
+        }
+        return;
+    }
+
+    memset(reply, 0, FLASH_PROTO_REPLY_SIZE);
+    reply->Seq = req->Seq;
+    reply->Cmd = req->Cmd | FLASH_PROTO_REPLY;
+    reply->Address = req->Address;
+    reply->Status = (uint8_t)service_run(req, Length, reply);
+    if(reply->Status != FLASH_PROTO_OK)
+        service_stats.Errors++;
+    service_stats.Requests++;
+    service_expect++;
+    service_send(reply);
+}
+
+/*********************************************************************
+ * @fn      FLASH_Service_Init
+ *
+ * @brief   Starts reception (UART_Rx_Init) and unlocks the fast mode
+ *          programming. The first request must be a SYNC.
+ *
+ * @param   Baudrate - USART baud rate.
+ *
+ * @return  SUCCESS, or ERROR if the RX DMA channel is held elsewhere.
+ */
+ErrorStatus FLASH_Service_Init(uint32_t Baudrate)
+{
+    COBS_DecodeInit(&service_dec, service_rx, sizeof(service_rx));
+    memset(service_reply, 0, sizeof(service_reply));
+    memset(&service_stats, 0, sizeof(service_stats));
+    service_expect = 0;
+    service_reboot = 0;
+    service_lost = 0;
+
+    if(UART_Rx_Init(Baudrate, NULL, NULL) != SUCCESS)
+        return ERROR;
+    FLASH_Unlock_Fast();
+    return SUCCESS;
+}
+
+/*********************************************************************
+ * @fn      FLASH_Service_DeInit
+ *
+ * @brief   Stops reception and locks the controller.
+ *
+ * @return  none
+ */
+void FLASH_Service_DeInit(void)
+{
+    UART_Rx_DeInit();
+    FLASH_Lock_Fast();
+}
+
+/*********************************************************************
+ * @fn      FLASH_Service_Poll
+ *
+ * @brief   Decodes the bytes received so far, up to and including the
+ *          first complete frame, and runs its request: at most one
+ *          request per call, so the caller's loop gets a turn between
+ *          pages. Call from the main loop.
+ *
+ * @return  1 once a REBOOT request was replied to: the caller resets
+ *          when the reply has left (NVIC_SystemReset). 0 otherwise.
+ */
+uint8_t FLASH_Service_Poll(void)
+{
+    UART_RxStatsTypeDef rx;
+    const uint8_t      *p;
+    uint32_t            n, used;
+    int32_t             frame = COBS_FRAME_NONE;
+    ErrorStatus         intact;
+
+    while(!service_reboot && frame == COBS_FRAME_NONE && (n = UART_Rx_Peek(&p)) != 0)
+    {
+        /* Bytes lost before this span: the frame they were in is gone */
+        UART_Rx_GetStats(&rx);
+        if(rx.Lost != service_lost)
+        {
+            service_lost = rx.Lost;
+            COBS_DecodeAbort(&service_dec);
+        }
+
+        used = COBS_Decode(&service_dec, p, n, &frame);
+        intact = UART_Rx_Consume(used);
+        if(frame == COBS_FRAME_NONE)
+        {
+            if(intact != SUCCESS)
+                COBS_DecodeAbort(&service_dec);
+        }
+        else if(frame == COBS_FRAME_BAD || intact != SUCCESS)
+        {
+            service_stats.BadFrames++;
+        }
+        else
+        {
+            service_frame((uint32_t)frame);
+        }
+    }
+    return service_reboot;
+}
+
+/*********************************************************************
+ * @fn      FLASH_Service_GetStats
+ *
+ * @brief   Copies the service counters.
+ *
+ * @return  none
+ */
+void FLASH_Service_GetStats(FLASH_ServiceStatsTypeDef *Stats)
+{
+    *Stats = service_stats;
+}
@@ -0,0 +1,51 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : flash_service.h
+ * Author             : typetrade
+ * Version            : V1.0.0
+ * Date               : 2026/10/17
+ * Description        : Flash programming over the UART: the device side of
+ *                      the flash_proto.h protocol.
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+#ifndef __FLASH_SERVICE_H
+#define __FLASH_SERVICE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "debug.h"
+#include "flash_erase.h"
+#include "flash_proto.h"
+
+/* Range the requests may erase, write and verify. The default keeps the
+ * first 32K, where this program runs. The end is cut to the flash size of
+ * the part (FLASH_ERASE_END), and SYNC reports the cut one. */
+#ifndef FLASH_SERVICE_START
+#define FLASH_SERVICE_START        ((uint32_t)0x08008000)
+#endif
+#ifndef FLASH_SERVICE_END
+#define FLASH_SERVICE_END          FLASH_ERASE_END
+#endif
+
+/* Service counters */
+typedef struct
+{
+    uint32_t Requests;          /* Requests run */
+    uint32_t BadFrames;         /* Frames dropped: CRC, framing or length, or bytes lost in the ring */
+    uint32_t Duplicates;        /* Requests run before, replied to again */
+    uint32_t OutOfOrder;        /* Requests after a missing one, dropped */
+    uint32_t PagesWritten;
+    uint32_t Errors;            /* Replies with a status other than FLASH_PROTO_OK */
+} FLASH_ServiceStatsTypeDef;
+
+ErrorStatus FLASH_Service_Init(uint32_t Baudrate);
+void        FLASH_Service_DeInit(void);
+uint8_t     FLASH_Service_Poll(void);
+void        FLASH_Service_GetStats(FLASH_ServiceStatsTypeDef *Stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __FLASH_SERVICE_H */
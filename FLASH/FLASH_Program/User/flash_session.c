@@ -0,0 +1,106 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : flash_session.c
+ * Author             : typetrade
+ * Version            : V1.0.0
+ * Date               : 2026/10/17
+ * Description        : Scoped HCLK/2 guard for flash operations above 100MHz.
+ *                      The outermost FLASH_Session_Enter halves HCLK when
+ *                      SystemCoreClock is above FLASH_SESSION_HCLK_MAX and
+ *                      patches what depends on it in place: SystemCoreClock,
+ *                      the Delay_Us/Delay_Ms factors and the BRR of the
+ *                      printf USART (PCLK halves with HCLK), after
+ *                      flushing what printf queued. The matching
+ *                      FLASH_Session_Exit puts everything back. Nested
+ *                      sessions only count.
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+#include "flash_session.h"
+
+#if(DEBUG == DEBUG_UART1)
+#define SESSION_USART              USART1
+#elif(DEBUG == DEBUG_UART2)
+#define SESSION_USART              USART2
+#elif(DEBUG == DEBUG_UART3)
+#define SESSION_USART              USART3
+#endif
+
+static uint8_t  session_depth = 0;
+static uint8_t  session_scaled = 0;
+static uint32_t session_clock;
+#ifdef SESSION_USART
+static uint16_t session_brr;
+#endif
+
+/*********************************************************************
+ * @fn      FLASH_Session_Enter
+ *
+ * @brief   Opens a flash session, see the file description.
+ *
+ * @return  none
+ */
+void FLASH_Session_Enter(void)
+{
+    if(session_depth++ != 0)
+        return;
+
+    session_scaled = 0;
+    if(SystemCoreClock <= FLASH_SESSION_HCLK_MAX || (RCC->CFGR0 & RCC_HPRE) != RCC_HPRE_DIV1)
+        return;
+
+#ifdef SESSION_USART
+    /* Let what printf queued leave at the old baud rate */
+    if(SESSION_USART->CTLR1 & USART_CTLR1_UE)
+    {
+        USART_Printf_Flush();
+    }
+    session_brr = SESSION_USART->BRR;
+#endif
+    session_clock = SystemCoreClock;
+
+    RCC->CFGR0 = (RCC->CFGR0 & ~RCC_HPRE) | RCC_HPRE_DIV2;
+    SystemCoreClock = session_clock / 2;
+    Delay_Init();
+#ifdef SESSION_USART
+    SESSION_USART->BRR = (uint16_t)((session_brr + 1) / 2);
+#endif
+    session_scaled = 1;
+}
+
+/*********************************************************************
+ * @fn      FLASH_Session_Exit
+ *
+ * @brief   Closes a flash session. The outermost one restores HCLK.
+ *
+ * @return  none
+ */
+void FLASH_Session_Exit(void)
+{
+    if(session_depth == 0 || --session_depth != 0 || !session_scaled)
+        return;
+
+#ifdef SESSION_USART
+    if(SESSION_USART->CTLR1 & USART_CTLR1_UE)
+    {
+        USART_Printf_Flush();
+    }
+#endif
+    RCC->CFGR0 = (RCC->CFGR0 & ~RCC_HPRE) | RCC_HPRE_DIV1;
+    SystemCoreClock = session_clock;
+    Delay_Init();
+#ifdef SESSION_USART
+    SESSION_USART->BRR = session_brr;
+#endif
+    session_scaled = 0;
+}
+
+/*********************************************************************
+ * @fn      FLASH_Session_Depth
+ *
+ * @brief   Number of open sessions.
+ *
+ * @return  Depth, 0 outside any session.
+ */
+uint8_t FLASH_Session_Depth(void)
+{
+    return session_depth;
+}
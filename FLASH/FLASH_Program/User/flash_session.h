@@ -0,0 +1,29 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : flash_session.h
+ * Author             : typetrade
+ * Version            : V1.0.0
+ * Date               : 2026/10/17
+ * Description        : Scoped HCLK/2 guard for flash operations above 100MHz.
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+#ifndef __FLASH_SESSION_H
+#define __FLASH_SESSION_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "debug.h"
+
+/* Highest HCLK the flash may be operated at */
+#define FLASH_SESSION_HCLK_MAX     ((uint32_t)100000000)
+
+void    FLASH_Session_Enter(void);
+void    FLASH_Session_Exit(void);
+uint8_t FLASH_Session_Depth(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __FLASH_SESSION_H */
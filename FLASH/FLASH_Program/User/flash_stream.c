@@ -0,0 +1,355 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : flash_stream.c
+ * Author             : typetrade
+ * Version            : V1.0.0
+ * Date               : 2026/10/17
+ * Description        : Double-buffered streaming writer.
+ *                      FLASH_Stream_Write copies into one 256B page buffer;
+ *                      when it is full it becomes a FLASH_JOB_PROGRAM_PAGE_FAST
+ *                      job and the producer goes on filling the other one
+ *                      while the controller programs. The region is erased
+ *                      in 32K blocks where aligned, 4K pages elsewhere,
+ *                      queued ahead of the page needing them: the queue
+ *                      runs jobs in order, so a page never starts before
+ *                      its erase ended. FLASH_Stream_Poll, from the main
+ *                      loop, erases up to FLASH_STREAM_AHEAD further while
+ *                      the controller is idle, so a burst arriving after
+ *                      a pause does not wait for an erase.
+ *                      Backpressure: with both buffers queued, Write takes
+ *                      what fits and returns short, and the Ready callback
+ *                      runs (FLASH interrupt) once a buffer is free. A
+ *                      producer that keeps one buffer full keeps the
+ *                      controller busy: ingest runs at the fast page
+ *                      program rate, less the erase time.
+ *
+ *                      Notes:
+ *                      - FLASH_Async_Init and FLASH_Unlock_Fast first, and
+ *                        above 100MHz keep a FLASH_Session until the
+ *                        stream is idle, as for flash_async.c.
+ *                      - Write, Flush and Poll run in one context (main
+ *                        loop, or one interrupt priority); the FLASH
+ *                        interrupt only completes buffers and erases.
+ *                      - A partial last page is padded with 0xFF by
+ *                        FLASH_Stream_Flush.
+ *                      - Code fetched from flash waits out the running
+ *                        job (flash_async.c): a producer in flash fills
+ *                        the other buffer between jobs, not during them.
+ *                      Built with SIM_HOST it runs against the host FLASH
+ *                      simulator (HOST/FlashStream).
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+#include <string.h>
+#include "flash_stream.h"
+#include "flash_async.h"
+#include "flash_erase.h"
+
+#define STREAM_BLOCK_SIZE          ((uint32_t)0x8000)
+
+/*********************************************************************
+ * @fn      stream_wake
+ *
+ * @brief   Runs Ready for a write that was cut short. FLASH interrupt.
+ *
+ * @return  none
+ */
+static void stream_wake(FLASH_StreamTypeDef *Stream)
+{
+    if(Stream->Waiting)
+    {
+        Stream->Waiting = 0;
+        if(Stream->Ready)
+            Stream->Ready(Stream->Context);
+    }
+}
+
+/*********************************************************************
+ * @fn      stream_programmed
+ *
+ * @brief   Page job callback, FLASH interrupt: frees the oldest buffer
+ *          and wakes a producer that was held back.
+ *
+ * @return  none
+ */
+static void stream_programmed(void *Context, FLASH_Status Status)
+{
+    FLASH_StreamTypeDef *stream = (FLASH_StreamTypeDef *)Context;
+
+    if(Status != FLASH_COMPLETE && stream->Status == FLASH_COMPLETE)
+        stream->Status = Status;
+    stream->Stats.Pages++;
+    stream->Busy[stream->Done] = 0;
+    stream->Done ^= 1;
+    stream_wake(stream);
+}
+
+/*********************************************************************
+ * @fn      stream_erased
+ *
+ * @brief   Erase job callback, FLASH interrupt. A queue slot is free,
+ *          which a full page may have been waiting for.
+ *
+ * @return  none
+ */
+static void stream_erased(void *Context, FLASH_Status Status)
+{
+    FLASH_StreamTypeDef *stream = (FLASH_StreamTypeDef *)Context;
+
+    if(Status != FLASH_COMPLETE && stream->Status == FLASH_COMPLETE)
+        stream->Status = Status;
+    stream->ErasesDone++;
+    stream_wake(stream);
+}
+
+/*********************************************************************
+ * @fn      stream_erase
+ *
+ * @brief   Queues the erase of the next block or page of the region.
+ *
+ * @return  SUCCESS, or ERROR with the job queue full.
+ */
+static ErrorStatus stream_erase(FLASH_StreamTypeDef *Stream)
+{
+    FLASH_JobTypeDef job;
+    uint32_t         size;
+
+    memset(&job, 0, sizeof(job));
+    job.Address = Stream->Erased;
+    job.Callback = stream_erased;
+    job.Context = Stream;
+    if((Stream->Erased & (STREAM_BLOCK_SIZE - 1)) == 0 && Stream->End - Stream->Erased >= STREAM_BLOCK_SIZE)
+    {
+        job.Op = FLASH_JOB_ERASE_32K_FAST;
+        size = STREAM_BLOCK_SIZE;
+    }
+    else
+    {
+        job.Op = FLASH_JOB_ERASE_PAGE;
+        size = FLASH_STREAM_ALIGN;
+    }
+    if(FLASH_Async_Submit(&job) != SUCCESS)
+        return ERROR;
+    Stream->Erased += size;
+    Stream->Stats.Erases++;
+    return SUCCESS;
+}
+
+/*********************************************************************
+ * @fn      stream_submit
+ *
+ * @brief   Queues the full buffer for programming, after the erase it
+ *          needs, and switches to the other one.
+ *
+ * @return  SUCCESS, or ERROR with the job queue full.
+ */
+static ErrorStatus stream_submit(FLASH_StreamTypeDef *Stream)
+{
+    FLASH_JobTypeDef job;
+
+    if(Stream->Erased < Stream->Next + FLASH_STREAM_PAGE_SIZE && stream_erase(Stream) != SUCCESS)
+        return ERROR;
+
+    memset(&job, 0, sizeof(job));
+    job.Op = FLASH_JOB_PROGRAM_PAGE_FAST;
+    job.Address = Stream->Next;
+    job.Buffer = Stream->Buf[Stream->Cur];
+    job.Length = FLASH_STREAM_PAGE_SIZE;
+    job.Callback = stream_programmed;
+    job.Context = Stream;
+    /* Busy before the job can complete */
+    Stream->Busy[Stream->Cur] = 1;
+    if(FLASH_Async_Submit(&job) != SUCCESS)
+    {
+        Stream->Busy[Stream->Cur] = 0;
+        return ERROR;
+    }
+    Stream->Next += FLASH_STREAM_PAGE_SIZE;
+    Stream->Fill = 0;
+    Stream->Cur ^= 1;
+    return SUCCESS;
+}
+
+/*********************************************************************
+ * @fn      FLASH_Stream_Init
+ *
+ * @brief   Starts a stream over a region and queues its first erase.
+ *
+ * @param   Stream - writer.
+ *          Start - region start, 4K aligned.
+ *          End - region end, 4K aligned.
+ *          Ready - called from the FLASH interrupt when a write that
+ *            was cut short may go on, may be NULL.
+ *          Context - passed to Ready.
+ *
+ * @return  SUCCESS, or ERROR for a bad region.
+ */
+ErrorStatus FLASH_Stream_Init(FLASH_StreamTypeDef *Stream, uint32_t Start, uint32_t End,
+                              void (*Ready)(void *Context), void *Context)
+{
+    if(((Start | End) & (FLASH_STREAM_ALIGN - 1)) || Start < FLASH_ERASE_START || End > FLASH_ERASE_END ||
+       Start >= End)
+        return ERROR;
+
+    memset(Stream, 0, sizeof(*Stream));
+    Stream->Start = Start;
+    Stream->End = End;
+    Stream->Next = Start;
+    Stream->Erased = Start;
+    Stream->Status = FLASH_COMPLETE;
+    Stream->Ready = Ready;
+    Stream->Context = Context;
+
+    /* Else the first page queues it */
+    stream_erase(Stream);
+    return SUCCESS;
+}
+
+/*********************************************************************
+ * @fn      FLASH_Stream_Write
+ *
+ * @brief   Takes stream bytes. Never waits: with both buffers queued
+ *          it takes what fits, and Ready runs once a buffer is free.
+ *
+ * @param   Stream - writer.
+ *          Data - bytes.
+ *          Length - byte count.
+ *
+ * @return  Bytes taken. Fewer than Length: both buffers busy (Ready
+ *          follows), the region is full, or a job failed
+ *          (FLASH_Stream_Status).
+ */
+uint32_t FLASH_Stream_Write(FLASH_StreamTypeDef *Stream, const void *Data, uint32_t Length)
+{
+    const uint8_t *p = (const uint8_t *)Data;
+    uint32_t       taken = 0, n;
+
+    while(taken < Length && Stream->Status == FLASH_COMPLETE)
+    {
+        if(Stream->Fill == FLASH_STREAM_PAGE_SIZE)
+        {
+            /* Full page the queue had no room for */
+            Stream->Waiting = 1;
+            if(stream_submit(Stream) != SUCCESS)
+            {
+                Stream->Stats.Stalls++;
+                break;
+            }
+            Stream->Waiting = 0;
+            continue;
+        }
+        if(Stream->Next >= Stream->End)
+            break;
+        if(Stream->Busy[Stream->Cur])
+        {
+            /* Set before looking again: the buffer may have just been freed */
+            Stream->Waiting = 1;
+            if(Stream->Busy[Stream->Cur])
+            {
+                Stream->Stats.Stalls++;
+                break;
+            }
+            Stream->Waiting = 0;
+        }
+
+        n = FLASH_STREAM_PAGE_SIZE - Stream->Fill;
+        if(n > Length - taken)
+            n = Length - taken;
+        memcpy((uint8_t *)Stream->Buf[Stream->Cur] + Stream->Fill, p + taken, n);
+        Stream->Fill += n;
+        taken += n;
+        if(Stream->Fill == FLASH_STREAM_PAGE_SIZE)
+            stream_submit(Stream);
+    }
+    return taken;
+}
+
+/*********************************************************************
+ * @fn      FLASH_Stream_Space
+ *
+ * @brief   Bytes FLASH_Stream_Write would take now, for producers that
+ *          size their transfers (e.g. a DMA).
+ *
+ * @return  Byte count.
+ */
+uint32_t FLASH_Stream_Space(const FLASH_StreamTypeDef *Stream)
+{
+    uint32_t n = 0, left;
+
+    if(Stream->Status != FLASH_COMPLETE || Stream->Next >= Stream->End)
+        return 0;
+    if(!Stream->Busy[Stream->Cur] && Stream->Fill < FLASH_STREAM_PAGE_SIZE)
+    {
+        n = FLASH_STREAM_PAGE_SIZE - Stream->Fill;
+        if(!Stream->Busy[Stream->Cur ^ 1])
+            n += FLASH_STREAM_PAGE_SIZE;
+    }
+    left = Stream->End - Stream->Next - Stream->Fill;
+    return n < left ? n : left;
+}
+
+/*********************************************************************
+ * @fn      FLASH_Stream_Flush
+ *
+ * @brief   Queues the page being filled, padded with 0xFF. The stream
+ *          goes on at the next page.
+ *
+ * @return  SUCCESS, or ERROR if the page could not be queued yet (both
+ *          buffers busy): call again.
+ */
+ErrorStatus FLASH_Stream_Flush(FLASH_StreamTypeDef *Stream)
+{
+    if(Stream->Fill == 0)
+        return SUCCESS;
+    if(Stream->Fill < FLASH_STREAM_PAGE_SIZE)
+    {
+        if(Stream->Busy[Stream->Cur])
+            return ERROR;
+        memset((uint8_t *)Stream->Buf[Stream->Cur] + Stream->Fill, 0xFF, FLASH_STREAM_PAGE_SIZE - Stream->Fill);
+        Stream->Fill = FLASH_STREAM_PAGE_SIZE;
+    }
+    return stream_submit(Stream);
+}
+
+/*********************************************************************
+ * @fn      FLASH_Stream_Poll
+ *
+ * @brief   Call from the main loop: while the controller is idle,
+ *          queues the next erase up to FLASH_STREAM_AHEAD past the page
+ *          being filled, one per call.
+ *
+ * @return  none
+ */
+void FLASH_Stream_Poll(FLASH_StreamTypeDef *Stream)
+{
+    uint32_t until = Stream->Next + FLASH_STREAM_PAGE_SIZE + FLASH_STREAM_AHEAD;
+
+    if(until > Stream->End)
+        until = Stream->End;
+    if(Stream->Status != FLASH_COMPLETE || Stream->Erased >= until || FLASH_Async_Pending() != 0)
+        return;
+    if(stream_erase(Stream) == SUCCESS)
+        Stream->Stats.ErasesAhead++;
+}
+
+/*********************************************************************
+ * @fn      FLASH_Stream_Idle
+ *
+ * @brief   Whether every page and erase queued has completed.
+ *
+ * @return  1 when idle.
+ */
+uint8_t FLASH_Stream_Idle(const FLASH_StreamTypeDef *Stream)
+{
+    return !Stream->Busy[0] && !Stream->Busy[1] && Stream->ErasesDone == Stream->Stats.Erases;
+}
+
+/*********************************************************************
+ * @fn      FLASH_Stream_Status
+ *
+ * @brief   First erase or program error of the stream.
+ *
+ * @return  FLASH_COMPLETE, FLASH_ERROR_PG or FLASH_ERROR_WRP.
+ */
+FLASH_Status FLASH_Stream_Status(const FLASH_StreamTypeDef *Stream)
+{
+    return Stream->Status;
+}
@@ -0,0 +1,73 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : flash_stream.h
+ * Author             : typetrade
+ * Version            : V1.0.0
+ * Date               : 2026/10/17
+ * Description        : Double-buffered streaming writer: lands a byte
+ *                      stream in a flash region through the flash_async
+ *                      job queue, erasing ahead of the write pointer.
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+#ifndef __FLASH_STREAM_H
+#define __FLASH_STREAM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "debug.h"
+
+#define FLASH_STREAM_PAGE_SIZE     256
+
+/* Regions start and end on 4K boundaries */
+#define FLASH_STREAM_ALIGN         ((uint32_t)0x1000)
+
+/* Erased flash FLASH_Stream_Poll keeps ahead of the write pointer while
+ * the controller is idle */
+#ifndef FLASH_STREAM_AHEAD
+#define FLASH_STREAM_AHEAD         ((uint32_t)0x8000)
+#endif
+
+/* Writer counters */
+typedef struct
+{
+    uint32_t Pages;             /* Pages programmed */
+    uint32_t Erases;            /* Erase jobs queued, 32K or 4K */
+    uint32_t ErasesAhead;       /* Of which by FLASH_Stream_Poll, before the data needed them */
+    uint32_t Stalls;            /* Writes cut short: both buffers or the job queue busy */
+} FLASH_StreamStatsTypeDef;
+
+/* Writer. Caller-owned, the fields are read-only outside flash_stream.c. */
+typedef struct
+{
+    uint32_t                 Buf[2][FLASH_STREAM_PAGE_SIZE / 4];
+    uint32_t                 Start;
+    uint32_t                 End;
+    uint32_t                 Next;          /* Address of the page being filled */
+    uint32_t                 Erased;        /* End of the erase jobs queued */
+    uint16_t                 Fill;          /* Bytes in the page being filled */
+    uint8_t                  Cur;           /* Buffer being filled */
+    uint8_t                  Done;          /* Buffer programmed next */
+    volatile uint8_t         Busy[2];       /* Buffer queued for programming */
+    volatile uint8_t         Waiting;       /* A write was cut short, Ready is due */
+    volatile uint32_t        ErasesDone;
+    volatile FLASH_Status    Status;        /* First job error, FLASH_COMPLETE if none */
+    void                   (*Ready)(void *Context);
+    void                    *Context;
+    FLASH_StreamStatsTypeDef Stats;
+} FLASH_StreamTypeDef;
+
+ErrorStatus  FLASH_Stream_Init(FLASH_StreamTypeDef *Stream, uint32_t Start, uint32_t End,
+                               void (*Ready)(void *Context), void *Context);
+uint32_t     FLASH_Stream_Write(FLASH_StreamTypeDef *Stream, const void *Data, uint32_t Length);
+uint32_t     FLASH_Stream_Space(const FLASH_StreamTypeDef *Stream);
+ErrorStatus  FLASH_Stream_Flush(FLASH_StreamTypeDef *Stream);
+void         FLASH_Stream_Poll(FLASH_StreamTypeDef *Stream);
+uint8_t      FLASH_Stream_Idle(const FLASH_StreamTypeDef *Stream);
+FLASH_Status FLASH_Stream_Status(const FLASH_StreamTypeDef *Stream);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __FLASH_STREAM_H */
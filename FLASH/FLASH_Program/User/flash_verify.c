@@ -0,0 +1,188 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : flash_verify.c
+ * Author             : typetrade
+ * Version            : V1.0.0
+ * Date               : 2026/10/17
+ * Description        : Verification of programmed FLASH through the CRC unit.
+ *                      The array side is streamed into CRC->DATAR by a
+ *                      memory-to-memory DMA channel (any free one, from
+ *                      the channel manager for the call), in
+ *                      transfers of at most 65535 words, so the CPU only
+ *                      starts it and waits for the last transfer complete
+ *                      flag. The RAM side of FLASH_Verify goes through
+ *                      CRC_CalcBlockCRC; on a CRC mismatch the range is
+ *                      compared page by page to find the first 256B page
+ *                      that differs.
+ *                      The CRC is the unit's own: CRC-32/MPEG-2 over 32-bit
+ *                      words, so lengths are whole words.
+ *                      The CRC unit is taken through CRC32_UnitAcquire, so
+ *                      a CRC-32 stream the CPU was feeding (crc32.h)
+ *                      survives; a verification interrupting another one
+ *                      gets FLASH_VERIFY_BUSY, as does one finding no free
+ *                      DMA channel.
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+#include "flash_verify.h"
+#include "crc32.h"
+#include "dma_chan.h"
+
+/* Largest DMA transfer, in words */
+#define FLASH_VERIFY_DMA_MAX       ((uint32_t)0xFFFF)
+
+#define FLASH_VERIFY_PAGE_MASK     ((uint32_t)(FLASH_VERIFY_PAGE_SIZE - 1))
+
+/*********************************************************************
+ * @fn      flash_verify_dma
+ *
+ * @brief   Streams Words words at Address into CRC->DATAR on Channel
+ *          and waits.
+ *
+ * @return  1 on success, 0 on a DMA transfer error.
+ */
+static uint8_t flash_verify_dma(uint8_t Channel, uint32_t Address, uint32_t Words)
+{
+    DMA_Channel_TypeDef *ch = DMA_Chan_Regs(Channel);
+    DMA_InitTypeDef      DMA_InitStructure;
+    uint32_t             flags, shift = 4 * (Channel - 1);
+
+    DMA_Cmd(ch, DISABLE);
+    DMA_InitStructure.DMA_PeripheralBaseAddr = (uint32_t)&CRC->DATAR;
+    DMA_InitStructure.DMA_MemoryBaseAddr = Address;
+    DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralDST;
+    DMA_InitStructure.DMA_BufferSize = Words;
+    DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+    DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
+    DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Word;
+    DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_Word;
+    DMA_InitStructure.DMA_Mode = DMA_Mode_Normal;
+    DMA_InitStructure.DMA_Priority = DMA_Priority_High;
+    DMA_InitStructure.DMA_M2M = DMA_M2M_Enable;
+    DMA_Init(ch, &DMA_InitStructure);
+    DMA1->INTFCR = (uint32_t)0xF << shift;
+    DMA_Cmd(ch, ENABLE);
+
+    do
+    {
+        flags = (DMA1->INTFR >> shift) & (DMA_CHAN_TC | DMA_CHAN_TE);
+    } while(flags == 0);
+
+    DMA_Cmd(ch, DISABLE);
+    DMA1->INTFCR = (uint32_t)0xF << shift;
+    return (flags & DMA_CHAN_TE) == 0;
+}
+
+/*********************************************************************
+ * @fn      FLASH_CRC_Calc
+ *
+ * @brief   CRC of a FLASH range, computed by the CRC unit from DMA.
+ *
+ * @param   Address - word aligned start address.
+ *          Length - bytes, a multiple of 4.
+ *          Crc - CRC of the range.
+ *
+ * @return  FLASH_VERIFY_OK, FLASH_VERIFY_ERROR or FLASH_VERIFY_BUSY.
+ */
+FLASH_VerifyStatus FLASH_CRC_Calc(uint32_t Address, uint32_t Length, uint32_t *Crc)
+{
+    FLASH_VerifyStatus status = FLASH_VERIFY_OK;
+    CRC32_UnitOwner    prev;
+    uint32_t           words, n, saved = 0;
+    uint8_t            ch;
+
+    if((Address | Length) & 3)
+        return FLASH_VERIFY_ERROR;
+
+    ch = DMA_Chan_Alloc(DMA_REQ_MEM2MEM, NULL, NULL);
+    if(ch == 0)
+        return FLASH_VERIFY_BUSY;
+    prev = CRC32_UnitAcquire(CRC32_UNIT_DMA, &saved);
+    if(prev == CRC32_UNIT_BUSY)
+    {
+        DMA_Chan_Free(ch);
+        return FLASH_VERIFY_BUSY;
+    }
+    CRC_ResetDR();
+
+    for(words = Length / 4; words; words -= n, Address += 4 * n){
+        n = words < FLASH_VERIFY_DMA_MAX ? words : FLASH_VERIFY_DMA_MAX;
+        if(!flash_verify_dma(ch, Address, n))
+        {
+            status = FLASH_VERIFY_ERROR;
+            break;
+        }
+    }
+
+    *Crc = CRC_GetCRC();
+    CRC32_UnitRelease(prev, saved);
+    DMA_Chan_Free(ch);
+    return status;
+}
+
+/*********************************************************************
+ * @fn      FLASH_VerifyCRC
+ *
+ * @brief   Checks a FLASH range against a known CRC, e.g. one received
+ *          with the image. The CPU takes no part in the comparison.
+ *
+ * @param   Address - word aligned start address.
+ *          Length - bytes, a multiple of 4.
+ *          Crc - expected CRC of the range.
+ *
+ * @return  FLASH_VERIFY_OK, FLASH_VERIFY_MISMATCH, FLASH_VERIFY_ERROR or
+ *          FLASH_VERIFY_BUSY.
+ */
+FLASH_VerifyStatus FLASH_VerifyCRC(uint32_t Address, uint32_t Length, uint32_t Crc)
+{
+    FLASH_VerifyStatus status;
+    uint32_t           crc;
+
+    status = FLASH_CRC_Calc(Address, Length, &crc);
+    if(status == FLASH_VERIFY_OK && crc != Crc)
+        status = FLASH_VERIFY_MISMATCH;
+    return status;
+}
+
+/*********************************************************************
+ * @fn      FLASH_Verify
+ *
+ * @brief   Checks a FLASH range against the buffer it was programmed
+ *          from, by comparing the CRC of both.
+ *
+ * @param   Address - word aligned start address.
+ *          Source - data the range should hold.
+ *          Length - bytes, a multiple of 4.
+ *          BadPage - on FLASH_VERIFY_MISMATCH, address of the first 256B
+ *            page that differs; may be NULL.
+ *
+ * @return  FLASH_VERIFY_OK, FLASH_VERIFY_MISMATCH, FLASH_VERIFY_ERROR or
+ *          FLASH_VERIFY_BUSY.
+ */
+FLASH_VerifyStatus FLASH_Verify(uint32_t Address, const uint32_t *Source, uint32_t Length, uint32_t *BadPage)
+{
+    FLASH_VerifyStatus status;
+    CRC32_UnitOwner    prev;
+    const uint32_t    *p;
+    uint32_t           crc, src, i, saved = 0;
+
+    status = FLASH_CRC_Calc(Address, Length, &crc);
+    if(status != FLASH_VERIFY_OK || Length == 0)
+        return status;
+
+    prev = CRC32_UnitAcquire(CRC32_UNIT_CPU, &saved);
+    if(prev == CRC32_UNIT_BUSY)
+        return FLASH_VERIFY_BUSY;
+    CRC_ResetDR();
+    src = CRC_CalcBlockCRC((uint32_t *)Source, Length / 4);
+    CRC32_UnitRelease(prev, saved);
+    if(src == crc)
+        return FLASH_VERIFY_OK;
+
+    if(BadPage)
+    {
+        /* Slow path, failures only: first differing word */
+        p = (const uint32_t *)Address;
+        for(i = 0; i < Length / 4 - 1 && p[i] == Source[i]; i++);
+        *BadPage = (Address + 4 * i) & ~FLASH_VERIFY_PAGE_MASK;
+    }
+    return FLASH_VERIFY_MISMATCH;
+}
@@ -0,0 +1,39 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : flash_verify.h
+ * Author             : typetrade
+ * Version            : V1.0.0
+ * Date               : 2026/10/17
+ * Description        : Verification of programmed FLASH through the CRC unit,
+ *                      fed by DMA.
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+#ifndef __FLASH_VERIFY_H
+#define __FLASH_VERIFY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "debug.h"
+
+/* Granularity of mismatch reports */
+#define FLASH_VERIFY_PAGE_SIZE     256
+
+typedef enum
+{
+    FLASH_VERIFY_OK = 0,
+    FLASH_VERIFY_MISMATCH,      /* Contents differ */
+    FLASH_VERIFY_ERROR,         /* Unaligned range, or a DMA transfer error */
+    FLASH_VERIFY_BUSY           /* CRC unit in use by an interrupted verification,
+                                   or no free DMA channel */
+} FLASH_VerifyStatus;
+
+FLASH_VerifyStatus FLASH_CRC_Calc(uint32_t Address, uint32_t Length, uint32_t *Crc);
+FLASH_VerifyStatus FLASH_VerifyCRC(uint32_t Address, uint32_t Length, uint32_t Crc);
+FLASH_VerifyStatus FLASH_Verify(uint32_t Address, const uint32_t *Source, uint32_t Length, uint32_t *BadPage);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __FLASH_VERIFY_H */
@@ -0,0 +1,248 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : flash_write.c
+ * Author             : typetrade
+ * Version            : V1.0.0
+ * Date               : 2026/10/17
+ * Description        : Bulk FLASH write on top of the fast page and halfword
+ *                      programming modes.
+ *                      FLASH_Write splits a range into 256B fast pages:
+ *                      - whole pages are erased and programmed in fast mode,
+ *                        straight from the caller's buffer when it is word
+ *                        aligned;
+ *                      - partial pages whose target halfwords are still
+ *                        erased are programmed halfword by halfword, the
+ *                        rest of the page is left untouched;
+ *                      - other partial pages are merged with their current
+ *                        contents in one 256B staging buffer, then erased
+ *                        and programmed in fast mode.
+ *                      Page erases go through FLASH_Erase_Unit, so they
+ *                      honour the blank check of flash_erase.c.
+ *                      In delta mode (FLASH_Write_DeltaCmd) a page whose
+ *                      target bytes already equal the source is neither
+ *                      erased nor programmed. Pages are compared word by
+ *                      word with an early exit on the first difference.
+ *                      Above 100MHz keep HCLK divided by 2 while writing,
+ *                      see main.c.
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+#include <string.h>
+#include "flash_write.h"
+#include "flash_erase.h"
+
+/* FLASH Control Register bits */
+#define CR_LOCK_Set                ((uint32_t)0x00000080)
+
+/* Erased halfword, see the note in main.c */
+#define FLASH_ERASED_HALFWORD      ((uint16_t)0xE339)
+
+#define FLASH_WRITE_PAGE_MASK      ((uint32_t)(FLASH_WRITE_PAGE_SIZE - 1))
+
+/* Staging buffer: unaligned sources and read-modify-write of partial pages */
+static uint32_t flash_write_buf[FLASH_WRITE_PAGE_SIZE / 4];
+
+static uint8_t                 flash_write_delta = 0;
+static FLASH_WriteStatsTypeDef flash_write_stats;
+
+/*********************************************************************
+ * @fn      flash_write_same
+ *
+ * @brief   Checks whether Length bytes at Address already equal Data.
+ *
+ * @return  1 if equal.
+ */
+static uint8_t flash_write_same(uint32_t Address, const uint8_t *Data, uint32_t Length)
+{
+    const uint32_t *p, *q;
+
+    if(((Address | (uintptr_t)Data | Length) & 3) != 0)
+        return memcmp((const void *)Address, Data, Length) == 0;
+
+    p = (const uint32_t *)Address;
+    q = (const uint32_t *)Data;
+    for(; Length; Length -= 4){
+        if(*p++ != *q++)
+            return 0;
+    }
+    return 1;
+}
+
+/*********************************************************************
+ * @fn      flash_write_page
+ *
+ * @brief   Erases a 256B page and programs it with Data in fast mode.
+ *
+ * @param   Page_Address - page address, 256B aligned.
+ *          Data - 256 bytes, any alignment.
+ *
+ * @return  FLASH Status.
+ */
+static FLASH_Status flash_write_page(uint32_t Page_Address, const uint8_t *Data)
+{
+    FLASH_Status status;
+
+    if(((uintptr_t)Data & 3) != 0)
+    {
+        memcpy(flash_write_buf, Data, FLASH_WRITE_PAGE_SIZE);
+        Data = (const uint8_t *)flash_write_buf;
+    }
+
+    status = FLASH_Erase_Unit(FLASH_ERASE_256B, Page_Address);
+    if(status != FLASH_COMPLETE)
+        return status;
+
+    FLASH_ClearFlag(FLASH_FLAG_EOP | FLASH_FLAG_PGERR | FLASH_FLAG_WRPRTERR);
+    FLASH_ProgramPage_Fast(Page_Address, (uint32_t *)Data);
+    status = FLASH_GetBank1Status();
+    if(status == FLASH_COMPLETE && memcmp((const void *)Page_Address, Data, FLASH_WRITE_PAGE_SIZE) != 0)
+        status = FLASH_ERROR_PG;
+
+    return status;
+}
+
+/*********************************************************************
+ * @fn      flash_write_blank
+ *
+ * @brief   Checks that Length bytes at Address, both even, read erased.
+ *
+ * @return  1 if every halfword is erased.
+ */
+static uint8_t flash_write_blank(uint32_t Address, uint32_t Length)
+{
+    const uint16_t *p = (const uint16_t *)Address;
+
+    for(; Length; Length -= 2){
+        if(*p++ != FLASH_ERASED_HALFWORD)
+            return 0;
+    }
+    return 1;
+}
+
+/*********************************************************************
+ * @fn      flash_write_halfwords
+ *
+ * @brief   Programs Length bytes, both Address and Length even, halfword
+ *          by halfword into erased flash.
+ *
+ * @return  FLASH Status.
+ */
+static FLASH_Status flash_write_halfwords(uint32_t Address, const uint8_t *Data, uint32_t Length)
+{
+    FLASH_Status status = FLASH_COMPLETE;
+
+    for(; Length && status == FLASH_COMPLETE; Length -= 2){
+        status = FLASH_ProgramHalfWord(Address, (uint16_t)(Data[0] | (Data[1] << 8)));
+        if(status == FLASH_COMPLETE && *(__IO uint16_t *)Address != (uint16_t)(Data[0] | (Data[1] << 8)))
+            status = FLASH_ERROR_PG;
+        Address += 2;
+        Data += 2;
+    }
+
+    return status;
+}
+
+/*********************************************************************
+ * @fn      FLASH_Write
+ *
+ * @brief   Writes Length bytes at any Address, preserving the rest of the
+ *          256B pages it touches. Unlocks fast mode itself and locks the
+ *          controller again if it was locked on entry.
+ *
+ * @param   Address - destination in the main array.
+ *          Buffer - source data, any alignment, not in the range written.
+ *          Length - bytes to write.
+ *
+ * @return  FLASH_COMPLETE, or the status of the first failing page
+ *          (FLASH_ERROR_PG also when a page does not read back).
+ */
+FLASH_Status FLASH_Write(uint32_t Address, const void *Buffer, uint32_t Length)
+{
+    const uint8_t *src = (const uint8_t *)Buffer;
+    FLASH_Status   status = FLASH_COMPLETE;
+    uint32_t       page, offset, n;
+    uint8_t        locked;
+
+    if(Length == 0)
+        return FLASH_COMPLETE;
+
+    locked = (FLASH->CTLR & CR_LOCK_Set) != 0;
+    FLASH_Unlock_Fast();
+
+    while(Length && status == FLASH_COMPLETE)
+    {
+        page = Address & ~FLASH_WRITE_PAGE_MASK;
+        offset = Address & FLASH_WRITE_PAGE_MASK;
+        n = FLASH_WRITE_PAGE_SIZE - offset;
+        if(n > Length)
+            n = Length;
+
+        if(flash_write_delta && flash_write_same(Address, src, n))
+        {
+            flash_write_stats.PagesSkipped++;
+            flash_write_stats.SavedTime_us += FLASH_Erase_OpTime(FLASH_ERASE_256B) + FLASH_WRITE_PAGE_TIME_US;
+        }
+        else if(n == FLASH_WRITE_PAGE_SIZE)
+        {
+            status = flash_write_page(page, src);
+            flash_write_stats.PagesWritten++;
+        }
+        else if(((Address | n) & 1) == 0 && flash_write_blank(Address, n))
+        {
+            status = flash_write_halfwords(Address, src, n);
+            flash_write_stats.PagesWritten++;
+        }
+        else
+        {
+            memcpy(flash_write_buf, (const void *)page, FLASH_WRITE_PAGE_SIZE);
+            memcpy((uint8_t *)flash_write_buf + offset, src, n);
+            status = flash_write_page(page, (const uint8_t *)flash_write_buf);
+            flash_write_stats.PagesWritten++;
+        }
+
+        Address += n;
+        src += n;
+        Length -= n;
+    }
+
+    if(locked)
+        FLASH_Lock_Fast();
+
+    return status;
+}
+
+/*********************************************************************
+ * @fn      FLASH_Write_DeltaCmd
+ *
+ * @brief   Enables or disables skipping pages that already hold the data.
+ *
+ * @param   NewState - ENABLE or DISABLE (default).
+ *
+ * @return  none
+ */
+void FLASH_Write_DeltaCmd(FunctionalState NewState)
+{
+    flash_write_delta = (NewState != DISABLE);
+}
+
+/*********************************************************************
+ * @fn      FLASH_Write_GetStats
+ *
+ * @brief   Copies the write counters.
+ *
+ * @return  none
+ */
+void FLASH_Write_GetStats(FLASH_WriteStatsTypeDef *Stats)
+{
+    *Stats = flash_write_stats;
+}
+
+/*********************************************************************
+ * @fn      FLASH_Write_ClearStats
+ *
+ * @brief   Clears the write counters.
+ *
+ * @return  none
+ */
+void FLASH_Write_ClearStats(void)
+{
+    memset(&flash_write_stats, 0, sizeof(flash_write_stats));
+}
@@ -0,0 +1,42 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : flash_write.h
+ * Author             : typetrade
+ * Version            : V1.0.0
+ * Date               : 2026/10/17
+ * Description        : Bulk FLASH write on top of the fast page and halfword
+ *                      programming modes.
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+#ifndef __FLASH_WRITE_H
+#define __FLASH_WRITE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "debug.h"
+
+/* Fast mode page size */
+#define FLASH_WRITE_PAGE_SIZE      256
+
+/* Nominal fast page program time in us, used for the time saved estimate */
+#define FLASH_WRITE_PAGE_TIME_US   1200
+
+/* Write counters */
+typedef struct
+{
+    uint32_t PagesWritten;   /* Pages (or partial pages) programmed */
+    uint32_t PagesSkipped;   /* Pages left alone by delta mode, already equal */
+    uint32_t SavedTime_us;   /* Erase + program time of the skipped pages */
+} FLASH_WriteStatsTypeDef;
+
+FLASH_Status FLASH_Write(uint32_t Address, const void *Buffer, uint32_t Length);
+void         FLASH_Write_DeltaCmd(FunctionalState NewState);
+void         FLASH_Write_GetStats(FLASH_WriteStatsTypeDef *Stats);
+void         FLASH_Write_ClearStats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __FLASH_WRITE_H */
@@ -27,6 +27,13 @@
 */
 
 #include "debug.h"
+#include "binlog.h"
+#include "hexdump.h"
+#include "flash_bench.h"
+#include "flash_service.h"
+#include "flash_session.h"
+#include "flash_verify.h"
+#include "profile.h"
 
 /* Global define */
 typedef enum {FAILED = 0, PASSED = !FAILED} TestStatus;
@@ -40,6 +47,14 @@ typedef enum {FAILED = 0, PASSED = !FAILED} TestStatus;
 #define FAST_FLASH_PROGRAM_END_ADDR  ((uint32_t)0x08010000)
 #define FAST_FLASH_SIZE  (64*1024)
 
+/* Uncomment to print the flash throughput benchmark (CSV) after the tests */
+//#define FLASH_BENCH
+
+/* Uncomment to take flash programming requests on USART2 after the tests
+ * (flash_service.h, HOST/FlashProg), until one reboots the chip */
+//#define FLASH_SERVICE
+#define FLASH_SERVICE_BAUD     2000000
+
 /* Global Variable */
 uint32_t EraseCounter = 0x0;  //  记录要擦除多少页
 uint32_t Address = 0x0;       //  记录写入的地址
@@ -67,11 +82,9 @@ volatile TestStatus MemoryEraseStatus = PASSED;
  */
 TestStatus Flash_Test(void)
 {
-    printf("FLASH Test\n");
+    LOG("FLASH Test\n");
 
-    RCC->CFGR0 |= (uint32_t)RCC_HPRE_DIV2;  //  将系统时钟的主频分频为2
-    Delay_Init();
-    USART_Printf_Init(115200);
+    FLASH_Session_Enter();  //  主频超过100MHz时将HCLK分频为2
     __disable_irq();
 
     // 解除闪存锁
@@ -92,13 +105,13 @@ TestStatus Flash_Test(void)
 
       if(FLASHStatus != FLASH_COMPLETE)
       {
-        printf("FLASH Erase Fail\r\n");
+        LOG("FLASH Erase Fail\r\n");
       }
-      printf("FLASH Erase Suc\r\n");
+      LOG("FLASH Erase Suc\r\n");
     }
 
     Address = PAGE_WRITE_START_ADDR;  //  向内部FLASH写入数据起始地址
-    printf("Programing...\r\n");
+    LOG("Programing...\r\n");
     while((Address < PAGE_WRITE_END_ADDR) && (FLASHStatus == FLASH_COMPLETE))
     {
       FLASHStatus = FLASH_ProgramHalfWord(Address, Data); //  向指定地址写入半字
@@ -107,7 +120,7 @@ TestStatus Flash_Test(void)
 
     Address = PAGE_WRITE_START_ADDR;
 
-    printf("Program Cheking...\r\n");
+    LOG("Program Cheking...\r\n");
     while((Address < PAGE_WRITE_END_ADDR) && (MemoryProgramStatus != FAILED))
     {
       if((*(__IO uint16_t*) Address) != Data)
@@ -119,19 +132,17 @@ TestStatus Flash_Test(void)
 
     if(MemoryProgramStatus == FAILED)
     {
-       printf("Memory Program FAIL!\r\n");
+       LOG("Memory Program FAIL!\r\n");
     }
     else
     {
-       printf("Memory Program PASS!\r\n");
+       LOG("Memory Program PASS!\r\n");
     }
 
     // 上锁
     FLASH_Lock();
 
-    RCC->CFGR0 &= ~(uint32_t)RCC_HPRE_DIV2;
-    Delay_Init();
-    USART_Printf_Init(115200);
+    FLASH_Session_Exit();
     __enable_irq();
     return MemoryProgramStatus;
 }
@@ -152,18 +163,17 @@ TestStatus Flash_Test(void)
  */
 u16 Flash_Test_Fast(void)
 {
-	u16 i,j,flag;
+	u16 i,flag;
+  u32 bad = 0;
   u32 buf[64];
 
     for(i=0; i<64; i++){
         buf[i] = i;
     }
 
-    printf("FLASH Fast Mode Test\n");
+    LOG("FLASH Fast Mode Test\n");
 
-    RCC->CFGR0 |= (uint32_t)RCC_HPRE_DIV2;
-    Delay_Init();
-    USART_Printf_Init(115200);
+    FLASH_Session_Enter();
     __disable_irq();
 
   // 快速编程模式解锁
@@ -178,65 +188,50 @@ u16 Flash_Test_Fast(void)
   // FLASH_BufLoad(0x0800E000, buf[0], buf[1], buf[2], buf[3]); //向指定地址开始连续写入16字节数据（4字节/次操作，写的地址每次偏移量为4），然后执行加载到缓冲区
   // FLASH_BufLoad(0x0800E000 + 0x10, buf[4], buf[5], buf[6], buf[7]);
 
-    printf("Program 32KByte start\n");
+    LOG("Program 32KByte start\n");
     for(i=0; i<128; i++){
         // 擦除指定闪存页，此处擦除指定地址所指定页
         FLASH_ProgramPage_Fast(FAST_FLASH_PROGRAM_START_ADDR + 256*i, buf);
     }
 
-	for(i=0; i<128; i++){ // 读编程地址数据校验
-	    for(j=0; j<64; j++){
-	        if(*(u32*)(FAST_FLASH_PROGRAM_START_ADDR+256*i+4*j) != j){
-	            flag = 0;
-	            break;
-	        }
-	        else{
-	            flag = 1;
-	        }
-	    }
-
-	}
+    // 读编程地址数据校验：DMA 将每页送入 CRC 单元，与 buf 的 CRC 比较
+    flag = 1;
+    for(i=0; i<128 && flag; i++){
+        if(FLASH_Verify(FAST_FLASH_PROGRAM_START_ADDR + 256*i, buf, 256, &bad) != FLASH_VERIFY_OK){
+            LOG("Verify fail at page 0x%08lx\n", (unsigned long)bad);
+            flag = 0;
+        }
+    }
 
 	if(flag){
-    printf("Program 32KByte suc\n");
+    LOG("Program 32KByte suc\n");
 	}
-	else printf("Program fail\n");
+	else LOG("Program fail\n");
 
-	printf("Erase 256Byte...\n");
+	LOG("Erase 256Byte...\n");
 	FLASH_ErasePage_Fast(FAST_FLASH_PROGRAM_START_ADDR);
 
-	printf("Read 4KByte...\n");
-	for(i=0;i<1024; i++){
-      printf("%08x ",*(u32*)(FAST_FLASH_PROGRAM_START_ADDR+4*i));
-
-	}printf("\n");
+	LOG("Read 4KByte...\n");
+	HexDump_Words(FAST_FLASH_PROGRAM_START_ADDR, 1024, HEXDUMP_ADDR | HEXDUMP_RLE);
 
-    printf("Erase 4KByte...\n");
+    LOG("Erase 4KByte...\n");
     // 擦除单个FLASH页面
     // @pa
     FLASH_ErasePage(FAST_FLASH_PROGRAM_START_ADDR);
 
-    printf("Read 8KByte...\n");
-    for(i=0;i<2048; i++){
-      printf("%08x ",*(u32*)(FAST_FLASH_PROGRAM_START_ADDR+4*i));
-
-    }printf("\n");
+    LOG("Read 8KByte...\n");
+    HexDump_Words(FAST_FLASH_PROGRAM_START_ADDR, 2048, HEXDUMP_ADDR | HEXDUMP_RLE);
 
-    printf("Erase 32KByte...\n");
+    LOG("Erase 32KByte...\n");
     FLASH_EraseBlock_32K_Fast(FAST_FLASH_PROGRAM_START_ADDR);
 
-    printf("Read 32KByte...\n");
-    for(i=0;i<(1024*9); i++){
-      printf("%08x ",*(u32*)(FAST_FLASH_PROGRAM_START_ADDR+4*i));
-
-    }printf("\n");
+    LOG("Read 32KByte...\n");
+    HexDump_Words(FAST_FLASH_PROGRAM_START_ADDR, 1024*9, HEXDUMP_ADDR | HEXDUMP_RLE);
 
 
     FLASH_Lock_Fast();
 
-    RCC->CFGR0 &= ~(uint32_t)RCC_HPRE_DIV2;
-    Delay_Init();
-    USART_Printf_Init(115200);
+    FLASH_Session_Exit();
     __enable_irq();
 
     return flag;
@@ -254,28 +249,48 @@ int main(void)
 	NVIC_PriorityGroupConfig(NVIC_PriorityGroup_2);
 	Delay_Init();
 	USART_Printf_Init(115200);
-	printf("SystemClk:%d\r\n",SystemCoreClock);
+	LOG("SystemClk:%d\r\n",SystemCoreClock);
 
-	printf("Flash Program Test\r\n");
+	LOG("Flash Program Test\r\n");
 
     // 判断内部 FLASH 标准编程测试结果
     if(Flash_Test() == PASSED)
     {
-        printf("读写内部 FLASH 标准编程测试成功\r\n");
+        LOG("读写内部 FLASH 标准编程测试成功\r\n");
     }
     else
     {
-        printf("读写内部 FLASH 标准编程测试失败\r\n");
+        LOG("读写内部 FLASH 标准编程测试失败\r\n");
     }
 
     if(Flash_Test_Fast())
     {
-        printf("读写内部 FLASH 快速编程测试成功\r\n");
+        LOG("读写内部 FLASH 快速编程测试成功\r\n");
     }
     else
     {
-        printf("读写内部 FLASH 快速编程测试失败\r\n");
+        LOG("读写内部 FLASH 快速编程测试失败\r\n");
+    }
+
+#ifdef FLASH_BENCH
+    Flash_Bench_Run();
+#endif
+
+    /* Per-function counters (CSV), empty unless built with PROF_ENABLE */
+    PROF_Dump();
+
+#ifdef FLASH_SERVICE
+    /* The session holds HCLK, and so the baud rate, while the service runs */
+    FLASH_Session_Enter();
+    if(FLASH_Service_Init(FLASH_SERVICE_BAUD) == SUCCESS)
+    {
+        while(!FLASH_Service_Poll())
+            ;
+        Delay_Ms(1);
+        NVIC_SystemReset();
     }
+    FLASH_Session_Exit();
+#endif
 
 	while(1);
 }
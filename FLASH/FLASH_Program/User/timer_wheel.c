@@ -0,0 +1,176 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : timer_wheel.c
+ * Author             : typetrade
+ * Version            : V1.0.0
+ * Date               : 2026/10/17
+ * Description        : Software timers on the SysTick timebase (timebase.h),
+ *                      kept in a wheel of TIMER_WHEEL_SLOTS lists indexed
+ *                      by the tick they are due at. Timer_Poll, called
+ *                      from the main loop, visits only the slots of the
+ *                      ticks that passed since the previous call (all of
+ *                      them once after a long gap) and runs the callbacks
+ *                      of the timers that are due, in the caller's context:
+ *                      callbacks may start flash operations and start or
+ *                      stop any timer, themselves included. A timer fires
+ *                      no earlier than its delay, and later by the polling
+ *                      interval. Periodic timers keep their phase; periods
+ *                      missed while the main loop was busy are skipped.
+ *                      Not for use from interrupt handlers.
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+#include "timer_wheel.h"
+#include "timebase.h"
+
+#define TIMER_WHEEL_MASK           ((uint32_t)(TIMER_WHEEL_SLOTS - 1))
+
+static TIMER_TypeDef *tw_slot[TIMER_WHEEL_SLOTS];
+static uint32_t       tw_last = 0;  /* Last tick Timer_Poll handled */
+
+/*********************************************************************
+ * @fn      tw_now
+ *
+ * @brief   Current tick.
+ *
+ * @return  Ticks of TIMER_TICK_US.
+ */
+static uint32_t tw_now(void)
+{
+    return (uint32_t)(now_us() / TIMER_TICK_US);
+}
+
+/*********************************************************************
+ * @fn      tw_insert
+ *
+ * @brief   Puts Timer in the slot of its Expire tick.
+ *
+ * @return  none
+ */
+static void tw_insert(TIMER_TypeDef *Timer)
+{
+    TIMER_TypeDef **head = &tw_slot[Timer->Expire & TIMER_WHEEL_MASK];
+
+    Timer->Next = *head;
+    if(*head)
+        (*head)->Link = &Timer->Next;
+    *head = Timer;
+    Timer->Link = head;
+}
+
+/*********************************************************************
+ * @fn      tw_unlink
+ *
+ * @brief   Takes Timer out of the list it is in.
+ *
+ * @return  none
+ */
+static void tw_unlink(TIMER_TypeDef *Timer)
+{
+    *Timer->Link = Timer->Next;
+    if(Timer->Next)
+        Timer->Next->Link = Timer->Link;
+    Timer->Next = NULL;
+    Timer->Link = NULL;
+}
+
+/*********************************************************************
+ * @fn      Timer_Start
+ *
+ * @brief   (Re)starts a timer.
+ *
+ * @param   Timer - timer, restarted if it is active.
+ *          Delay_ms - time to the first expiry.
+ *          Period_ms - time between later expiries, 0 for one shot.
+ *          Callback - called by Timer_Poll on expiry.
+ *          Arg - passed to Callback.
+ *
+ * @return  none
+ */
+void Timer_Start(TIMER_TypeDef *Timer, uint32_t Delay_ms, uint32_t Period_ms,
+                 TIMER_CallbackTypeDef Callback, void *Arg)
+{
+    uint64_t due_us = now_us() + (uint64_t)Delay_ms * 1000;
+    uint32_t expire = (uint32_t)((due_us + TIMER_TICK_US - 1) / TIMER_TICK_US);
+
+    if(Timer_Active(Timer))
+        tw_unlink(Timer);
+
+    /* Ticks up to tw_last are behind Timer_Poll already */
+    if((int32_t)(expire - tw_last) <= 0)
+        expire = tw_last + 1;
+
+    Timer->Expire = expire;
+    Timer->Period = (uint32_t)(((uint64_t)Period_ms * 1000 + TIMER_TICK_US - 1) / TIMER_TICK_US);
+    Timer->Callback = Callback;
+    Timer->Arg = Arg;
+    tw_insert(Timer);
+}
+
+/*********************************************************************
+ * @fn      Timer_Stop
+ *
+ * @brief   Stops a timer, nothing if it is not active.
+ *
+ * @return  none
+ */
+void Timer_Stop(TIMER_TypeDef *Timer)
+{
+    if(Timer_Active(Timer))
+        tw_unlink(Timer);
+}
+
+/*********************************************************************
+ * @fn      Timer_Active
+ *
+ * @brief   Checks whether a timer is waiting to expire.
+ *
+ * @return  1 if it is.
+ */
+uint8_t Timer_Active(const TIMER_TypeDef *Timer)
+{
+    return Timer->Link != NULL;
+}
+
+/*********************************************************************
+ * @fn      Timer_Poll
+ *
+ * @brief   Runs the callbacks of the timers that are due.
+ *
+ * @return  none
+ */
+void Timer_Poll(void)
+{
+    TIMER_TypeDef *list, *t;
+    uint32_t       now = tw_now(), last = tw_last, n, i;
+
+    n = now - last;
+    if(n > TIMER_WHEEL_SLOTS)
+        n = TIMER_WHEEL_SLOTS;
+    /* Timers started by the callbacks are due after now */
+    tw_last = now;
+
+    for(i = 1; i <= n; i++){
+        /* Detach the slot: timers put back or restarted go to the new list */
+        list = tw_slot[(last + i) & TIMER_WHEEL_MASK];
+        tw_slot[(last + i) & TIMER_WHEEL_MASK] = NULL;
+        if(list)
+            list->Link = &list;
+
+        while((t = list) != NULL)
+        {
+            tw_unlink(t);
+            if((int32_t)(t->Expire - now) > 0)
+            {
+                tw_insert(t);
+                continue;
+            }
+            if(t->Period)
+            {
+                t->Expire += t->Period;
+                if((int32_t)(t->Expire - now) <= 0)
+                    t->Expire = now + t->Period - (now - t->Expire) % t->Period;
+                tw_insert(t);
+            }
+            t->Callback(t, t->Arg);
+        }
+    }
+}
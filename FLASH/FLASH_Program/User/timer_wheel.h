@@ -0,0 +1,54 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : timer_wheel.h
+ * Author             : typetrade
+ * Version            : V1.0.0
+ * Date               : 2026/10/17
+ * Description        : Software timers on the SysTick timebase.
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+#ifndef __TIMER_WHEEL_H
+#define __TIMER_WHEEL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Timer resolution */
+#ifndef TIMER_TICK_US
+#define TIMER_TICK_US              1000
+#endif
+
+/* Wheel slots, power of 2. Timers due further out wait in their slot. */
+#ifndef TIMER_WHEEL_SLOTS
+#define TIMER_WHEEL_SLOTS          32
+#endif
+
+struct TIMER_Struct;
+typedef void (*TIMER_CallbackTypeDef)(struct TIMER_Struct *Timer, void *Arg);
+
+/* One timer, owned by the caller and zero-initialized before first use.
+ * Fields are private to timer_wheel.c. */
+typedef struct TIMER_Struct
+{
+    struct TIMER_Struct  *Next;
+    struct TIMER_Struct **Link;      /* Pointer that points at this timer */
+    uint32_t              Expire;    /* Tick it is due at */
+    uint32_t              Period;    /* Ticks, 0 for a one-shot timer */
+    TIMER_CallbackTypeDef Callback;
+    void                 *Arg;
+} TIMER_TypeDef;
+
+void    Timer_Start(TIMER_TypeDef *Timer, uint32_t Delay_ms, uint32_t Period_ms,
+                    TIMER_CallbackTypeDef Callback, void *Arg);
+void    Timer_Stop(TIMER_TypeDef *Timer);
+uint8_t Timer_Active(const TIMER_TypeDef *Timer);
+void    Timer_Poll(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TIMER_WHEEL_H */
@@ -0,0 +1,409 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : uart_rx.c
+ * Author             : typetrade
+ * Version            : V1.0.0
+ * Date               : 2026/10/17
+ * Description        : USART reception by circular DMA into a ring buffer.
+ *                      The RX DMA channel (from dma_chan.h) writes the
+ *                      ring round and round without the CPU; the write
+ *                      position, Size - CNTR, is published to the reader
+ *                      by the half and full ring interrupts, by the USART
+ *                      IDLE interrupt one frame after a burst ends, and by
+ *                      the reader itself on each call. The reader gets
+ *                      contiguous spans of the ring (UART_Rx_Peek) and
+ *                      releases them when done (UART_Rx_Consume): nothing
+ *                      is copied.
+ *                      At 4 Mbaud a byte arrives every 2.5us (360 cycles
+ *                      at 144MHz); with a 1K ring that is one interrupt
+ *                      per 512 bytes plus one per burst, the CPU is free
+ *                      otherwise.
+ *                      Nothing stops the DMA when the reader falls behind:
+ *                      Peek finds out it was lapped and skips to the
+ *                      oldest bytes still in the ring, Consume reports
+ *                      spans overwritten while they were held; both count
+ *                      in the statistics. A USART overrun (ORE) means the
+ *                      DMA did not take a byte within a frame time.
+ *                      UART_Tx_Write sends on the same USART by polling
+ *                      TXE, for short replies to what was received.
+ *                      Built with SIM_HOST the handlers are driven by the
+ *                      host USART and DMA models (HOST/UartRx).
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+#include <string.h>
+#include "uart_rx.h"
+#include "dma_chan.h"
+
+#ifdef SIM_HOST
+#include "sim_periph.h"
+#endif
+
+#if(UART_RX_BUF_SIZE & (UART_RX_BUF_SIZE - 1)) || UART_RX_BUF_SIZE < 4 || UART_RX_BUF_SIZE > 32768
+#error "UART_RX_BUF_SIZE must be a power of 2, 4 to 32768"
+#endif
+
+#if(UART_RX_PORT == 1)
+#define UART_RX_USART              USART1
+#define UART_RX_REQ                DMA_REQ_USART1_RX
+#define UART_RX_IRQn               USART1_IRQn
+#define UART_RX_IRQHandler         USART1_IRQHandler
+#define UART_RX_GPIO               GPIOA
+#define UART_RX_PIN                GPIO_Pin_10
+#define UART_TX_PIN                GPIO_Pin_9
+#elif(UART_RX_PORT == 2)
+#define UART_RX_USART              USART2
+#define UART_RX_REQ                DMA_REQ_USART2_RX
+#define UART_RX_IRQn               USART2_IRQn
+#define UART_RX_IRQHandler         USART2_IRQHandler
+#define UART_RX_GPIO               GPIOA
+#define UART_RX_PIN                GPIO_Pin_3
+#define UART_TX_PIN                GPIO_Pin_2
+#elif(UART_RX_PORT == 3)
+#define UART_RX_USART              USART3
+#define UART_RX_REQ                DMA_REQ_USART3_RX
+#define UART_RX_IRQn               USART3_IRQn
+#define UART_RX_IRQHandler         USART3_IRQHandler
+#define UART_RX_GPIO               GPIOB
+#define UART_RX_PIN                GPIO_Pin_11
+#define UART_TX_PIN                GPIO_Pin_10
+#else
+#error "UART_RX_PORT must be 1, 2 or 3"
+#endif
+
+#define UART_RX_MASK               ((uint32_t)(UART_RX_BUF_SIZE - 1))
+
+/* Flags a STATR then DATAR read clears */
+#define UART_RX_LINE_ERRORS        (USART_FLAG_PE | USART_FLAG_FE | USART_FLAG_NE)
+
+#define UART_RX_CFGR               (DMA_Mode_Circular | DMA_MemoryInc_Enable | DMA_PeripheralDataSize_Byte | \
+                                    DMA_MemoryDataSize_Byte | DMA_DIR_PeripheralSRC | DMA_Priority_VeryHigh | \
+                                    DMA_IT_HT | DMA_IT_TC | DMA_IT_TE | DMA_CFGR1_EN)
+
+#ifdef SIM_HOST
+#define UART_RX_ISR
+#else
+#define UART_RX_ISR                __attribute__((interrupt("WCH-Interrupt-fast")))
+#endif
+
+void UART_RX_IRQHandler(void) UART_RX_ISR;
+
+/* Ring: the DMA writes at uart_rx_pos, uart_rx_head counts the bytes
+ * published, uart_rx_tail the bytes consumed. */
+static uint8_t             uart_rx_buf[UART_RX_BUF_SIZE];
+static volatile uint32_t   uart_rx_head = 0;
+static uint32_t            uart_rx_tail = 0;
+static volatile uint32_t   uart_rx_pos = 0;
+static uint8_t             uart_rx_ch = 0;
+static UART_RxNotify       uart_rx_notify;
+static void               *uart_rx_context;
+static UART_RxStatsTypeDef uart_rx_stats;
+
+/*********************************************************************
+ * @fn      uart_rx_advance
+ *
+ * @brief   Publishes what the DMA wrote since the last call. Interrupts
+ *          off, or from the handlers.
+ *
+ * @return  Bytes published.
+ */
+static uint32_t uart_rx_advance(void)
+{
+    uint32_t pos = (UART_RX_BUF_SIZE - DMA_Chan_Regs(uart_rx_ch)->CNTR) & UART_RX_MASK;
+    uint32_t n = (pos - uart_rx_pos) & UART_RX_MASK;
+
+    uart_rx_pos = pos;
+    uart_rx_head += n;
+    return n;
+}
+
+/*********************************************************************
+ * @fn      uart_rx_publish
+ *
+ * @brief   Publishes new bytes from a handler and tells the reader.
+ *
+ * @return  none
+ */
+static void uart_rx_publish(void)
+{
+    uart_rx_stats.Irqs++;
+    if(uart_rx_advance() && uart_rx_notify)
+        uart_rx_notify(uart_rx_context);
+}
+
+/*********************************************************************
+ * @fn      uart_rx_dma_irq
+ *
+ * @brief   RX channel handler: half or full ring, or a transfer error.
+ *
+ * @return  none
+ */
+static void uart_rx_dma_irq(void *Context, uint32_t Flags)
+{
+    if(Flags & DMA_CHAN_TE)
+        uart_rx_stats.DmaErrors++;
+    uart_rx_publish();
+}
+
+/*********************************************************************
+ * @fn      UART_RX_IRQHandler
+ *
+ * @brief   This function handles the USART interrupt: line idle after
+ *          a burst, and receive errors.
+ *
+ * @return  none
+ */
+void UART_RX_IRQHandler(void)
+{
+    uint32_t statr = UART_RX_USART->STATR;
+
+    /* A DATAR read ends the clearing sequence; with a byte waiting the
+     * DMA read of it does, the byte stays the DMA's, unless the channel
+     * stopped (transfer error) and nothing else would take it. */
+    if(!(statr & USART_FLAG_RXNE) || !(DMA_Chan_Regs(uart_rx_ch)->CFGR & DMA_CFGR1_EN))
+        (void)UART_RX_USART->DATAR;
+    if(statr & USART_FLAG_ORE)
+        uart_rx_stats.HwOverruns++;
+    if(statr & UART_RX_LINE_ERRORS)
+        uart_rx_stats.LineErrors++;
+    uart_rx_publish();
+}
+
+/*********************************************************************
+ * @fn      uart_rx_resync
+ *
+ * @brief   Moves the reader past the bytes the DMA overwrote.
+ *
+ * @return  Bytes available.
+ */
+static uint32_t uart_rx_resync(void)
+{
+    uint32_t irq, n;
+
+    irq = __irq_save();
+    uart_rx_advance();
+    n = uart_rx_head - uart_rx_tail;
+    __irq_restore(irq);
+
+    if(n > UART_RX_BUF_SIZE)
+    {
+        uart_rx_stats.Overruns++;
+        uart_rx_stats.Lost += n - UART_RX_BUF_SIZE;
+        uart_rx_tail += n - UART_RX_BUF_SIZE;
+        n = UART_RX_BUF_SIZE;
+    }
+    return n;
+}
+
+/*********************************************************************
+ * @fn      UART_Rx_Init
+ *
+ * @brief   Sets up the USART of UART_RX_PORT for 8N1 reception, and
+ *          transmission for UART_Tx_Write (TX pin in alternate function
+ *          push-pull), and starts the RX DMA into the ring.
+ *
+ * @param   Baudrate - USART communication baud rate.
+ *          Notify - called from the interrupts with new bytes, may be
+ *                   NULL to poll.
+ *          Context - passed to Notify.
+ *
+ * @return  SUCCESS, or ERROR if the RX DMA channel is held elsewhere.
+ */
+ErrorStatus UART_Rx_Init(uint32_t Baudrate, UART_RxNotify Notify, void *Context)
+{
+    GPIO_InitTypeDef     GPIO_InitStructure;
+    USART_InitTypeDef    USART_InitStructure;
+    DMA_Channel_TypeDef *ch;
+
+    UART_Rx_DeInit();
+    uart_rx_ch = DMA_Chan_Alloc(UART_RX_REQ, uart_rx_dma_irq, NULL);
+    if(uart_rx_ch == 0)
+        return ERROR;
+
+#if(UART_RX_PORT == 1)
+    RCC_APB2PeriphClockCmd(RCC_APB2Periph_USART1 | RCC_APB2Periph_GPIOA, ENABLE);
+#elif(UART_RX_PORT == 2)
+    RCC_APB1PeriphClockCmd(RCC_APB1Periph_USART2, ENABLE);
+    RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOA, ENABLE);
+#else
+    RCC_APB1PeriphClockCmd(RCC_APB1Periph_USART3, ENABLE);
+    RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOB, ENABLE);
+#endif
+    GPIO_InitStructure.GPIO_Pin = UART_RX_PIN;
+    GPIO_InitStructure.GPIO_Speed = GPIO_Speed_50MHz;
+    GPIO_InitStructure.GPIO_Mode = GPIO_Mode_IN_FLOATING;
+    GPIO_Init(UART_RX_GPIO, &GPIO_InitStructure);
+    GPIO_InitStructure.GPIO_Pin = UART_TX_PIN;
+    GPIO_InitStructure.GPIO_Mode = GPIO_Mode_AF_PP;
+    GPIO_Init(UART_RX_GPIO, &GPIO_InitStructure);
+
+    USART_InitStructure.USART_BaudRate = Baudrate;
+    USART_InitStructure.USART_WordLength = USART_WordLength_8b;
+    USART_InitStructure.USART_StopBits = USART_StopBits_1;
+    USART_InitStructure.USART_Parity = USART_Parity_No;
+    USART_InitStructure.USART_HardwareFlowControl = USART_HardwareFlowControl_None;
+    USART_InitStructure.USART_Mode = USART_Mode_Rx | USART_Mode_Tx;
+    USART_Init(UART_RX_USART, &USART_InitStructure);
+
+    uart_rx_head = 0;
+    uart_rx_tail = 0;
+    uart_rx_pos = 0;
+    uart_rx_notify = Notify;
+    uart_rx_context = Context;
+    memset(&uart_rx_stats, 0, sizeof(uart_rx_stats));
+
+    ch = DMA_Chan_Regs(uart_rx_ch);
+    ch->PADDR = (uint32_t)&UART_RX_USART->DATAR;
+    ch->MADDR = (uint32_t)uart_rx_buf;
+    ch->CNTR = UART_RX_BUF_SIZE;
+    ch->CFGR = UART_RX_CFGR;
+
+    USART_DMACmd(UART_RX_USART, USART_DMAReq_Rx, ENABLE);
+    UART_RX_USART->CTLR3 |= USART_CTLR3_EIE;
+    USART_ITConfig(UART_RX_USART, USART_IT_IDLE, ENABLE);
+    USART_Cmd(UART_RX_USART, ENABLE);
+#ifdef SIM_HOST
+    SIM_USART_SetIRQHandler(UART_RX_PORT, UART_RX_IRQHandler);
+#else
+    NVIC_EnableIRQ(UART_RX_IRQn);
+#endif
+
+    return SUCCESS;
+}
+
+/*********************************************************************
+ * @fn      UART_Rx_DeInit
+ *
+ * @brief   Stops reception and gives the DMA channel back. The USART
+ *          stays enabled for transmission.
+ *
+ * @return  none
+ */
+void UART_Rx_DeInit(void)
+{
+    if(uart_rx_ch == 0)
+        return;
+
+#ifdef SIM_HOST
+    SIM_USART_SetIRQHandler(UART_RX_PORT, NULL);
+#else
+    NVIC_DisableIRQ(UART_RX_IRQn);
+#endif
+    USART_ITConfig(UART_RX_USART, USART_IT_IDLE, DISABLE);
+    UART_RX_USART->CTLR3 &= ~USART_CTLR3_EIE;
+    USART_DMACmd(UART_RX_USART, USART_DMAReq_Rx, DISABLE);
+    DMA_Chan_Free(uart_rx_ch);
+    uart_rx_ch = 0;
+}
+
+/*********************************************************************
+ * @fn      UART_Rx_Available
+ *
+ * @brief   Bytes received and not consumed, up to the ring size.
+ *
+ * @return  Byte count.
+ */
+uint32_t UART_Rx_Available(void)
+{
+    if(uart_rx_ch == 0)
+        return 0;
+    return uart_rx_resync();
+}
+
+/*********************************************************************
+ * @fn      UART_Rx_Peek
+ *
+ * @brief   The oldest bytes not consumed, in place in the ring: up to
+ *          its end, the rest comes with the next call. Main loop only.
+ *
+ * @param   Data - start of the span.
+ *
+ * @return  Span length, 0 if nothing is waiting.
+ */
+uint32_t UART_Rx_Peek(const uint8_t **Data)
+{
+    uint32_t n, offset;
+
+    if(uart_rx_ch == 0)
+        return 0;
+
+    n = uart_rx_resync();
+    offset = uart_rx_tail & UART_RX_MASK;
+    if(n > UART_RX_BUF_SIZE - offset)
+        n = UART_RX_BUF_SIZE - offset;
+    *Data = &uart_rx_buf[offset];
+    return n;
+}
+
+/*********************************************************************
+ * @fn      UART_Rx_Consume
+ *
+ * @brief   Releases the first Length bytes of what UART_Rx_Peek showed.
+ *
+ * @param   Length - bytes, at most what is available.
+ *
+ * @return  SUCCESS, or ERROR if the DMA overwrote some of them before
+ *          this call: what was read from the span is not reliable.
+ */
+ErrorStatus UART_Rx_Consume(uint32_t Length)
+{
+    uint32_t irq, n, over;
+
+    if(uart_rx_ch == 0)
+        return ERROR;
+
+    irq = __irq_save();
+    uart_rx_advance();
+    n = uart_rx_head - uart_rx_tail;
+    __irq_restore(irq);
+
+    if(Length > n)
+        Length = n;
+    uart_rx_tail += Length;
+    if(n <= UART_RX_BUF_SIZE)
+        return SUCCESS;
+
+    over = n - UART_RX_BUF_SIZE;
+    uart_rx_stats.Overruns++;
+    uart_rx_stats.Lost += over < Length ? over : Length;
+    return ERROR;
+}
+
+/*********************************************************************
+ * @fn      UART_Rx_GetStats
+ *
+ * @brief   Copies the reception statistics; Received counts the bytes
+ *          published so far.
+ *
+ * @return  none
+ */
+void UART_Rx_GetStats(UART_RxStatsTypeDef *Stats)
+{
+    uint32_t irq;
+
+    irq = __irq_save();
+    *Stats = uart_rx_stats;
+    Stats->Received = uart_rx_head;
+    __irq_restore(irq);
+}
+
+/*********************************************************************
+ * @fn      UART_Tx_Write
+ *
+ * @brief   Sends bytes on the USART of UART_RX_PORT, waiting for TXE
+ *          before each. Returns once the last one is in the transmit
+ *          register. Main loop only.
+ *
+ * @param   Data - bytes to send.
+ *          Length - byte count.
+ *
+ * @return  none
+ */
+void UART_Tx_Write(const void *Data, uint32_t Length)
+{
+    const uint8_t *p = (const uint8_t *)Data;
+
+    while(Length--)
+    {
+        while(!(UART_RX_USART->STATR & USART_FLAG_TXE));
+        UART_RX_USART->DATAR = *p++;
+    }
+}
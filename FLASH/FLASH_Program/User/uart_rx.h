@@ -0,0 +1,59 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : uart_rx.h
+ * Author             : typetrade
+ * Version            : V1.0.0
+ * Date               : 2026/10/17
+ * Description        : USART reception by circular DMA into a ring buffer,
+ *                      read in place, and polled transmission for replies.
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+#ifndef __UART_RX_H
+#define __UART_RX_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "debug.h"
+
+/* USART received from: 1, 2 or 3. The default keeps USART1 for printf
+ * (DEBUG); sharing it works, the USART is then set up by the last of
+ * USART_Printf_Init and UART_Rx_Init. */
+#ifndef UART_RX_PORT
+#define UART_RX_PORT               2
+#endif
+
+/* Ring size, a power of 2 up to 32768. The consumer has half of it in
+ * byte times to keep up, and interrupts must not be held off longer. */
+#ifndef UART_RX_BUF_SIZE
+#define UART_RX_BUF_SIZE           1024
+#endif
+
+/* Called from the interrupts that publish new bytes: half and full ring
+ * (DMA HT/TC) and line idle (USART IDLE) */
+typedef void (*UART_RxNotify)(void *Context);
+
+typedef struct
+{
+    uint32_t Received;          /* Bytes published */
+    uint32_t Overruns;          /* Times the DMA caught up with the reader */
+    uint32_t Lost;              /* Bytes overwritten before they were read */
+    uint32_t HwOverruns;        /* USART ORE: a byte not taken by the DMA in time */
+    uint32_t LineErrors;        /* Framing, noise or parity errors */
+    uint32_t DmaErrors;         /* DMA transfer errors, reception stopped */
+    uint32_t Irqs;              /* Interrupts taken */
+} UART_RxStatsTypeDef;
+
+ErrorStatus UART_Rx_Init(uint32_t Baudrate, UART_RxNotify Notify, void *Context);
+void        UART_Rx_DeInit(void);
+uint32_t    UART_Rx_Available(void);
+uint32_t    UART_Rx_Peek(const uint8_t **Data);
+ErrorStatus UART_Rx_Consume(uint32_t Length);
+void        UART_Rx_GetStats(UART_RxStatsTypeDef *Stats);
+void        UART_Tx_Write(const void *Data, uint32_t Length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __UART_RX_H */
@@ -0,0 +1,262 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : main.c
+ * Author             : typetrade
+ * Version            : V1.0.0
+ * Date               : 2026/10/17
+ * Description        : Runs the DMA channel manager of Debug/dma_chan.c
+ *                      against the host DMA model: the channel of every
+ *                      request line, exclusive ownership, memory-to-memory
+ *                      allocation, flags handed to the owner's handler
+ *                      from the interrupt and by polling, and descriptor
+ *                      chains gathering a header, payload and CRC into
+ *                      one buffer, re-armed from the channel interrupt,
+ *                      with a transfer error in the middle and a chain
+ *                      dropped by freeing its channel.
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include "ch32v20x.h"
+#include "sim_flash.h"
+#include "sim_periph.h"
+#include "sim_test.h"
+#include "dma_chan.h"
+
+#define PAYLOAD_SIZE           1000
+
+/* Byte and word gather fragments, as a driver would build them */
+#define CFGR_M2M_BYTES         (DMA_M2M_Enable | DMA_Priority_Medium | DMA_PeripheralInc_Enable | \
+                                DMA_MemoryInc_Enable | DMA_DIR_PeripheralSRC)
+#define CFGR_M2M_WORDS         (CFGR_M2M_BYTES | DMA_PeripheralDataSize_Word | DMA_MemoryDataSize_Word)
+
+static uint8_t  header[8] = {0xA5, 0x5A, 0x01, 0x02, 0xE8, 0x03, 0x00, 0x00};
+static uint32_t payload[PAYLOAD_SIZE / 4];
+static uint32_t crc_word = 0x1234ABCD;
+static uint8_t  src[256], dst[PAYLOAD_SIZE + 64], ref[PAYLOAD_SIZE + 64];
+
+static DMA_DescTypeDef frame[3];
+
+/* What the callbacks saw */
+static uint32_t    handler_flags, handler_calls;
+static int         done_calls;
+static ErrorStatus done_status;
+
+/* Request line to channel, from the reference manual */
+static const uint8_t req_channel[DMA_REQ_COUNT] = {
+    0, 1, 2, 3, 4, 5, 4, 5, 7, 6, 2, 3, 6, 7, 4, 5
+};
+
+/*********************************************************************
+ * @fn      on_flags
+ *
+ * @brief   Channel handler: collects the flags.
+ *
+ * @return  none
+ */
+static void on_flags(void *Context, uint32_t Flags)
+{
+    handler_flags |= Flags;
+    handler_calls++;
+}
+
+/*********************************************************************
+ * @fn      on_done
+ *
+ * @brief   Chain callback.
+ *
+ * @return  none
+ */
+static void on_done(void *Context, ErrorStatus Status)
+{
+    done_status = Status;
+    done_calls++;
+}
+
+/*********************************************************************
+ * @fn      wait_chain
+ *
+ * @brief   Lets simulated time pass, with interrupts, until the chain
+ *          on Channel completed.
+ *
+ * @return  none
+ */
+static void wait_chain(uint8_t Channel)
+{
+    int n;
+
+    for(n = 0; DMA_Chain_Busy(Channel) && n < 100000; n++){
+        SIM_AdvanceTime_ns(1000);
+    }
+}
+
+/*********************************************************************
+ * @fn      start_m2m
+ *
+ * @brief   Starts a 64-byte copy on Channel, interrupts as in Ie.
+ *
+ * @return  none
+ */
+static void start_m2m(uint8_t Channel, uint32_t Ie)
+{
+    DMA_Channel_TypeDef *ch = DMA_Chan_Regs(Channel);
+
+    ch->CFGR = 0;
+    ch->PADDR = (uint32_t)(uintptr_t)src;
+    ch->MADDR = (uint32_t)(uintptr_t)dst;
+    ch->CNTR = 64;
+    ch->CFGR = CFGR_M2M_BYTES | Ie | DMA_CFGR1_EN;
+}
+
+/*********************************************************************
+ * @fn      main
+ *
+ * @brief   Main program.
+ *
+ * @return  0 if every check passed.
+ */
+int main(void)
+{
+    static const uint8_t    m2m_order[DMA_CHAN_COUNT] = {1, 3, 6, 2, 7, 5, 4};
+    SIM_PERIPH_StatsTypeDef st;
+    uint8_t                 held[DMA_CHAN_COUNT], ch, uart;
+    uint32_t                i, bad = 0, n;
+    uint64_t                t0, dt;
+
+    if(SIM_FLASH_Init() != 0 || SIM_PERIPH_Init() != 0)
+        return 2;
+
+    for(i = 0; i < sizeof(src); i++){
+        src[i] = (uint8_t)(i * 13 + 1);
+    }
+    for(i = 0; i < PAYLOAD_SIZE / 4; i++){
+        payload[i] = i * 0x01030507;
+    }
+
+    /* Request lines */
+    for(i = 1; i < DMA_REQ_COUNT; i++){
+        ch = DMA_Chan_Alloc((DMA_RequestTypeDef)i, NULL, NULL);
+        if(ch != req_channel[i])
+            bad++;
+        DMA_Chan_Free(ch);
+    }
+    expect("every request line gets its channel", bad == 0);
+    expect("unknown request line refused", DMA_Chan_Alloc(DMA_REQ_COUNT, NULL, NULL) == 0);
+
+    uart = DMA_Chan_Alloc(DMA_REQ_USART1_TX, NULL, NULL);
+    expect("lines sharing a held channel refused", uart == 4 && DMA_Chan_Alloc(DMA_REQ_SPI2_RX, NULL, NULL) == 0 &&
+           DMA_Chan_Alloc(DMA_REQ_I2C2_TX, NULL, NULL) == 0 && DMA_Chan_Alloc(DMA_REQ_USART1_TX, NULL, NULL) == 0);
+    DMA_Chan_Free(uart);
+    ch = DMA_Chan_Alloc(DMA_REQ_SPI2_RX, NULL, NULL);
+    expect("  free again once released", ch == 4);
+    DMA_Chan_Free(ch);
+
+    /* Memory-to-memory */
+    for(bad = 0, i = 0; i < DMA_CHAN_COUNT; i++){
+        held[i] = DMA_Chan_Alloc(DMA_REQ_MEM2MEM, NULL, NULL);
+        if(held[i] != m2m_order[i])
+            bad++;
+    }
+    expect("memory-to-memory takes the channels in order", bad == 0);
+    expect("  none left", DMA_Chan_Alloc(DMA_REQ_MEM2MEM, NULL, NULL) == 0 &&
+           DMA_Chan_Alloc(DMA_REQ_ADC1, NULL, NULL) == 0);
+    for(i = 0; i < DMA_CHAN_COUNT; i++){
+        DMA_Chan_Free(held[i]);
+    }
+    uart = DMA_Chan_Alloc(DMA_REQ_USART1_TX, NULL, NULL);
+    for(i = 0; i < DMA_CHAN_COUNT - 1; i++){
+        held[i] = DMA_Chan_Alloc(DMA_REQ_MEM2MEM, NULL, NULL);
+    }
+    expect("  a held line's channel is passed over", held[5] == 5 &&
+           DMA_Chan_Alloc(DMA_REQ_MEM2MEM, NULL, NULL) == 0);
+    for(i = 0; i < DMA_CHAN_COUNT - 1; i++){
+        DMA_Chan_Free(held[i]);
+    }
+    DMA_Chan_Free(uart);
+
+    /* Handler dispatch */
+    ch = DMA_Chan_Alloc(DMA_REQ_MEM2MEM, on_flags, NULL);
+    handler_flags = handler_calls = 0;
+    memset(dst, 0, sizeof(dst));
+    start_m2m(ch, DMA_IT_HT | DMA_IT_TC);
+    for(i = 0; i < 100; i++){
+        SIM_AdvanceTime_ns(1000);
+    }
+    expect("handler gets HT and TC from the interrupt", handler_calls == 2 &&
+           handler_flags == (DMA_CHAN_HT | DMA_CHAN_TC) && memcmp(dst, src, 64) == 0);
+    expect("  flags cleared for it", (DMA1->INTFR & ((uint32_t)0xF << (4 * (ch - 1)))) == 0);
+    handler_flags = handler_calls = 0;
+    start_m2m(ch, 0);
+    for(i = 0; i < 100; i++){
+        SIM_AdvanceTime_ns(1000);
+    }
+    n = handler_calls;
+    DMA_Chan_Service(ch);
+    expect("polled channel: flags on DMA_Chan_Service", n == 0 && handler_calls == 1 &&
+           (handler_flags & (DMA_CHAN_TC | DMA_CHAN_HT)) == (DMA_CHAN_TC | DMA_CHAN_HT));
+    DMA_Chan_Free(ch);
+
+    /* Header, payload, CRC gathered into one buffer */
+    frame[0].Cfgr = CFGR_M2M_BYTES;
+    frame[0].Periph = (uint32_t)(uintptr_t)header;
+    frame[0].Memory = (uint32_t)(uintptr_t)dst;
+    frame[0].Count = sizeof(header);
+    frame[0].Next = &frame[1];
+    frame[1].Cfgr = CFGR_M2M_WORDS;
+    frame[1].Periph = (uint32_t)(uintptr_t)payload;
+    frame[1].Memory = (uint32_t)(uintptr_t)(dst + sizeof(header));
+    frame[1].Count = PAYLOAD_SIZE / 4;
+    frame[1].Next = &frame[2];
+    frame[2].Cfgr = CFGR_M2M_WORDS | DMA_Mode_Circular | DMA_IT_HT;  /* Dropped by the manager */
+    frame[2].Periph = (uint32_t)(uintptr_t)&crc_word;
+    frame[2].Memory = (uint32_t)(uintptr_t)(dst + sizeof(header) + PAYLOAD_SIZE);
+    frame[2].Count = 1;
+    frame[2].Next = NULL;
+    memset(dst, 0, sizeof(dst));
+    memcpy(ref, dst, sizeof(ref));
+    memcpy(ref, header, sizeof(header));
+    memcpy(ref + sizeof(header), payload, PAYLOAD_SIZE);
+    memcpy(ref + sizeof(header) + PAYLOAD_SIZE, &crc_word, 4);
+
+    ch = DMA_Chan_Alloc(DMA_REQ_MEM2MEM, NULL, NULL);
+    done_calls = 0;
+    SIM_PERIPH_ClearStats();
+    t0 = SIM_GetTime_ns();
+    expect("chain started", DMA_Chain_Start(ch, &frame[0], on_done, NULL) == SUCCESS && DMA_Chain_Busy(ch));
+    expect("  second start refused while it runs", DMA_Chain_Start(ch, &frame[0], on_done, NULL) == ERROR);
+    wait_chain(ch);
+    dt = SIM_GetTime_ns() - t0;
+    SIM_PERIPH_GetStats(&st);
+    printf("3-fragment chain, %u bytes: %.3f us simulated\n", (unsigned)(sizeof(header) + PAYLOAD_SIZE + 4), dt / 1000.0);
+    expect("  one completion, data gathered in place", done_calls == 1 && done_status == SUCCESS &&
+           memcmp(dst, ref, sizeof(dst)) == 0);
+    expect("  items moved by DMA only", st.DmaBeats == sizeof(header) + PAYLOAD_SIZE / 4 + 1 && st.DmaErrors == 0);
+    expect("  channel idle afterwards", !DMA_Chain_Busy(ch) && DMA_Chan_Regs(ch)->CFGR == 0);
+
+    /* Transfer error in the middle fragment ends the chain */
+    frame[1].Periph = FLASH_R_BASE;
+    memset(dst, 0, sizeof(dst));
+    done_calls = 0;
+    DMA_Chain_Start(ch, &frame[0], on_done, NULL);
+    wait_chain(ch);
+    expect("error in fragment 2 ends the chain", done_calls == 1 && done_status == ERROR &&
+           memcmp(dst, header, sizeof(header)) == 0 && dst[sizeof(header) + PAYLOAD_SIZE] == 0);
+    frame[1].Periph = (uint32_t)(uintptr_t)payload;
+    memset(dst, 0, sizeof(dst));
+    done_calls = 0;
+    DMA_Chain_Start(ch, &frame[0], on_done, NULL);
+    wait_chain(ch);
+    expect("  channel usable after the error", done_calls == 1 && done_status == SUCCESS &&
+           memcmp(dst, ref, sizeof(dst)) == 0);
+
+    /* Freeing the channel drops a running chain */
+    done_calls = 0;
+    DMA_Chain_Start(ch, &frame[0], on_done, NULL);
+    DMA_Chan_Free(ch);
+    for(i = 0; i < 100; i++){
+        SIM_AdvanceTime_ns(1000);
+    }
+    expect("free drops the chain, no callback", done_calls == 0 && !DMA_Chain_Busy(ch) &&
+           DMA_Chain_Start(ch, &frame[0], on_done, NULL) == ERROR);
+
+    return fails ? 1 : 0;
+}
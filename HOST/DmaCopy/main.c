@@ -0,0 +1,249 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : main.c
+ * Author             : typetrade
+ * Version            : V1.0.0
+ * Date               : 2026/10/17
+ * Description        : Runs the DMA copy engine of User/dma_copy.c against
+ *                      the host DMA model: every alignment of short
+ *                      copies and fills, transfers split at the count
+ *                      limit, queued and chained jobs completing from the
+ *                      channel interrupts, channels held elsewhere,
+ *                      transfer errors, and the time a copy takes.
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include "ch32v20x.h"
+#include "sim_flash.h"
+#include "sim_periph.h"
+#include "sim_test.h"
+#include "dma_copy.h"
+#include "dma_chan.h"
+
+#define BIG_SIZE               300000
+#define CHAIN_LEN              5
+
+static uint8_t src[BIG_SIZE + 8], dst[BIG_SIZE + 8], ref[BIG_SIZE + 8];
+
+/* Completion records of the async jobs */
+static int         done_count;
+static int         done_order[16];
+static ErrorStatus done_status[16];
+static int         chain_left;
+
+/*********************************************************************
+ * @fn      on_done
+ *
+ * @brief   Job callback: records the job number in Context.
+ *
+ * @return  none
+ */
+static void on_done(void *Context, ErrorStatus Status)
+{
+    done_status[done_count] = Status;
+    done_order[done_count++] = (int)(intptr_t)Context;
+}
+
+/*********************************************************************
+ * @fn      on_chain
+ *
+ * @brief   Job callback: submits the next 1K of a chain.
+ *
+ * @return  none
+ */
+static void on_chain(void *Context, ErrorStatus Status)
+{
+    DMA_CopyJobTypeDef job;
+    int                i = (int)(intptr_t)Context;
+
+    on_done(Context, Status);
+    if(--chain_left == 0)
+        return;
+    memset(&job, 0, sizeof(job));
+    job.Op = DMA_COPY_OP_COPY;
+    job.Dst = dst + 1024 * (i + 1);
+    job.Src = src + 1024 * (i + 1);
+    job.Length = 1024;
+    job.Callback = on_chain;
+    job.Context = (void *)(intptr_t)(i + 1);
+    DMA_Copy_Submit(&job);
+}
+
+/*********************************************************************
+ * @fn      wait_idle
+ *
+ * @brief   Lets simulated time pass, with interrupts, until no job is
+ *          pending.
+ *
+ * @return  none
+ */
+static void wait_idle(void)
+{
+    int n;
+
+    for(n = 0; DMA_Copy_Pending() && n < 100000; n++){
+        SIM_AdvanceTime_ns(1000);
+    }
+}
+
+/*********************************************************************
+ * @fn      main
+ *
+ * @brief   Main program.
+ *
+ * @return  0 if every check passed.
+ */
+int main(void)
+{
+    SIM_PERIPH_StatsTypeDef st;
+    DMA_CopyJobTypeDef      job;
+    uint32_t                i, len, so, d_o, bad = 0, bad_fill = 0;
+    uint8_t                 held[DMA_CHAN_COUNT];
+    uint64_t                t0, dt;
+    int                     order_ok;
+
+    if(SIM_FLASH_Init() != 0 || SIM_PERIPH_Init() != 0)
+        return 2;
+    expect("engine takes its channels", DMA_Copy_Init() == SUCCESS);
+
+    for(i = 0; i < sizeof(src); i++){
+        src[i] = (uint8_t)(i * 7 + (i >> 8));
+    }
+
+    /* Every alignment of short copies and fills, nothing written around */
+    for(so = 0; so < 4; so++){
+        for(d_o = 0; d_o < 4; d_o++){
+            for(len = 0; len <= 40; len++){
+                memset(dst, 0xEE, 64);
+                memcpy(ref, dst, 64);
+                memcpy(ref + 4 + d_o, src + so, len);
+                if(DMA_Copy_Sync(dst + 4 + d_o, src + so, len) != SUCCESS || memcmp(dst, ref, 64) != 0)
+                    bad++;
+            }
+        }
+        for(len = 0; len <= 40; len++){
+            memset(dst, 0xEE, 64);
+            memcpy(ref, dst, 64);
+            memset(ref + 4 + so, 0x5A, len);
+            if(DMA_Fill_Sync(dst + 4 + so, 0x5A, len) != SUCCESS || memcmp(dst, ref, 64) != 0)
+                bad_fill++;
+        }
+    }
+    expect("copies, lengths 0-40, 16 alignments", bad == 0);
+    expect("fills, lengths 0-40, 4 alignments", bad_fill == 0);
+
+    /* Item size follows the relative alignment */
+    SIM_PERIPH_ClearStats();
+    DMA_Copy_Sync(dst + 1, src + 1, 4096);
+    SIM_PERIPH_GetStats(&st);
+    expect("equal alignment moves words", st.DmaBeats == 4092 / 4 && memcmp(dst + 1, src + 1, 4096) == 0);
+    SIM_PERIPH_ClearStats();
+    DMA_Copy_Sync(dst + 2, src, 4096);
+    SIM_PERIPH_GetStats(&st);
+    expect("halfword alignment moves halfwords", st.DmaBeats == 4096 / 2 && memcmp(dst + 2, src, 4096) == 0);
+
+    /* Over the 65535 item limit */
+    SIM_PERIPH_ClearStats();
+    memset(dst, 0, sizeof(dst));
+    expect("300000 bytes in words", DMA_Copy_Sync(dst, src, BIG_SIZE) == SUCCESS &&
+           memcmp(dst, src, BIG_SIZE) == 0 && dst[BIG_SIZE] == 0);
+    SIM_PERIPH_GetStats(&st);
+    expect("  split at 65535 items", st.DmaBeats == BIG_SIZE / 4 && st.DmaErrors == 0);
+    memset(dst, 0, sizeof(dst));
+    expect("70001 bytes in bytes", DMA_Copy_Sync(dst + 1, src, 70001) == SUCCESS &&
+           memcmp(dst + 1, src, 70001) == 0 && dst[0] == 0 && dst[70002] == 0);
+    memset(dst, 0, sizeof(dst));
+    expect("300000 byte fill", DMA_Fill_Sync(dst + 3, 0xA5, BIG_SIZE) == SUCCESS &&
+           dst[2] == 0 && dst[3] == 0xA5 && dst[BIG_SIZE + 2] == 0xA5 && dst[BIG_SIZE + 3] == 0 &&
+           memchr(dst + 3, 0, BIG_SIZE) == NULL);
+
+    /* Time: one word per SIM_DMA_BEAT_CYCLES, plus setup */
+    t0 = SIM_GetTime_ns();
+    DMA_Copy_Sync(dst, src, 8192);
+    dt = SIM_GetTime_ns() - t0;
+    printf("8K copy: %.3f us simulated\n", dt / 1000.0);
+    expect("8K copy time follows the beat rate", dt >= 2048ULL * SIM_DMA_BEAT_CYCLES * 1000000000ULL / SystemCoreClock &&
+           dt < 2112ULL * SIM_DMA_BEAT_CYCLES * 1000000000ULL / SystemCoreClock);
+
+    /* Queue: two channels run, eight wait, the next is refused */
+    memset(dst, 0, sizeof(dst));
+    memset(&job, 0, sizeof(job));
+    done_count = 0;
+    job.Op = DMA_COPY_OP_COPY;
+    job.Length = 2048;
+    job.Callback = on_done;
+    for(i = 0; i < 10; i++){
+        job.Dst = dst + 2048 * i;
+        job.Src = src + 2048 * i;
+        job.Context = (void *)(intptr_t)i;
+        if(DMA_Copy_Submit(&job) != SUCCESS)
+            bad++;
+    }
+    expect("10 jobs accepted, two channels busy", bad == 0 && DMA_Copy_Pending() == 10 &&
+           (DMA1_Channel1->CFGR & 1) && (DMA1_Channel3->CFGR & 1));
+    expect("11th job refused", DMA_Copy_Submit(&job) == ERROR);
+    wait_idle();
+    for(order_ok = 1, i = 0; i < 10; i++){
+        if(done_status[i] != SUCCESS || done_order[i] < (int)i - 1 || done_order[i] > (int)i + 1)
+            order_ok = 0;
+    }
+    expect("completed from the interrupts, in about order", done_count == 10 && order_ok &&
+           memcmp(dst, src, 2048 * 10) == 0 && DMA_Copy_Pending() == 0);
+
+    /* Chain submitted from the callbacks */
+    memset(dst, 0, sizeof(dst));
+    done_count = 0;
+    chain_left = CHAIN_LEN;
+    job.Dst = dst;
+    job.Src = src;
+    job.Length = 1024;
+    job.Callback = on_chain;
+    job.Context = (void *)(intptr_t)0;
+    DMA_Copy_Submit(&job);
+    wait_idle();
+    expect("chain of 5 from the callbacks", done_count == CHAIN_LEN && done_order[CHAIN_LEN - 1] == CHAIN_LEN - 1 &&
+           memcmp(dst, src, 1024 * CHAIN_LEN) == 0 && dst[1024 * CHAIN_LEN] == 0);
+
+    /* Channel 1 held by the ADC: the engine takes 3 and 6 */
+    DMA_Copy_DeInit();
+    held[0] = DMA_Chan_Alloc(DMA_REQ_ADC1, NULL, NULL);
+    expect("engine started beside the ADC1 channel", held[0] == 1 && DMA_Copy_Init() == SUCCESS);
+    memset(dst, 0, sizeof(dst));
+    done_count = 0;
+    job.Callback = on_done;
+    for(i = 0; i < 2; i++){
+        job.Dst = dst + 1024 * i;
+        job.Src = src + 1024 * i;
+        job.Context = (void *)(intptr_t)i;
+        DMA_Copy_Submit(&job);
+    }
+    expect("  channel held elsewhere is not used", DMA_Copy_Pending() == 2 && (DMA1_Channel3->CFGR & 1) &&
+           (DMA1_Channel6->CFGR & 1) && !(DMA1_Channel1->CFGR & 1));
+    wait_idle();
+    expect("  jobs complete", done_count == 2 && memcmp(dst, src, 2048) == 0);
+    DMA_Chan_Free(held[0]);
+
+    /* Every channel held elsewhere */
+    DMA_Copy_DeInit();
+    for(i = 0; i < DMA_CHAN_COUNT; i++){
+        held[i] = DMA_Chan_Alloc(DMA_REQ_MEM2MEM, NULL, NULL);
+    }
+    expect("no channel free: init and copies fail", DMA_Copy_Init() == ERROR &&
+           DMA_Copy_Sync(dst, src, 64) == ERROR && DMA_Copy_Submit(&job) == ERROR);
+    for(i = 0; i < DMA_CHAN_COUNT; i++){
+        DMA_Chan_Free(held[i]);
+    }
+    expect("  channels back, engine restarts", DMA_Copy_Init() == SUCCESS);
+
+    /* Transfer error: FLASH controller registers are not DMA readable */
+    done_count = 0;
+    job.Dst = dst;
+    job.Src = (const void *)(uintptr_t)FLASH_R_BASE;
+    job.Length = 64;
+    DMA_Copy_Submit(&job);
+    wait_idle();
+    expect("bus error reported to the callback", done_count == 1 && done_status[0] == ERROR);
+    expect("engine usable after the error", DMA_Copy_Sync(dst, src, 64) == SUCCESS && memcmp(dst, src, 64) == 0);
+
+    return fails ? 1 : 0;
+}
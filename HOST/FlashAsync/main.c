@@ -0,0 +1,160 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : main.c
+ * Author             : typetrade
+ * Version            : V1.0.0
+ * Date               : 2026/10/17
+ * Description        : Drives the flash_async job queue against the host FLASH
+ *                      simulator: a main loop keeps running while erase and
+ *                      program jobs complete from the FLASH interrupt.
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include "flash_async.h"
+#include "sim_flash.h"
+#include "sim_test.h"
+
+#define ASYNC_TEST_ADDR        ((uint32_t)0x08008000)
+#define ASYNC_STD_ADDR         ((uint32_t)0x08010000)
+
+/* One main loop pass, e.g. servicing UART and CAN */
+#define ASYNC_LOOP_NS          10000
+
+static uint32_t     page[64];
+static uint16_t     halfwords[32];
+static FLASH_Status results[16];
+static uint32_t     completed = 0;
+static uint32_t     loops = 0;
+
+/*********************************************************************
+ * @fn      job_done
+ *
+ * @brief   Completion callback, records the status of job Context.
+ *
+ * @return  none
+ */
+static void job_done(void *Context, FLASH_Status Status)
+{
+    results[(uintptr_t)Context] = Status;
+    completed++;
+}
+
+/*********************************************************************
+ * @fn      submit
+ *
+ * @brief   Queues one job tagged with Tag, running the main loop while
+ *          the queue is full.
+ *
+ * @return  none
+ */
+static void submit(FLASH_JobOpTypeDef Op, uint32_t Address, const void *Buffer, uint32_t Length, uint32_t Tag)
+{
+    FLASH_JobTypeDef job;
+
+    job.Op = Op;
+    job.Address = Address;
+    job.Buffer = Buffer;
+    job.Length = Length;
+    job.Callback = job_done;
+    job.Context = (void *)(uintptr_t)Tag;
+    results[Tag] = FLASH_BUSY;
+
+    while(FLASH_Async_Submit(&job) != SUCCESS)
+    {
+        SIM_AdvanceTime_ns(ASYNC_LOOP_NS);
+        loops++;
+    }
+}
+
+/*********************************************************************
+ * @fn      check_fill
+ *
+ * @brief   Checks that Length bytes at Address read back as Value words.
+ *
+ * @return  1 when all words match.
+ */
+static int check_fill(uint32_t Address, uint32_t Length, uint32_t Value)
+{
+    uint32_t i;
+
+    for(i = 0; i < Length; i += 4){
+        if(*(uint32_t *)(uintptr_t)(Address + i) != Value)
+            return 0;
+    }
+    return 1;
+}
+
+/*********************************************************************
+ * @fn      main
+ *
+ * @brief   Main program.
+ *
+ * @return  0 if every job completed as expected.
+ */
+int main(void)
+{
+    SIM_FLASH_StatsTypeDef st;
+    FLASH_JobTypeDef       bad;
+    uint64_t               t0;
+    uint32_t               i;
+
+    if(SIM_FLASH_Init() != 0)
+        return 2;
+
+    for(i = 0; i < 64; i++){
+        page[i] = 0xA5000000 | i;
+    }
+    for(i = 0; i < 32; i++){
+        halfwords[i] = (uint16_t)(0x3C00 | i);
+    }
+
+    FLASH_Unlock_Fast();
+    FLASH_Async_Init();
+
+    memset(&bad, 0, sizeof(bad));
+    bad.Op = FLASH_JOB_PROGRAM_PAGE_FAST;
+    bad.Address = ASYNC_TEST_ADDR + 4;
+    bad.Buffer = page;
+    expect("misaligned job rejected", FLASH_Async_Submit(&bad) == ERROR && FLASH_Async_Pending() == 0);
+
+    t0 = SIM_GetTime_ns();
+    submit(FLASH_JOB_ERASE_32K_FAST, ASYNC_TEST_ADDR, NULL, 0, 0);
+    for(i = 0; i < 8; i++){
+        submit(FLASH_JOB_PROGRAM_PAGE_FAST, ASYNC_TEST_ADDR + 256 * i, page, 256, 1 + i);
+    }
+    submit(FLASH_JOB_ERASE_PAGE_FAST, ASYNC_TEST_ADDR + 256 * 7, NULL, 0, 9);
+    submit(FLASH_JOB_ERASE_PAGE, ASYNC_STD_ADDR, NULL, 0, 10);
+    submit(FLASH_JOB_PROGRAM, ASYNC_STD_ADDR, halfwords, sizeof(halfwords), 11);
+    submit(FLASH_JOB_PROGRAM, ASYNC_STD_ADDR, halfwords, 2, 12);
+
+    while(FLASH_Async_Pending())
+    {
+        SIM_AdvanceTime_ns(ASYNC_LOOP_NS);
+        loops++;
+    }
+
+    expect("every callback ran", completed == 13);
+    expect("32K block erase", results[0] == FLASH_COMPLETE);
+    for(i = 1; i <= 8; i++){
+        if(results[i] != FLASH_COMPLETE)
+            break;
+        if(i < 8 && memcmp((void *)(uintptr_t)(ASYNC_TEST_ADDR + 256 * (i - 1)), page, 256) != 0)
+            break;
+    }
+    expect("8 fast page programs", i == 9);
+    expect("fast page erase", results[9] == FLASH_COMPLETE && check_fill(ASYNC_TEST_ADDR + 256 * 7, 256, SIM_FLASH_ERASED_WORD));
+    expect("4K page erase", results[10] == FLASH_COMPLETE);
+    expect("halfword program", results[11] == FLASH_COMPLETE &&
+                               memcmp((void *)(uintptr_t)ASYNC_STD_ADDR, halfwords, sizeof(halfwords)) == 0);
+    expect("program over data reports FLASH_ERROR_PG", results[12] == FLASH_ERROR_PG);
+    expect("EOP/error interrupts disabled when idle", (FLASH->CTLR & (FLASH_IT_EOP | FLASH_IT_ERROR)) == 0);
+
+    SIM_FLASH_GetStats(&st);
+    printf("\n13 jobs in %.3f ms, controller busy %.3f ms, main loop ran %u times (%.3f ms)\n",
+           (SIM_GetTime_ns() - t0) / 1e6, st.Busy_ns / 1e6, loops, loops * (ASYNC_LOOP_NS / 1e6));
+
+    FLASH_Lock_Fast();
+    FLASH_Lock();
+
+    return fails ? 1 : 0;
+}
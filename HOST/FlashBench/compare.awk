@@ -0,0 +1,19 @@
+# Compares a flash_bench CSV (second file) against a baseline (first file).
+# Rows are keyed by api,sysclk_hz,hclk_div. Fails when us_per_op grew by
+# more than tol percent, when an API reports errors or when a row vanished.
+FNR == 1 || /^#/ { next }
+NR == FNR { base[$1 "," $2 "," $4] = $8; next }
+{
+    key = $1 "," $2 "," $4
+    seen[key] = 1
+    if ($7 != 0) { printf "FAIL %s: %s errors\n", key, $7; bad = 1 }
+    if (key in base && $8 > base[key] * (1 + tol / 100)) {
+        printf "FAIL %s: %s us/op, baseline %s us/op\n", key, $8, base[key]
+        bad = 1
+    }
+}
+END {
+    for (k in base) if (!(k in seen)) { printf "FAIL %s: missing\n", k; bad = 1 }
+    if (!bad) print "bench-check: no regression"
+    exit bad
+}
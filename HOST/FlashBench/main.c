@@ -0,0 +1,27 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : main.c
+ * Author             : typetrade
+ * Version            : V1.0.0
+ * Date               : 2026/10/17
+ * Description        : Runs the flash throughput benchmark (User/flash_bench.c)
+ *                      against the host FLASH simulator, CSV on stdout.
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+#include "flash_bench.h"
+#include "sim_flash.h"
+
+/*********************************************************************
+ * @fn      main
+ *
+ * @brief   Main program.
+ *
+ * @return  none
+ */
+int main(void)
+{
+    if(SIM_FLASH_Init() != 0)
+        return 2;
+
+    Flash_Bench_Run();
+    return 0;
+}
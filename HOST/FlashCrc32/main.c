@@ -0,0 +1,176 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : main.c
+ * Author             : typetrade
+ * Version            : V1.0.0
+ * Date               : 2026/10/17
+ * Description        : Checks User/crc32.c against a bitwise zlib CRC-32
+ *                      for every length and alignment up to a few words,
+ *                      through the host CRC unit model and in software,
+ *                      whole and split into chunks; streams interleaved
+ *                      through contexts; and sharing of the unit with an
+ *                      interrupt handler arriving in the middle of a CPU
+ *                      stream and of a DMA stream (User/flash_verify.c).
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include "ch32v20x.h"
+#include "sim_flash.h"
+#include "sim_periph.h"
+#include "sim_test.h"
+#include "crc32.h"
+#include "flash_verify.h"
+
+#define ISR_CRC_BYTES          203
+
+static uint8_t data[4096 + 3];
+
+/* What isr found */
+static uint32_t           isr_crc, isr_unit_writes, isr_flash_crc;
+static FLASH_VerifyStatus isr_status;
+
+/*********************************************************************
+ * @fn      ref_crc32
+ *
+ * @brief   Bitwise zlib crc32(Crc, p, n).
+ *
+ * @return  CRC.
+ */
+static uint32_t ref_crc32(uint32_t Crc, const uint8_t *p, uint32_t n)
+{
+    uint32_t c = ~Crc;
+    int      b;
+
+    while(n--)
+    {
+        c ^= *p++;
+        for(b = 0; b < 8; b++){
+            c = (c & 1) ? (c >> 1) ^ 0xEDB88320 : c >> 1;
+        }
+    }
+    return ~c;
+}
+
+/*********************************************************************
+ * @fn      isr
+ *
+ * @brief   What an interrupt handler sharing the unit does: a CRC-32 of
+ *          its own, and a FLASH CRC by DMA. Called where the interrupt
+ *          would arrive, since the host model runs handlers only between
+ *          time steps, never inside a register access.
+ *
+ * @return  none
+ */
+static void isr(void)
+{
+    SIM_PERIPH_StatsTypeDef a, b;
+
+    SIM_PERIPH_GetStats(&a);
+    isr_crc = CRC32_Update(0x5A5A5A5A, data + 1000, ISR_CRC_BYTES);
+    SIM_PERIPH_GetStats(&b);
+    isr_unit_writes = b.CrcCpuWrites - a.CrcCpuWrites;
+    isr_status = FLASH_CRC_Calc(0x08000000, 0x400, &isr_flash_crc);
+}
+
+/*********************************************************************
+ * @fn      main
+ *
+ * @brief   Main program.
+ *
+ * @return  0 if every check passed.
+ */
+int main(void)
+{
+    SIM_PERIPH_StatsTypeDef st;
+    CRC32_CtxTypeDef        ca, cb;
+    uint32_t                len, off, cut, ref, bad_hw = 0, bad_sw = 0, bad_split = 0, x = 1;
+    uint32_t                isr_ref, flash_ref, crc, saved = 0;
+    CRC32_UnitOwner         prev;
+
+    if(SIM_FLASH_Init() != 0 || SIM_PERIPH_Init() != 0)
+        return 2;
+
+    for(len = 0; len < sizeof(data); len++){
+        x = x * 1103515245 + 12345;
+        data[len] = (uint8_t)(x >> 16);
+    }
+
+    expect("check value of \"123456789\"", CRC32_Calc("123456789", 9) == 0xCBF43926 &&
+           CRC32_Update_Soft(0, "123456789", 9) == 0xCBF43926);
+    expect("empty input", CRC32_Calc(data, 0) == 0 && CRC32_Update(0x12345678, data, 0) == 0x12345678);
+
+    for(off = 0; off < 4; off++){
+        for(len = 0; len <= 67; len++){
+            ref = ref_crc32(0, data + off, len);
+            if(CRC32_Calc(data + off, len) != ref)
+                bad_hw++;
+            if(CRC32_Update_Soft(0, data + off, len) != ref)
+                bad_sw++;
+            for(cut = 0; cut <= len; cut += 5){
+                if(CRC32_Update(CRC32_Update(0, data + off, cut), data + off + cut, len - cut) != ref)
+                    bad_split++;
+            }
+        }
+    }
+    expect("unit path, lengths 0-67 at 4 alignments", bad_hw == 0);
+    expect("slice-by-4, lengths 0-67 at 4 alignments", bad_sw == 0);
+    expect("split streams resume on the unit", bad_split == 0);
+
+    SIM_PERIPH_ClearStats();
+    expect("4099 bytes, unaligned", CRC32_Calc(data + 1, 4099) == ref_crc32(0, data + 1, 4099));
+    SIM_PERIPH_GetStats(&st);
+    expect("whole words through the unit", st.CrcCpuWrites == 4099 / 4 && st.GatedWrites == 0);
+    SIM_PERIPH_ClearStats();
+    crc = CRC32_Update(ref_crc32(0, data, 7), data + 7, 400);
+    SIM_PERIPH_GetStats(&st);
+    expect("resumed CRC takes one seed word", crc == ref_crc32(0, data, 407) && st.CrcCpuWrites == 100 + 1);
+
+    /* Unit state set directly */
+    CRC32_UnitAcquire(CRC32_UNIT_CPU, &saved);
+    for(bad_hw = 0, len = 0; len < 1000; len++){
+        x = x * 1103515245 + 12345;
+        CRC32_UnitLoad(x ^ (len << 20));
+        if(CRC->DATAR != (x ^ (len << 20)))
+            bad_hw++;
+    }
+    CRC32_UnitRelease(CRC32_UNIT_FREE, 0);
+    expect("CRC32_UnitLoad sets DATAR", bad_hw == 0);
+
+    /* Two streams fed alternately, in uneven chunks */
+    CRC32_Init(&ca);
+    CRC32_Init(&cb);
+    for(off = 0; off < 2000; off += 37){
+        CRC32_Feed(&ca, data + off, 37);
+        CRC32_Feed(&cb, data + 2048 + cb.Length, off & 1 ? 18 : 19);
+    }
+    expect("interleaved contexts", CRC32_Final(&ca) == ref_crc32(0, data, 37 * 55) && ca.Length == 37 * 55 &&
+           CRC32_Final(&cb) == ref_crc32(0, data + 2048, cb.Length));
+
+    /* Interrupt taking the unit from a CPU stream after 300 of 1000
+     * words */
+    isr_ref = ref_crc32(0x5A5A5A5A, data + 1000, ISR_CRC_BYTES);
+    FLASH_CRC_Calc(0x08000000, 0x400, &flash_ref);
+    prev = CRC32_UnitAcquire(CRC32_UNIT_CPU, &saved);
+    CRC_ResetDR();
+    CRC_CalcBlockCRC((uint32_t *)data, 300);
+    isr();
+    crc = CRC_CalcBlockCRC((uint32_t *)data + 300, 700);
+    CRC32_UnitRelease(prev, saved);
+    CRC_ResetDR();
+    expect("interrupt in a CPU stream, stream intact", prev == CRC32_UNIT_FREE && crc == CRC_CalcBlockCRC((uint32_t *)data, 1000));
+    /* Its seed word, its own words, and the reload of the interrupted
+     * state */
+    expect("  handler CRC-32 on the unit", isr_crc == isr_ref && isr_unit_writes == 1 + ISR_CRC_BYTES / 4 + 1);
+    expect("  handler FLASH CRC by DMA", isr_status == FLASH_VERIFY_OK && isr_flash_crc == flash_ref);
+
+    /* Interrupt while a DMA channel feeds the unit */
+    prev = CRC32_UnitAcquire(CRC32_UNIT_DMA, &saved);
+    isr();
+    CRC32_UnitRelease(prev, saved);
+    expect("interrupt in a DMA stream", prev == CRC32_UNIT_FREE);
+    expect("  handler CRC-32 in software", isr_crc == isr_ref && isr_unit_writes == 0);
+    expect("  handler FLASH CRC busy", isr_status == FLASH_VERIFY_BUSY);
+    expect("unit free again", FLASH_CRC_Calc(0x08000000, 0x400, &crc) == FLASH_VERIFY_OK && crc == flash_ref);
+
+    return fails ? 1 : 0;
+}
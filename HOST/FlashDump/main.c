@@ -0,0 +1,126 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : main.c
+ * Author             : typetrade
+ * Version            : V1.0.0
+ * Date               : 2026/10/17
+ * Description        : Dumps simulated flash with HexDump_Words to stdout
+ *                      and writes what a printf based dump of the same
+ *                      words prints to EXPECT. "make run" compares the two.
+ *                      Checks go to stderr.
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+#include <stdio.h>
+#include "debug.h"
+#include "hexdump.h"
+#include "sim_flash.h"
+
+/* stdout carries the dump */
+#define SIM_TEST_OUT           stderr
+#include "sim_test.h"
+
+#define DUMP_ADDR              ((uint32_t)0x08008000)
+
+static FILE *expect_file;
+
+/*********************************************************************
+ * @fn      reference
+ *
+ * @brief   printf version of HexDump_Words.
+ *
+ * @return  Number of lines.
+ */
+static uint32_t reference(uint32_t Address, uint32_t Count, uint8_t Flags)
+{
+    const uint32_t *w = (const uint32_t *)Address;
+    uint32_t        i = 0, n, lines = 0;
+    int             slot = 0;
+
+    while(i < Count)
+    {
+        if(slot == 0 && (Flags & HEXDUMP_ADDR))
+            fprintf(expect_file, "%08x: ", Address + 4 * i);
+        else if(slot != 0)
+            fprintf(expect_file, " ");
+
+        n = 1;
+        if(Flags & HEXDUMP_RLE)
+        {
+            while(i + n < Count && w[i + n] == w[i])
+                n++;
+            if(n < HEXDUMP_RLE_MIN)
+                n = 1;
+        }
+        fprintf(expect_file, "%08x", w[i]);
+        if(n > 1)
+            fprintf(expect_file, "*%u", n);
+        i += n;
+
+        if(++slot == HEXDUMP_WORDS_PER_LINE || i == Count)
+        {
+            fprintf(expect_file, "\n");
+            lines++;
+            slot = 0;
+        }
+    }
+    return lines;
+}
+
+/*********************************************************************
+ * @fn      both
+ *
+ * @brief   Dumps with HexDump_Words and the reference.
+ *
+ * @return  Number of lines.
+ */
+static uint32_t both(uint32_t Address, uint32_t Count, uint8_t Flags)
+{
+    HexDump_Words(Address, Count, Flags);
+    return reference(Address, Count, Flags);
+}
+
+/*********************************************************************
+ * @fn      main
+ *
+ * @brief   Main program.
+ *
+ * @return  0 if every check passed.
+ */
+int main(int argc, char **argv)
+{
+    uint32_t i;
+
+    if(argc != 2)
+    {
+        fprintf(stderr, "usage: %s EXPECT\n", argv[0]);
+        return 2;
+    }
+    if(SIM_FLASH_Init() != 0)
+        return 2;
+    expect_file = fopen(argv[1], "wb");
+    if(expect_file == NULL)
+        return 2;
+
+    /* 10 counting words, a run of 2, a run of 3, the rest erased */
+    FLASH_Unlock();
+    FLASH_ErasePage(DUMP_ADDR);
+    for(i = 0; i < 10; i++){
+        FLASH_ProgramWord(DUMP_ADDR + 4 * i, i * 0x11111111);
+    }
+    FLASH_ProgramWord(DUMP_ADDR + 4 * 12, 0x12345678);
+    FLASH_ProgramWord(DUMP_ADDR + 4 * 13, 0x12345678);
+    FLASH_ProgramWord(DUMP_ADDR + 4 * 15, 0xA5A5A5A5);
+    FLASH_ProgramWord(DUMP_ADDR + 4 * 16, 0xA5A5A5A5);
+    FLASH_ProgramWord(DUMP_ADDR + 4 * 17, 0xA5A5A5A5);
+    FLASH_Lock();
+
+    both(DUMP_ADDR, 1, 0);
+    both(DUMP_ADDR, 20, 0);
+    both(DUMP_ADDR, 64, HEXDUMP_ADDR);
+    both(DUMP_ADDR, 64, HEXDUMP_RLE);
+    expect("erased 4K page folds into one line", both(DUMP_ADDR + 4 * 32, 1024 - 32, HEXDUMP_ADDR | HEXDUMP_RLE) == 1);
+    expect("mixed words keep one line per 8 words", both(DUMP_ADDR, 24, HEXDUMP_ADDR) == 3);
+
+    fclose(expect_file);
+    fflush(stdout);
+    return fails ? 1 : 0;
+}
@@ -0,0 +1,233 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : main.c
+ * Author             : typetrade
+ * Version            : V1.0.0
+ * Date               : 2026/10/17
+ * Description        : Exercises the flash_kv store against the host FLASH
+ *                      simulator: updates, deletes, remounts, wear spread
+ *                      and a power cut after every single flash operation
+ *                      of an update that triggers a reclaim, then inside
+ *                      each erase of it, leaving the page half erased.
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include "flash_kv.h"
+#include "sim_flash.h"
+#include "sim_test.h"
+
+#define KV_BASE                ((uint32_t)0x08020000)
+#define KV_PAGES               8
+/* Half-erased page patterns tried at each cut that hits an erase */
+#define KV_TEARS               64
+#define KV_MAX_OPS             256
+
+static const FLASH_KV_ConfigTypeDef kv = {KV_BASE, KV_PAGES};
+static const FLASH_KV_ConfigTypeDef misaligned = {KV_BASE + 4, KV_PAGES};
+static const FLASH_KV_ConfigTypeDef small = {KV_BASE, 4};
+
+/* Page erases done before each cut of the sweep */
+static uint32_t erases_before[KV_MAX_OPS + 1];
+
+/*********************************************************************
+ * @fn      value_of
+ *
+ * @brief   Test value of Key at Version, Length bytes.
+ *
+ * @return  none
+ */
+static void value_of(uint16_t Key, uint32_t Version, uint8_t *Buf, uint16_t Length)
+{
+    uint16_t i;
+
+    for(i = 0; i < Length; i++){
+        Buf[i] = (uint8_t)(Key * 31 + Version * 7 + i);
+    }
+}
+
+/*********************************************************************
+ * @fn      holds
+ *
+ * @brief   Checks that Key reads back as its value at Version.
+ *
+ * @return  1 if it does.
+ */
+static int holds(uint16_t Key, uint32_t Version, uint16_t Length)
+{
+    uint8_t  want[FLASH_KV_MAX_VALUE], got[FLASH_KV_MAX_VALUE];
+    uint16_t len = 0;
+
+    value_of(Key, Version, want, Length);
+    if(FLASH_KV_Read(Key, got, sizeof(got), &len) != FLASH_KV_OK || len != Length)
+        return 0;
+    return memcmp(want, got, Length) == 0;
+}
+
+/*********************************************************************
+ * @fn      fill
+ *
+ * @brief   Formats Config and writes keys 2..LastKey (Key * 8 bytes),
+ *          then key 1 (4 bytes) Updates + 1 times.
+ *
+ * @return  1 if every write succeeded.
+ */
+static int fill(const FLASH_KV_ConfigTypeDef *Config, uint16_t LastKey, uint32_t Updates)
+{
+    uint8_t  buf[FLASH_KV_MAX_VALUE];
+    uint16_t k;
+    uint32_t v;
+
+    if(FLASH_KV_Format(Config) != FLASH_KV_OK)
+        return 0;
+    for(k = 2; k <= LastKey; k++){
+        value_of(k, 0, buf, k * 8);
+        if(FLASH_KV_Write(k, buf, k * 8) != FLASH_KV_OK)
+            return 0;
+    }
+    for(v = 0; v <= Updates; v++){
+        value_of(1, v, buf, 4);
+        if(FLASH_KV_Write(1, buf, 4) != FLASH_KV_OK)
+            return 0;
+    }
+    return 1;
+}
+
+/*********************************************************************
+ * @fn      others_intact
+ *
+ * @brief   Checks keys 2..LastKey.
+ *
+ * @return  1 if all hold their value.
+ */
+static int others_intact(uint16_t LastKey)
+{
+    uint16_t k;
+
+    for(k = 2; k <= LastKey; k++){
+        if(!holds(k, 0, k * 8))
+            return 0;
+    }
+    return 1;
+}
+
+/*********************************************************************
+ * @fn      main
+ *
+ * @brief   Main program.
+ *
+ * @return  0 if every check passed.
+ */
+int main(void)
+{
+    SIM_FLASH_StatsTypeDef st;
+    FLASH_KV_StatsTypeDef  ks;
+    uint8_t                buf[FLASH_KV_MAX_VALUE];
+    uint32_t               hw0, ops, cut, updates, bad, seed, torn, e0;
+
+    if(SIM_FLASH_Init() != 0)
+        return 2;
+
+    expect("mount rejects a misaligned store", FLASH_KV_Mount(&misaligned) == FLASH_KV_INVALID);
+    expect("blank flash mounts empty", FLASH_KV_Mount(&kv) == FLASH_KV_OK &&
+           FLASH_KV_Read(1, buf, sizeof(buf), NULL) == FLASH_KV_NOT_FOUND);
+    expect("write 10 keys", fill(&kv, 10, 0));
+    expect("read back", holds(1, 0, 4) && others_intact(10));
+
+    SIM_FLASH_GetStats(&st);
+    hw0 = st.Op[SIM_OP_HALFWORD].Count;
+    value_of(1, 1, buf, 4);
+    FLASH_KV_Write(1, buf, 4);
+    SIM_FLASH_GetStats(&st);
+    expect("4-byte update costs 6 halfword programs, no erase", st.Op[SIM_OP_HALFWORD].Count - hw0 == 6 && holds(1, 1, 4));
+    SIM_FLASH_GetStats(&st);
+    hw0 = st.Op[SIM_OP_HALFWORD].Count;
+    FLASH_KV_Write(1, buf, 4);
+    SIM_FLASH_GetStats(&st);
+    FLASH_KV_GetStats(&ks);
+    expect("rewriting the same value programs nothing", st.Op[SIM_OP_HALFWORD].Count == hw0 && ks.Unchanged == 1);
+
+    expect("1000 updates", fill(&kv, 10, 1000) && holds(1, 1000, 4) && others_intact(10));
+    FLASH_KV_GetStats(&ks);
+    SIM_FLASH_GetStats(&st);
+    printf("  %u reclaims, %u records relocated, %u erases, %u free pages\n",
+           ks.GcRuns, ks.Relocated, ks.Erases, ks.FreePages);
+    expect("one erased page kept in reserve", ks.FreePages >= 1);
+
+    expect("remount rebuilds the index", FLASH_KV_Mount(&kv) == FLASH_KV_OK && holds(1, 1000, 4) && others_intact(10));
+    expect("delete", FLASH_KV_Delete(3) == FLASH_KV_OK && FLASH_KV_Read(3, buf, sizeof(buf), NULL) == FLASH_KV_NOT_FOUND);
+    expect("delete survives remount", FLASH_KV_Mount(&kv) == FLASH_KV_OK && FLASH_KV_Read(3, buf, sizeof(buf), NULL) == FLASH_KV_NOT_FOUND &&
+           holds(2, 0, 16) && holds(4, 0, 32));
+    value_of(3, 0, buf, 24);
+    FLASH_KV_Write(3, buf, 24);
+
+    /* Find an update that reclaims a page holding live records, and how
+     * many flash operations it takes */
+    for(updates = 1; updates < 200; updates++){
+        fill(&small, 5, updates - 1);
+        FLASH_KV_GetStats(&ks);
+        hw0 = ks.Relocated;
+        SIM_FLASH_GetStats(&st);
+        ops = st.Op[SIM_OP_HALFWORD].Count + st.Op[SIM_OP_PAGE_ERASE].Count;
+        e0 = st.Op[SIM_OP_PAGE_ERASE].Count;
+        value_of(1, updates, buf, 4);
+        FLASH_KV_Write(1, buf, 4);
+        FLASH_KV_GetStats(&ks);
+        if(ks.Relocated != hw0)
+            break;
+    }
+    SIM_FLASH_GetStats(&st);
+    ops = st.Op[SIM_OP_HALFWORD].Count + st.Op[SIM_OP_PAGE_ERASE].Count - ops;
+    printf("  update %u reclaims a page, relocating %u records: %u flash operations\n", updates, ks.Relocated - hw0,
+           ops);
+
+    /* Cut power after every operation of that update, then remount.
+     * Seed 0 drops the operation hit and finds the erases, the other
+     * seeds tear each erase. */
+    if(ops > KV_MAX_OPS)
+        ops = KV_MAX_OPS;
+    erases_before[ops] = st.Op[SIM_OP_PAGE_ERASE].Count - e0;
+    for(seed = 0; seed <= KV_TEARS; seed++){
+        bad = 0;
+        SIM_FLASH_GetStats(&st);
+        torn = st.Torn;
+        SIM_FLASH_TearCutErase(seed);
+        for(cut = 0; cut < ops; cut++){
+            if(seed != 0 && erases_before[cut + 1] == erases_before[cut])
+                continue;
+            fill(&small, 5, updates - 1);
+            SIM_FLASH_GetStats(&st);
+            e0 = st.Op[SIM_OP_PAGE_ERASE].Count;
+            SIM_FLASH_CutPowerAfter((int32_t)cut);
+            value_of(1, updates, buf, 4);
+            FLASH_KV_Write(1, buf, 4);
+            SIM_FLASH_CutPowerAfter(-1);
+            SIM_FLASH_GetStats(&st);
+            if(seed == 0)
+                erases_before[cut] = st.Op[SIM_OP_PAGE_ERASE].Count - e0;
+            if(FLASH_KV_Mount(&small) != FLASH_KV_OK || !(holds(1, updates - 1, 4) || holds(1, updates, 4)) ||
+               !others_intact(5))
+            {
+                printf("  power cut after %u operations, tear %u: store damaged\n", cut, seed);
+                bad++;
+                continue;
+            }
+            /* The store must stay usable */
+            value_of(1, updates + 1, buf, 4);
+            if(FLASH_KV_Write(1, buf, 4) != FLASH_KV_OK || !holds(1, updates + 1, 4) ||
+               FLASH_KV_Mount(&small) != FLASH_KV_OK || !holds(1, updates + 1, 4) || !others_intact(5))
+            {
+                printf("  power cut after %u operations, tear %u: store unusable afterwards\n", cut, seed);
+                bad++;
+            }
+        }
+        SIM_FLASH_TearCutErase(0);
+        SIM_FLASH_GetStats(&st);
+        if(seed == 0)
+            expect("power cut at every step of a reclaiming update", bad == 0);
+        else if(bad != 0 || st.Torn == torn)
+            break;
+    }
+    expect("power cut inside its erases, 64 half-erased patterns", seed > KV_TEARS);
+
+    return fails ? 1 : 0;
+}
@@ -0,0 +1,131 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : main.c
+ * Author             : typetrade
+ * Version            : V1.0.0
+ * Date               : 2026/10/17
+ * Description        : Writes binlog.h records of the main.c messages and a
+ *                      set of format corner cases to RECORDS, and the text
+ *                      printf would have printed, with the timestamps the
+ *                      decoder must rebuild, to TEXT. "make run" then
+ *                      checks that log_decode turns RECORDS into TEXT.
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#define LOG_BINARY
+#include "binlog.h"
+#include "debug.h"
+#include "sim_flash.h"
+#include "sim_test.h"
+
+static FILE    *rec_file, *txt_file;
+static uint32_t rec_bytes = 0, txt_bytes = 0;
+static uint64_t t0_ns;
+static int      bol = 1;
+
+/* Logs and writes the expected text of the same call */
+#define BOTH(...)                    \
+    do                               \
+    {                                \
+        LOG(__VA_ARGS__);            \
+        expect_text(__VA_ARGS__);    \
+    } while(0)
+
+/*********************************************************************
+ * @fn      sink
+ *
+ * @brief   Record sink: appends to RECORDS.
+ *
+ * @return  none
+ */
+static void sink(const uint8_t *Data, uint32_t Length)
+{
+    fwrite(Data, 1, Length, rec_file);
+    rec_bytes += Length;
+}
+
+/*********************************************************************
+ * @fn      expect_text
+ *
+ * @brief   Appends what printf prints for Fmt to TEXT, after the
+ *          timestamp when it starts a line.
+ *
+ * @return  none
+ */
+static void expect_text(const char *Fmt, ...)
+{
+    uint64_t us = (SIM_GetTime_ns() - t0_ns) / 1000;
+    va_list  ap;
+
+    if(bol)
+        fprintf(txt_file, "[%4lu.%06lu] ", (unsigned long)(us / 1000000), (unsigned long)(us % 1000000));
+    va_start(ap, Fmt);
+    txt_bytes += vfprintf(txt_file, Fmt, ap);
+    va_end(ap);
+    bol = Fmt[strlen(Fmt) - 1] == '\n';
+}
+
+/*********************************************************************
+ * @fn      main
+ *
+ * @brief   Main program.
+ *
+ * @return  0 if every check passed.
+ */
+int main(int argc, char **argv)
+{
+    static const uint8_t junk[] = {0x00, 0x13, LOG_SYNC, 0xFF, 0xFF, 0x03};
+    uint32_t status_rec, status_txt, i;
+
+    if(argc != 3)
+    {
+        fprintf(stderr, "usage: %s RECORDS TEXT\n", argv[0]);
+        return 2;
+    }
+    if(SIM_FLASH_Init() != 0)
+        return 2;
+    rec_file = fopen(argv[1], "wb");
+    txt_file = fopen(argv[2], "wb");
+    if(rec_file == NULL || txt_file == NULL)
+        return 2;
+
+    t0_ns = SIM_GetTime_ns();
+    LOG_Init(sink);
+
+    /* Status messages of main.c, a few hundred us apart */
+    for(i = 0; i < 8; i++){
+        SIM_AdvanceTime_ns(250000);
+        BOTH("FLASH Erase Suc\r\n");
+        SIM_AdvanceTime_ns(120000);
+        BOTH("Programing...\r\n");
+        SIM_AdvanceTime_ns(90000);
+        BOTH("Memory Program PASS!\r\n");
+        SIM_AdvanceTime_ns(40000);
+        BOTH("读写内部 FLASH 标准编程测试成功\r\n");
+    }
+    status_rec = rec_bytes;
+    status_txt = txt_bytes;
+    expect("status messages shrink at least 5x", status_rec * 5 <= status_txt);
+    printf("  %u text bytes sent as %u record bytes\n", status_txt, status_rec);
+
+    /* Arguments */
+    SIM_AdvanceTime_ns(3000000000ULL);
+    BOTH("SystemClk:%d\r\n", SystemCoreClock);
+    for(i = 0; i < 16; i++){
+        BOTH("%08x ", 0xE339E339 ^ (i * 0x01010101));
+    }
+    BOTH("\n");
+    BOTH("%d %i %u %hd %hhu\n", -1, -2147483647 - 1, 4294967295U, 70000, 300);
+    BOTH("[%5u|%-4x|%#o|%+d|%c|%%|%X]\n", 42, 0xab, 8, 7, 'Z', 0xBEEF);
+    BOTH("%*d|%.*u|%-*.*x\n", 6, -12, 4, 7, 8, 3, 0x1f);
+
+    /* Bytes that are no record in between must be skipped */
+    fwrite(junk, 1, sizeof(junk), rec_file);
+    SIM_AdvanceTime_ns(1000);
+    BOTH("after %u junk bytes\n", (uint32_t)sizeof(junk));
+
+    fclose(rec_file);
+    fclose(txt_file);
+    return fails ? 1 : 0;
+}
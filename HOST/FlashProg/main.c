@@ -0,0 +1,308 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : main.c
+ * Author             : typetrade
+ * Version            : V1.0.0
+ * Date               : 2026/10/17
+ * Description        : Programs a device running flash_service.c over a
+ *                      serial port.
+ *
+ *                      flash_prog [-b BAUD] [-a ADDRESS] [-w WINDOW]
+ *                                 [-t MS] [-r] [-s] DEVICE FILE
+ *
+ *                      Erases the 256B pages FILE covers from ADDRESS
+ *                      (default: the start of the device's writable
+ *                      range), writes FILE with WINDOW pages in flight
+ *                      (default and most: FLASH_PROTO_WINDOW), has the
+ *                      device check its CRC, and with -r reboots it.
+ *                      -b sets the baud rate (default 2000000, 8N1, no
+ *                      flow control), -t the reply timeout. Prints the
+ *                      time and throughput of each step; -s adds the
+ *                      link counters.
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include "prog_client.h"
+
+/* Baud rates termios knows */
+static const struct
+{
+    uint32_t Baud;
+    speed_t  Speed;
+} prog_speeds[] = {
+    {9600, B9600},       {19200, B19200},     {38400, B38400},     {57600, B57600},
+    {115200, B115200},   {230400, B230400},   {460800, B460800},   {500000, B500000},
+    {576000, B576000},   {921600, B921600},   {1000000, B1000000}, {1152000, B1152000},
+    {1500000, B1500000}, {2000000, B2000000}, {2500000, B2500000}, {3000000, B3000000},
+    {3500000, B3500000}, {4000000, B4000000},
+};
+
+/*********************************************************************
+ * @fn      usage
+ *
+ * @brief   Prints the command line and exits.
+ *
+ * @return  none
+ */
+static void usage(void)
+{
+    fprintf(stderr, "usage: flash_prog [-b BAUD] [-a ADDRESS] [-w WINDOW] [-t MS] [-r] [-s] DEVICE FILE\n");
+    exit(2);
+}
+
+/*********************************************************************
+ * @fn      now_s
+ *
+ * @brief   Monotonic time.
+ *
+ * @return  Seconds.
+ */
+static double now_s(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/*********************************************************************
+ * @fn      tty_open
+ *
+ * @brief   Opens a serial port raw, 8N1, at Baud.
+ *
+ * @return  File descriptor, -1 on error.
+ */
+static int tty_open(const char *Path, uint32_t Baud)
+{
+    struct termios tio;
+    size_t         i;
+    int            fd;
+
+    for(i = 0; i < sizeof(prog_speeds) / sizeof(prog_speeds[0]); i++){
+        if(prog_speeds[i].Baud == Baud)
+            break;
+    }
+    if(i == sizeof(prog_speeds) / sizeof(prog_speeds[0]))
+    {
+        fprintf(stderr, "flash_prog: unsupported baud rate %u\n", Baud);
+        return -1;
+    }
+
+    fd = open(Path, O_RDWR | O_NOCTTY);
+    if(fd < 0)
+    {
+        fprintf(stderr, "flash_prog: %s: %s\n", Path, strerror(errno));
+        return -1;
+    }
+    if(tcgetattr(fd, &tio) != 0)
+    {
+        fprintf(stderr, "flash_prog: %s: %s\n", Path, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    cfmakeraw(&tio);
+    tio.c_cflag &= ~(CSTOPB | CRTSCTS);
+    tio.c_cflag |= CLOCAL | CREAD;
+    tio.c_cc[VMIN] = 0;
+    tio.c_cc[VTIME] = 0;
+    cfsetispeed(&tio, prog_speeds[i].Speed);
+    cfsetospeed(&tio, prog_speeds[i].Speed);
+    if(tcsetattr(fd, TCSANOW, &tio) != 0)
+    {
+        fprintf(stderr, "flash_prog: %s: %s\n", Path, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    tcflush(fd, TCIOFLUSH);
+    return fd;
+}
+
+/*********************************************************************
+ * @fn      tty_send
+ *
+ * @brief   Link Send: writes every byte.
+ *
+ * @return  0, -1 on error.
+ */
+static int tty_send(void *Link, const uint8_t *Data, uint32_t Length)
+{
+    int     fd = *(int *)Link;
+    ssize_t n;
+
+    while(Length)
+    {
+        n = write(fd, Data, Length);
+        if(n < 0 && errno == EINTR)
+            continue;
+        if(n <= 0)
+            return -1;
+        Data += n;
+        Length -= (uint32_t)n;
+    }
+    return 0;
+}
+
+/*********************************************************************
+ * @fn      tty_recv
+ *
+ * @brief   Link Recv: waits up to Timeout_ms for bytes.
+ *
+ * @return  Bytes read, 0 on timeout, -1 on error.
+ */
+static int tty_recv(void *Link, uint8_t *Data, uint32_t Max, uint32_t Timeout_ms)
+{
+    struct pollfd p = {.fd = *(int *)Link, .events = POLLIN};
+    ssize_t       n;
+    int           r;
+
+    r = poll(&p, 1, (int)Timeout_ms);
+    if(r < 0)
+        return errno == EINTR ? 0 : -1;
+    if(r == 0)
+        return 0;
+    n = read(p.fd, Data, Max);
+    if(n < 0)
+        return errno == EINTR || errno == EAGAIN ? 0 : -1;
+    return (int)n;
+}
+
+/*********************************************************************
+ * @fn      load_file
+ *
+ * @brief   Reads a whole file, padded with 0xFF to whole pages.
+ *
+ * @return  Malloc'ed contents, NULL on error.
+ */
+static uint8_t *load_file(const char *Path, uint32_t *Size)
+{
+    FILE    *f = fopen(Path, "rb");
+    uint8_t *buf;
+    long     n;
+    uint32_t padded;
+
+    if(f == NULL)
+        return NULL;
+    fseek(f, 0, SEEK_END);
+    n = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    padded = ((uint32_t)n + FLASH_PROTO_PAGE_SIZE - 1) & ~(uint32_t)(FLASH_PROTO_PAGE_SIZE - 1);
+    buf = malloc(padded ? padded : 1);
+    if(n <= 0 || buf == NULL || fread(buf, 1, n, f) != (size_t)n)
+    {
+        free(buf);
+        fclose(f);
+        return NULL;
+    }
+    fclose(f);
+    memset(buf + n, 0xFF, padded - n);
+    *Size = padded;
+    return buf;
+}
+
+/*********************************************************************
+ * @fn      check
+ *
+ * @brief   Exits with a message if a step failed.
+ *
+ * @return  none
+ */
+static void check(const char *Step, int Status, const PROG_ClientTypeDef *Client)
+{
+    if(Status == FLASH_PROTO_OK)
+        return;
+    fprintf(stderr, "flash_prog: %s at 0x%08x: %s\n", Step, Client->FailAddress, PROG_StatusName(Status));
+    exit(1);
+}
+
+/*********************************************************************
+ * @fn      main
+ *
+ * @brief   Main program.
+ *
+ * @return  0 if the image was written and verified.
+ */
+int main(int argc, char **argv)
+{
+    PROG_ClientTypeDef client;
+    PROG_LinkTypeDef   link;
+    uint8_t           *image;
+    uint32_t           baud = 2000000, address = 0, size, crc, timeout = 0;
+    int                fd, opt, reboot = 0, stats = 0, window = FLASH_PROTO_WINDOW, have_address = 0;
+    double             t;
+
+    while((opt = getopt(argc, argv, "b:a:w:t:rs")) != -1)
+    {
+        switch(opt)
+        {
+            case 'b': baud = strtoul(optarg, NULL, 0); break;
+            case 'a': address = strtoul(optarg, NULL, 0); have_address = 1; break;
+            case 'w': window = atoi(optarg); break;
+            case 't': timeout = strtoul(optarg, NULL, 0); break;
+            case 'r': reboot = 1; break;
+            case 's': stats = 1; break;
+            default:  usage();
+        }
+    }
+    if(argc - optind != 2 || window < 1 || window > FLASH_PROTO_WINDOW)
+        usage();
+
+    image = load_file(argv[optind + 1], &size);
+    if(image == NULL)
+    {
+        fprintf(stderr, "flash_prog: cannot read %s\n", argv[optind + 1]);
+        return 1;
+    }
+    fd = tty_open(argv[optind], baud);
+    if(fd < 0)
+        return 1;
+
+    link.Send = tty_send;
+    link.Recv = tty_recv;
+    link.Link = &fd;
+    PROG_Init(&client, &link);
+    client.Window = (uint8_t)window;
+    if(timeout)
+        client.Timeout_ms = timeout;
+
+    check("sync", PROG_Sync(&client), &client);
+    if(!have_address)
+        address = client.Start;
+    printf("device range 0x%08x-0x%08x, window %u\n", client.Start, client.End, client.Window);
+    if(address < client.Start || address > client.End || size > client.End - address)
+    {
+        fprintf(stderr, "flash_prog: %u bytes at 0x%08x do not fit\n", size, address);
+        return 1;
+    }
+
+    t = now_s();
+    check("erase", PROG_Erase(&client, address, size), &client);
+    printf("erase  %7u bytes %8.3f s\n", size, now_s() - t);
+
+    t = now_s();
+    check("write", PROG_Write(&client, address, image, size), &client);
+    t = now_s() - t;
+    printf("write  %7u bytes %8.3f s %8.1f KB/s\n", size, t, size / 1024.0 / t);
+
+    t = now_s();
+    check("verify", PROG_Verify(&client, address, image, size, &crc), &client);
+    printf("verify %7u bytes %8.3f s crc 0x%08x\n", size, now_s() - t, crc);
+
+    if(reboot)
+        check("reboot", PROG_Reboot(&client), &client);
+
+    if(stats)
+        fprintf(stderr, "requests %u resent %u bad replies %u tx %llu rx %llu\n", client.Stats.Requests,
+                client.Stats.Resent, client.Stats.BadReplies, (unsigned long long)client.Stats.TxBytes,
+                (unsigned long long)client.Stats.RxBytes);
+
+    close(fd);
+    free(image);
+    return 0;
+}
@@ -0,0 +1,418 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : prog_client.c
+ * Author             : typetrade
+ * Version            : V1.0.0
+ * Date               : 2026/10/17
+ * Description        : Host side of the flash_proto.h protocol, over any
+ *                      byte link (a serial port in HOST/FlashProg/main.c,
+ *                      the simulated USART in HOST/ProtoLoop).
+ *                      SYNC, ERASE, VERIFY and REBOOT are sent one at a
+ *                      time. PROG_Write keeps up to Window WRITE requests
+ *                      in flight and sends the next page as each reply
+ *                      comes back, so the device programs one page while
+ *                      the next ones travel. Replies come in sequence
+ *                      order; one that does not come within Timeout_ms
+ *                      sends every request from the oldest unanswered one
+ *                      again (go-back-N), the device replies again to
+ *                      those it already ran.
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+#include <string.h>
+#include "prog_client.h"
+
+/* Erase time allowed per 4K on top of Timeout_ms: a 4K erase, the
+ * slowest per byte */
+#define PROG_ERASE_MS_PER_4K       5
+
+static uint32_t prog_crc_table[256];
+
+/*********************************************************************
+ * @fn      PROG_Crc32
+ *
+ * @brief   zlib CRC-32, the frame CRC.
+ *
+ * @return  CRC.
+ */
+uint32_t PROG_Crc32(const void *Data, uint32_t Length)
+{
+    const uint8_t *p = (const uint8_t *)Data;
+    uint32_t       crc = 0xFFFFFFFF, i, c;
+    int            b;
+
+    if(prog_crc_table[1] == 0)
+    {
+        for(i = 0; i < 256; i++){
+            c = i;
+            for(b = 0; b < 8; b++){
+                c = (c & 1) ? (c >> 1) ^ 0xEDB88320 : c >> 1;
+            }
+            prog_crc_table[i] = c;
+        }
+    }
+    while(Length--)
+    {
+        crc = prog_crc_table[(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+/*********************************************************************
+ * @fn      PROG_CrcWords
+ *
+ * @brief   CRC-32/MPEG-2 of little-endian words, the VERIFY CRC.
+ *
+ * @param   Length - bytes, a multiple of 4.
+ *
+ * @return  CRC.
+ */
+uint32_t PROG_CrcWords(const void *Data, uint32_t Length)
+{
+    const uint8_t *p = (const uint8_t *)Data;
+    uint32_t       crc = 0xFFFFFFFF;
+    int            b;
+
+    for(; Length >= 4; Length -= 4, p += 4){
+        crc ^= (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+        for(b = 0; b < 32; b++){
+            crc = (crc & 0x80000000) ? (crc << 1) ^ 0x04C11DB7 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+/*********************************************************************
+ * @fn      PROG_StatusName
+ *
+ * @brief   Name of a result, for messages.
+ *
+ * @return  Name string.
+ */
+const char *PROG_StatusName(int Status)
+{
+    switch(Status)
+    {
+        case FLASH_PROTO_OK:           return "ok";
+        case FLASH_PROTO_ERR_CMD:      return "bad request";
+        case FLASH_PROTO_ERR_RANGE:    return "outside the writable range or misaligned";
+        case FLASH_PROTO_ERR_FLASH:    return "flash operation failed";
+        case FLASH_PROTO_ERR_MISMATCH: return "CRC mismatch";
+        case FLASH_PROTO_ERR_BUSY:     return "device busy";
+        case PROG_ERR_TIMEOUT:         return "no reply";
+        case PROG_ERR_LINK:            return "link error";
+        case PROG_ERR_ARG:             return "misaligned address or length";
+        default:                       return "unknown status";
+    }
+}
+
+/*********************************************************************
+ * @fn      prog_send
+ *
+ * @brief   Sends one request frame.
+ *
+ * @param   Req - request, header filled in.
+ *          Length - message length.
+ *
+ * @return  0, or PROG_ERR_LINK.
+ */
+static int prog_send(PROG_ClientTypeDef *Client, const FLASH_ProtoMsgTypeDef *Req, uint32_t Length)
+{
+    uint8_t  msg[FLASH_PROTO_MSG_MAX + 4];
+    uint8_t  frame[FLASH_PROTO_FRAME_MAX];
+    uint32_t crc, n;
+
+    memcpy(msg, Req, Length);
+    crc = PROG_Crc32(msg, Length);
+    memcpy(msg + Length, &crc, 4);
+    n = COBS_Encode(msg, Length + 4, frame);
+
+    Client->Stats.Requests++;
+    Client->Stats.TxBytes += n;
+    return Client->Link.Send(Client->Link.Link, frame, n) == 0 ? 0 : PROG_ERR_LINK;
+}
+
+/*********************************************************************
+ * @fn      prog_recv
+ *
+ * @brief   Waits for the next reply frame that passes its CRC.
+ *
+ * @param   Reply - receives it.
+ *          Timeout_ms - longest wait for each piece of it.
+ *
+ * @return  0, PROG_ERR_TIMEOUT or PROG_ERR_LINK.
+ */
+static int prog_recv(PROG_ClientTypeDef *Client, FLASH_ProtoMsgTypeDef *Reply, uint32_t Timeout_ms)
+{
+    uint32_t crc;
+    int32_t  frame;
+    int      n;
+
+    for(;;)
+    {
+        while(Client->RxPos < Client->RxLength)
+        {
+            Client->RxPos += COBS_Decode(&Client->Dec, Client->Rx + Client->RxPos, Client->RxLength - Client->RxPos,
+                                         &frame);
+            if(frame == COBS_FRAME_NONE)
+                continue;
+            if(frame == FLASH_PROTO_REPLY_SIZE + 4)
+            {
+                memcpy(&crc, Client->Frame + FLASH_PROTO_REPLY_SIZE, 4);
+                if(crc == PROG_Crc32(Client->Frame, FLASH_PROTO_REPLY_SIZE) && (Client->Frame[1] & FLASH_PROTO_REPLY))
+                {
+                    memcpy(Reply, Client->Frame, FLASH_PROTO_REPLY_SIZE);
+                    return 0;
+                }
+            }
+            Client->Stats.BadReplies++;
+        }
+
+        n = Client->Link.Recv(Client->Link.Link, Client->Rx, sizeof(Client->Rx), Timeout_ms);
+        if(n < 0)
+            return PROG_ERR_LINK;
+        if(n == 0)
+            return PROG_ERR_TIMEOUT;
+        Client->Stats.RxBytes += n;
+        Client->RxPos = 0;
+        Client->RxLength = (uint32_t)n;
+    }
+}
+
+/*********************************************************************
+ * @fn      prog_request
+ *
+ * @brief   Sends one request and waits for its reply, sending it again
+ *          after each timeout.
+ *
+ * @param   Req - request; Seq is filled in.
+ *          Length - message length.
+ *          Timeout_ms - reply wait.
+ *          Reply - receives the reply.
+ *
+ * @return  Reply status, PROG_ERR_TIMEOUT or PROG_ERR_LINK.
+ */
+static int prog_request(PROG_ClientTypeDef *Client, FLASH_ProtoMsgTypeDef *Req, uint32_t Length, uint32_t Timeout_ms,
+                        FLASH_ProtoMsgTypeDef *Reply)
+{
+    int tries, r;
+
+    Req->Seq = Client->Seq;
+    for(tries = 0; tries <= Client->Retries; tries++){
+        if(tries)
+            Client->Stats.Resent++;
+        if(prog_send(Client, Req, Length) != 0)
+            return PROG_ERR_LINK;
+        while((r = prog_recv(Client, Reply, Timeout_ms)) == 0)
+        {
+            if(Reply->Seq == Req->Seq && Reply->Cmd == (Req->Cmd | FLASH_PROTO_REPLY))
+            {
+                Client->Seq++;
+                if(Reply->Status != FLASH_PROTO_OK)
+                    Client->FailAddress = Req->Address;
+                return Reply->Status;
+            }
+            Client->Stats.BadReplies++;
+        }
+        if(r != PROG_ERR_TIMEOUT)
+            return r;
+    }
+    Client->FailAddress = Req->Address;
+    return PROG_ERR_TIMEOUT;
+}
+
+/*********************************************************************
+ * @fn      PROG_Init
+ *
+ * @brief   Sets up a client with the defaults: full window, 500ms
+ *          timeout, 3 retries.
+ *
+ * @return  none
+ */
+void PROG_Init(PROG_ClientTypeDef *Client, const PROG_LinkTypeDef *Link)
+{
+    memset(Client, 0, sizeof(*Client));
+    Client->Link = *Link;
+    Client->Window = FLASH_PROTO_WINDOW;
+    Client->Timeout_ms = 500;
+    Client->Retries = 3;
+    COBS_DecodeInit(&Client->Dec, Client->Frame, sizeof(Client->Frame));
+}
+
+/*********************************************************************
+ * @fn      PROG_Sync
+ *
+ * @brief   Starts a session: the device takes the client's sequence
+ *          numbers and reports its writable range.
+ *
+ * @return  FLASH_PROTO_OK, or an error.
+ */
+int PROG_Sync(PROG_ClientTypeDef *Client)
+{
+    FLASH_ProtoMsgTypeDef req, reply;
+    uint8_t               delim = 0;
+    int                   r;
+
+    /* A delimiter ends whatever the device took for the start of a frame */
+    if(Client->Link.Send(Client->Link.Link, &delim, 1) != 0)
+        return PROG_ERR_LINK;
+
+    memset(&req, 0, FLASH_PROTO_HDR_SIZE);
+    req.Cmd = FLASH_PROTO_SYNC;
+    r = prog_request(Client, &req, FLASH_PROTO_HDR_SIZE, Client->Timeout_ms, &reply);
+    if(r != FLASH_PROTO_OK)
+        return r;
+    Client->Start = reply.Address;
+    Client->End = reply.u.Arg[0];
+    if(Client->Window > reply.u.Arg[1])
+        Client->Window = (uint8_t)reply.u.Arg[1];
+    return FLASH_PROTO_OK;
+}
+
+/*********************************************************************
+ * @fn      PROG_Erase
+ *
+ * @brief   Erases a range, 256B aligned.
+ *
+ * @return  FLASH_PROTO_OK, or an error.
+ */
+int PROG_Erase(PROG_ClientTypeDef *Client, uint32_t Address, uint32_t Length)
+{
+    FLASH_ProtoMsgTypeDef req, reply;
+
+    if((Address | Length) & (FLASH_PROTO_PAGE_SIZE - 1))
+        return PROG_ERR_ARG;
+    memset(&req, 0, FLASH_PROTO_HDR_SIZE + 4);
+    req.Cmd = FLASH_PROTO_ERASE;
+    req.Address = Address;
+    req.u.Arg[0] = Length;
+    return prog_request(Client, &req, FLASH_PROTO_HDR_SIZE + 4,
+                        Client->Timeout_ms + (Length / 4096 + 1) * PROG_ERASE_MS_PER_4K, &reply);
+}
+
+/*********************************************************************
+ * @fn      PROG_Write
+ *
+ * @brief   Programs erased flash page by page, Window pages in flight.
+ *          A last partial page is padded with 0xFF.
+ *
+ * @param   Address - 256B aligned.
+ *          Data - image.
+ *          Length - bytes.
+ *
+ * @return  FLASH_PROTO_OK, or the first error (FailAddress is its
+ *          page; pages sent after it may have been written).
+ */
+int PROG_Write(PROG_ClientTypeDef *Client, uint32_t Address, const void *Data, uint32_t Length)
+{
+    FLASH_ProtoMsgTypeDef req, reply;
+    uint32_t              pages, base = 0, next = 0, sent = 0, n;
+    uint8_t               seq0 = Client->Seq, d, window;
+    int                   tries = 0, r;
+
+    if(Address & (FLASH_PROTO_PAGE_SIZE - 1))
+        return PROG_ERR_ARG;
+    window = Client->Window ? Client->Window : 1;
+    if(window > FLASH_PROTO_WINDOW)
+        window = FLASH_PROTO_WINDOW;
+    pages = (Length + FLASH_PROTO_PAGE_SIZE - 1) / FLASH_PROTO_PAGE_SIZE;
+
+    memset(&req, 0, FLASH_PROTO_HDR_SIZE);
+    req.Cmd = FLASH_PROTO_WRITE;
+    while(base < pages)
+    {
+        for(; next < pages && next - base < window; next++){
+            req.Seq = (uint8_t)(seq0 + next);
+            req.Address = Address + next * FLASH_PROTO_PAGE_SIZE;
+            n = Length - next * FLASH_PROTO_PAGE_SIZE;
+            if(n > FLASH_PROTO_PAGE_SIZE)
+                n = FLASH_PROTO_PAGE_SIZE;
+            memcpy(req.u.Data, (const uint8_t *)Data + next * FLASH_PROTO_PAGE_SIZE, n);
+            memset(req.u.Data + n, 0xFF, FLASH_PROTO_PAGE_SIZE - n);
+            if(next < sent)
+                Client->Stats.Resent++;
+            else
+                sent = next + 1;
+            if(prog_send(Client, &req, FLASH_PROTO_HDR_SIZE + FLASH_PROTO_PAGE_SIZE) != 0)
+                return PROG_ERR_LINK;
+        }
+
+        r = prog_recv(Client, &reply, Client->Timeout_ms);
+        if(r == PROG_ERR_TIMEOUT)
+        {
+            if(++tries > Client->Retries)
+            {
+                Client->Seq = (uint8_t)(seq0 + sent);
+                Client->FailAddress = Address + base * FLASH_PROTO_PAGE_SIZE;
+                return PROG_ERR_TIMEOUT;
+            }
+            next = base;
+            continue;
+        }
+        if(r != 0)
+            return r;
+
+        /* Replies cover the oldest requests in flight, in order */
+        d = (uint8_t)(reply.Seq - (uint8_t)(seq0 + base));
+        if(reply.Cmd != (FLASH_PROTO_WRITE | FLASH_PROTO_REPLY) || d >= next - base)
+        {
+            Client->Stats.BadReplies++;
+            continue;
+        }
+        if(reply.Status != FLASH_PROTO_OK)
+        {
+            Client->Seq = (uint8_t)(seq0 + sent);
+            Client->FailAddress = reply.Address;
+            return reply.Status;
+        }
+        base += d + 1;
+        tries = 0;
+    }
+
+    Client->Seq = (uint8_t)(seq0 + pages);
+    return FLASH_PROTO_OK;
+}
+
+/*********************************************************************
+ * @fn      PROG_Verify
+ *
+ * @brief   Has the device compare a range with the CRC of Data.
+ *
+ * @param   Address - word aligned.
+ *          Data - what the range should hold.
+ *          Length - bytes, a multiple of 4.
+ *          Crc - CRC the device computed, may be NULL.
+ *
+ * @return  FLASH_PROTO_OK, FLASH_PROTO_ERR_MISMATCH, or an error.
+ */
+int PROG_Verify(PROG_ClientTypeDef *Client, uint32_t Address, const void *Data, uint32_t Length, uint32_t *Crc)
+{
+    FLASH_ProtoMsgTypeDef req, reply;
+    int                   r;
+
+    if((Address | Length) & 3)
+        return PROG_ERR_ARG;
+    memset(&req, 0, FLASH_PROTO_HDR_SIZE + 8);
+    req.Cmd = FLASH_PROTO_VERIFY;
+    req.Address = Address;
+    req.u.Arg[0] = Length;
+    req.u.Arg[1] = PROG_CrcWords(Data, Length);
+    r = prog_request(Client, &req, FLASH_PROTO_HDR_SIZE + 8, Client->Timeout_ms, &reply);
+    if(Crc && (r == FLASH_PROTO_OK || r == FLASH_PROTO_ERR_MISMATCH))
+        *Crc = reply.u.Arg[1];
+    return r;
+}
+
+/*********************************************************************
+ * @fn      PROG_Reboot
+ *
+ * @brief   Resets the device; it replies first.
+ *
+ * @return  FLASH_PROTO_OK, or an error.
+ */
+int PROG_Reboot(PROG_ClientTypeDef *Client)
+{
+    FLASH_ProtoMsgTypeDef req, reply;
+
+    memset(&req, 0, FLASH_PROTO_HDR_SIZE);
+    req.Cmd = FLASH_PROTO_REBOOT;
+    return prog_request(Client, &req, FLASH_PROTO_HDR_SIZE, Client->Timeout_ms, &reply);
+}
@@ -0,0 +1,77 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : prog_client.h
+ * Author             : typetrade
+ * Version            : V1.0.0
+ * Date               : 2026/10/17
+ * Description        : Host side of the flash_proto.h protocol, over any
+ *                      byte link.
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+#ifndef __PROG_CLIENT_H
+#define __PROG_CLIENT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "cobs.h"
+#include "flash_proto.h"
+
+/* Results besides the FLASH_ProtoStatus of a reply */
+#define PROG_ERR_TIMEOUT           (-1) /* No reply, Retries times in a row */
+#define PROG_ERR_LINK              (-2) /* Send or Recv failed */
+#define PROG_ERR_ARG               (-3) /* Misaligned request */
+
+/* Byte link to the device */
+typedef struct
+{
+    int (*Send)(void *Link, const uint8_t *Data, uint32_t Length);                  /* 0 when all sent */
+    int (*Recv)(void *Link, uint8_t *Data, uint32_t Max, uint32_t Timeout_ms);      /* Bytes, 0 after
+                                                                                       Timeout_ms, -1 */
+    void *Link;
+} PROG_LinkTypeDef;
+
+/* Client counters */
+typedef struct
+{
+    uint32_t Requests;          /* Requests sent */
+    uint32_t Resent;            /* Of which sent again after a timeout */
+    uint32_t BadReplies;        /* Replies dropped: CRC, framing, or not awaited */
+    uint64_t TxBytes;
+    uint64_t RxBytes;
+} PROG_StatsTypeDef;
+
+typedef struct
+{
+    PROG_LinkTypeDef    Link;
+    uint8_t             Window;         /* WRITE requests outstanding, 1 to FLASH_PROTO_WINDOW */
+    uint32_t            Timeout_ms;     /* Reply wait before sending again, erase time added */
+    uint8_t             Retries;        /* Sends again in a row before PROG_ERR_TIMEOUT */
+    uint32_t            Start;          /* Writable range, from PROG_Sync */
+    uint32_t            End;
+    uint32_t            FailAddress;    /* Address of the last failed request */
+    PROG_StatsTypeDef   Stats;
+    uint8_t             Seq;
+    COBS_DecoderTypeDef Dec;
+    uint8_t             Frame[FLASH_PROTO_MSG_MAX + 4];
+    uint8_t             Rx[512];
+    uint32_t            RxPos;
+    uint32_t            RxLength;
+} PROG_ClientTypeDef;
+
+void     PROG_Init(PROG_ClientTypeDef *Client, const PROG_LinkTypeDef *Link);
+int      PROG_Sync(PROG_ClientTypeDef *Client);
+int      PROG_Erase(PROG_ClientTypeDef *Client, uint32_t Address, uint32_t Length);
+int      PROG_Write(PROG_ClientTypeDef *Client, uint32_t Address, const void *Data, uint32_t Length);
+int      PROG_Verify(PROG_ClientTypeDef *Client, uint32_t Address, const void *Data, uint32_t Length, uint32_t *Crc);
+int      PROG_Reboot(PROG_ClientTypeDef *Client);
+uint32_t PROG_Crc32(const void *Data, uint32_t Length);
+uint32_t PROG_CrcWords(const void *Data, uint32_t Length);
+const char *PROG_StatusName(int Status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __PROG_CLIENT_H */
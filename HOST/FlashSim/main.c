@@ -0,0 +1,304 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : main.c
+ * Author             : typetrade
+ * Version            : V1.0.0
+ * Date               : 2026/10/17
+ * Description        : Runs every function of ch32v20x_flash.c against the
+ *                      host FLASH simulator and reports simulated busy time.
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include "ch32v20x.h"
+#include "sim_flash.h"
+#include "sim_test.h"
+#include "flash_write.h"
+#include "flash_erase.h"
+#include "eeprom_cache.h"
+
+#define SIM_TEST_ADDR          ((uint32_t)0x08008000)
+
+/* Flash word at an offset of the EEPROM cache area */
+#define EC_WORD(offset)        (*(uint32_t *)(uintptr_t)(EEPROM_CACHE_BASE + (offset)))
+
+/* Only declared for CH32V20x_D8/D8W, but always built by ch32v20x_flash.c */
+FLASH_Status EEPROM_READ(uint32_t StartAddr, void *Buffer, uint32_t Length);
+FLASH_Status EEPROM_ERASE(uint32_t StartAddr, uint32_t Length);
+FLASH_Status EEPROM_WRITE(uint32_t StartAddr, void *Buffer, uint32_t Length);
+void         FLASH_GetMACAddress(uint8_t *Buffer);
+
+/*********************************************************************
+ * @fn      report
+ *
+ * @brief   Prints one line per driver call: status, elapsed and busy time.
+ *
+ * @return  none
+ */
+static void report(const char *name, int ok, uint64_t t0, uint64_t b0)
+{
+    SIM_FLASH_StatsTypeDef st;
+
+    SIM_FLASH_GetStats(&st);
+    printf("%-48s %-4s %12.3f us elapsed %12.3f us busy\n", name, ok ? "ok" : "FAIL",
+           (SIM_GetTime_ns() - t0) / 1000.0, (st.Busy_ns - b0) / 1000.0);
+    if(!ok)
+        fails++;
+}
+
+#define RUN(name, expr, check)                            \
+    do {                                                  \
+        SIM_FLASH_StatsTypeDef st_;                       \
+        uint64_t t0_ = SIM_GetTime_ns();                  \
+        SIM_FLASH_GetStats(&st_);                         \
+        expr;                                             \
+        report(name, (check), t0_, st_.Busy_ns);          \
+    } while(0)
+
+/*********************************************************************
+ * @fn      check_fill
+ *
+ * @brief   Checks that Length bytes at Address read back as Value words.
+ *
+ * @return  1 when all words match.
+ */
+static int check_fill(uint32_t Address, uint32_t Length, uint32_t Value)
+{
+    uint32_t i;
+
+    for(i = 0; i < Length; i += 4){
+        if(*(uint32_t *)(uintptr_t)(Address + i) != Value)
+            return 0;
+    }
+    return 1;
+}
+
+/*********************************************************************
+ * @fn      main
+ *
+ * @brief   Main program.
+ *
+ * @return  0 if every call behaved as expected.
+ */
+int main(void)
+{
+    SIM_FLASH_StatsTypeDef st;
+    FLASH_Status status = FLASH_COMPLETE;
+    uint32_t     buf[64];
+    uint32_t     word = 0;
+    uint8_t      mac[6];
+    uint8_t      blob[3001];
+    uint8_t      edge[4];
+    FLASH_EraseStepTypeDef steps[8];
+    FLASH_EraseStatsTypeDef es;
+    FLASH_WriteStatsTypeDef ws;
+    EEPROM_CacheStatsTypeDef cs;
+    FLASH_OpStatsTypeDef os;
+    SIM_FLASH_TimingTypeDef tm;
+    uint32_t     n;
+    uint32_t     i;
+    uint32_t     ops;
+    uint32_t     clk;
+
+    if(SIM_FLASH_Init() != 0)
+        return 2;
+
+    for(i = 0; i < 64; i++){
+        buf[i] = 0x5A000000 | i;
+    }
+
+    printf("Standard mode\n");
+    RUN("FLASH_Unlock", FLASH_Unlock(), (FLASH->CTLR & 0x80) == 0);
+    RUN("FLASH_ClearFlag", FLASH_ClearFlag(FLASH_FLAG_BSY | FLASH_FLAG_EOP | FLASH_FLAG_PGERR | FLASH_FLAG_WRPRTERR), 1);
+    RUN("FLASH_ErasePage", status = FLASH_ErasePage(SIM_TEST_ADDR), status == FLASH_COMPLETE && check_fill(SIM_TEST_ADDR, 4096, SIM_FLASH_ERASED_WORD));
+    RUN("FLASH_ProgramHalfWord", status = FLASH_ProgramHalfWord(SIM_TEST_ADDR, 0xAAAA), status == FLASH_COMPLETE && *(uint16_t *)(uintptr_t)SIM_TEST_ADDR == 0xAAAA);
+    RUN("FLASH_ProgramHalfWord (not erased)", status = FLASH_ProgramHalfWord(SIM_TEST_ADDR, 0x5555), status == FLASH_ERROR_PG);
+    RUN("FLASH_GetFlagStatus", word = FLASH_GetFlagStatus(FLASH_FLAG_PGERR), word == SET);
+    RUN("FLASH_GetStatus", status = FLASH_GetStatus(), status == FLASH_ERROR_PG);
+    RUN("FLASH_ClearFlag", FLASH_ClearFlag(FLASH_FLAG_PGERR | FLASH_FLAG_EOP), FLASH_GetBank1Status() == FLASH_COMPLETE);
+    RUN("FLASH_ProgramWord", status = FLASH_ProgramWord(SIM_TEST_ADDR + 4, 0x12345678), status == FLASH_COMPLETE && *(uint32_t *)(uintptr_t)(SIM_TEST_ADDR + 4) == 0x12345678);
+    RUN("FLASH_GetBank1Status", status = FLASH_GetBank1Status(), status == FLASH_COMPLETE);
+    RUN("FLASH_WaitForLastOperation", status = FLASH_WaitForLastOperation(0x5000), status == FLASH_COMPLETE);
+    RUN("FLASH_WaitForLastBank1Operation", status = FLASH_WaitForLastBank1Operation(0x5000), status == FLASH_COMPLETE);
+    RUN("FLASH_ITConfig", FLASH_ITConfig(FLASH_IT_EOP, ENABLE); FLASH_ITConfig(FLASH_IT_EOP, DISABLE), (FLASH->CTLR & FLASH_IT_EOP) == 0);
+    RUN("FLASH_Access_Clock_Cfg", FLASH_Access_Clock_Cfg(FLASH_Access_SYSTEM), (FLASH->CTLR & FLASH_Access_SYSTEM) != 0);
+    RUN("FLASH_Enhance_Mode", FLASH_Enhance_Mode(DISABLE), 1);
+    RUN("FLASH_EraseAllPages", status = FLASH_EraseAllPages(), status == FLASH_COMPLETE && check_fill(SIM_TEST_ADDR, 8, SIM_FLASH_ERASED_WORD));
+    RUN("FLASH_EraseAllBank1Pages", status = FLASH_EraseAllBank1Pages(), status == FLASH_COMPLETE);
+
+    printf("EEPROM emulation\n");
+    word = 0xC0FFEE11;
+    RUN("EEPROM_ERASE", status = EEPROM_ERASE(0, 4096), status == FLASH_COMPLETE);
+    RUN("EEPROM_WRITE", status = EEPROM_WRITE(0, &word, 4), status == FLASH_COMPLETE);
+    word = 0;
+    RUN("EEPROM_READ", status = EEPROM_READ(0, &word, 4), status == FLASH_COMPLETE && word == 0xC0FFEE11);
+    RUN("FLASH_GetMACAddress", FLASH_GetMACAddress(mac), mac[0] == 0x84);
+
+    printf("Option bytes\n");
+    RUN("FLASH_GetReadOutProtectionStatus", word = FLASH_GetReadOutProtectionStatus(), word == RESET);
+    RUN("FLASH_GetUserOptionByte", word = FLASH_GetUserOptionByte(), word == 0xFF);
+    RUN("FLASH_GetWriteProtectionOptionByte", word = FLASH_GetWriteProtectionOptionByte(), word == 0xFFFFFFFF);
+    RUN("FLASH_EraseOptionBytes", status = FLASH_EraseOptionBytes(), status == FLASH_COMPLETE);
+    RUN("FLASH_ProgramOptionByteData", status = FLASH_ProgramOptionByteData(0x1FFFF804, 0x3C), status == FLASH_COMPLETE && OB->Data0 == 0xC33C);
+    RUN("FLASH_UserOptionByteConfig", status = FLASH_UserOptionByteConfig(OB_IWDG_SW, OB_STOP_NoRST, OB_STDBY_NoRST), status == FLASH_COMPLETE && (OB->USER & 0xFF) == 0xFF);
+    RUN("FLASH_EnableWriteProtection", status = FLASH_EnableWriteProtection(FLASH_WRProt_Sectors8), status == FLASH_COMPLETE && (OB->WRPR1 & 0xFF) == 0xFE);
+    RUN("FLASH_ReadOutProtection", status = FLASH_ReadOutProtection(DISABLE), status == FLASH_COMPLETE && OB->RDPR == 0x5AA5);
+    RUN("FLASH_Lock", FLASH_Lock(), (FLASH->CTLR & 0x80) != 0);
+
+    printf("Fast mode\n");
+    SIM_FLASH_Reset();
+    RUN("FLASH_UnlockBank1", FLASH_UnlockBank1(), (FLASH->CTLR & 0x80) == 0);
+    RUN("FLASH_LockBank1", FLASH_LockBank1(), (FLASH->CTLR & 0x80) != 0);
+    RUN("FLASH_Unlock_Fast", FLASH_Unlock_Fast(), (FLASH->CTLR & 0x8080) == 0);
+    RUN("FLASH_EraseBlock_64K_Fast", FLASH_EraseBlock_64K_Fast(0x08000000), check_fill(0x08000000, 65536, SIM_FLASH_ERASED_WORD));
+    RUN("FLASH_EraseBlock_32K_Fast", FLASH_EraseBlock_32K_Fast(SIM_TEST_ADDR), check_fill(SIM_TEST_ADDR, 32768, SIM_FLASH_ERASED_WORD));
+    RUN("FLASH_ProgramPage_Fast", FLASH_ProgramPage_Fast(SIM_TEST_ADDR, buf), memcmp((void *)(uintptr_t)SIM_TEST_ADDR, buf, 256) == 0);
+    RUN("FLASH_ErasePage_Fast", FLASH_ErasePage_Fast(SIM_TEST_ADDR), check_fill(SIM_TEST_ADDR, 256, SIM_FLASH_ERASED_WORD));
+    RUN("FLASH_ProgramPage_Fast x128 (32K)",
+        for(i = 0; i < 128; i++) FLASH_ProgramPage_Fast(SIM_TEST_ADDR + 256 * i, buf),
+        memcmp((void *)(uintptr_t)(SIM_TEST_ADDR + 256 * 127), buf, 256) == 0);
+    RUN("FLASH_Lock_Fast", FLASH_Lock_Fast(), (FLASH->CTLR & 0x8080) == 0x8080);
+
+    printf("Bulk write\n");
+    for(i = 0; i < sizeof(blob); i++){
+        blob[i] = (uint8_t)(i * 7 + 3);
+    }
+    memcpy(edge, (void *)(uintptr_t)SIM_TEST_ADDR, 3);
+    edge[3] = *(uint8_t *)(uintptr_t)(SIM_TEST_ADDR + 3 + 3000);
+    RUN("FLASH_Write unaligned 3000B", status = FLASH_Write(SIM_TEST_ADDR + 3, blob + 1, 3000),
+        status == FLASH_COMPLETE && memcmp((void *)(uintptr_t)(SIM_TEST_ADDR + 3), blob + 1, 3000) == 0 &&
+        memcmp((void *)(uintptr_t)SIM_TEST_ADDR, edge, 3) == 0 && *(uint8_t *)(uintptr_t)(SIM_TEST_ADDR + 3 + 3000) == edge[3] &&
+        (FLASH->CTLR & 0x8080) == 0x8080);
+    SIM_FLASH_GetStats(&st);
+    word = st.Op[SIM_OP_PAGE_ERASE].Count;
+    RUN("FLASH_Write 16B into erased flash", status = FLASH_Write(0x08010010, blob, 16),
+        status == FLASH_COMPLETE && memcmp((void *)(uintptr_t)0x08010010, blob, 16) == 0 &&
+        (SIM_FLASH_GetStats(&st), st.Op[SIM_OP_PAGE_ERASE].Count == word));
+
+    FLASH_Write_DeltaCmd(ENABLE);
+    FLASH_Write_ClearStats();
+    blob[1000] ^= 0xFF;
+    RUN("FLASH_Write (delta, one page changed)", status = FLASH_Write(SIM_TEST_ADDR + 3, blob + 1, 3000),
+        status == FLASH_COMPLETE && memcmp((void *)(uintptr_t)(SIM_TEST_ADDR + 3), blob + 1, 3000) == 0 &&
+        (FLASH_Write_GetStats(&ws), ws.PagesWritten == 1 && ws.PagesSkipped == 11 && ws.SavedTime_us == 11 * 3600));
+    blob[1000] ^= 0xFF;
+    FLASH_Write_DeltaCmd(DISABLE);
+
+    printf("Erase planner\n");
+    RUN("FLASH_Erase_Plan", n = FLASH_Erase_Plan(0x08007F00, 0x08030200 - 0x08007F00, steps, 8),
+        n == 6 && steps[0].Op == FLASH_ERASE_256B && steps[1].Op == FLASH_ERASE_32K && steps[1].Address == 0x08008000 &&
+        steps[2].Op == FLASH_ERASE_64K && steps[3].Op == FLASH_ERASE_64K && steps[4].Op == FLASH_ERASE_256B && steps[5].Address == 0x08030100);
+    RUN("FLASH_Erase_Plan (unaligned)", n = FLASH_Erase_Plan(0x08008010, 0x1000, NULL, 0), n == 0);
+    RUN("FLASH_Erase_End (ESIG flash size)", word = FLASH_Erase_End(), word == SIM_FLASH_BASE + SIM_FLASH_SIZE);
+    RUN("FLASH_EraseRange (past the end)", status = FLASH_EraseRange(word - 4096, 8192),
+        status == FLASH_ERROR_PG && !FLASH_Erase_IsBlank(word - 4096, 8192));
+    RUN("FLASH_Erase_EstimateTime", word = FLASH_Erase_EstimateTime(0x08007F00, 0x08030200 - 0x08007F00), word == 2400 * 3 + 9600 + 12000 * 2);
+    FLASH_Write(0x08007EFC, blob, 4);
+    FLASH_Write(0x08030200, blob, 4);
+    SIM_FLASH_GetStats(&st);
+    RUN("FLASH_EraseRange", status = FLASH_EraseRange(0x08007F00, 0x08030200 - 0x08007F00),
+        status == FLASH_COMPLETE && check_fill(0x08007F00, 0x08030200 - 0x08007F00, SIM_FLASH_ERASED_WORD) &&
+        memcmp((void *)(uintptr_t)0x08007EFC, blob, 4) == 0 && memcmp((void *)(uintptr_t)0x08030200, blob, 4) == 0 &&
+        (FLASH->CTLR & 0x80) != 0);
+    FLASH_Erase_BlankCheckCmd(ENABLE);
+    FLASH_Erase_ClearStats();
+    SIM_FLASH_GetStats(&st);
+    word = st.Op[SIM_OP_BLOCK32_ERASE].Count + st.Op[SIM_OP_BLOCK64_ERASE].Count + st.Op[SIM_OP_PAGE_ERASE].Count;
+    RUN("FLASH_EraseRange (blank check, blank)", status = FLASH_EraseRange(0x08007F00, 0x08030200 - 0x08007F00),
+        status == FLASH_COMPLETE && (SIM_FLASH_GetStats(&st), FLASH_Erase_GetStats(&es),
+        st.Op[SIM_OP_BLOCK32_ERASE].Count + st.Op[SIM_OP_BLOCK64_ERASE].Count + st.Op[SIM_OP_PAGE_ERASE].Count == word) &&
+        es.Skipped[FLASH_ERASE_64K] == 2 && es.Skipped[FLASH_ERASE_32K] == 1 && es.Skipped[FLASH_ERASE_256B] == 3 &&
+        es.SavedTime_us == FLASH_Erase_EstimateTime(0x08007F00, 0x08030200 - 0x08007F00));
+    FLASH_Write(0x08009000, blob, 8);
+    FLASH_Erase_ClearStats();
+    RUN("FLASH_EraseRange (blank check, one dirty block)", status = FLASH_EraseRange(0x08007F00, 0x08030200 - 0x08007F00),
+        status == FLASH_COMPLETE && check_fill(0x08009000, 8, SIM_FLASH_ERASED_WORD) &&
+        (FLASH_Erase_GetStats(&es), es.Erased[FLASH_ERASE_32K] == 1 && es.Skipped[FLASH_ERASE_64K] == 2));
+    FLASH_Erase_ClearStats();
+    RUN("FLASH_Write (blank check, erased page)", status = FLASH_Write(0x08008000, blob, 256),
+        status == FLASH_COMPLETE && (FLASH_Erase_GetStats(&es), es.Skipped[FLASH_ERASE_256B] == 1 && es.Erased[FLASH_ERASE_256B] == 0));
+    FLASH_Erase_BlankCheckCmd(DISABLE);
+    RUN("EEPROM_ERASE 4096 erases one page", (FLASH_Unlock(), FLASH_ProgramWord(0x08071000, 0x11223344), status = EEPROM_ERASE(0, 4096), FLASH_Lock()),
+        status == FLASH_COMPLETE && *(uint32_t *)(uintptr_t)0x08071000 == 0x11223344);
+
+    printf("EEPROM cache\n");
+    EEPROM_Cache_Init();
+    SIM_FLASH_GetStats(&st);
+    ops = st.Op[SIM_OP_PAGE_ERASE].Count + st.Op[SIM_OP_PAGE_PROGRAM].Count + st.Op[SIM_OP_HALFWORD].Count;
+    RUN("EEPROM_Cache_Write x200 (4B, one page)",
+        for(i = 0; i < 200; i++) { word = i; EEPROM_Cache_Write(0x0000 + (i % 64) * 4, &word, 4); },
+        (SIM_FLASH_GetStats(&st), st.Op[SIM_OP_PAGE_ERASE].Count + st.Op[SIM_OP_PAGE_PROGRAM].Count + st.Op[SIM_OP_HALFWORD].Count == ops) &&
+        (EEPROM_Cache_GetStats(&cs), cs.Coalesced == 199));
+    RUN("EEPROM_Cache_Read (hit)", status = EEPROM_Cache_Read(0x0000 + 7 * 4, &word, 4),
+        status == FLASH_COMPLETE && word == 199 && (EEPROM_Cache_GetStats(&cs), cs.ReadHits == 1) &&
+        EC_WORD(0x0000 + 7 * 4) == SIM_FLASH_ERASED_WORD);
+    RUN("EEPROM_Cache_Sync", status = EEPROM_Cache_Sync(),
+        status == FLASH_COMPLETE && EC_WORD(0x0000 + 7 * 4) == 199 &&
+        (SIM_FLASH_GetStats(&st), st.Op[SIM_OP_PAGE_ERASE].Count + st.Op[SIM_OP_PAGE_PROGRAM].Count + st.Op[SIM_OP_HALFWORD].Count == ops + 2));
+    word = 0xA5A5A5A5;
+    EEPROM_Cache_Write(0x0102, &word, 4);
+    RUN("EEPROM_Cache_Tick (timeout)", (EEPROM_Cache_Tick(EEPROM_CACHE_TIMEOUT_MS - 1), n = EC_WORD(0x0100), status = EEPROM_Cache_Tick(EEPROM_CACHE_TIMEOUT_MS)),
+        status == FLASH_COMPLETE && n == SIM_FLASH_ERASED_WORD && memcmp((void *)(uintptr_t)(EEPROM_CACHE_BASE + 0x0102), &word, 4) == 0 &&
+        (EEPROM_Cache_GetStats(&cs), cs.Timeouts == 1 && cs.Flushes == 2));
+    RUN("EEPROM_Cache_Write (evicts LRU page)",
+        for(i = 0; i <= EEPROM_CACHE_PAGES; i++) { word = 0x1000 + i; EEPROM_Cache_Write(0x0800 + 256 * i, &word, 4); },
+        (EEPROM_Cache_GetStats(&cs), cs.Evictions >= 1) && EC_WORD(0x0800) == 0x1000);
+    RUN("EEPROM_Cache_Write (outside area)", status = EEPROM_Cache_Write(EEPROM_CACHE_AREA - 2, &word, 4), status == FLASH_ERROR_PG);
+    EEPROM_Cache_Sync();
+    word = 0x5A5A0001;
+    EEPROM_Cache_Write(0x1000, &word, 4);
+    RUN("EEPROM_READ after EEPROM_Cache_Write (dirty page)", (word = 0, status = EEPROM_READ(0x1000, &word, 4)),
+        status == FLASH_COMPLETE && word == 0x5A5A0001 && EC_WORD(0x1000) == SIM_FLASH_ERASED_WORD);
+    word = 0x5A5A0002;
+    RUN("EEPROM_WRITE to a cached page (written back)", (FLASH_Unlock(), status = EEPROM_WRITE(0x1004, &word, 4), FLASH_Lock()),
+        status == FLASH_COMPLETE && EC_WORD(0x1004) == SIM_FLASH_ERASED_WORD &&
+        (EEPROM_Cache_GetStats(&cs), cs.EepromWrites == 1) && EEPROM_Cache_Sync() == FLASH_COMPLETE &&
+        EC_WORD(0x1000) == 0x5A5A0001 && EC_WORD(0x1004) == 0x5A5A0002);
+    word = 0x5A5A0003;
+    RUN("EEPROM_WRITE to an uncached page (written back)", (FLASH_Unlock(), status = EEPROM_WRITE(0x1800, &word, 4), FLASH_Lock()),
+        status == FLASH_COMPLETE && EC_WORD(0x1800) == SIM_FLASH_ERASED_WORD &&
+        (EEPROM_Cache_GetStats(&cs), cs.EepromWrites == 2) && EEPROM_Cache_Sync() == FLASH_COMPLETE &&
+        EC_WORD(0x1800) == 0x5A5A0003);
+    EEPROM_Cache_Write(0x1000, &word, 4);
+    RUN("EEPROM_ERASE erases the area, drops cached pages", (FLASH_Unlock(), status = EEPROM_ERASE(0x1000, 4096), FLASH_Lock()),
+        status == FLASH_COMPLETE && (EEPROM_Cache_GetStats(&cs), cs.Dropped == 2) && EEPROM_Cache_Sync() == FLASH_COMPLETE &&
+        EC_WORD(0x1000) == SIM_FLASH_ERASED_WORD && EC_WORD(0x1800) == SIM_FLASH_ERASED_WORD &&
+        EEPROM_READ(0x1000, &word, 4) == FLASH_COMPLETE && word == SIM_FLASH_ERASED_WORD);
+    RUN("EEPROM_ERASE (outside area)", status = EEPROM_ERASE(EEPROM_CACHE_AREA, 4096), status == FLASH_ERROR_PG);
+
+    printf("Timeouts\n");
+    FLASH_Unlock();
+    FLASH_ClearOpStats();
+    RUN("FLASH_ErasePage (busy time recorded)", status = FLASH_ErasePage(SIM_TEST_ADDR),
+        status == FLASH_COMPLETE && (FLASH_GetOpStats(FLASH_OP_PAGE_ERASE, &os), os.Count == 1 && os.Last_us >= 4800 && os.Last_us <= 4810));
+    SIM_FLASH_GetTiming(&tm);
+    tm.SIM_SkipBusyPolls = 0;
+    SIM_FLASH_SetTiming(&tm);
+    word = FLASH_GetOpTimeout(FLASH_OP_PAGE_ERASE);
+    FLASH_SetOpTimeout(FLASH_OP_PAGE_ERASE, 1000);
+    clk = SystemCoreClock;
+    SystemCoreClock = 24000000;
+    RUN("FLASH_ErasePage (1ms budget, 24MHz)", status = FLASH_ErasePage(SIM_TEST_ADDR),
+        status == FLASH_TIMEOUT && (FLASH_GetOpStats(FLASH_OP_PAGE_ERASE, &os), os.Timeouts == 1 && os.Last_us >= 1000 && os.Last_us <= 1010));
+    FLASH_WaitForLastOperation(10000);
+    SystemCoreClock = 144000000;
+    RUN("FLASH_ErasePage (1ms budget, 144MHz)", status = FLASH_ErasePage(SIM_TEST_ADDR),
+        status == FLASH_TIMEOUT && (FLASH_GetOpStats(FLASH_OP_PAGE_ERASE, &os), os.Timeouts == 2 && os.Last_us >= 1000 && os.Last_us <= 1010));
+    RUN("FLASH_WaitForLastOperation (10ms)", status = FLASH_WaitForLastOperation(10000), status == FLASH_COMPLETE);
+    SystemCoreClock = clk;
+    FLASH_SetOpTimeout(FLASH_OP_PAGE_ERASE, word);
+    tm.SIM_SkipBusyPolls = 1;
+    SIM_FLASH_SetTiming(&tm);
+    FLASH_Lock();
+
+    SIM_FLASH_GetStats(&st);
+    printf("\nOperations since last reset\n");
+    for(i = 0; i < SIM_OP_NUM; i++){
+        if(st.Op[i].Count)
+            printf("  %-20s %8u ops %14.3f us\n", SIM_OpName((SIM_OpTypeDef)i), st.Op[i].Count, st.Op[i].Busy_ns / 1000.0);
+    }
+    printf("  register reads %u, writes %u, PGERR %u, WRPRTERR %u, stray writes %u\n",
+           st.RegReads, st.RegWrites, st.PgErrors, st.WrpErrors, st.StrayWrites);
+    printf("  simulated time %.3f ms, busy %.3f ms\n", SIM_GetTime_ns() / 1e6, st.Busy_ns / 1e6);
+
+    return fails ? 1 : 0;
+}
@@ -0,0 +1,210 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : main.c
+ * Author             : typetrade
+ * Version            : V1.0.0
+ * Date               : 2026/10/17
+ * Description        : Drives the streaming writer of User/flash_stream.c
+ *                      against the host FLASH simulator: a producer that
+ *                      never runs dry, held back only by the writer, must
+ *                      keep the controller busy; a producer that spends
+ *                      CPU time per page is compared with producing and
+ *                      programming in turn; bursts after pauses must not
+ *                      wait for an erase; then the end of the region.
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include "flash_async.h"
+#include "flash_stream.h"
+#include "sim_flash.h"
+#include "sim_test.h"
+
+#define STREAM_ADDR            ((uint32_t)0x08010000)
+#define STREAM_SIZE            (128 * 1024)
+#define COST_ADDR              ((uint32_t)0x08030000)
+#define COST_SIZE              (64 * 1024)
+#define SYNC_ADDR              ((uint32_t)0x08040000)
+#define BURST_ADDR             ((uint32_t)0x08050000)
+#define BURST_SIZE             (64 * 1024)
+#define BURST_LEN              4096
+
+/* One main loop pass while the writer holds the producer back */
+#define LOOP_NS                5000
+/* Producer CPU time per 32 bytes: 1ms per page */
+#define COST_NS_PER_32B        125000
+#define PAUSE_NS               40000000ULL
+
+static FLASH_StreamTypeDef stream;
+static uint8_t             data[STREAM_SIZE];
+static uint32_t            page[64];
+static uint32_t            readies;
+
+/*********************************************************************
+ * @fn      on_ready
+ *
+ * @brief   Ready callback.
+ *
+ * @return  none
+ */
+static void on_ready(void *Context)
+{
+    readies++;
+}
+
+/*********************************************************************
+ * @fn      feed
+ *
+ * @brief   Writes Length bytes in Chunk pieces, spending Cost_ns per
+ *          piece to produce it and running the main loop whenever the
+ *          writer holds it back.
+ *
+ * @return  none
+ */
+static void feed(const uint8_t *Data, uint32_t Length, uint32_t Chunk, uint64_t Cost_ns)
+{
+    uint32_t n, m;
+
+    while(Length)
+    {
+        n = Length < Chunk ? Length : Chunk;
+        if(Cost_ns)
+            SIM_AdvanceTime_ns(Cost_ns);
+        while(n)
+        {
+            m = FLASH_Stream_Write(&stream, Data, n);
+            Data += m;
+            Length -= m;
+            n -= m;
+            if(n)
+            {
+                FLASH_Stream_Poll(&stream);
+                SIM_AdvanceTime_ns(LOOP_NS);
+            }
+        }
+    }
+}
+
+/*********************************************************************
+ * @fn      drain
+ *
+ * @brief   Flushes and runs the main loop until the writer is idle.
+ *
+ * @return  none
+ */
+static void drain(void)
+{
+    while(FLASH_Stream_Flush(&stream) != SUCCESS)
+    {
+        SIM_AdvanceTime_ns(LOOP_NS);
+    }
+    while(!FLASH_Stream_Idle(&stream))
+    {
+        SIM_AdvanceTime_ns(LOOP_NS);
+    }
+}
+
+/*********************************************************************
+ * @fn      main
+ *
+ * @brief   Main program.
+ *
+ * @return  0 if every check passed.
+ */
+int main(void)
+{
+    SIM_FLASH_TimingTypeDef tm;
+    uint64_t                t0, t, busy, t_sync, burst, burst_max = 0;
+    uint32_t                i, len, pages;
+    uint8_t                 tail[256];
+
+    if(SIM_FLASH_Init() != 0)
+        return 2;
+    SIM_FLASH_GetTiming(&tm);
+
+    for(i = 0; i < STREAM_SIZE; i++){
+        data[i] = (uint8_t)(i * 13 + (i >> 8) * 5 + (i >> 16));
+    }
+
+    FLASH_Unlock_Fast();
+    FLASH_Async_Init();
+
+    expect("misaligned region rejected", FLASH_Stream_Init(&stream, STREAM_ADDR + 256, STREAM_ADDR + 8192, NULL,
+                                                           NULL) == ERROR);
+    expect("region past the array rejected", FLASH_Stream_Init(&stream, 0x0807F000, 0x08081000, NULL, NULL) == ERROR);
+
+    /* Sustained: the producer always has data, the writer sets the pace.
+     * The controller must never idle: the time is the program and erase
+     * time of the region. The last page is a partial one. */
+    len = STREAM_SIZE - 100;
+    t0 = SIM_GetTime_ns();
+    expect("init 128K stream", FLASH_Stream_Init(&stream, STREAM_ADDR, STREAM_ADDR + STREAM_SIZE, on_ready, NULL) ==
+           SUCCESS);
+    feed(data, len, 100, 0);
+    drain();
+    t = SIM_GetTime_ns() - t0;
+    pages = STREAM_SIZE / FLASH_STREAM_PAGE_SIZE;
+    busy = pages * tm.SIM_OpTime[SIM_OP_PAGE_PROGRAM] + stream.Stats.Erases * tm.SIM_OpTime[SIM_OP_BLOCK32_ERASE];
+    memset(tail, 0xFF, sizeof(tail));
+    expect("  flash holds the stream", memcmp((void *)(uintptr_t)STREAM_ADDR, data, len) == 0);
+    expect("  partial last page padded by Flush", memcmp((void *)(uintptr_t)(STREAM_ADDR + len), tail, 100) == 0);
+    expect("  4 32K erases, every page programmed", stream.Stats.Erases == 4 && stream.Stats.Pages == pages &&
+           FLASH_Stream_Status(&stream) == FLASH_COMPLETE);
+    expect("  producer held back, woken by Ready", stream.Stats.Stalls > 0 && readies > 0 &&
+           readies <= stream.Stats.Stalls);
+    printf("  %u bytes in %llu us: %llu KB/s, page program alone %llu KB/s\n", len, (unsigned long long)(t / 1000),
+           (unsigned long long)((uint64_t)len * 1000000000ULL / 1024 / t),
+           (unsigned long long)(FLASH_STREAM_PAGE_SIZE * 1000000000ULL / 1024 / tm.SIM_OpTime[SIM_OP_PAGE_PROGRAM]));
+    expect("  controller busy at least 98% of the time", busy * 100 >= t * 98);
+
+    /* A producer spending 1ms per page: the stream overlaps it with the
+     * 1.2ms page program, producing then programming adds them up */
+    t0 = SIM_GetTime_ns();
+    expect("init 64K stream", FLASH_Stream_Init(&stream, COST_ADDR, COST_ADDR + COST_SIZE, on_ready, NULL) ==
+           SUCCESS);
+    feed(data, COST_SIZE, 32, COST_NS_PER_32B);
+    drain();
+    t = SIM_GetTime_ns() - t0;
+    expect("  flash holds the stream", memcmp((void *)(uintptr_t)COST_ADDR, data, COST_SIZE) == 0);
+
+    t0 = SIM_GetTime_ns();
+    FLASH_EraseBlock_32K_Fast(SYNC_ADDR);
+    FLASH_EraseBlock_32K_Fast(SYNC_ADDR + 0x8000);
+    for(i = 0; i < COST_SIZE; i += FLASH_STREAM_PAGE_SIZE){
+        SIM_AdvanceTime_ns(COST_NS_PER_32B * (FLASH_STREAM_PAGE_SIZE / 32));
+        memcpy(page, data + i, FLASH_STREAM_PAGE_SIZE);
+        FLASH_ProgramPage_Fast(SYNC_ADDR + i, page);
+    }
+    t_sync = SIM_GetTime_ns() - t0;
+    expect("  same data produced then programmed in turn",
+           memcmp((void *)(uintptr_t)SYNC_ADDR, data, COST_SIZE) == 0);
+    printf("  stream %llu us, in turn %llu us: %.2fx faster\n", (unsigned long long)(t / 1000),
+           (unsigned long long)(t_sync / 1000), (double)t_sync / t);
+    expect("  stream at least 1.6x faster", t * 16 <= t_sync * 10);
+
+    /* Bursts after pauses: the erases run in the pauses */
+    expect("init 64K stream", FLASH_Stream_Init(&stream, BURST_ADDR, BURST_ADDR + BURST_SIZE, on_ready, NULL) ==
+           SUCCESS);
+    drain();
+    for(i = 0; i < BURST_SIZE; i += BURST_LEN){
+        t0 = SIM_GetTime_ns();
+        feed(data + i, BURST_LEN, 64, 0);
+        burst = SIM_GetTime_ns() - t0;
+        if(burst > burst_max)
+            burst_max = burst;
+        for(t0 = SIM_GetTime_ns(); SIM_GetTime_ns() - t0 < PAUSE_NS;){
+            FLASH_Stream_Poll(&stream);
+            SIM_AdvanceTime_ns(LOOP_NS);
+        }
+    }
+    drain();
+    printf("  longest 4K burst %llu us\n", (unsigned long long)(burst_max / 1000));
+    expect("  flash holds the bursts", memcmp((void *)(uintptr_t)BURST_ADDR, data, BURST_SIZE) == 0);
+    expect("  second 32K erased ahead, in a pause", stream.Stats.Erases == 2 && stream.Stats.ErasesAhead == 1);
+    expect("  no burst waited for an erase",
+           burst_max < (BURST_LEN / FLASH_STREAM_PAGE_SIZE - 1) * tm.SIM_OpTime[SIM_OP_PAGE_PROGRAM]);
+
+    expect("full region takes no more", FLASH_Stream_Space(&stream) == 0 &&
+           FLASH_Stream_Write(&stream, data, 16) == 0 && FLASH_Stream_Idle(&stream));
+
+    return fails ? 1 : 0;
+}
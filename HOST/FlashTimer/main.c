@@ -0,0 +1,241 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : main.c
+ * Author             : typetrade
+ * Version            : V1.0.0
+ * Date               : 2026/10/17
+ * Description        : Exercises the timebase and the timer wheel against
+ *                      simulated time: one-shot and periodic timers, long
+ *                      polling gaps, timers stopped and restarted from
+ *                      callbacks, and a flash erase retried on a deadline
+ *                      instead of a busy wait.
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include "debug.h"
+#include "sim_flash.h"
+#include "sim_test.h"
+#include "timebase.h"
+#include "timer_wheel.h"
+
+#define ERASE_ADDR             ((uint32_t)0x08008000)
+
+/* Fire log */
+static uint32_t fired_at[64];
+static void    *fired_arg[64];
+static uint32_t fired = 0;
+
+static TIMER_TypeDef ta, tb, tc;
+
+/* Erase retry state */
+static TIMER_TypeDef erase_timer;
+static uint64_t      erase_deadline;
+static uint32_t      erase_tries = 0;
+static int           erase_result = -1;
+
+/*********************************************************************
+ * @fn      ms
+ *
+ * @brief   Simulated time.
+ *
+ * @return  Milliseconds since Timebase_Init.
+ */
+static uint32_t ms(void)
+{
+    return (uint32_t)(now_us() / 1000);
+}
+
+/*********************************************************************
+ * @fn      align_ms
+ *
+ * @brief   Advances simulated time to the next whole millisecond and
+ *          polls, so the tests below start on a tick.
+ *
+ * @return  none
+ */
+static void align_ms(void)
+{
+    SIM_AdvanceTime_ns(1000000 - (now_us() % 1000) * 1000);
+    Timer_Poll();
+}
+
+/*********************************************************************
+ * @fn      run_ms
+ *
+ * @brief   Advances simulated time by Total ms, polling every Step us.
+ *
+ * @return  none
+ */
+static void run_ms(uint32_t Total, uint32_t Step_us)
+{
+    uint64_t end = now_us() + (uint64_t)Total * 1000;
+
+    while(now_us() < end)
+    {
+        SIM_AdvanceTime_ns((uint64_t)Step_us * 1000);
+        Timer_Poll();
+    }
+}
+
+/*********************************************************************
+ * @fn      log_cb
+ *
+ * @brief   Records the time and Arg of the expiry.
+ *
+ * @return  none
+ */
+static void log_cb(TIMER_TypeDef *Timer, void *Arg)
+{
+    (void)Timer;
+    if(fired < 64)
+    {
+        fired_at[fired] = (uint32_t)now_us();
+        fired_arg[fired] = Arg;
+    }
+    fired++;
+}
+
+/*********************************************************************
+ * @fn      stop_cb
+ *
+ * @brief   Stops the timer passed in Arg, then logs.
+ *
+ * @return  none
+ */
+static void stop_cb(TIMER_TypeDef *Timer, void *Arg)
+{
+    Timer_Stop((TIMER_TypeDef *)Arg);
+    log_cb(Timer, Arg);
+}
+
+/*********************************************************************
+ * @fn      erase_cb
+ *
+ * @brief   One try of an erase that gives up on its deadline. The first
+ *          two tries find the controller busy, as if another job still
+ *          ran, and come back 2ms later instead of spinning.
+ *
+ * @return  none
+ */
+static void erase_cb(TIMER_TypeDef *Timer, void *Arg)
+{
+    (void)Arg;
+    erase_tries++;
+    if(erase_tries < 3)
+    {
+        if(deadline_passed(erase_deadline))
+            erase_result = 0;
+        else
+            Timer_Start(Timer, 2, 0, erase_cb, NULL);
+        return;
+    }
+    FLASH_Unlock();
+    erase_result = FLASH_ErasePage(ERASE_ADDR) == FLASH_COMPLETE;
+    FLASH_Lock();
+}
+
+/*********************************************************************
+ * @fn      main
+ *
+ * @brief   Main program.
+ *
+ * @return  0 if every check passed.
+ */
+int main(void)
+{
+    uint64_t t0, c0;
+    uint32_t start, i, n, ok;
+
+    if(SIM_FLASH_Init() != 0)
+        return 2;
+    Timebase_Init();
+
+    /* Timebase */
+    t0 = now_us();
+    c0 = now_cycles();
+    SIM_AdvanceTime_ns(1500000);
+    expect("now_us follows time", now_us() - t0 == 1500);
+    expect("now_cycles counts HCLK", now_cycles() - c0 == 1500ULL * (SystemCoreClock / 1000000));
+    t0 = now_us();
+    SystemCoreClock = 72000000;
+    Timebase_Rebase();
+    SIM_AdvanceTime_ns(1000000);
+    expect("now_us continuous across a clock change", now_us() - t0 == 1000);
+    SystemCoreClock = 144000000;
+    Timebase_Rebase();
+    t0 = deadline_us(250);
+    SIM_AdvanceTime_ns(249000);
+    ok = !deadline_passed(t0);
+    SIM_AdvanceTime_ns(1000);
+    expect("deadline passes on time", ok && deadline_passed(t0));
+
+    /* One shot: not early, once */
+    align_ms();
+    start = (uint32_t)now_us();
+    Timer_Start(&ta, 5, 0, log_cb, &ta);
+    run_ms(4, 100);
+    ok = fired == 0 && Timer_Active(&ta);
+    run_ms(10, 100);
+    expect("one-shot fires once, not early", ok && fired == 1 && fired_at[0] >= start + 5000 &&
+           fired_at[0] < start + 6100 && !Timer_Active(&ta));
+
+    /* Periodic */
+    align_ms();
+    fired = 0;
+    Timer_Start(&ta, 2, 2, log_cb, &ta);
+    run_ms(20, 250);
+    Timer_Stop(&ta);
+    n = fired;
+    ok = n == 10;
+    for(i = 1; i < fired && i < 64; i++){
+        if(fired_at[i] - fired_at[i - 1] < 1500 || fired_at[i] - fired_at[i - 1] > 2500)
+            ok = 0;
+    }
+    expect("2ms periodic fires 10 times in 20ms", ok);
+    run_ms(10, 500);
+    expect("stopped timer stays quiet", fired == n);
+
+    /* One poll after a long gap fires what is due, in order */
+    fired = 0;
+    Timer_Start(&ta, 3, 0, log_cb, &ta);
+    Timer_Start(&tb, 100, 0, log_cb, &tb);
+    Timer_Start(&tc, 40, 0, log_cb, &tc);
+    SIM_AdvanceTime_ns(50000000);
+    Timer_Poll();
+    expect("long gap: due timers fire in order", fired == 2 && fired_arg[0] == &ta && fired_arg[1] == &tc && Timer_Active(&tb));
+    run_ms(60, 1000);
+    expect("timer beyond one wheel turn fires later", fired == 3 && fired_arg[2] == &tb);
+
+    /* Two timers due in the same poll stop each other: whichever runs
+     * first, the other must not */
+    align_ms();
+    fired = 0;
+    Timer_Start(&ta, 5, 0, stop_cb, &tb);
+    Timer_Start(&tb, 5, 0, stop_cb, &ta);
+    run_ms(10, 1000);
+    expect("timer stopped by a callback does not fire", fired == 1 && !Timer_Active(&ta) && !Timer_Active(&tb));
+
+    /* Periodic timer after missed periods keeps its phase */
+    align_ms();
+    fired = 0;
+    start = (uint32_t)now_us();
+    Timer_Start(&ta, 10, 10, log_cb, &ta);
+    SIM_AdvanceTime_ns(35000000);
+    Timer_Poll();
+    run_ms(10, 500);
+    Timer_Stop(&ta);
+    expect("missed periods skipped, phase kept", fired == 2 && (fired_at[1] - start) % 10000 < 1000);
+
+    /* Erase retried on a deadline */
+    erase_deadline = deadline_us(20000);
+    Timer_Start(&erase_timer, 0, 0, erase_cb, NULL);
+    start = ms();
+    while(erase_result < 0 && ms() - start < 100)
+    {
+        SIM_AdvanceTime_ns(100000);
+        Timer_Poll();
+    }
+    expect("erase retried from the timer wheel", erase_result == 1 && erase_tries == 3);
+
+    return fails ? 1 : 0;
+}
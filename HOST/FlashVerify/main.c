@@ -0,0 +1,114 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : main.c
+ * Author             : typetrade
+ * Version            : V1.0.0
+ * Date               : 2026/10/17
+ * Description        : Runs the CRC/DMA verification of User/flash_verify.c
+ *                      against the host FLASH, CRC and DMA models: CRC
+ *                      values against a software reference, mismatch
+ *                      location, transfers split at the DMA count limit,
+ *                      and the share of the work left to the CPU.
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include "ch32v20x.h"
+#include "sim_flash.h"
+#include "sim_periph.h"
+#include "sim_test.h"
+#include "flash_verify.h"
+
+#define VERIFY_ADDR            ((uint32_t)0x08008000)
+#define VERIFY_SIZE            ((uint32_t)0x8000)
+#define BAD_PAGE               37
+
+static uint32_t image[VERIFY_SIZE / 4];
+
+/*********************************************************************
+ * @fn      ref_crc
+ *
+ * @brief   Software CRC of Words words, as the CRC unit computes it.
+ *
+ * @return  CRC.
+ */
+static uint32_t ref_crc(const uint32_t *p, uint32_t Words)
+{
+    uint32_t crc = 0xFFFFFFFF, i;
+    int      b;
+
+    for(i = 0; i < Words; i++){
+        crc ^= p[i];
+        for(b = 0; b < 32; b++){
+            crc = (crc & 0x80000000) ? (crc << 1) ^ 0x04C11DB7 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+/*********************************************************************
+ * @fn      main
+ *
+ * @brief   Main program.
+ *
+ * @return  0 if every check passed.
+ */
+int main(void)
+{
+    SIM_PERIPH_StatsTypeDef st;
+    uint32_t                i, crc, bad, page[64];
+    uint64_t                t0, dt;
+    FLASH_VerifyStatus      s;
+
+    if(SIM_FLASH_Init() != 0 || SIM_PERIPH_Init() != 0)
+        return 2;
+
+    for(i = 0; i < VERIFY_SIZE / 4; i++){
+        image[i] = i * 0x9E3779B9;
+    }
+    FLASH_Unlock_Fast();
+    FLASH_EraseBlock_32K_Fast(VERIFY_ADDR);
+    for(i = 0; i < VERIFY_SIZE / 256; i++){
+        FLASH_ProgramPage_Fast(VERIFY_ADDR + 256 * i, &image[64 * i]);
+    }
+
+    SIM_PERIPH_ClearStats();
+    t0 = SIM_GetTime_ns();
+    s = FLASH_CRC_Calc(VERIFY_ADDR, VERIFY_SIZE, &crc);
+    dt = SIM_GetTime_ns() - t0;
+    SIM_PERIPH_GetStats(&st);
+    expect("FLASH_CRC_Calc matches the software CRC", s == FLASH_VERIFY_OK && crc == ref_crc(image, VERIFY_SIZE / 4));
+    expect("array fed by DMA, not by the CPU", st.DmaBeats == VERIFY_SIZE / 4 && st.CrcWrites == VERIFY_SIZE / 4 &&
+           st.CrcCpuWrites == 0 && st.GatedWrites == 0);
+    printf("32K through DMA: %.3f us simulated\n", dt / 1000.0);
+    expect("DMA time follows the beat rate", dt >= (VERIFY_SIZE / 4) * (uint64_t)SIM_DMA_BEAT_CYCLES * 1000000000ULL / SystemCoreClock &&
+           dt < (VERIFY_SIZE / 4 + 64) * (uint64_t)SIM_DMA_BEAT_CYCLES * 1000000000ULL / SystemCoreClock);
+
+    expect("FLASH_Verify passes on a good image", FLASH_Verify(VERIFY_ADDR, image, VERIFY_SIZE, &bad) == FLASH_VERIFY_OK);
+    expect("FLASH_VerifyCRC takes the right CRC", FLASH_VerifyCRC(VERIFY_ADDR, VERIFY_SIZE, crc) == FLASH_VERIFY_OK);
+    expect("FLASH_VerifyCRC rejects a wrong CRC", FLASH_VerifyCRC(VERIFY_ADDR, VERIFY_SIZE, crc ^ 1) == FLASH_VERIFY_MISMATCH);
+    expect("unaligned range rejected", FLASH_Verify(VERIFY_ADDR + 2, image, 256, &bad) == FLASH_VERIFY_ERROR &&
+           FLASH_VerifyCRC(VERIFY_ADDR, 254, 0) == FLASH_VERIFY_ERROR);
+
+    /* One word of page BAD_PAGE programmed differently */
+    memcpy(page, &image[64 * BAD_PAGE], sizeof(page));
+    page[17] ^= 0x00010000;
+    FLASH_ErasePage_Fast(VERIFY_ADDR + 256 * BAD_PAGE);
+    FLASH_ProgramPage_Fast(VERIFY_ADDR + 256 * BAD_PAGE, page);
+    bad = 0;
+    s = FLASH_Verify(VERIFY_ADDR, image, VERIFY_SIZE, &bad);
+    expect("mismatch reports the first bad 256B page", s == FLASH_VERIFY_MISMATCH && bad == VERIFY_ADDR + 256 * BAD_PAGE);
+    s = FLASH_Verify(VERIFY_ADDR + 256 * (BAD_PAGE + 1), &image[64 * (BAD_PAGE + 1)], VERIFY_SIZE - 256 * (BAD_PAGE + 1), &bad);
+    expect("range after the bad page passes", s == FLASH_VERIFY_OK);
+    s = FLASH_Verify(VERIFY_ADDR + 256 * BAD_PAGE + 72, &image[64 * BAD_PAGE + 18], 4, &bad);
+    expect("word after the bad word passes", s == FLASH_VERIFY_OK);
+    FLASH_Lock_Fast();
+
+    /* 320K: five DMA transfers of at most 65535 words */
+    SIM_PERIPH_ClearStats();
+    s = FLASH_CRC_Calc(0x08010000, 0x50000, &crc);
+    SIM_PERIPH_GetStats(&st);
+    expect("320K split at the DMA count limit", s == FLASH_VERIFY_OK && st.DmaBeats == 0x50000 / 4 &&
+           crc == ref_crc((const uint32_t *)(uintptr_t)0x08010000, 0x50000 / 4));
+
+    return fails ? 1 : 0;
+}
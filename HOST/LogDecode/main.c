@@ -0,0 +1,452 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : main.c
+ * Author             : typetrade
+ * Version            : V1.0.0
+ * Date               : 2026/10/17
+ * Description        : Decoder of binlog.h records.
+ *
+ *                      log_decode [-n] [-s] DICT [RECORDS]
+ *
+ *                      DICT is the firmware ELF, or its log_fmt section
+ *                      extracted with
+ *                        objcopy -O binary -j log_fmt FLASH_Program.elf dict
+ *                      RECORDS is a capture of the debug UART, stdin when
+ *                      absent, so the decoder can sit behind a serial port.
+ *                      Each line starts with the [s.us] time of its record
+ *                      (-n: no timestamps). -s prints the byte counts to
+ *                      stderr. Unknown bytes are skipped up to the next
+ *                      record that decodes.
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+#include <elf.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "binlog.h"
+
+static char    *dict;
+static uint32_t dict_size;
+
+/* Counters for -s */
+static uint64_t in_bytes = 0, out_bytes = 0, records = 0, skipped = 0;
+
+/*********************************************************************
+ * @fn      load_file
+ *
+ * @brief   Reads a whole file.
+ *
+ * @return  Malloc'ed contents, NULL on error.
+ */
+static uint8_t *load_file(const char *Path, uint32_t *Size)
+{
+    FILE    *f = fopen(Path, "rb");
+    uint8_t *buf;
+    long     n;
+
+    if(f == NULL)
+        return NULL;
+    fseek(f, 0, SEEK_END);
+    n = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    buf = malloc(n + 1);
+    if(buf == NULL || fread(buf, 1, n, f) != (size_t)n)
+    {
+        free(buf);
+        fclose(f);
+        return NULL;
+    }
+    fclose(f);
+    buf[n] = 0;
+    *Size = (uint32_t)n;
+    return buf;
+}
+
+/*********************************************************************
+ * @fn      elf_shdr
+ *
+ * @brief   Reads name, file offset and size of section Index.
+ *
+ * @return  none
+ */
+static void elf_shdr(const uint8_t *Elf, uint64_t Shoff, uint32_t Shentsize, uint32_t Index,
+                     uint32_t *Name, uint64_t *Offset, uint64_t *Size)
+{
+    const uint8_t *sh = Elf + Shoff + (uint64_t)Shentsize * Index;
+
+    if(Elf[EI_CLASS] == ELFCLASS32)
+    {
+        *Name = ((const Elf32_Shdr *)sh)->sh_name;
+        *Offset = ((const Elf32_Shdr *)sh)->sh_offset;
+        *Size = ((const Elf32_Shdr *)sh)->sh_size;
+    }
+    else
+    {
+        *Name = ((const Elf64_Shdr *)sh)->sh_name;
+        *Offset = ((const Elf64_Shdr *)sh)->sh_offset;
+        *Size = ((const Elf64_Shdr *)sh)->sh_size;
+    }
+}
+
+/*********************************************************************
+ * @fn      elf_section
+ *
+ * @brief   Finds the log_fmt section of a 32 or 64-bit ELF.
+ *
+ * @return  0 when found.
+ */
+static int elf_section(const uint8_t *Elf, uint32_t Size, uint32_t *Offset, uint32_t *Length)
+{
+    uint64_t shoff, off, len, stroff, strsize;
+    uint32_t shentsize, shnum, shstrndx, name, i;
+
+    if(Elf[EI_CLASS] == ELFCLASS32)
+    {
+        const Elf32_Ehdr *eh = (const Elf32_Ehdr *)Elf;
+        shoff = eh->e_shoff;
+        shentsize = eh->e_shentsize;
+        shnum = eh->e_shnum;
+        shstrndx = eh->e_shstrndx;
+    }
+    else
+    {
+        const Elf64_Ehdr *eh = (const Elf64_Ehdr *)Elf;
+        shoff = eh->e_shoff;
+        shentsize = eh->e_shentsize;
+        shnum = eh->e_shnum;
+        shstrndx = eh->e_shstrndx;
+    }
+    if(shoff + (uint64_t)shentsize * shnum > Size || shstrndx >= shnum)
+        return -1;
+
+    /* Section names */
+    elf_shdr(Elf, shoff, shentsize, shstrndx, &name, &stroff, &strsize);
+    if(stroff + strsize > Size)
+        return -1;
+
+    for(i = 0; i < shnum; i++){
+        elf_shdr(Elf, shoff, shentsize, i, &name, &off, &len);
+        if(name + sizeof("log_fmt") > strsize || strcmp((const char *)Elf + stroff + name, "log_fmt") != 0)
+            continue;
+        if(off + len > Size)
+            return -1;
+        *Offset = (uint32_t)off;
+        *Length = (uint32_t)len;
+        return 0;
+    }
+    return -1;
+}
+
+/*********************************************************************
+ * @fn      load_dict
+ *
+ * @brief   Loads the format strings from an ELF or a raw section dump.
+ *
+ * @return  0 on success.
+ */
+static int load_dict(const char *Path)
+{
+    uint8_t *buf;
+    uint32_t size, off, len;
+
+    buf = load_file(Path, &size);
+    if(buf == NULL)
+        return -1;
+    if(size >= EI_NIDENT && memcmp(buf, ELFMAG, SELFMAG) == 0)
+    {
+        if(elf_section(buf, size, &off, &len) != 0)
+            return -1;
+        memmove(buf, buf + off, len);
+        buf[len] = 0;
+        size = len;
+    }
+    dict = (char *)buf;
+    dict_size = size;
+    return 0;
+}
+
+/*********************************************************************
+ * @fn      get_varint
+ *
+ * @brief   Reads an unsigned LEB128 varint of at most 32 bits.
+ *
+ * @return  0 on success, -1 at end of input or on an overlong varint.
+ */
+static int get_varint(FILE *In, uint32_t *Value)
+{
+    uint32_t v = 0;
+    int      c, shift;
+
+    for(shift = 0; shift < 35; shift += 7){
+        c = getc(In);
+        if(c == EOF)
+            return -1;
+        in_bytes++;
+        v |= (uint32_t)(c & 0x7F) << shift;
+        if((c & 0x80) == 0)
+        {
+            *Value = v;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+/*********************************************************************
+ * @fn      count_args
+ *
+ * @brief   Counts the arguments Fmt consumes, '*' widths included.
+ *
+ * @return  Count, -1 if Fmt is not a plausible LOG() format.
+ */
+static int count_args(const char *Fmt)
+{
+    int n = 0;
+
+    while(*Fmt)
+    {
+        if(*Fmt++ != '%')
+            continue;
+        if(*Fmt == '%')
+        {
+            Fmt++;
+            continue;
+        }
+        while(*Fmt && strchr("-+ #0", *Fmt))
+            Fmt++;
+        if(*Fmt == '*')
+        {
+            n++;
+            Fmt++;
+        }
+        while(*Fmt >= '0' && *Fmt <= '9')
+            Fmt++;
+        if(*Fmt == '.')
+        {
+            Fmt++;
+            if(*Fmt == '*')
+            {
+                n++;
+                Fmt++;
+            }
+            while(*Fmt >= '0' && *Fmt <= '9')
+                Fmt++;
+        }
+        while(*Fmt && strchr("hlzjt", *Fmt))
+            Fmt++;
+        if(*Fmt == 0)
+            return -1;
+        Fmt++;
+        n++;
+    }
+    return n > LOG_MAX_ARGS ? -1 : n;
+}
+
+/*********************************************************************
+ * @fn      format
+ *
+ * @brief   Rebuilds the text of one record, as newlib printf would.
+ *
+ * @return  Characters written.
+ */
+static int format(FILE *Out, const char *Fmt, const uint32_t *Args)
+{
+    char        spec[32];
+    const char *start;
+    int         n = 0, len, star[2], nstar;
+    int         h;
+    uint32_t    v;
+
+    while(*Fmt)
+    {
+        if(*Fmt != '%')
+        {
+            putc(*Fmt++, Out);
+            n++;
+            continue;
+        }
+        start = Fmt++;
+        if(*Fmt == '%')
+        {
+            putc('%', Out);
+            Fmt++;
+            n++;
+            continue;
+        }
+
+        /* Copy flags, width and precision, take '*' from the arguments */
+        nstar = 0;
+        while(*Fmt && strchr("-+ #0", *Fmt))
+            Fmt++;
+        if(*Fmt == '*')
+        {
+            star[nstar++] = (int32_t)*Args++;
+            Fmt++;
+        }
+        while(*Fmt >= '0' && *Fmt <= '9')
+            Fmt++;
+        if(*Fmt == '.')
+        {
+            Fmt++;
+            if(*Fmt == '*')
+            {
+                star[nstar++] = (int32_t)*Args++;
+                Fmt++;
+            }
+            while(*Fmt >= '0' && *Fmt <= '9')
+                Fmt++;
+        }
+        len = (int)(Fmt - start);
+        if(len > (int)sizeof(spec) - 2)
+            len = (int)sizeof(spec) - 2;
+        memcpy(spec, start, len);
+
+        /* Length modifiers: arguments are 32-bit, only h and hh narrow them */
+        h = 0;
+        while(*Fmt && strchr("hlzjt", *Fmt))
+        {
+            if(*Fmt == 'h')
+                h++;
+            Fmt++;
+        }
+        spec[len] = *Fmt;
+        spec[len + 1] = 0;
+        v = *Args++;
+
+        switch(*Fmt)
+        {
+            case 'd':
+            case 'i':
+                v = h == 1 ? (uint32_t)(int16_t)v : h >= 2 ? (uint32_t)(int8_t)v : v;
+                n += nstar == 2 ? fprintf(Out, spec, star[0], star[1], (int)(int32_t)v) :
+                     nstar == 1 ? fprintf(Out, spec, star[0], (int)(int32_t)v) : fprintf(Out, spec, (int)(int32_t)v);
+                break;
+
+            case 'u':
+            case 'x':
+            case 'X':
+            case 'o':
+            case 'c':
+                v = h == 1 ? (uint16_t)v : h >= 2 ? (uint8_t)v : v;
+                n += nstar == 2 ? fprintf(Out, spec, star[0], star[1], (unsigned)v) :
+                     nstar == 1 ? fprintf(Out, spec, star[0], (unsigned)v) : fprintf(Out, spec, (unsigned)v);
+                break;
+
+            case 'p':
+                n += fprintf(Out, "0x%08x", (unsigned)v);
+                break;
+
+            default:
+                /* %s and floats cannot be deferred */
+                n += fprintf(Out, "<%%%c:0x%08x>", *Fmt, (unsigned)v);
+                break;
+        }
+        if(*Fmt)
+            Fmt++;
+    }
+    return n;
+}
+
+/*********************************************************************
+ * @fn      decode
+ *
+ * @brief   Decodes records from In until end of input.
+ *
+ * @return  none
+ */
+static void decode(FILE *In, FILE *Out, int Stamps)
+{
+    uint32_t id, dt, args[LOG_MAX_ARGS];
+    uint64_t now = 0, start;
+    int      c, nargs, i, bol = 1;
+    const char *fmt;
+
+    while((c = getc(In)) != EOF)
+    {
+        start = in_bytes++;
+        if(c != LOG_SYNC)
+        {
+            skipped++;
+            continue;
+        }
+
+        /* A record decodes only if its ID starts a string of the dictionary */
+        if(get_varint(In, &id) != 0)
+            break;
+        if(id >= dict_size || (id != 0 && dict[id - 1] != 0) || (nargs = count_args(dict + id)) < 0)
+        {
+            skipped += in_bytes - start;
+            continue;
+        }
+        fmt = dict + id;
+        if(get_varint(In, &dt) != 0)
+            break;
+        for(i = 0; i < nargs; i++){
+            if(get_varint(In, &args[i]) != 0)
+                break;
+        }
+        if(i != nargs)
+            break;
+
+        now += dt;
+        records++;
+        if(Stamps && bol)
+        {
+            fprintf(Out, "[%4lu.%06lu] ", (unsigned long)(now / 1000000), (unsigned long)(now % 1000000));
+        }
+        out_bytes += format(Out, fmt, args);
+        if(*fmt)
+            bol = fmt[strlen(fmt) - 1] == '\n';
+    }
+}
+
+/*********************************************************************
+ * @fn      main
+ *
+ * @brief   Main program.
+ *
+ * @return  0 on success.
+ */
+int main(int argc, char **argv)
+{
+    FILE *in = stdin;
+    int   stamps = 1, stats = 0, a = 1;
+
+    for(; a < argc && argv[a][0] == '-' && argv[a][1]; a++){
+        if(strcmp(argv[a], "-n") == 0)
+            stamps = 0;
+        else if(strcmp(argv[a], "-s") == 0)
+            stats = 1;
+        else
+            break;
+    }
+    if(a >= argc || argc - a > 2)
+    {
+        fprintf(stderr, "usage: %s [-n] [-s] DICT [RECORDS]\n", argv[0]);
+        return 2;
+    }
+    if(load_dict(argv[a]) != 0)
+    {
+        fprintf(stderr, "%s: no log_fmt strings\n", argv[a]);
+        return 1;
+    }
+    if(argc - a == 2 && strcmp(argv[a + 1], "-") != 0)
+    {
+        in = fopen(argv[a + 1], "rb");
+        if(in == NULL)
+        {
+            perror(argv[a + 1]);
+            return 1;
+        }
+    }
+
+    decode(in, stdout, stamps);
+
+    if(stats)
+    {
+        fprintf(stderr, "%llu records, %llu bytes in, %llu characters out (%.1fx), %llu bytes skipped\n",
+                (unsigned long long)records, (unsigned long long)in_bytes, (unsigned long long)out_bytes,
+                in_bytes ? (double)out_bytes / in_bytes : 0.0, (unsigned long long)skipped);
+    }
+    return 0;
+}
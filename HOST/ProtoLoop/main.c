@@ -0,0 +1,253 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : main.c
+ * Author             : typetrade
+ * Version            : V1.0.0
+ * Date               : 2026/10/17
+ * Description        : Runs the UART flash programming protocol end to end
+ *                      on the host models: the HOST/FlashProg client
+ *                      sends on the simulated USART2 RX line at 2 Mbaud
+ *                      and reads the replies from its TX, the device side
+ *                      (User/flash_service.c) is polled whenever the
+ *                      client waits. Checks erase, a pipelined 64K write
+ *                      against the line rate and against a window of one,
+ *                      verify, a corrupted request, lost replies, range
+ *                      and CRC errors and reboot.
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include "ch32v20x.h"
+#include "sim_flash.h"
+#include "sim_periph.h"
+#include "sim_test.h"
+#include "flash_service.h"
+#include "uart_rx.h"
+#include "prog_client.h"
+
+#define BAUD                   2000000
+#define IMAGE_SIZE             (64 * 1024)
+#define POLL_NS                10000
+#define LINK_TX_SIZE           (256 * 1024)
+
+static uint8_t  image[IMAGE_SIZE];
+/* Bytes on the line stay in place until received (SIM_USART_Feed) */
+static uint8_t  link_tx[LINK_TX_SIZE];
+static uint32_t link_tx_len;
+/* Fault injection: the request frame to corrupt and the reply frames to
+ * drop, counted from 1 since armed, 0 for none */
+static uint32_t link_tx_frames, link_corrupt;
+static uint32_t link_rx_frames, link_drop[2];
+static uint8_t  link_rx_mid, link_rx_drop;
+static uint8_t  rebooted;
+
+/*********************************************************************
+ * @fn      link_send
+ *
+ * @brief   Link Send: puts a frame on the USART2 RX line, right after
+ *          the bytes still arriving.
+ *
+ * @return  0, -1 if the line buffer is full.
+ */
+static int link_send(void *Link, const uint8_t *Data, uint32_t Length)
+{
+    uint8_t *p;
+
+    if(SIM_USART_FeedLeft(2) == 0)
+        link_tx_len = 0;
+    if(Length > LINK_TX_SIZE - link_tx_len)
+        return -1;
+    p = link_tx + link_tx_len;
+    memcpy(p, Data, Length);
+    if(++link_tx_frames == link_corrupt && Length > 8)
+    {
+        /* Keeps the framing, breaks the CRC */
+        p[Length / 2] ^= (p[Length / 2] == 0x55) ? 0xAA : 0x55;
+    }
+    if(SIM_USART_Feed(2, p, Length, BAUD) != 0)
+        return -1;
+    link_tx_len += Length;
+    return 0;
+}
+
+/*********************************************************************
+ * @fn      link_recv
+ *
+ * @brief   Link Recv: takes what USART2 transmitted, polling the
+ *          device and running the models while there is nothing.
+ *
+ * @return  Bytes, 0 after Timeout_ms of simulated time.
+ */
+static int link_recv(void *Link, uint8_t *Data, uint32_t Max, uint32_t Timeout_ms)
+{
+    uint64_t until = SIM_GetTime_ns() + (uint64_t)Timeout_ms * 1000000;
+    uint32_t i, n, m = 0;
+    uint8_t  c;
+
+    while(m == 0)
+    {
+        n = SIM_USART_Drain(2, Data, Max);
+        if(n == 0)
+        {
+            if(SIM_GetTime_ns() >= until)
+                return 0;
+            rebooted |= FLASH_Service_Poll();
+            SIM_AdvanceTime_ns(POLL_NS);
+            continue;
+        }
+        for(i = 0; i < n; i++){
+            c = Data[i];
+            if(!link_rx_mid)
+            {
+                link_rx_mid = 1;
+                link_rx_drop = link_rx_frames + 1 == link_drop[0] || link_rx_frames + 1 == link_drop[1];
+            }
+            if(!link_rx_drop)
+                Data[m++] = c;
+            if(c == 0)
+            {
+                link_rx_frames++;
+                link_rx_mid = 0;
+            }
+        }
+    }
+    return (int)m;
+}
+
+/*********************************************************************
+ * @fn      write_timed
+ *
+ * @brief   PROG_Write, timed.
+ *
+ * @return  Result of PROG_Write.
+ */
+static int write_timed(PROG_ClientTypeDef *Client, uint32_t Address, const void *Data, uint32_t Length,
+                       uint64_t *Time_ns)
+{
+    uint64_t t0 = SIM_GetTime_ns();
+    int      r;
+
+    r = PROG_Write(Client, Address, Data, Length);
+    *Time_ns = SIM_GetTime_ns() - t0;
+    return r;
+}
+
+/*********************************************************************
+ * @fn      main
+ *
+ * @brief   Main program.
+ *
+ * @return  0 if every check passed.
+ */
+int main(void)
+{
+    PROG_ClientTypeDef        client;
+    PROG_LinkTypeDef          link = {link_send, link_recv, NULL};
+    FLASH_ServiceStatsTypeDef st, st0;
+    UART_RxStatsTypeDef       rx;
+    uint64_t                  t_pipe, t_one, tx0, ideal_ns;
+    uint32_t                  i, crc, start;
+    char                      name[64];
+
+    if(SIM_FLASH_Init() != 0 || SIM_PERIPH_Init() != 0)
+        return 2;
+
+    for(i = 0; i < IMAGE_SIZE; i++){
+        image[i] = (uint8_t)(i * 29 + (i >> 8) * 7);
+    }
+    /* Zeros are what COBS stuffs: a run of them in the image */
+    memset(image + 1000, 0, 600);
+
+    expect("service init", FLASH_Service_Init(BAUD) == SUCCESS);
+    PROG_Init(&client, &link);
+    client.Timeout_ms = 20;
+
+    expect("sync", PROG_Sync(&client) == FLASH_PROTO_OK);
+    expect("  range and window reported", client.Start == FLASH_SERVICE_START && client.End == FLASH_Erase_End() &&
+           client.Window == FLASH_PROTO_WINDOW);
+    start = client.Start;
+
+    expect("erase 128K", PROG_Erase(&client, start, 2 * IMAGE_SIZE) == FLASH_PROTO_OK);
+    expect("  blank", FLASH_Erase_IsBlank(start, 2 * IMAGE_SIZE));
+
+    /* Pipelined: the line never idles, so the write takes the time of
+     * its bytes at BAUD plus the last page's program time */
+    tx0 = client.Stats.TxBytes;
+    expect("write 64K, window 4", write_timed(&client, start, image, IMAGE_SIZE, &t_pipe) == FLASH_PROTO_OK);
+    expect("  flash holds the image", memcmp((const void *)start, image, IMAGE_SIZE) == 0);
+    ideal_ns = (client.Stats.TxBytes - tx0) * 10 * 1000000000ULL / BAUD;
+    printf("  %u bytes in %llu us: %llu KB/s, line-limited %llu KB/s\n", IMAGE_SIZE,
+           (unsigned long long)(t_pipe / 1000), (unsigned long long)(IMAGE_SIZE * 1000000000ULL / 1024 / t_pipe),
+           (unsigned long long)(IMAGE_SIZE * 1000000000ULL / 1024 / ideal_ns));
+    expect("  at least 90% of the line rate", t_pipe * 9 <= ideal_ns * 10);
+
+    crc = 0;
+    expect("verify", PROG_Verify(&client, start, image, IMAGE_SIZE, &crc) == FLASH_PROTO_OK);
+    expect("  device CRC is the CRC-32/MPEG-2 of the image", crc == PROG_CrcWords(image, IMAGE_SIZE));
+
+    /* Stop and wait: every page waits for the previous one's program */
+    client.Window = 1;
+    expect("write 64K, window 1", write_timed(&client, start + IMAGE_SIZE, image, IMAGE_SIZE, &t_one) ==
+           FLASH_PROTO_OK);
+    expect("  flash holds the image",
+           memcmp((const void *)(start + IMAGE_SIZE), image, IMAGE_SIZE) == 0);
+    printf("  %llu us, window 4 is %.2fx faster\n", (unsigned long long)(t_one / 1000), (double)t_one / t_pipe);
+    expect("  window 4 at least 1.5x faster", t_pipe * 3 <= t_one * 2);
+    client.Window = FLASH_PROTO_WINDOW;
+
+    expect("erase over written pages", PROG_Erase(&client, start, 4096 + 512) == FLASH_PROTO_OK);
+    expect("  blank", FLASH_Erase_IsBlank(start, 4096 + 512) && !FLASH_Erase_IsBlank(start + 4096 + 512, 256));
+
+    /* A corrupted request: dropped with those after it, sent again */
+    FLASH_Service_GetStats(&st0);
+    client.Stats.Resent = 0;
+    link_tx_frames = 0;
+    link_corrupt = 3;
+    expect("write 4K, third request corrupted", PROG_Write(&client, start, image, 4096) == FLASH_PROTO_OK);
+    link_corrupt = 0;
+    FLASH_Service_GetStats(&st);
+    expect("  bad frame dropped, requests sent again", st.BadFrames - st0.BadFrames == 1 && client.Stats.Resent > 0);
+    expect("  page written once each", st.PagesWritten - st0.PagesWritten == 16);
+    expect("  flash holds the image", memcmp((const void *)start, image, 4096) == 0);
+
+    /* Lost replies: a later reply covers one in the middle, the last one
+     * is asked for again and replied to without programming twice */
+    expect("erase 4K", PROG_Erase(&client, start, 4096) == FLASH_PROTO_OK);
+    FLASH_Service_GetStats(&st0);
+    client.Stats.Resent = 0;
+    link_rx_frames = 0;
+    link_drop[0] = 2;
+    link_drop[1] = 16;
+    expect("write 4K, second and last replies lost", PROG_Write(&client, start, image, 4096) == FLASH_PROTO_OK);
+    link_drop[0] = link_drop[1] = 0;
+    FLASH_Service_GetStats(&st);
+    expect("  last request replied to again", st.Duplicates - st0.Duplicates == 1 && client.Stats.Resent == 1);
+    expect("  page written once each", st.PagesWritten - st0.PagesWritten == 16);
+    expect("  flash holds the image", memcmp((const void *)start, image, 4096) == 0);
+
+    /* Errors */
+    expect("write below the range refused",
+           PROG_Write(&client, start - FLASH_PROTO_PAGE_SIZE, image, FLASH_PROTO_PAGE_SIZE) == FLASH_PROTO_ERR_RANGE &&
+           client.FailAddress == start - FLASH_PROTO_PAGE_SIZE);
+    expect("erase past the end refused", PROG_Erase(&client, client.End - 4096, 8192) == FLASH_PROTO_ERR_RANGE);
+    image[100] ^= 1;
+    crc = 0;
+    expect("verify of other data: mismatch", PROG_Verify(&client, start, image, 4096, &crc) == FLASH_PROTO_ERR_MISMATCH);
+    image[100] ^= 1;
+    expect("  device CRC returned", crc == PROG_CrcWords(image, 4096));
+    expect("misaligned erase rejected locally", PROG_Erase(&client, start + 4, 256) == PROG_ERR_ARG);
+
+    UART_Rx_GetStats(&rx);
+    snprintf(name, sizeof(name), "no bytes lost in the ring (%u received)", (unsigned)rx.Received);
+    expect(name, rx.Lost == 0);
+
+    expect("reboot", PROG_Reboot(&client) == FLASH_PROTO_OK && rebooted);
+    FLASH_Service_GetStats(&st);
+    printf("  service: %u requests, %u pages, %u bad frames, %u duplicates, %u out of order, %u errors\n",
+           st.Requests, st.PagesWritten, st.BadFrames, st.Duplicates, st.OutOfOrder, st.Errors);
+    printf("  client: %u requests, %u resent, %u bad replies\n", client.Stats.Requests, client.Stats.Resent,
+           client.Stats.BadReplies);
+    FLASH_Service_DeInit();
+
+    printf("\n%s\n", fails ? "FAILED" : "all checks passed");
+    return fails ? 1 : 0;
+}
@@ -0,0 +1,1272 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : sim_flash.c
+ * Author             : typetrade
+ * Version            : V1.0.0
+ * Date               : 2026/10/17
+ * Description        : Host-side register-level simulator of the CH32V20x FLASH
+ *                      controller.
+ *
+ *                      The FLASH register block, the main array and the option
+ *                      byte page are mapped at their real addresses. The
+ *                      register page is PROT_NONE and the array pages are
+ *                      read-only, so every register access and every array
+ *                      write faults. The SIGSEGV handler prepares the page,
+ *                      single-steps the faulting instruction (x86 TF) and the
+ *                      SIGTRAP handler applies the side effects. The driver
+ *                      therefore runs unmodified, including its poll loops.
+ *                      The register blocks of other peripherals are
+ *                      trapped the same way through SIM_MapBlock, their
+ *                      models (sim_periph.c) see each access and take
+ *                      part in simulated time and interrupts.
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+#define _GNU_SOURCE
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <ucontext.h>
+#include <sys/mman.h>
+#include "sim_flash.h"
+
+#if !defined(__x86_64__) || !defined(__linux__)
+#error "The FLASH simulator single-steps faulting accesses and needs Linux x86_64"
+#endif
+
+#ifndef MAP_FIXED_NOREPLACE
+#define MAP_FIXED_NOREPLACE        0x100000
+#endif
+
+#define SIM_PAGE_SIZE              ((uint32_t)0x1000)
+#define SIM_TRAP_FLAG              ((greg_t)0x100)
+
+/* Register offsets inside FLASH_TypeDef */
+#define REG_ACTLR                  0x00
+#define REG_KEYR                   0x04
+#define REG_OBKEYR                 0x08
+#define REG_STATR                  0x0C
+#define REG_CTLR                   0x10
+#define REG_ADDR                   0x14
+#define REG_OBR                    0x1C
+#define REG_WPR                    0x20
+#define REG_MODEKEYR               0x24
+#define REG_NUM                    10
+
+/* Flash Control Register bits */
+#define CR_PG                      ((uint32_t)0x00000001)
+#define CR_PER                     ((uint32_t)0x00000002)
+#define CR_MER                     ((uint32_t)0x00000004)
+#define CR_OPTPG                   ((uint32_t)0x00000010)
+#define CR_OPTER                   ((uint32_t)0x00000020)
+#define CR_STRT                    ((uint32_t)0x00000040)
+#define CR_LOCK                    ((uint32_t)0x00000080)
+#define CR_OPTWRE                  ((uint32_t)0x00000200)
+#define CR_ERRIE                   ((uint32_t)0x00000400)
+#define CR_EOPIE                   ((uint32_t)0x00001000)
+#define CR_FAST_LOCK               ((uint32_t)0x00008000)
+#define CR_PAGE_PG                 ((uint32_t)0x00010000)
+#define CR_PAGE_ER                 ((uint32_t)0x00020000)
+#define CR_BER32                   ((uint32_t)0x00040000)
+#define CR_BER64                   ((uint32_t)0x00080000)
+#define CR_PG_STRT                 ((uint32_t)0x00200000)
+#define CR_FAST_MASK               (CR_PAGE_PG | CR_PAGE_ER | CR_BER32 | CR_BER64 | CR_PG_STRT)
+
+/* FLASH Status Register bits */
+#define SR_BSY                     ((uint32_t)0x00000001)
+#define SR_WR_BSY                  ((uint32_t)0x00000002)
+#define SR_PGERR                   ((uint32_t)0x00000004)
+#define SR_WRPRTERR                ((uint32_t)0x00000010)
+#define SR_EOP                     ((uint32_t)0x00000020)
+
+/* FLASH Keys */
+#define FLASH_KEY1                 ((uint32_t)0x45670123)
+#define FLASH_KEY2                 ((uint32_t)0xCDEF89AB)
+
+/* Option bytes */
+#define SIM_OB_BASE                ((uint32_t)0x1FFFF800)
+#define SIM_OB_SIZE                16
+#define SIM_UID_BASE               ((uint32_t)0x1FFFF7E8)
+/* ESIG flash capacity, in KB */
+#define SIM_FLACAP_BASE            ((uint32_t)0x1FFFF7E0)
+
+/* Memory regions */
+typedef enum
+{
+    SIM_REGION_NONE = 0,
+    SIM_REGION_REG,
+    SIM_REGION_ARRAY,
+    SIM_REGION_INFO,
+    SIM_REGION_BLOCK
+} SIM_RegionTypeDef;
+
+/* Register blocks mapped by SIM_MapBlock */
+#define SIM_BLOCK_MAX              8
+
+/* Nominal timings. They are placeholders to be replaced with numbers measured
+ * on a board through SIM_FLASH_SetTiming(). RegAccess models one poll of
+ * STATR: about 12 HCLK cycles at the 72MHz flash clock. Busy polls are
+ * skipped by default; clear SIM_SkipBusyPolls to count every iteration, e.g.
+ * to exercise the timeouts of FLASH_WaitForLastOperation. */
+static SIM_FLASH_TimingTypeDef sim_timing = {
+    .SIM_OpTime = {
+        [SIM_OP_HALFWORD]      = 24000,
+        [SIM_OP_PAGE_LOAD]     = 60,
+        [SIM_OP_PAGE_PROGRAM]  = 1200000,
+        [SIM_OP_PAGE_ERASE]    = 2400000,
+        [SIM_OP_SECTOR_ERASE]  = 4800000,
+        [SIM_OP_BLOCK32_ERASE] = 9600000,
+        [SIM_OP_BLOCK64_ERASE] = 12000000,
+        [SIM_OP_MASS_ERASE]    = 24000000,
+        [SIM_OP_OB_ERASE]      = 4800000,
+        [SIM_OP_OB_PROGRAM]    = 24000,
+    },
+    .SIM_RegAccess = 166,
+    .SIM_SkipBusyPolls = 1,
+};
+
+/* Core clock of the simulated part (system_ch32v20x.c on the target).
+ * The driver's time-based timeouts convert mcycle with it. */
+uint32_t SystemCoreClock = 144000000;
+
+static const char *const sim_op_name[SIM_OP_NUM] = {
+    "halfword_program",
+    "page_load",
+    "page_program_fast",
+    "page_erase_fast",
+    "sector_erase_4k",
+    "block_erase_32k",
+    "block_erase_64k",
+    "mass_erase",
+    "ob_erase",
+    "ob_program",
+};
+
+/* Controller state */
+static struct
+{
+    uint32_t ACTLR;
+    uint32_t STATR;
+    uint32_t CTLR;
+    uint32_t ADDR;
+    uint32_t OBR;
+    uint32_t WPR;
+    uint8_t  KeyStage;
+    uint8_t  ModeKeyStage;
+    uint8_t  OBKeyStage;
+    uint64_t Now_ns;
+    uint64_t BusyUntil_ns;
+    uint64_t McycleNs;      /* Now_ns at the last mcycle read */
+    uint64_t McycleMilli;   /* mcycle x 1000 at that time */
+    uint32_t PageBuf[64];
+    uint64_t PageBufLoaded;
+    uint32_t PageBufAddr;
+} sim;
+
+static SIM_FLASH_StatsTypeDef sim_stats;
+
+/* Program/erase operations left before a simulated power cut, -1: none */
+static int32_t sim_cut_left = -1;
+
+/* Pattern of the erase the power cut hits, 0: the erase is dropped whole */
+static uint32_t sim_tear_seed = 0;
+
+/* FLASH_IRQHandler of the program under test, NULL while the IRQ is masked */
+static void (*sim_irq_handler)(void);
+
+/* Register blocks of the other peripherals */
+static const SIM_BlockTypeDef *sim_block[SIM_BLOCK_MAX];
+static uint32_t                sim_blocks = 0;
+
+/* Pending single-step */
+static struct
+{
+    int               Active;
+    SIM_RegionTypeDef Region;
+    const SIM_BlockTypeDef *Block;
+    uint32_t          Addr;
+    int               Write;
+    uint8_t           Saved[SIM_PAGE_SIZE];
+} sim_trap;
+
+/* Writable alias of the three fixed mappings */
+static uint8_t *sim_alias_array;
+static uint8_t *sim_alias_info;
+static uint32_t *sim_alias_reg;
+
+/*********************************************************************
+ * @fn      sim_fatal
+ *
+ * @brief   Reports an unrecoverable condition from signal context.
+ *
+ * @return  none
+ */
+static void sim_fatal(const char *msg)
+{
+    (void)!write(2, msg, strlen(msg));
+    _exit(70);
+}
+
+/*********************************************************************
+ * @fn      sim_find_block
+ *
+ * @brief   Looks up the trapped register block holding an address.
+ *
+ * @return  Block, NULL if none.
+ */
+static const SIM_BlockTypeDef *sim_find_block(uintptr_t addr)
+{
+    uint32_t i;
+
+    for(i = 0; i < sim_blocks; i++){
+        if(sim_block[i]->Size && addr >= sim_block[i]->Base && addr < sim_block[i]->Base + SIM_PAGE_SIZE)
+            return sim_block[i];
+    }
+    return NULL;
+}
+
+/*********************************************************************
+ * @fn      sim_region
+ *
+ * @brief   Classifies a faulting address.
+ *
+ * @return  Region containing the address.
+ */
+static SIM_RegionTypeDef sim_region(uintptr_t addr)
+{
+    if(sim_find_block(addr))
+        return SIM_REGION_BLOCK;
+    if(addr >= SIM_FLASH_R_BASE && addr < SIM_FLASH_R_BASE + SIM_PAGE_SIZE)
+        return SIM_REGION_REG;
+    if(addr >= SIM_FLASH_BASE && addr < SIM_FLASH_BASE + SIM_FLASH_SIZE)
+        return SIM_REGION_ARRAY;
+    if(addr >= SIM_INFO_BASE && addr < SIM_INFO_BASE + SIM_INFO_SIZE)
+        return SIM_REGION_INFO;
+    return SIM_REGION_NONE;
+}
+
+/*********************************************************************
+ * @fn      sim_update
+ *
+ * @brief   Completes the running operation once simulated time passed it.
+ *
+ * @return  none
+ */
+static void sim_update(void)
+{
+    uint32_t i;
+
+    if((sim.STATR & SR_BSY) && sim.Now_ns >= sim.BusyUntil_ns)
+    {
+        sim.STATR &= ~SR_BSY;
+        sim.STATR |= SR_EOP;
+    }
+    for(i = 0; i < sim_blocks; i++){
+        if(sim_block[i]->Update)
+            sim_block[i]->Update();
+    }
+}
+
+/*********************************************************************
+ * @fn      sim_next_event
+ *
+ * @brief   Earliest time at which the controller or a block model has
+ *          something to complete.
+ *
+ * @return  Time in ns, UINT64_MAX if nothing is running.
+ */
+static uint64_t sim_next_event(void)
+{
+    uint64_t next = UINT64_MAX, t;
+    uint32_t i;
+
+    if(sim.STATR & SR_BSY)
+        next = sim.BusyUntil_ns;
+    for(i = 0; i < sim_blocks; i++){
+        if(sim_block[i]->NextEvent && (t = sim_block[i]->NextEvent()) < next)
+            next = t;
+    }
+    return next;
+}
+
+/*********************************************************************
+ * @fn      sim_irq
+ *
+ * @brief   Runs the FLASH interrupt handler while an enabled source is
+ *          pending (EOP with EOPIE, PGERR/WRPRTERR with ERRIE). Only called
+ *          from thread context, never from inside a register trap.
+ *
+ * @return  none
+ */
+static void sim_irq(void)
+{
+    uint32_t n;
+
+    for(n = 0; sim_irq_handler && n < 16; n++){
+        if(!((sim.STATR & SR_EOP) && (sim.CTLR & CR_EOPIE)) &&
+           !((sim.STATR & (SR_PGERR | SR_WRPRTERR)) && (sim.CTLR & CR_ERRIE)))
+            break;
+        sim_irq_handler();
+    }
+    if(n == 16)
+        sim_fatal("sim_flash: FLASH_IRQHandler does not clear its flags\n");
+    for(n = 0; n < sim_blocks; n++){
+        if(sim_block[n]->Irq)
+            sim_block[n]->Irq();
+    }
+}
+
+/*********************************************************************
+ * @fn      sim_stall
+ *
+ * @brief   Bus accesses to the array stall until the controller is idle.
+ *
+ * @return  none
+ */
+static void sim_stall(void)
+{
+    if((sim.STATR & SR_BSY) && sim.Now_ns < sim.BusyUntil_ns)
+    {
+        sim.Now_ns = sim.BusyUntil_ns;
+    }
+    sim_update();
+}
+
+/*********************************************************************
+ * @fn      sim_wrp
+ *
+ * @brief   Checks the write protection of the 4K sector holding Address.
+ *
+ * @return  1 if protected.
+ */
+static int sim_wrp(uint32_t Address)
+{
+    uint32_t sector;
+
+    if(Address < SIM_FLASH_BASE || Address >= SIM_FLASH_BASE + SIM_FLASH_SIZE)
+        return 0;
+
+    sector = (Address - SIM_FLASH_BASE) >> 12;
+    if(sector > 31)
+        sector = 31;
+
+    return (sim.WPR & ((uint32_t)1 << sector)) == 0;
+}
+
+/*********************************************************************
+ * @fn      sim_erased
+ *
+ * @brief   Checks that Length bytes at Offset of the array read erased.
+ *
+ * @return  1 if erased.
+ */
+static int sim_erased(uint32_t Offset, uint32_t Length)
+{
+    uint32_t i;
+
+    for(i = 0; i < Length; i++){
+        uint8_t e = ((Offset + i) & 1) ? 0xE3 : 0x39;
+        if(sim_alias_array[Offset + i] != e)
+            return 0;
+    }
+    return 1;
+}
+
+/*********************************************************************
+ * @fn      sim_fill_erased
+ *
+ * @brief   Erases Length bytes of the array at Offset.
+ *
+ * @return  none
+ */
+static void sim_fill_erased(uint32_t Offset, uint32_t Length)
+{
+    uint32_t i;
+
+    for(i = 0; i < Length; i += 4){
+        *(uint32_t *)(sim_alias_array + Offset + i) = SIM_FLASH_ERASED_WORD;
+    }
+}
+
+/*********************************************************************
+ * @fn      sim_tear
+ *
+ * @brief   Leaves Length bytes of the array at Offset half erased: each
+ *          word is erased, unchanged or a bitwise mix of both, picked
+ *          from sim_tear_seed and its offset.
+ *
+ * @return  none
+ */
+static void sim_tear(uint32_t Offset, uint32_t Length)
+{
+    uint32_t i, h, *w;
+
+    for(i = 0; i < Length; i += 4){
+        w = (uint32_t *)(sim_alias_array + Offset + i);
+        h = (sim_tear_seed ^ (i * 0x9E3779B9)) * 0x85EBCA6B;
+        h ^= h >> 13;
+        h *= 0xC2B2AE35;
+        h ^= h >> 16;
+        if(h % 3 == 0)
+            *w = SIM_FLASH_ERASED_WORD;
+        else if(h % 3 == 2)
+            *w = (*w & h) | (SIM_FLASH_ERASED_WORD & ~h);
+    }
+}
+
+/*********************************************************************
+ * @fn      sim_start
+ *
+ * @brief   Starts an operation: checks protection, applies the data change
+ *          and makes the controller busy for the modelled time.
+ *
+ * @param   Op - operation kind.
+ *          Address - target address (already aligned).
+ *          Length - bytes affected in the main array, 0 for option bytes.
+ *
+ * @return  none
+ */
+static void sim_start(SIM_OpTypeDef Op, uint32_t Address, uint32_t Length)
+{
+    uint32_t a;
+
+    sim_stall();
+
+    if(Length)
+    {
+        if(Address < SIM_FLASH_BASE || Address + Length > SIM_FLASH_BASE + SIM_FLASH_SIZE)
+        {
+            sim.STATR |= SR_PGERR;
+            sim_stats.PgErrors++;
+            return;
+        }
+        for(a = Address; a < Address + Length; a += 4096){
+            if(sim_wrp(a))
+            {
+                sim.STATR |= SR_WRPRTERR;
+                sim_stats.WrpErrors++;
+                return;
+            }
+        }
+    }
+
+    if(sim_cut_left >= 0)
+    {
+        if(sim_cut_left == 0)
+        {
+            sim_stats.Dropped++;
+            if(sim_tear_seed && Length && Op != SIM_OP_HALFWORD && Op != SIM_OP_PAGE_PROGRAM)
+            {
+                sim_tear(Address - SIM_FLASH_BASE, Length);
+                sim_stats.Torn++;
+            }
+            return;
+        }
+        sim_cut_left--;
+    }
+
+    sim.STATR |= SR_BSY;
+    sim.BusyUntil_ns = sim.Now_ns + sim_timing.SIM_OpTime[Op];
+    sim_stats.Op[Op].Count++;
+    sim_stats.Op[Op].Busy_ns += sim_timing.SIM_OpTime[Op];
+    sim_stats.Busy_ns += sim_timing.SIM_OpTime[Op];
+
+    if(Op != SIM_OP_HALFWORD && Op != SIM_OP_PAGE_PROGRAM && Op != SIM_OP_OB_PROGRAM && Length)
+    {
+        sim_fill_erased(Address - SIM_FLASH_BASE, Length);
+    }
+}
+
+/*********************************************************************
+ * @fn      sim_reload_ob
+ *
+ * @brief   Reloads OBR and WPR from the option byte area, as after a reset.
+ *
+ * @return  none
+ */
+static void sim_reload_ob(void)
+{
+    const uint16_t *ob = (const uint16_t *)(sim_alias_info + (SIM_OB_BASE - SIM_INFO_BASE));
+
+    sim.OBR = ((uint32_t)(ob[1] & 0xFF) << 2) | (((ob[0] & 0xFF) != 0xA5) ? 0x02 : 0x00);
+    sim.WPR = (uint32_t)(ob[4] & 0xFF) | ((uint32_t)(ob[5] & 0xFF) << 8) |
+              ((uint32_t)(ob[6] & 0xFF) << 16) | ((uint32_t)(ob[7] & 0xFF) << 24);
+}
+
+/*********************************************************************
+ * @fn      sim_key
+ *
+ * @brief   Runs one step of a KEY1/KEY2 unlock sequence.
+ *
+ * @return  1 when the sequence completed.
+ */
+static int sim_key(uint8_t *Stage, uint32_t Value)
+{
+    if(Value == FLASH_KEY1)
+    {
+        *Stage = 1;
+        return 0;
+    }
+    if(*Stage == 1 && Value == FLASH_KEY2)
+    {
+        *Stage = 0;
+        return 1;
+    }
+    *Stage = 0;
+    return 0;
+}
+
+/*********************************************************************
+ * @fn      sim_ctlr_write
+ *
+ * @brief   Applies a write to CTLR, starting operations on STRT/PG_STRT.
+ *
+ * @return  none
+ */
+static void sim_ctlr_write(uint32_t Value)
+{
+    uint32_t old = sim.CTLR;
+
+    if(old & CR_LOCK)
+    {
+        return;
+    }
+    if(Value & CR_LOCK)
+    {
+        sim.CTLR = old | CR_LOCK | CR_FAST_LOCK;
+        return;
+    }
+    if(old & CR_FAST_LOCK)
+    {
+        Value &= ~CR_FAST_MASK;
+    }
+    if(!(old & CR_OPTWRE))
+    {
+        Value &= ~(CR_OPTPG | CR_OPTER);
+    }
+
+    Value = (Value & ~(CR_OPTWRE | CR_FAST_LOCK)) | (old & CR_OPTWRE & Value) | (old & CR_FAST_LOCK) | (Value & CR_FAST_LOCK);
+    sim.CTLR = Value & ~(CR_STRT | CR_PG_STRT);
+
+    if(Value & CR_STRT)
+    {
+        if(Value & CR_PER)
+            sim_start(SIM_OP_SECTOR_ERASE, sim.ADDR & ~(uint32_t)0xFFF, 4096);
+        else if(Value & CR_MER)
+            sim_start(SIM_OP_MASS_ERASE, SIM_FLASH_BASE, SIM_FLASH_SIZE);
+        else if(Value & CR_OPTER)
+        {
+            sim_start(SIM_OP_OB_ERASE, SIM_OB_BASE, 0);
+            memset(sim_alias_info + (SIM_OB_BASE - SIM_INFO_BASE), 0xFF, SIM_OB_SIZE);
+        }
+        else if(Value & CR_PAGE_ER)
+            sim_start(SIM_OP_PAGE_ERASE, sim.ADDR & ~(uint32_t)0xFF, 256);
+        else if(Value & CR_BER32)
+            sim_start(SIM_OP_BLOCK32_ERASE, sim.ADDR & ~(uint32_t)0x7FFF, 32768);
+        else if(Value & CR_BER64)
+            sim_start(SIM_OP_BLOCK64_ERASE, sim.ADDR & ~(uint32_t)0xFFFF, 65536);
+    }
+
+    if((Value & CR_PG_STRT) && (Value & CR_PAGE_PG))
+    {
+        uint32_t off = sim.PageBufAddr - SIM_FLASH_BASE;
+        uint32_t i;
+
+        for(i = 0; i < 64; i++){
+            if((sim.PageBufLoaded & ((uint64_t)1 << i)) && !sim_erased(off + 4 * i, 4))
+            {
+                sim.STATR |= SR_PGERR;
+                sim_stats.PgErrors++;
+                sim.PageBufLoaded = 0;
+                return;
+            }
+        }
+        sim_start(SIM_OP_PAGE_PROGRAM, sim.PageBufAddr, 256);
+        if(sim.STATR & SR_BSY)
+        {
+            for(i = 0; i < 64; i++){
+                if(sim.PageBufLoaded & ((uint64_t)1 << i))
+                    *(uint32_t *)(sim_alias_array + off + 4 * i) = sim.PageBuf[i];
+            }
+        }
+        sim.PageBufLoaded = 0;
+    }
+}
+
+/*********************************************************************
+ * @fn      sim_reg_read
+ *
+ * @brief   Returns the value a register reads back as.
+ *
+ * @return  Register value.
+ */
+static uint32_t sim_reg_read(uint32_t Offset)
+{
+    switch(Offset)
+    {
+        case REG_ACTLR: return sim.ACTLR;
+        case REG_STATR: return sim.STATR;
+        case REG_CTLR:  return sim.CTLR;
+        case REG_ADDR:  return sim.ADDR;
+        case REG_OBR:   return sim.OBR;
+        case REG_WPR:   return sim.WPR;
+        default:        return 0;
+    }
+}
+
+/*********************************************************************
+ * @fn      sim_reg_write
+ *
+ * @brief   Applies a write of Value to the register at Offset.
+ *
+ * @return  none
+ */
+static void sim_reg_write(uint32_t Offset, uint32_t Value)
+{
+    switch(Offset)
+    {
+        case REG_ACTLR:
+            sim.ACTLR = Value;
+            break;
+
+        case REG_KEYR:
+            if(sim_key(&sim.KeyStage, Value))
+                sim.CTLR &= ~CR_LOCK;
+            break;
+
+        case REG_OBKEYR:
+            if(sim_key(&sim.OBKeyStage, Value) && !(sim.CTLR & CR_LOCK))
+                sim.CTLR |= CR_OPTWRE;
+            break;
+
+        case REG_MODEKEYR:
+            if(sim_key(&sim.ModeKeyStage, Value) && !(sim.CTLR & CR_LOCK))
+                sim.CTLR &= ~CR_FAST_LOCK;
+            break;
+
+        case REG_STATR:
+            sim.STATR &= ~(Value & (SR_PGERR | SR_WRPRTERR | SR_EOP));
+            break;
+
+        case REG_CTLR:
+            sim_ctlr_write(Value);
+            break;
+
+        case REG_ADDR:
+            sim.ADDR = Value;
+            break;
+
+        default:
+            break;
+    }
+}
+
+/*********************************************************************
+ * @fn      sim_array_write
+ *
+ * @brief   Applies a CPU store to the main array or to the option bytes,
+ *          according to the programming mode selected in CTLR.
+ *
+ * @return  none
+ */
+static void sim_array_write(SIM_RegionTypeDef Region, uint32_t Address, const uint8_t *Page)
+{
+    uint32_t off = Address & (SIM_PAGE_SIZE - 1);
+
+    if(Region == SIM_REGION_INFO)
+    {
+        uint32_t a = Address & ~(uint32_t)1;
+        uint16_t v = *(const uint16_t *)(Page + (off & ~(uint32_t)1));
+
+        if(!(sim.CTLR & CR_OPTPG) || a < SIM_OB_BASE || a >= SIM_OB_BASE + SIM_OB_SIZE)
+        {
+            sim_stats.StrayWrites++;
+            return;
+        }
+        sim_start(SIM_OP_OB_PROGRAM, a, 0);
+        *(uint16_t *)(sim_alias_info + (a - SIM_INFO_BASE)) = v;
+        return;
+    }
+
+    if(sim.CTLR & CR_PAGE_PG)
+    {
+        uint32_t a = Address & ~(uint32_t)3;
+
+        sim_stall();
+        if(sim.PageBufLoaded == 0)
+            sim.PageBufAddr = a & ~(uint32_t)0xFF;
+        sim.PageBuf[(a >> 2) & 63] = *(const uint32_t *)(Page + (off & ~(uint32_t)3));
+        sim.PageBufLoaded |= (uint64_t)1 << ((a >> 2) & 63);
+        sim.Now_ns += sim_timing.SIM_OpTime[SIM_OP_PAGE_LOAD];
+        sim_stats.Op[SIM_OP_PAGE_LOAD].Count++;
+        sim_stats.Op[SIM_OP_PAGE_LOAD].Busy_ns += sim_timing.SIM_OpTime[SIM_OP_PAGE_LOAD];
+    }
+    else if(sim.CTLR & CR_PG)
+    {
+        uint32_t a = Address & ~(uint32_t)1;
+
+        sim_stall();
+        if(!sim_erased(a - SIM_FLASH_BASE, 2))
+        {
+            sim.STATR |= SR_PGERR;
+            sim_stats.PgErrors++;
+            return;
+        }
+        sim_start(SIM_OP_HALFWORD, a, 2);
+        if(sim.STATR & SR_BSY)
+            *(uint16_t *)(sim_alias_array + (a - SIM_FLASH_BASE)) = *(const uint16_t *)(Page + (off & ~(uint32_t)1));
+    }
+    else
+    {
+        sim_stats.StrayWrites++;
+    }
+}
+
+/*********************************************************************
+ * @fn      sim_segv
+ *
+ * @brief   Fault on a simulated region: opens the page and single-steps the
+ *          faulting instruction.
+ *
+ * @return  none
+ */
+static void sim_segv(int sig, siginfo_t *si, void *ctx)
+{
+    ucontext_t *uc = (ucontext_t *)ctx;
+    uintptr_t   addr = (uintptr_t)si->si_addr;
+    uintptr_t   page = addr & ~(uintptr_t)(SIM_PAGE_SIZE - 1);
+    uint32_t    i;
+
+    (void)sig;
+
+    if(sim_trap.Active)
+        sim_fatal("sim_flash: nested fault while single-stepping\n");
+
+    sim_trap.Region = sim_region(addr);
+    sim_trap.Addr = (uint32_t)addr;
+    sim_trap.Write = (uc->uc_mcontext.gregs[REG_ERR] & 2) != 0;
+
+    switch(sim_trap.Region)
+    {
+        case SIM_REGION_REG:
+            sim.Now_ns += sim_timing.SIM_RegAccess;
+            if(sim_timing.SIM_SkipBusyPolls && !sim_trap.Write &&
+               (sim_trap.Addr & (SIM_PAGE_SIZE - 4)) == REG_STATR)
+            {
+                sim_stall();
+            }
+            sim_update();
+            if(sim_trap.Write)
+                sim_stats.RegWrites++;
+            else
+                sim_stats.RegReads++;
+            for(i = 0; i < REG_NUM; i++){
+                sim_alias_reg[i] = sim_reg_read(i * 4);
+            }
+            mprotect((void *)page, SIM_PAGE_SIZE, PROT_READ | PROT_WRITE);
+            break;
+
+        case SIM_REGION_BLOCK:
+            sim_trap.Block = sim_find_block(addr);
+            sim.Now_ns += (uint64_t)sim_trap.Block->AccessCycles * 1000000000ULL / SystemCoreClock;
+            sim_update();
+            if(sim_trap.Block->Before)
+                sim_trap.Block->Before(sim_trap.Addr & (SIM_PAGE_SIZE - 4), sim_trap.Write);
+            mprotect((void *)page, SIM_PAGE_SIZE, PROT_READ | PROT_WRITE);
+            for(i = 0; i < sim_trap.Block->Size; i += 4){
+                ((uint32_t *)page)[i / 4] = sim_trap.Block->Read(i);
+            }
+            break;
+
+        case SIM_REGION_ARRAY:
+        case SIM_REGION_INFO:
+            if(!sim_trap.Write)
+                sim_fatal("sim_flash: unexpected read fault\n");
+            memcpy(sim_trap.Saved, (const void *)page, SIM_PAGE_SIZE);
+            mprotect((void *)page, SIM_PAGE_SIZE, PROT_READ | PROT_WRITE);
+            break;
+
+        default:
+            sim_fatal("sim_flash: segmentation fault outside the simulated device\n");
+    }
+
+    sim_trap.Active = 1;
+    uc->uc_mcontext.gregs[REG_EFL] |= SIM_TRAP_FLAG;
+}
+
+/*********************************************************************
+ * @fn      sim_trap_step
+ *
+ * @brief   Runs after the faulting instruction: applies its side effects and
+ *          closes the page again.
+ *
+ * @return  none
+ */
+static void sim_trap_step(int sig, siginfo_t *si, void *ctx)
+{
+    ucontext_t *uc = (ucontext_t *)ctx;
+    uintptr_t   page = sim_trap.Addr & ~(uintptr_t)(SIM_PAGE_SIZE - 1);
+    uint8_t     now[SIM_PAGE_SIZE];
+    uint32_t    i;
+
+    (void)sig;
+    (void)si;
+
+    if(!sim_trap.Active)
+        sim_fatal("sim_flash: unexpected SIGTRAP\n");
+
+    uc->uc_mcontext.gregs[REG_EFL] &= ~SIM_TRAP_FLAG;
+    sim_trap.Active = 0;
+
+    if(sim_trap.Region == SIM_REGION_REG)
+    {
+        mprotect((void *)page, SIM_PAGE_SIZE, PROT_NONE);
+        if(sim_trap.Write)
+            sim_reg_write(sim_trap.Addr & (SIM_PAGE_SIZE - 4), sim_alias_reg[(sim_trap.Addr & (SIM_PAGE_SIZE - 4)) / 4]);
+        return;
+    }
+
+    if(sim_trap.Region == SIM_REGION_BLOCK)
+    {
+        uint32_t offset = sim_trap.Addr & (SIM_PAGE_SIZE - 4);
+        uint32_t value = ((const uint32_t *)page)[offset / 4];
+
+        mprotect((void *)page, SIM_PAGE_SIZE, PROT_NONE);
+        sim_trap.Block->Access(offset, sim_trap.Write, value);
+        return;
+    }
+
+    /* The raw store landed in the backing page: take it out again and feed
+     * it through the programming model. Other words changed by the same
+     * instruction (wide stores) are applied as well. */
+    memcpy(now, (const void *)page, SIM_PAGE_SIZE);
+    memcpy((void *)page, sim_trap.Saved, SIM_PAGE_SIZE);
+    mprotect((void *)page, SIM_PAGE_SIZE, PROT_READ);
+
+    sim_array_write(sim_trap.Region, sim_trap.Addr, now);
+    for(i = 0; i < SIM_PAGE_SIZE; i += 4){
+        if((page + i) != (sim_trap.Addr & ~(uintptr_t)3) && memcmp(now + i, sim_trap.Saved + i, 4) != 0)
+            sim_array_write(sim_trap.Region, (uint32_t)(page + i), now);
+    }
+}
+
+/*********************************************************************
+ * @fn      sim_map
+ *
+ * @brief   Maps Length bytes of the backing file at a fixed address.
+ *
+ * @return  0 on success.
+ */
+static int sim_map(int fd, uint32_t Base, uint32_t Length, off_t Offset, int Prot)
+{
+    void *p = mmap((void *)(uintptr_t)Base, Length, Prot, MAP_SHARED | MAP_FIXED_NOREPLACE, fd, Offset);
+
+    if(p == MAP_FAILED || p != (void *)(uintptr_t)Base)
+    {
+        fprintf(stderr, "sim_flash: cannot map 0x%08x: %s\n", Base, strerror(errno));
+        return -1;
+    }
+    return 0;
+}
+
+/*********************************************************************
+ * @fn      SIM_FLASH_Init
+ *
+ * @brief   Maps the simulated device and installs the fault handlers.
+ *          Must be called before any FLASH_xxx function.
+ *
+ * @return  0 on success.
+ */
+int SIM_FLASH_Init(void)
+{
+    struct sigaction sa;
+    size_t  total = SIM_FLASH_SIZE + SIM_INFO_SIZE + SIM_PAGE_SIZE;
+    uint8_t *alias;
+    int     fd;
+
+    fd = memfd_create("ch32v20x_flash", 0);
+    if(fd < 0 || ftruncate(fd, (off_t)total) != 0)
+    {
+        perror("sim_flash: memfd");
+        return -1;
+    }
+
+    alias = mmap(NULL, total, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if(alias == MAP_FAILED)
+    {
+        perror("sim_flash: mmap");
+        return -1;
+    }
+    sim_alias_array = alias;
+    sim_alias_info = alias + SIM_FLASH_SIZE;
+    sim_alias_reg = (uint32_t *)(alias + SIM_FLASH_SIZE + SIM_INFO_SIZE);
+
+    if(sim_map(fd, SIM_FLASH_BASE, SIM_FLASH_SIZE, 0, PROT_READ) ||
+       sim_map(fd, SIM_INFO_BASE, SIM_INFO_SIZE, SIM_FLASH_SIZE, PROT_READ) ||
+       sim_map(fd, SIM_FLASH_R_BASE, SIM_PAGE_SIZE, SIM_FLASH_SIZE + SIM_INFO_SIZE, PROT_NONE))
+    {
+        return -1;
+    }
+    close(fd);
+
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_flags = SA_SIGINFO;
+    sigemptyset(&sa.sa_mask);
+    sa.sa_sigaction = sim_segv;
+    sigaction(SIGSEGV, &sa, NULL);
+    sa.sa_sigaction = sim_trap_step;
+    sigaction(SIGTRAP, &sa, NULL);
+
+    SIM_FLASH_Reset();
+    return 0;
+}
+
+/*********************************************************************
+ * @fn      SIM_FLASH_Reset
+ *
+ * @brief   Returns the device to its delivery state: array erased, option
+ *          bytes unprotected, controller locked, statistics and time cleared.
+ *
+ * @return  none
+ */
+void SIM_FLASH_Reset(void)
+{
+    static const uint16_t ob_default[8] = {0x5AA5, 0x00FF, 0x00FF, 0x00FF, 0x00FF, 0x00FF, 0x00FF, 0x00FF};
+    static const uint8_t  uid[8] = {0x84, 0xC2, 0xE4, 0x03, 0x02, 0x03, 0xFF, 0xFF};
+
+    sim_fill_erased(0, SIM_FLASH_SIZE);
+    memset(sim_alias_info, 0xFF, SIM_INFO_SIZE);
+    memcpy(sim_alias_info + (SIM_OB_BASE - SIM_INFO_BASE), ob_default, sizeof(ob_default));
+    memcpy(sim_alias_info + (SIM_UID_BASE - SIM_INFO_BASE), uid, sizeof(uid));
+    *(uint16_t *)(sim_alias_info + (SIM_FLACAP_BASE - SIM_INFO_BASE)) = (uint16_t)(SIM_FLASH_SIZE / 1024);
+
+    memset(&sim, 0, sizeof(sim));
+    sim.CTLR = CR_LOCK | CR_FAST_LOCK;
+    sim_reload_ob();
+    SIM_FLASH_ClearStats();
+}
+
+/*********************************************************************
+ * @fn      SIM_FLASH_SetTiming
+ *
+ * @brief   Replaces the timing model.
+ *
+ * @return  none
+ */
+void SIM_FLASH_SetTiming(const SIM_FLASH_TimingTypeDef *Timing)
+{
+    sim_timing = *Timing;
+}
+
+/*********************************************************************
+ * @fn      SIM_FLASH_GetTiming
+ *
+ * @brief   Reads back the timing model.
+ *
+ * @return  none
+ */
+void SIM_FLASH_GetTiming(SIM_FLASH_TimingTypeDef *Timing)
+{
+    *Timing = sim_timing;
+}
+
+/*********************************************************************
+ * @fn      SIM_FLASH_GetStats
+ *
+ * @brief   Copies the operation counters.
+ *
+ * @return  none
+ */
+void SIM_FLASH_GetStats(SIM_FLASH_StatsTypeDef *Stats)
+{
+    *Stats = sim_stats;
+}
+
+/*********************************************************************
+ * @fn      SIM_FLASH_ClearStats
+ *
+ * @brief   Clears the operation counters.
+ *
+ * @return  none
+ */
+void SIM_FLASH_ClearStats(void)
+{
+    memset(&sim_stats, 0, sizeof(sim_stats));
+}
+
+/*********************************************************************
+ * @fn      sim_mcycle
+ *
+ * @brief   Machine cycle counter of the simulated core: advances at
+ *          SystemCoreClock, and like the hardware counter it keeps
+ *          counting from where it was when the clock changes (the time
+ *          since the previous read counts at the new clock).
+ *
+ * @return  mcycle.
+ */
+static uint64_t sim_mcycle(void)
+{
+    sim.McycleMilli += (sim.Now_ns - sim.McycleNs) * (SystemCoreClock / 1000000);
+    sim.McycleNs = sim.Now_ns;
+    return sim.McycleMilli / 1000;
+}
+
+/*********************************************************************
+ * @fn      __get_MCYCLE
+ *
+ * @brief   Machine cycle counter of the simulated core.
+ *
+ * @return  Low 32 bits of mcycle.
+ */
+uint32_t __get_MCYCLE(void)
+{
+    return (uint32_t)sim_mcycle();
+}
+
+/*********************************************************************
+ * @fn      __get_MCYCLEH
+ *
+ * @brief   Machine cycle counter of the simulated core, high word.
+ *
+ * @return  High 32 bits of mcycle.
+ */
+uint32_t __get_MCYCLEH(void)
+{
+    return (uint32_t)(sim_mcycle() >> 32);
+}
+
+/*********************************************************************
+ * @fn      SIM_GetTime_ns
+ *
+ * @brief   Simulated time since reset.
+ *
+ * @return  Time in nanoseconds.
+ */
+uint64_t SIM_GetTime_ns(void)
+{
+    return sim.Now_ns;
+}
+
+/*********************************************************************
+ * @fn      SIM_AdvanceTime_ns
+ *
+ * @brief   Accounts time spent outside the FLASH controller. Operations
+ *          ending within the interval, in the controller or in a block
+ *          model, complete at their own end time and raise their
+ *          interrupt there, so work the handler chains starts on time.
+ *
+ * @return  none
+ */
+void SIM_AdvanceTime_ns(uint64_t ns)
+{
+    uint64_t end = sim.Now_ns + ns, next;
+
+    sim_irq();
+    while((next = sim_next_event()) <= end)
+    {
+        if(next > sim.Now_ns)
+            sim.Now_ns = next;
+        sim_update();
+        sim_irq();
+    }
+    if(end > sim.Now_ns)
+        sim.Now_ns = end;
+    sim_update();
+    sim_irq();
+}
+
+/*********************************************************************
+ * @fn      SIM_FLASH_SetIRQHandler
+ *
+ * @brief   Installs the handler run for the FLASH interrupt, the host
+ *          counterpart of enabling FLASH_IRQn. NULL masks the interrupt.
+ *
+ * @return  none
+ */
+void SIM_FLASH_SetIRQHandler(void (*Handler)(void))
+{
+    sim_irq_handler = Handler;
+}
+
+/*********************************************************************
+ * @fn      SIM_FLASH_CutPowerAfter
+ *
+ * @brief   Simulates a power cut: after Ops more program or erase
+ *          operations, further ones leave the array unchanged and end at
+ *          once without an error flag, as if the chip lost power before
+ *          they ran. -1 restores power.
+ *
+ * @return  none
+ */
+void SIM_FLASH_CutPowerAfter(int32_t Ops)
+{
+    sim_cut_left = Ops;
+}
+
+/*********************************************************************
+ * @fn      SIM_FLASH_TearCutErase
+ *
+ * @brief   Makes the power cut of SIM_FLASH_CutPowerAfter land inside
+ *          the erase it hits instead of before it: the erase ends at once
+ *          like a dropped one but leaves its range half erased, in a
+ *          pattern picked by Seed. Programs are still dropped whole.
+ *          0 drops erases whole again.
+ *
+ * @return  none
+ */
+void SIM_FLASH_TearCutErase(uint32_t Seed)
+{
+    sim_tear_seed = Seed;
+}
+
+/*********************************************************************
+ * @fn      SIM_OpName
+ *
+ * @brief   Name of an operation kind, for reports.
+ *
+ * @return  Name string.
+ */
+const char *SIM_OpName(SIM_OpTypeDef Op)
+{
+    return (Op < SIM_OP_NUM) ? sim_op_name[Op] : "unknown";
+}
+
+/*********************************************************************
+ * @fn      SIM_MapBlock
+ *
+ * @brief   Maps the register page of another peripheral model. Block
+ *          must stay valid, the models keep theirs static.
+ *
+ * @return  0 on success.
+ */
+int SIM_MapBlock(const SIM_BlockTypeDef *Block)
+{
+    void *p;
+
+    if(sim_blocks == SIM_BLOCK_MAX || (Block->Base & (SIM_PAGE_SIZE - 1)) || Block->Size > SIM_PAGE_SIZE)
+        return -1;
+
+    p = mmap((void *)(uintptr_t)Block->Base, SIM_PAGE_SIZE, Block->Size ? PROT_NONE : PROT_READ | PROT_WRITE,
+             MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+    if(p == MAP_FAILED || p != (void *)(uintptr_t)Block->Base)
+    {
+        fprintf(stderr, "sim_flash: cannot map 0x%08x: %s\n", Block->Base, strerror(errno));
+        return -1;
+    }
+    sim_block[sim_blocks++] = Block;
+    return 0;
+}
+
+/*********************************************************************
+ * @fn      SIM_Stall_ns
+ *
+ * @brief   Lets simulated time run to Until_ns without running any
+ *          interrupt handler, as a bus access that waits does. For
+ *          block models, from their Before callback.
+ *
+ * @return  none
+ */
+void SIM_Stall_ns(uint64_t Until_ns)
+{
+    if(Until_ns > sim.Now_ns)
+        sim.Now_ns = Until_ns;
+    sim_update();
+}
+
+/*********************************************************************
+ * @fn      SIM_BusRead
+ *
+ * @brief   Read of another bus master (the DMA): the array and option
+ *          bytes, a block register, or host memory.
+ *
+ * @param   Address - address, aligned to Size.
+ *          Size - 1, 2 or 4 bytes.
+ *          Value - value read.
+ *
+ * @return  1 on success, 0 on a bus error.
+ */
+int SIM_BusRead(uint32_t Address, uint8_t Size, uint32_t *Value)
+{
+    const SIM_BlockTypeDef *block;
+    const uint8_t          *p;
+    uint32_t                offset, v;
+
+    switch(sim_region(Address))
+    {
+        case SIM_REGION_BLOCK:
+            block = sim_find_block(Address);
+            offset = Address & (SIM_PAGE_SIZE - 4);
+            v = offset < block->Size ? block->Read(offset) : 0;
+            block->Access(offset, 0, v);
+            *Value = (v >> (8 * (Address & 3))) & (Size == 4 ? 0xFFFFFFFF : ((uint32_t)1 << (8 * Size)) - 1);
+            return 1;
+
+        case SIM_REGION_REG:
+            return 0;
+
+        case SIM_REGION_ARRAY:
+            p = sim_alias_array + (Address - SIM_FLASH_BASE);
+            break;
+
+        case SIM_REGION_INFO:
+            p = sim_alias_info + (Address - SIM_INFO_BASE);
+            break;
+
+        default:
+            p = (const uint8_t *)(uintptr_t)Address;
+            break;
+    }
+    if(Address == 0)
+        return 0;
+
+    v = 0;
+    memcpy(&v, p, Size);
+    *Value = v;
+    return 1;
+}
+
+/*********************************************************************
+ * @fn      SIM_BusWrite
+ *
+ * @brief   Write of another bus master (the DMA): a block register or
+ *          host memory. The array cannot be written without the
+ *          controller, such writes count as stray and fail.
+ *
+ * @param   Address - address, aligned to Size.
+ *          Size - 1, 2 or 4 bytes.
+ *          Value - value, in its low Size bytes.
+ *
+ * @return  1 on success, 0 on a bus error.
+ */
+int SIM_BusWrite(uint32_t Address, uint8_t Size, uint32_t Value)
+{
+    const SIM_BlockTypeDef *block;
+    uint32_t                offset, shift, mask, v;
+
+    switch(sim_region(Address))
+    {
+        case SIM_REGION_BLOCK:
+            block = sim_find_block(Address);
+            offset = Address & (SIM_PAGE_SIZE - 4);
+            shift = 8 * (Address & 3);
+            mask = (Size == 4 ? 0xFFFFFFFF : ((uint32_t)1 << (8 * Size)) - 1) << shift;
+            v = offset < block->Size ? block->Read(offset) : 0;
+            block->Access(offset, 1, (v & ~mask) | ((Value << shift) & mask));
+            return 1;
+
+        case SIM_REGION_REG:
+            return 0;
+
+        case SIM_REGION_ARRAY:
+        case SIM_REGION_INFO:
+            sim_stats.StrayWrites++;
+            return 0;
+
+        default:
+            if(Address == 0)
+                return 0;
+            memcpy((void *)(uintptr_t)Address, &Value, Size);
+            return 1;
+    }
+}
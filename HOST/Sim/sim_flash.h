@@ -0,0 +1,114 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : sim_flash.h
+ * Author             : typetrade
+ * Version            : V1.0.0
+ * Date               : 2026/10/17
+ * Description        : Host-side register-level simulator of the CH32V20x FLASH
+ *                      controller (FPEC), so ch32v20x_flash.c runs unmodified
+ *                      on Linux x86_64.
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+#ifndef __SIM_FLASH_H
+#define __SIM_FLASH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/* Simulated address map */
+#define SIM_FLASH_BASE                 ((uint32_t)0x08000000)
+#define SIM_FLASH_SIZE                 ((uint32_t)0x00080000) /* Bank1: 0x08000000 - 0x0807FFFF */
+#define SIM_INFO_BASE                  ((uint32_t)0x1FFFF000) /* Boot/UID/option byte page */
+#define SIM_INFO_SIZE                  ((uint32_t)0x00001000)
+#define SIM_FLASH_R_BASE               ((uint32_t)0x40022000)
+
+/* Erased cell pattern, see the note in main.c */
+#define SIM_FLASH_ERASED_WORD          ((uint32_t)0xE339E339)
+
+/* Simulated operation kinds */
+typedef enum
+{
+    SIM_OP_HALFWORD = 0,   /* Standard halfword program (PG) */
+    SIM_OP_PAGE_LOAD,      /* One word loaded into the 256B fast buffer */
+    SIM_OP_PAGE_PROGRAM,   /* Fast 256B page program (PG_STRT) */
+    SIM_OP_PAGE_ERASE,     /* Fast 256B page erase */
+    SIM_OP_SECTOR_ERASE,   /* Standard 4K page erase */
+    SIM_OP_BLOCK32_ERASE,  /* Fast 32K block erase */
+    SIM_OP_BLOCK64_ERASE,  /* Fast 64K block erase */
+    SIM_OP_MASS_ERASE,     /* Whole bank erase */
+    SIM_OP_OB_ERASE,       /* Option byte erase */
+    SIM_OP_OB_PROGRAM,     /* Option byte halfword program */
+    SIM_OP_NUM
+} SIM_OpTypeDef;
+
+/* Timing model, all values in nanoseconds */
+typedef struct
+{
+    uint32_t SIM_OpTime[SIM_OP_NUM]; /* Busy time of each operation kind */
+    uint32_t SIM_RegAccess;          /* Cost of one FLASH register access (bus + poll loop) */
+    uint8_t  SIM_SkipBusyPolls;      /* 1: a STATR read while busy jumps to the end of the
+                                        operation instead of costing one poll, so poll loops
+                                        run once instead of thousands of trapped reads */
+} SIM_FLASH_TimingTypeDef;
+
+/* Per operation counters */
+typedef struct
+{
+    uint32_t Count;
+    uint64_t Busy_ns;
+} SIM_OpStatTypeDef;
+
+typedef struct
+{
+    SIM_OpStatTypeDef Op[SIM_OP_NUM];
+    uint64_t          Busy_ns;       /* Total time the controller reported BSY */
+    uint32_t          RegReads;      /* Trapped FLASH register reads */
+    uint32_t          RegWrites;     /* Trapped FLASH register writes */
+    uint32_t          PgErrors;      /* Operations rejected with PGERR */
+    uint32_t          WrpErrors;     /* Operations rejected with WRPRTERR */
+    uint32_t          StrayWrites;   /* Array writes outside any program mode */
+    uint32_t          Dropped;       /* Operations lost to SIM_FLASH_CutPowerAfter */
+    uint32_t          Torn;          /* Of which erases left half done, SIM_FLASH_TearCutErase */
+} SIM_FLASH_StatsTypeDef;
+
+/* Register block of another simulated peripheral (sim_periph.c), trapped
+ * like the FLASH registers. The callbacks run in the fault handlers,
+ * except Irq. Size 0 maps a plain RAM page: no trapping, no callbacks. */
+typedef struct
+{
+    uint32_t Base;                                    /* Page address */
+    uint32_t Size;                                    /* Bytes of registers from Base */
+    uint32_t AccessCycles;                            /* HCLK cycles per register access */
+    void     (*Before)(uint32_t Offset, int Write);   /* Access about to happen, may stall */
+    uint32_t (*Read)(uint32_t Offset);                /* Value of the word at Offset */
+    void     (*Access)(uint32_t Offset, int Write, uint32_t Value); /* Access done */
+    void     (*Update)(void);                         /* Simulated time moved on */
+    uint64_t (*NextEvent)(void);                      /* Next time Update has work, UINT64_MAX: none */
+    void     (*Irq)(void);                            /* Runs pending interrupt handlers */
+} SIM_BlockTypeDef;
+
+int      SIM_FLASH_Init(void);
+void     SIM_FLASH_Reset(void);
+void     SIM_FLASH_SetTiming(const SIM_FLASH_TimingTypeDef *Timing);
+void     SIM_FLASH_GetTiming(SIM_FLASH_TimingTypeDef *Timing);
+void     SIM_FLASH_GetStats(SIM_FLASH_StatsTypeDef *Stats);
+void     SIM_FLASH_ClearStats(void);
+uint64_t SIM_GetTime_ns(void);
+void     SIM_AdvanceTime_ns(uint64_t ns);
+void     SIM_FLASH_SetIRQHandler(void (*Handler)(void));
+void     SIM_FLASH_CutPowerAfter(int32_t Ops);
+void     SIM_FLASH_TearCutErase(uint32_t Seed);
+const char *SIM_OpName(SIM_OpTypeDef Op);
+
+int      SIM_MapBlock(const SIM_BlockTypeDef *Block);
+void     SIM_Stall_ns(uint64_t Until_ns);
+int      SIM_BusRead(uint32_t Address, uint8_t Size, uint32_t *Value);
+int      SIM_BusWrite(uint32_t Address, uint8_t Size, uint32_t Value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,1069 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : sim_periph.c
+ * Author             : typetrade
+ * Version            : V1.0.0
+ * Date               : 2026/10/17
+ * Description        : Host-side register-level models of the CH32V20x
+ *                      peripherals around the FLASH controller.
+ *
+ *                      - RCC is a plain RAM page: the drivers set clock
+ *                        gates, the models below ignore register writes
+ *                        while their gate in AHBPCENR is off.
+ *                      - CRC: CRC-32, polynomial 0x04C11DB7, 32-bit words
+ *                        MSB first, reset to 0xFFFFFFFF, no output XOR.
+ *                      - DMA1: 8 channels. Memory-to-memory transfers run
+ *                        from EN at one item every SIM_DMA_BEAT_CYCLES
+ *                        HCLK cycles of simulated time; the data moves as
+ *                        time passes, so CNTR reads show the progress.
+ *                        HT/TC/TE flags and interrupts as on the part.
+ *                        Back-to-back INTFR reads while a transfer runs
+ *                        (a poll loop) jump to its next event, like a
+ *                        skipped FLASH busy poll.
+ *                        Channels without MEM2MEM move one item per
+ *                        request of their peripheral (USART RX).
+ *                      - USART1-3: the receive side. SIM_USART_Feed puts
+ *                        bytes on the RX line at a given baud rate; each
+ *                        one lands in DATAR when its stop bit ends, sets
+ *                        RXNE (ORE if the previous one was not taken) and
+ *                        requests the RX DMA channel with DMAR. IDLE sets
+ *                        one frame after the last byte, and clears by a
+ *                        STATR read then a DATAR read. Transmitted bytes
+ *                        leave at once: TXE and TC stay set, the bytes
+ *                        wait in a buffer for SIM_USART_Drain.
+ *                      - AFIO/GPIO is a plain RAM page.
+ *                      Addresses the DMA uses must be 32-bit on the host:
+ *                      HOST/Makefile links without PIE, so static buffers
+ *                      qualify, stack and heap buffers may not.
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sim_flash.h"
+#include "sim_periph.h"
+
+/* RCC */
+#define RCC_AHBPCENR               0x14
+#define RCC_APB2PCENR              0x18
+#define RCC_APB1PCENR              0x1C
+#define RCC_AHB_DMA1               ((uint32_t)0x00000001)
+#define RCC_AHB_CRC                ((uint32_t)0x00000040)
+#define RCC_AHBPCENR_RESET         ((uint32_t)0x00000014) /* SRAM and FLITF clocks */
+
+/* CRC register offsets and bits */
+#define CRC_DATAR                  0x00
+#define CRC_IDATAR                 0x04
+#define CRC_CTLR                   0x08
+#define CRC_CTLR_RESET             ((uint32_t)0x00000001)
+#define CRC_POLY                   ((uint32_t)0x04C11DB7)
+
+/* DMA register offsets and bits */
+#define DMA_INTFR                  0x00
+#define DMA_INTFCR                 0x04
+#define DMA_CH_BASE                0x08
+#define DMA_CH_STRIDE              0x14
+#define DMA_CH_CFGR                0x00
+#define DMA_CH_CNTR                0x04
+#define DMA_CH_PADDR               0x08
+#define DMA_CH_MADDR               0x0C
+
+#define CFGR_EN                    ((uint32_t)0x00000001)
+#define CFGR_TCIE                  ((uint32_t)0x00000002)
+#define CFGR_HTIE                  ((uint32_t)0x00000004)
+#define CFGR_TEIE                  ((uint32_t)0x00000008)
+#define CFGR_DIR                   ((uint32_t)0x00000010)
+#define CFGR_CIRC                  ((uint32_t)0x00000020)
+#define CFGR_PINC                  ((uint32_t)0x00000040)
+#define CFGR_MINC                  ((uint32_t)0x00000080)
+#define CFGR_MEM2MEM               ((uint32_t)0x00004000)
+#define CFGR_MASK                  ((uint32_t)0x00007FFF)
+
+/* INTFR bits of channel index k (0-based) */
+#define INT_GIF(k)                 ((uint32_t)1 << (4 * (k)))
+#define INT_TCIF(k)                ((uint32_t)2 << (4 * (k)))
+#define INT_HTIF(k)                ((uint32_t)4 << (4 * (k)))
+#define INT_TEIF(k)                ((uint32_t)8 << (4 * (k)))
+
+/* USART register offsets and bits */
+#define USART_STATR                0x00
+#define USART_DATAR                0x04
+#define USART_BRR                  0x08
+#define USART_CTLR1                0x0C
+#define USART_CTLR2                0x10
+#define USART_CTLR3                0x14
+#define USART_GPR                  0x18
+#define USART_SIZE                 0x1C
+
+#define STATR_ORE                  ((uint32_t)0x00000008)
+#define STATR_IDLE                 ((uint32_t)0x00000010)
+#define STATR_RXNE                 ((uint32_t)0x00000020)
+#define STATR_TC                   ((uint32_t)0x00000040)
+#define STATR_TXE                  ((uint32_t)0x00000080)
+#define STATR_RESET                (STATR_TC | STATR_TXE)
+#define STATR_CLEAR_BY_READ        ((uint32_t)0x0000001F) /* PE, FE, NE, ORE, IDLE */
+
+#define CTLR1_RE                   ((uint32_t)0x00000004)
+#define CTLR1_IDLEIE               ((uint32_t)0x00000010)
+#define CTLR1_RXNEIE               ((uint32_t)0x00000020)
+#define CTLR1_UE                   ((uint32_t)0x00002000)
+#define CTLR3_EIE                  ((uint32_t)0x00000001)
+#define CTLR3_DMAR                 ((uint32_t)0x00000040)
+
+/* USART2 and USART3 share the APB1 page, USART1 sits in the APB2 one */
+#define SIM_USART_APB1_PAGE        (SIM_USART2_BASE & ~(uint32_t)0xFFF)
+#define SIM_USART_APB2_PAGE        (SIM_USART1_BASE & ~(uint32_t)0xFFF)
+
+/* One DMA channel */
+typedef struct
+{
+    uint32_t CFGR;
+    uint32_t CNTR;      /* Last count written, reloaded in circular mode */
+    uint32_t PADDR;
+    uint32_t MADDR;
+    uint32_t Left;      /* Items left, what CNTR reads, kept over EN off/on */
+    uint32_t PCur;      /* Next peripheral-side address */
+    uint32_t MCur;      /* Next memory-side address */
+    uint64_t Start_ns;  /* Memory-to-memory: time the transfer started */
+    uint32_t Done;      /* Memory-to-memory: items moved since Start_ns */
+    void (*Handler)(void);
+} SIM_DmaChTypeDef;
+
+/* One USART */
+typedef struct
+{
+    uint32_t       Base;
+    uint32_t       Gate;        /* RCC APBxPCENR offset << 16 | bit */
+    uint8_t        RxChannel;   /* DMA1 channel index of its RX request */
+    uint32_t       STATR;
+    uint32_t       DATAR;       /* Last byte received */
+    uint32_t       BRR;
+    uint32_t       CTLR1;
+    uint32_t       CTLR2;
+    uint32_t       CTLR3;
+    uint32_t       GPR;
+    uint32_t       Snap;        /* STATR flags seen by the last STATR read */
+    const uint8_t *Line;        /* Bytes still to arrive */
+    uint32_t       LineLeft;
+    uint64_t       Next_ns;     /* Stop bit end of the next byte */
+    uint64_t       Frame_ns;    /* One 10-bit frame at the feed's baud rate */
+    uint64_t       Idle_ns;     /* Time IDLE sets, UINT64_MAX if it does not */
+    uint8_t        Tx[SIM_USART_TX_SIZE]; /* Transmitted, not drained */
+    uint32_t       TxLength;
+    void (*Handler)(void);
+} SIM_UsartTypeDef;
+
+/* Core clock of the simulated part, sim_flash.c */
+extern uint32_t SystemCoreClock;
+
+static uint8_t *rcc_page = (uint8_t *)(uintptr_t)SIM_RCC_BASE;
+
+static uint32_t         crc_data;
+static uint8_t          crc_id;
+static uint32_t         dma_intfr;
+static SIM_DmaChTypeDef dma_ch[SIM_DMA_CHANNELS];
+static uint8_t          dma_in_beat = 0;
+static uint8_t          dma_polling = 0;  /* Last DMA access was an INTFR read */
+
+static SIM_UsartTypeDef usart[SIM_USART_NUM] = {
+    {.Base = SIM_USART1_BASE, .Gate = (RCC_APB2PCENR << 16) | 14, .RxChannel = 4},
+    {.Base = SIM_USART2_BASE, .Gate = (RCC_APB1PCENR << 16) | 17, .RxChannel = 5},
+    {.Base = SIM_USART3_BASE, .Gate = (RCC_APB1PCENR << 16) | 18, .RxChannel = 2},
+};
+
+static SIM_PERIPH_StatsTypeDef periph_stats;
+
+/*********************************************************************
+ * @fn      rcc_on
+ *
+ * @brief   Checks an AHB clock gate.
+ *
+ * @return  1 if the clock runs.
+ */
+static int rcc_on(uint32_t Gate)
+{
+    return (*(volatile uint32_t *)(rcc_page + RCC_AHBPCENR) & Gate) != 0;
+}
+
+/*********************************************************************
+ * @fn      crc_read
+ *
+ * @brief   CRC register read.
+ *
+ * @return  Register value.
+ */
+static uint32_t crc_read(uint32_t Offset)
+{
+    switch(Offset)
+    {
+        case CRC_DATAR:  return crc_data;
+        case CRC_IDATAR: return crc_id;
+        default:         return 0;
+    }
+}
+
+/*********************************************************************
+ * @fn      crc_access
+ *
+ * @brief   CRC register access: a DATAR write folds one word in.
+ *
+ * @return  none
+ */
+static void crc_access(uint32_t Offset, int Write, uint32_t Value)
+{
+    int i;
+
+    if(!Write)
+        return;
+    if(!rcc_on(RCC_AHB_CRC))
+    {
+        periph_stats.GatedWrites++;
+        return;
+    }
+
+    switch(Offset)
+    {
+        case CRC_DATAR:
+            crc_data ^= Value;
+            for(i = 0; i < 32; i++){
+                crc_data = (crc_data & 0x80000000) ? (crc_data << 1) ^ CRC_POLY : crc_data << 1;
+            }
+            periph_stats.CrcWrites++;
+            if(!dma_in_beat)
+                periph_stats.CrcCpuWrites++;
+            break;
+
+        case CRC_IDATAR:
+            crc_id = (uint8_t)Value;
+            break;
+
+        case CRC_CTLR:
+            if(Value & CRC_CTLR_RESET)
+                crc_data = 0xFFFFFFFF;
+            break;
+
+        default:
+            break;
+    }
+}
+
+/*********************************************************************
+ * @fn      dma_size
+ *
+ * @brief   Item size of a PSIZE/MSIZE field.
+ *
+ * @return  1, 2 or 4 bytes.
+ */
+static uint8_t dma_size(uint32_t Field)
+{
+    return (Field & 3) == 0 ? 1 : (Field & 3) == 1 ? 2 : 4;
+}
+
+/*********************************************************************
+ * @fn      dma_beat
+ *
+ * @brief   Moves one item of channel index k: read at the source size,
+ *          written at the destination size (zero-extended or
+ *          truncated). A bus error disables the channel with TEIF.
+ *
+ * @return  1 on success.
+ */
+static int dma_beat(uint32_t k)
+{
+    SIM_DmaChTypeDef *ch = &dma_ch[k];
+    uint8_t           psize = dma_size(ch->CFGR >> 8), msize = dma_size(ch->CFGR >> 10);
+    uint32_t          v;
+    int               ok;
+
+    dma_in_beat = 1;
+    if(ch->CFGR & CFGR_DIR)
+        ok = SIM_BusRead(ch->MCur, msize, &v) && SIM_BusWrite(ch->PCur, psize, v);
+    else
+        ok = SIM_BusRead(ch->PCur, psize, &v) && SIM_BusWrite(ch->MCur, msize, v);
+    dma_in_beat = 0;
+
+    if(!ok)
+    {
+        ch->CFGR &= ~CFGR_EN;
+        dma_intfr |= INT_TEIF(k) | INT_GIF(k);
+        periph_stats.DmaErrors++;
+        return 0;
+    }
+
+    if(ch->CFGR & CFGR_PINC)
+        ch->PCur += psize;
+    if(ch->CFGR & CFGR_MINC)
+        ch->MCur += msize;
+    ch->Left--;
+    periph_stats.DmaBeats++;
+
+    if(ch->Left == ch->CNTR / 2)
+        dma_intfr |= INT_HTIF(k) | INT_GIF(k);
+    if(ch->Left == 0)
+    {
+        dma_intfr |= INT_TCIF(k) | INT_GIF(k);
+        if(ch->CFGR & CFGR_CIRC)
+        {
+            ch->Left = ch->CNTR;
+            ch->PCur = ch->PADDR;
+            ch->MCur = ch->MADDR;
+        }
+    }
+    return 1;
+}
+
+/*********************************************************************
+ * @fn      dma_request
+ *
+ * @brief   Peripheral request on channel index k: one item moves if the
+ *          channel is enabled for a peripheral and has items left.
+ *
+ * @return  none
+ */
+static void dma_request(uint32_t k)
+{
+    const SIM_DmaChTypeDef *ch = &dma_ch[k];
+
+    if(rcc_on(RCC_AHB_DMA1) && (ch->CFGR & (CFGR_EN | CFGR_MEM2MEM)) == CFGR_EN && ch->Left)
+        dma_beat(k);
+}
+
+/*********************************************************************
+ * @fn      dma_items_ns
+ *
+ * @brief   Time memory-to-memory items take at the current clock.
+ *
+ * @return  Nanoseconds, rounded up.
+ */
+static uint64_t dma_items_ns(uint64_t Items)
+{
+    uint64_t mhz = SystemCoreClock / 1000000;
+
+    return (Items * SIM_DMA_BEAT_CYCLES * 1000 + mhz - 1) / mhz;
+}
+
+/*********************************************************************
+ * @fn      dma_m2m_running
+ *
+ * @brief   Checks whether channel index k runs a memory-to-memory
+ *          transfer.
+ *
+ * @return  1 if it does.
+ */
+static int dma_m2m_running(uint32_t k)
+{
+    const SIM_DmaChTypeDef *ch = &dma_ch[k];
+
+    return (ch->CFGR & (CFGR_EN | CFGR_MEM2MEM)) == (CFGR_EN | CFGR_MEM2MEM) && ch->Left;
+}
+
+/*********************************************************************
+ * @fn      dma_update
+ *
+ * @brief   Moves the memory-to-memory items due by now.
+ *
+ * @return  none
+ */
+static void dma_update(void)
+{
+    uint64_t now = SIM_GetTime_ns(), due;
+    uint32_t k;
+
+    for(k = 0; k < SIM_DMA_CHANNELS; k++){
+        if(!dma_m2m_running(k))
+            continue;
+        due = (now - dma_ch[k].Start_ns) * (SystemCoreClock / 1000000) / (SIM_DMA_BEAT_CYCLES * 1000);
+        while(dma_ch[k].Done < due && dma_m2m_running(k))
+        {
+            dma_ch[k].Done++;
+            dma_beat(k);
+        }
+    }
+}
+
+/*********************************************************************
+ * @fn      dma_next_event
+ *
+ * @brief   Time the next HT or TC flag of a memory-to-memory transfer
+ *          sets.
+ *
+ * @return  Time in ns, UINT64_MAX if none runs.
+ */
+static uint64_t dma_next_event(void)
+{
+    uint64_t next = UINT64_MAX, t;
+    uint32_t k, items;
+
+    for(k = 0; k < SIM_DMA_CHANNELS; k++){
+        if(!dma_m2m_running(k))
+            continue;
+        /* Items moved when the next flag sets */
+        items = dma_ch[k].Done + dma_ch[k].Left;
+        if(dma_ch[k].Left > dma_ch[k].CNTR / 2)
+            items -= dma_ch[k].CNTR / 2;
+        t = dma_ch[k].Start_ns + dma_items_ns(items);
+        if(t < next)
+            next = t;
+    }
+    return next;
+}
+
+/*********************************************************************
+ * @fn      dma_irq
+ *
+ * @brief   Runs the handler of each channel with an enabled flag set.
+ *
+ * @return  none
+ */
+static void dma_irq(void)
+{
+    uint32_t k, n, pending;
+
+    for(k = 0; k < SIM_DMA_CHANNELS; k++){
+        for(n = 0; dma_ch[k].Handler && n < 16; n++){
+            pending = ((dma_ch[k].CFGR & CFGR_TCIE) ? INT_TCIF(k) : 0) |
+                      ((dma_ch[k].CFGR & CFGR_HTIE) ? INT_HTIF(k) : 0) |
+                      ((dma_ch[k].CFGR & CFGR_TEIE) ? INT_TEIF(k) : 0);
+            if(!(dma_intfr & pending))
+                break;
+            dma_ch[k].Handler();
+        }
+        if(n == 16)
+        {
+            fprintf(stderr, "sim_periph: DMA1 channel %lu handler does not clear its flags\n", (unsigned long)k + 1);
+            exit(70);
+        }
+    }
+}
+
+/*********************************************************************
+ * @fn      dma_before
+ *
+ * @brief   A poll of INTFR waits for the next flag of a running
+ *          transfer instead of costing one access per iteration. A
+ *          single read, as in an interrupt handler, does not wait.
+ *
+ * @return  none
+ */
+static void dma_before(uint32_t Offset, int Write)
+{
+    uint64_t next;
+
+    if(Write || Offset != DMA_INTFR)
+    {
+        dma_polling = 0;
+        return;
+    }
+    next = dma_next_event();
+    if(dma_polling && next != UINT64_MAX)
+        SIM_Stall_ns(next);
+    dma_polling = 1;
+}
+
+/*********************************************************************
+ * @fn      dma_read
+ *
+ * @brief   DMA register read.
+ *
+ * @return  Register value.
+ */
+static uint32_t dma_read(uint32_t Offset)
+{
+    const SIM_DmaChTypeDef *ch;
+
+    if(Offset == DMA_INTFR)
+        return dma_intfr;
+    if(Offset < DMA_CH_BASE)
+        return 0;
+
+    ch = &dma_ch[(Offset - DMA_CH_BASE) / DMA_CH_STRIDE];
+    switch((Offset - DMA_CH_BASE) % DMA_CH_STRIDE)
+    {
+        case DMA_CH_CFGR:  return ch->CFGR;
+        case DMA_CH_CNTR:  return ch->Left;
+        case DMA_CH_PADDR: return ch->PADDR;
+        case DMA_CH_MADDR: return ch->MADDR;
+        default:           return 0;
+    }
+}
+
+/*********************************************************************
+ * @fn      dma_access
+ *
+ * @brief   DMA register access: flag clears and channel setup. CNTR,
+ *          PADDR and MADDR only take writes while the channel is off.
+ *
+ * @return  none
+ */
+static void dma_access(uint32_t Offset, int Write, uint32_t Value)
+{
+    SIM_DmaChTypeDef *ch;
+    uint32_t          k, clear;
+
+    if(!Write)
+        return;
+    if(!rcc_on(RCC_AHB_DMA1))
+    {
+        periph_stats.GatedWrites++;
+        return;
+    }
+
+    if(Offset == DMA_INTFCR)
+    {
+        for(k = 0; k < SIM_DMA_CHANNELS; k++){
+            clear = Value & (INT_GIF(k) | INT_TCIF(k) | INT_HTIF(k) | INT_TEIF(k));
+            if(clear & INT_GIF(k))
+                clear |= INT_TCIF(k) | INT_HTIF(k) | INT_TEIF(k);
+            dma_intfr &= ~clear;
+            if(!(dma_intfr & (INT_TCIF(k) | INT_HTIF(k) | INT_TEIF(k))))
+                dma_intfr &= ~INT_GIF(k);
+        }
+        return;
+    }
+    if(Offset < DMA_CH_BASE)
+        return;
+
+    k = (Offset - DMA_CH_BASE) / DMA_CH_STRIDE;
+    ch = &dma_ch[k];
+    switch((Offset - DMA_CH_BASE) % DMA_CH_STRIDE)
+    {
+        case DMA_CH_CFGR:
+            if(!(ch->CFGR & CFGR_EN) && (Value & CFGR_EN))
+            {
+                ch->PCur = ch->PADDR;
+                ch->MCur = ch->MADDR;
+                ch->Start_ns = SIM_GetTime_ns();
+                ch->Done = 0;
+            }
+            ch->CFGR = Value & CFGR_MASK;
+            break;
+
+        case DMA_CH_CNTR:
+            if(!(ch->CFGR & CFGR_EN))
+                ch->CNTR = ch->Left = Value & 0xFFFF;
+            break;
+
+        case DMA_CH_PADDR:
+            if(!(ch->CFGR & CFGR_EN))
+                ch->PADDR = Value;
+            break;
+
+        case DMA_CH_MADDR:
+            if(!(ch->CFGR & CFGR_EN))
+                ch->MADDR = Value;
+            break;
+
+        default:
+            break;
+    }
+}
+
+/*********************************************************************
+ * @fn      usart_on
+ *
+ * @brief   Checks the APB clock gate of a USART.
+ *
+ * @return  1 if the clock runs.
+ */
+static int usart_on(const SIM_UsartTypeDef *u)
+{
+    return (*(volatile uint32_t *)(rcc_page + (u->Gate >> 16)) & ((uint32_t)1 << (u->Gate & 0x1F))) != 0;
+}
+
+/*********************************************************************
+ * @fn      usart_at
+ *
+ * @brief   USART whose registers hold an address.
+ *
+ * @return  USART, NULL if none.
+ */
+static SIM_UsartTypeDef *usart_at(uint32_t Address)
+{
+    uint32_t n;
+
+    for(n = 0; n < SIM_USART_NUM; n++){
+        if(Address >= usart[n].Base && Address < usart[n].Base + USART_SIZE)
+            return &usart[n];
+    }
+    return NULL;
+}
+
+/*********************************************************************
+ * @fn      usart_read
+ *
+ * @brief   USART register read, at Page + Offset.
+ *
+ * @return  Register value.
+ */
+static uint32_t usart_read(uint32_t Page, uint32_t Offset)
+{
+    const SIM_UsartTypeDef *u = usart_at(Page + Offset);
+
+    if(u == NULL)
+        return 0;
+    switch(Page + Offset - u->Base)
+    {
+        case USART_STATR: return u->STATR;
+        case USART_DATAR: return u->DATAR;
+        case USART_BRR:   return u->BRR;
+        case USART_CTLR1: return u->CTLR1;
+        case USART_CTLR2: return u->CTLR2;
+        case USART_CTLR3: return u->CTLR3;
+        case USART_GPR:   return u->GPR;
+        default:          return 0;
+    }
+}
+
+/*********************************************************************
+ * @fn      usart_access
+ *
+ * @brief   USART register access: flag clearing sequences and setup.
+ *
+ * @return  none
+ */
+static void usart_access(uint32_t Page, uint32_t Offset, int Write, uint32_t Value)
+{
+    SIM_UsartTypeDef *u = usart_at(Page + Offset);
+
+    if(u == NULL)
+        return;
+    if(!Write)
+    {
+        if(Page + Offset - u->Base == USART_STATR)
+        {
+            u->Snap = u->STATR & STATR_CLEAR_BY_READ;
+        }
+        else if(Page + Offset - u->Base == USART_DATAR)
+        {
+            u->STATR &= ~(STATR_RXNE | u->Snap);
+            u->Snap = 0;
+        }
+        return;
+    }
+    if(!usart_on(u))
+    {
+        periph_stats.GatedWrites++;
+        return;
+    }
+
+    switch(Page + Offset - u->Base)
+    {
+        case USART_STATR:
+            /* RXNE and TC clear by writing 0, the rest is read-only */
+            u->STATR &= Value | ~(STATR_RXNE | STATR_TC);
+            break;
+        case USART_DATAR:
+            periph_stats.UsartTxBytes++;
+            if(u->TxLength < SIM_USART_TX_SIZE)
+                u->Tx[u->TxLength++] = (uint8_t)Value;
+            else
+                periph_stats.UsartTxLost++;
+            u->STATR |= STATR_TC | STATR_TXE;
+            break;
+        case USART_BRR:   u->BRR = Value & 0xFFFF;  break;
+        case USART_CTLR1: u->CTLR1 = Value & 0x3FFF; break;
+        case USART_CTLR2: u->CTLR2 = Value & 0x7F7F; break;
+        case USART_CTLR3: u->CTLR3 = Value & 0x07FF; break;
+        case USART_GPR:   u->GPR = Value & 0xFFFF;  break;
+        default:          break;
+    }
+}
+
+/*********************************************************************
+ * @fn      usart_apb1_read
+ *
+ * @brief   Register read in the USART2/USART3 page.
+ *
+ * @return  Register value.
+ */
+static uint32_t usart_apb1_read(uint32_t Offset)
+{
+    return usart_read(SIM_USART_APB1_PAGE, Offset);
+}
+
+/*********************************************************************
+ * @fn      usart_apb1_access
+ *
+ * @brief   Register access in the USART2/USART3 page.
+ *
+ * @return  none
+ */
+static void usart_apb1_access(uint32_t Offset, int Write, uint32_t Value)
+{
+    usart_access(SIM_USART_APB1_PAGE, Offset, Write, Value);
+}
+
+/*********************************************************************
+ * @fn      usart_apb2_read
+ *
+ * @brief   Register read in the USART1 page.
+ *
+ * @return  Register value.
+ */
+static uint32_t usart_apb2_read(uint32_t Offset)
+{
+    return usart_read(SIM_USART_APB2_PAGE, Offset);
+}
+
+/*********************************************************************
+ * @fn      usart_apb2_access
+ *
+ * @brief   Register access in the USART1 page.
+ *
+ * @return  none
+ */
+static void usart_apb2_access(uint32_t Offset, int Write, uint32_t Value)
+{
+    usart_access(SIM_USART_APB2_PAGE, Offset, Write, Value);
+}
+
+/*********************************************************************
+ * @fn      usart_receive
+ *
+ * @brief   The next byte on the line of u reaches the receiver.
+ *
+ * @return  none
+ */
+static void usart_receive(SIM_UsartTypeDef *u)
+{
+    uint8_t b = *u->Line++;
+
+    u->LineLeft--;
+    u->Idle_ns = u->Next_ns + u->Frame_ns;
+    u->Next_ns += u->Frame_ns;
+    if(!usart_on(u) || (u->CTLR1 & (CTLR1_UE | CTLR1_RE)) != (CTLR1_UE | CTLR1_RE))
+        return;
+
+    if(u->STATR & STATR_RXNE)
+    {
+        u->STATR |= STATR_ORE;
+        periph_stats.UsartOverruns++;
+        return;
+    }
+    u->DATAR = b;
+    u->STATR |= STATR_RXNE;
+    periph_stats.UsartRxBytes++;
+    if(u->CTLR3 & CTLR3_DMAR)
+        dma_request(u->RxChannel);
+}
+
+/*********************************************************************
+ * @fn      usart_update
+ *
+ * @brief   Receives the bytes due by now and sets IDLE when due, in
+ *          time order.
+ *
+ * @return  none
+ */
+static void usart_update(void)
+{
+    uint64_t          now = SIM_GetTime_ns();
+    SIM_UsartTypeDef *u;
+    uint32_t          n;
+
+    for(n = 0; n < SIM_USART_NUM; n++){
+        u = &usart[n];
+        for(;;)
+        {
+            if(u->LineLeft && u->Next_ns <= now && u->Next_ns <= u->Idle_ns)
+            {
+                usart_receive(u);
+            }
+            else if(u->Idle_ns <= now)
+            {
+                if(usart_on(u) && (u->CTLR1 & (CTLR1_UE | CTLR1_RE)) == (CTLR1_UE | CTLR1_RE))
+                    u->STATR |= STATR_IDLE;
+                u->Idle_ns = UINT64_MAX;
+            }
+            else
+            {
+                break;
+            }
+        }
+    }
+}
+
+/*********************************************************************
+ * @fn      usart_next_event
+ *
+ * @brief   Time the next byte arrives or IDLE sets.
+ *
+ * @return  Time in ns, UINT64_MAX if none.
+ */
+static uint64_t usart_next_event(void)
+{
+    uint64_t next = UINT64_MAX;
+    uint32_t n;
+
+    for(n = 0; n < SIM_USART_NUM; n++){
+        if(usart[n].LineLeft && usart[n].Next_ns < next)
+            next = usart[n].Next_ns;
+        if(usart[n].Idle_ns < next)
+            next = usart[n].Idle_ns;
+    }
+    return next;
+}
+
+/*********************************************************************
+ * @fn      usart_irq
+ *
+ * @brief   Runs the handler of each USART with an enabled source
+ *          pending: IDLE, RXNE, or ORE with RXNEIE or EIE and DMAR.
+ *
+ * @return  none
+ */
+static void usart_irq(void)
+{
+    const SIM_UsartTypeDef *u;
+    uint32_t                n, k, pending;
+
+    for(n = 0; n < SIM_USART_NUM; n++){
+        u = &usart[n];
+        for(k = 0; u->Handler && k < 16; k++){
+            pending = ((u->CTLR1 & CTLR1_IDLEIE) ? STATR_IDLE : 0) |
+                      ((u->CTLR1 & CTLR1_RXNEIE) ? STATR_RXNE | STATR_ORE : 0) |
+                      ((u->CTLR3 & (CTLR3_EIE | CTLR3_DMAR)) == (CTLR3_EIE | CTLR3_DMAR) ? STATR_ORE : 0);
+            if(!(u->STATR & pending))
+                break;
+            u->Handler();
+        }
+        if(k == 16)
+        {
+            fprintf(stderr, "sim_periph: USART%lu handler does not clear its flags\n", (unsigned long)n + 1);
+            exit(70);
+        }
+    }
+}
+
+static const SIM_BlockTypeDef sim_rcc_block = {
+    .Base = SIM_RCC_BASE,
+};
+
+static const SIM_BlockTypeDef sim_crc_block = {
+    .Base = SIM_CRC_BASE,
+    .Size = 0x0C,
+    .AccessCycles = 1,
+    .Read = crc_read,
+    .Access = crc_access,
+};
+
+static const SIM_BlockTypeDef sim_dma_block = {
+    .Base = SIM_DMA1_BASE,
+    .Size = DMA_CH_BASE + DMA_CH_STRIDE * SIM_DMA_CHANNELS,
+    .AccessCycles = 1,
+    .Before = dma_before,
+    .Read = dma_read,
+    .Access = dma_access,
+    .Update = dma_update,
+    .NextEvent = dma_next_event,
+    .Irq = dma_irq,
+};
+
+static const SIM_BlockTypeDef sim_gpio_block = {
+    .Base = SIM_GPIO_PAGE,
+};
+
+static const SIM_BlockTypeDef sim_usart_apb1_block = {
+    .Base = SIM_USART_APB1_PAGE,
+    .Size = SIM_USART3_BASE + USART_SIZE - SIM_USART_APB1_PAGE,
+    .AccessCycles = 2,
+    .Read = usart_apb1_read,
+    .Access = usart_apb1_access,
+    .Update = usart_update,
+    .NextEvent = usart_next_event,
+    .Irq = usart_irq,
+};
+
+static const SIM_BlockTypeDef sim_usart_apb2_block = {
+    .Base = SIM_USART_APB2_PAGE,
+    .Size = SIM_USART1_BASE + USART_SIZE - SIM_USART_APB2_PAGE,
+    .AccessCycles = 2,
+    .Read = usart_apb2_read,
+    .Access = usart_apb2_access,
+};
+
+/*********************************************************************
+ * @fn      SIM_PERIPH_Init
+ *
+ * @brief   Maps RCC, CRC, DMA1, AFIO/GPIO and the USARTs. Call after
+ *          SIM_FLASH_Init.
+ *
+ * @return  0 on success.
+ */
+int SIM_PERIPH_Init(void)
+{
+    if(SIM_MapBlock(&sim_rcc_block) || SIM_MapBlock(&sim_crc_block) || SIM_MapBlock(&sim_dma_block) ||
+       SIM_MapBlock(&sim_gpio_block) || SIM_MapBlock(&sim_usart_apb1_block) || SIM_MapBlock(&sim_usart_apb2_block))
+        return -1;
+
+    SIM_PERIPH_Reset();
+    return 0;
+}
+
+/*********************************************************************
+ * @fn      SIM_PERIPH_Reset
+ *
+ * @brief   Returns the peripherals to their reset state, interrupt
+ *          handlers included, and clears the counters.
+ *
+ * @return  none
+ */
+void SIM_PERIPH_Reset(void)
+{
+    uint32_t n;
+
+    memset(rcc_page, 0, 0x400);
+    *(volatile uint32_t *)(rcc_page + RCC_AHBPCENR) = RCC_AHBPCENR_RESET;
+    crc_data = 0xFFFFFFFF;
+    crc_id = 0;
+    dma_intfr = 0;
+    memset(dma_ch, 0, sizeof(dma_ch));
+    memset((void *)(uintptr_t)SIM_GPIO_PAGE, 0, 0x1000);
+    for(n = 0; n < SIM_USART_NUM; n++){
+        usart[n].STATR = STATR_RESET;
+        usart[n].DATAR = usart[n].BRR = usart[n].CTLR1 = usart[n].CTLR2 = usart[n].CTLR3 = usart[n].GPR = 0;
+        usart[n].Snap = 0;
+        usart[n].Line = NULL;
+        usart[n].LineLeft = 0;
+        usart[n].Idle_ns = UINT64_MAX;
+        usart[n].TxLength = 0;
+        usart[n].Handler = NULL;
+    }
+    SIM_PERIPH_ClearStats();
+}
+
+/*********************************************************************
+ * @fn      SIM_PERIPH_GetStats
+ *
+ * @brief   Copies the counters.
+ *
+ * @return  none
+ */
+void SIM_PERIPH_GetStats(SIM_PERIPH_StatsTypeDef *Stats)
+{
+    *Stats = periph_stats;
+}
+
+/*********************************************************************
+ * @fn      SIM_PERIPH_ClearStats
+ *
+ * @brief   Clears the counters.
+ *
+ * @return  none
+ */
+void SIM_PERIPH_ClearStats(void)
+{
+    memset(&periph_stats, 0, sizeof(periph_stats));
+}
+
+/*********************************************************************
+ * @fn      SIM_DMA_SetIRQHandler
+ *
+ * @brief   Installs the handler run for a DMA1 channel interrupt, the
+ *          host counterpart of enabling DMA1_ChannelX_IRQn. NULL masks
+ *          the interrupt.
+ *
+ * @param   Channel - 1 to SIM_DMA_CHANNELS.
+ *
+ * @return  none
+ */
+void SIM_DMA_SetIRQHandler(uint8_t Channel, void (*Handler)(void))
+{
+    if(Channel >= 1 && Channel <= SIM_DMA_CHANNELS)
+        dma_ch[Channel - 1].Handler = Handler;
+}
+
+/*********************************************************************
+ * @fn      SIM_USART_Feed
+ *
+ * @brief   Puts bytes on the RX line of a USART, 8N1 at Baud, starting
+ *          now: byte i is received (10 * (i + 1)) bit times later. Data
+ *          is read as it arrives and must stay valid until then. Bytes
+ *          that continue the ones still arriving in memory, at the same
+ *          Baud, follow them on the line without a gap.
+ *
+ * @param   Usart - 1 to SIM_USART_NUM.
+ *          Data - bytes.
+ *          Length - byte count.
+ *          Baud - bit rate of the sender.
+ *
+ * @return  0, or -1 if bytes of an earlier feed are still to arrive
+ *          and Data does not continue them.
+ */
+int SIM_USART_Feed(uint8_t Usart, const uint8_t *Data, uint32_t Length, uint32_t Baud)
+{
+    SIM_UsartTypeDef *u;
+
+    if(Usart < 1 || Usart > SIM_USART_NUM || Baud == 0)
+        return -1;
+    u = &usart[Usart - 1];
+    if(u->LineLeft)
+    {
+        if(Data != u->Line + u->LineLeft || u->Frame_ns != 10 * 1000000000ULL / Baud)
+            return -1;
+        u->LineLeft += Length;
+        return 0;
+    }
+    u->Line = Data;
+    u->LineLeft = Length;
+    u->Frame_ns = 10 * 1000000000ULL / Baud;
+    u->Next_ns = SIM_GetTime_ns() + u->Frame_ns;
+    return 0;
+}
+
+/*********************************************************************
+ * @fn      SIM_USART_FeedLeft
+ *
+ * @brief   Bytes of the last feed still to arrive.
+ *
+ * @param   Usart - 1 to SIM_USART_NUM.
+ *
+ * @return  Byte count.
+ */
+uint32_t SIM_USART_FeedLeft(uint8_t Usart)
+{
+    if(Usart < 1 || Usart > SIM_USART_NUM)
+        return 0;
+    return usart[Usart - 1].LineLeft;
+}
+
+/*********************************************************************
+ * @fn      SIM_USART_Drain
+ *
+ * @brief   Takes the bytes a USART transmitted, oldest first.
+ *
+ * @param   Usart - 1 to SIM_USART_NUM.
+ *          Data - receives them.
+ *          Max - room in Data.
+ *
+ * @return  Bytes taken.
+ */
+uint32_t SIM_USART_Drain(uint8_t Usart, uint8_t *Data, uint32_t Max)
+{
+    SIM_UsartTypeDef *u;
+    uint32_t          n;
+
+    if(Usart < 1 || Usart > SIM_USART_NUM)
+        return 0;
+    u = &usart[Usart - 1];
+    n = u->TxLength < Max ? u->TxLength : Max;
+    memcpy(Data, u->Tx, n);
+    memmove(u->Tx, u->Tx + n, u->TxLength - n);
+    u->TxLength -= n;
+    return n;
+}
+
+/*********************************************************************
+ * @fn      SIM_USART_SetIRQHandler
+ *
+ * @brief   Installs the handler run for a USART interrupt, the host
+ *          counterpart of enabling USARTx_IRQn. NULL masks it.
+ *
+ * @param   Usart - 1 to SIM_USART_NUM.
+ *
+ * @return  none
+ */
+void SIM_USART_SetIRQHandler(uint8_t Usart, void (*Handler)(void))
+{
+    if(Usart >= 1 && Usart <= SIM_USART_NUM)
+        usart[Usart - 1].Handler = Handler;
+}
@@ -0,0 +1,70 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : sim_periph.h
+ * Author             : typetrade
+ * Version            : V1.0.0
+ * Date               : 2026/10/17
+ * Description        : Host-side register-level models of the CH32V20x
+ *                      peripherals around the FLASH controller: RCC clock
+ *                      gates, CRC unit, DMA1 and the USART receivers, on
+ *                      the traps of sim_flash.c.
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+#ifndef __SIM_PERIPH_H
+#define __SIM_PERIPH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/* Simulated address map */
+#define SIM_DMA1_BASE                  ((uint32_t)0x40020000)
+#define SIM_RCC_BASE                   ((uint32_t)0x40021000)
+#define SIM_CRC_BASE                   ((uint32_t)0x40023000)
+#define SIM_GPIO_PAGE                  ((uint32_t)0x40010000)  /* AFIO, EXTI, GPIOA, GPIOB */
+#define SIM_USART1_BASE                ((uint32_t)0x40013800)
+#define SIM_USART2_BASE                ((uint32_t)0x40004400)
+#define SIM_USART3_BASE                ((uint32_t)0x40004800)
+
+/* USART1 to USART3 */
+#define SIM_USART_NUM                  3
+
+/* Transmitted bytes kept per USART until SIM_USART_Drain */
+#define SIM_USART_TX_SIZE              4096
+
+/* DMA1 channels, 1-based as in DMA1_Channel1..DMA1_Channel8 */
+#define SIM_DMA_CHANNELS               8
+
+/* HCLK cycles per DMA beat, memory-to-memory. Nominal, like the FLASH
+ * timings: replace with a board measurement. */
+#define SIM_DMA_BEAT_CYCLES            4
+
+typedef struct
+{
+    uint32_t DmaBeats;      /* Items moved by DMA1 */
+    uint32_t DmaErrors;     /* Transfers stopped by a bus error */
+    uint32_t CrcWrites;     /* Words fed to CRC->DATAR, by the CPU or the DMA */
+    uint32_t CrcCpuWrites;  /* Of which by the CPU */
+    uint32_t GatedWrites;   /* Register writes ignored, peripheral clock off */
+    uint32_t UsartRxBytes;  /* Bytes received into a USART DATAR */
+    uint32_t UsartOverruns; /* Bytes lost to ORE, DATAR not read in time */
+    uint32_t UsartTxBytes;  /* Bytes written to a USART DATAR */
+    uint32_t UsartTxLost;   /* Of which not kept, SIM_USART_TX_SIZE waiting */
+} SIM_PERIPH_StatsTypeDef;
+
+int  SIM_PERIPH_Init(void);
+void SIM_PERIPH_Reset(void);
+void SIM_PERIPH_GetStats(SIM_PERIPH_StatsTypeDef *Stats);
+void SIM_PERIPH_ClearStats(void);
+void SIM_DMA_SetIRQHandler(uint8_t Channel, void (*Handler)(void));
+int      SIM_USART_Feed(uint8_t Usart, const uint8_t *Data, uint32_t Length, uint32_t Baud);
+uint32_t SIM_USART_FeedLeft(uint8_t Usart);
+uint32_t SIM_USART_Drain(uint8_t Usart, uint8_t *Data, uint32_t Max);
+void     SIM_USART_SetIRQHandler(uint8_t Usart, void (*Handler)(void));
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
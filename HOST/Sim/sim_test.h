@@ -0,0 +1,42 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : sim_test.h
+ * Author             : typetrade
+ * Version            : V1.0.0
+ * Date               : 2026/10/17
+ * Description        : Check printer of the host test programs: one line
+ *                      per check, counted in fails for the exit status.
+ *                      Each program is a single translation unit including
+ *                      this once. Define SIM_TEST_OUT before including it
+ *                      when stdout carries the program's own output.
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+#ifndef __SIM_TEST_H
+#define __SIM_TEST_H
+
+#include <stdio.h>
+
+/* Column of the ok/FAIL verdict */
+#define SIM_TEST_WIDTH                 52
+
+#ifndef SIM_TEST_OUT
+#define SIM_TEST_OUT                   stdout
+#endif
+
+/* Failed checks so far */
+static int fails = 0;
+
+/*********************************************************************
+ * @fn      expect
+ *
+ * @brief   Prints and counts one check.
+ *
+ * @return  none
+ */
+static inline void expect(const char *name, int ok)
+{
+    fprintf(SIM_TEST_OUT, "%-*s %s\n", SIM_TEST_WIDTH, name, ok ? "ok" : "FAIL");
+    if(!ok)
+        fails++;
+}
+
+#endif
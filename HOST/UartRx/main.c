@@ -0,0 +1,193 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : main.c
+ * Author             : typetrade
+ * Version            : V1.0.0
+ * Date               : 2026/10/17
+ * Description        : Runs the USART ring receiver of User/uart_rx.c
+ *                      against the host USART and DMA models: a short
+ *                      burst published by the IDLE interrupt, spans read
+ *                      in place across the end of the ring, a long stream
+ *                      at 4 Mbaud read by a polling consumer with the
+ *                      interrupts it took, a reader lapped by the DMA, a
+ *                      span overwritten while held, and a USART overrun
+ *                      with the DMA stopped.
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include "ch32v20x.h"
+#include "sim_flash.h"
+#include "sim_periph.h"
+#include "sim_test.h"
+#include "dma_chan.h"
+#include "uart_rx.h"
+
+#define BAUD                   4000000
+#define STREAM_SIZE            (256 * 1024)
+#define POLL_NS                50000
+
+static uint8_t  line[STREAM_SIZE];
+static uint32_t notified;
+
+/*********************************************************************
+ * @fn      on_rx
+ *
+ * @brief   Notify callback.
+ *
+ * @return  none
+ */
+static void on_rx(void *Context)
+{
+    notified++;
+}
+
+/*********************************************************************
+ * @fn      frame_ns
+ *
+ * @brief   Time of n 10-bit frames at BAUD.
+ *
+ * @return  Nanoseconds.
+ */
+static uint64_t frame_ns(uint32_t n)
+{
+    return (uint64_t)n * 10 * 1000000000ULL / BAUD;
+}
+
+/*********************************************************************
+ * @fn      drain
+ *
+ * @brief   Reads every span waiting, checking it against line from
+ *          *Offset on.
+ *
+ * @return  Bytes that differed.
+ */
+static uint32_t drain(uint32_t *Offset)
+{
+    const uint8_t *p;
+    uint32_t       n, bad = 0;
+
+    while((n = UART_Rx_Peek(&p)) != 0)
+    {
+        if(memcmp(p, line + *Offset, n) != 0)
+            bad += n;
+        *Offset += n;
+        if(UART_Rx_Consume(n) != SUCCESS)
+            bad++;
+    }
+    return bad;
+}
+
+/*********************************************************************
+ * @fn      main
+ *
+ * @brief   Main program.
+ *
+ * @return  0 if every check passed.
+ */
+int main(void)
+{
+    UART_RxStatsTypeDef st;
+    const uint8_t      *p, *q;
+    uint32_t            i, n, m, off, bad, irqs;
+    uint64_t            t0, dt;
+
+    if(SIM_FLASH_Init() != 0 || SIM_PERIPH_Init() != 0)
+        return 2;
+
+    for(i = 0; i < STREAM_SIZE; i++){
+        line[i] = (uint8_t)(i * 131 + (i >> 9));
+    }
+
+    expect("init", UART_Rx_Init(BAUD, on_rx, NULL) == SUCCESS);
+    expect("  circular DMA on the USART RX line", (DMA_Chan_Regs(6)->CFGR & (DMA_Mode_Circular | DMA_CFGR1_EN)) ==
+           (DMA_Mode_Circular | DMA_CFGR1_EN) && (USART2->CTLR3 & USART_DMAReq_Rx) && (USART2->CTLR1 & 0x0010));
+    expect("  channel held", DMA_Chan_Alloc(DMA_REQ_USART2_RX, NULL, NULL) == 0);
+    expect("  PA2 (TX) alternate push-pull, PA3 (RX) floating in",
+           ((GPIOA->CFGLR >> 8) & 0xF) == 0xB && ((GPIOA->CFGLR >> 12) & 0xF) == 0x4);
+
+    /* A burst shorter than half the ring: only IDLE publishes it */
+    notified = 0;
+    SIM_USART_Feed(2, line, 100, BAUD);
+    SIM_AdvanceTime_ns(frame_ns(100) + frame_ns(1) / 2);
+    UART_Rx_GetStats(&st);
+    expect("burst not published before the line is idle", st.Irqs == 0 && notified == 0);
+    SIM_AdvanceTime_ns(frame_ns(1));
+    UART_Rx_GetStats(&st);
+    expect("  IDLE interrupt publishes it", st.Irqs == 1 && notified == 1 && st.Received == 100);
+    n = UART_Rx_Peek(&p);
+    expect("  read in place", n == 100 && memcmp(p, line, 100) == 0 && UART_Rx_Consume(100) == SUCCESS &&
+           UART_Rx_Available() == 0);
+
+    /* Spans stop at the end of the ring */
+    SIM_USART_Feed(2, line + 100, 1000, BAUD);
+    SIM_AdvanceTime_ns(frame_ns(1002));
+    n = UART_Rx_Peek(&p);
+    m = UART_Rx_Consume(n) == SUCCESS ? UART_Rx_Peek(&q) : 0;
+    expect("spans split at the end of the ring", n == UART_RX_BUF_SIZE - 100 && m == 1000 - n && q == p - 100 &&
+           memcmp(p, line + 100, n) == 0 && memcmp(q, line + 100 + n, m) == 0);
+    UART_Rx_Consume(m);
+
+    /* A long stream, polled */
+    UART_Rx_GetStats(&st);
+    irqs = st.Irqs;
+    off = 0;
+    bad = 0;
+    t0 = SIM_GetTime_ns();
+    SIM_USART_Feed(2, line, STREAM_SIZE, BAUD);
+    while(SIM_USART_FeedLeft(2))
+    {
+        SIM_AdvanceTime_ns(POLL_NS);
+        bad += drain(&off);
+    }
+    SIM_AdvanceTime_ns(frame_ns(2));
+    bad += drain(&off);
+    dt = SIM_GetTime_ns() - t0;
+    UART_Rx_GetStats(&st);
+    irqs = st.Irqs - irqs;
+    printf("%u bytes at %u baud in %.3f ms: %u interrupts, one per %u bytes\n", STREAM_SIZE, BAUD, dt / 1e6,
+           (unsigned)irqs, (unsigned)(STREAM_SIZE / irqs));
+    expect("256K stream at 4 Mbaud, every byte in order", off == STREAM_SIZE && bad == 0);
+    expect("  no overrun, nothing lost", st.Overruns == 0 && st.Lost == 0 && st.HwOverruns == 0);
+    expect("  one interrupt per half ring, plus IDLE", irqs == STREAM_SIZE / (UART_RX_BUF_SIZE / 2) + 1);
+
+    /* A reader lapped by the DMA */
+    SIM_USART_Feed(2, line, 3000, BAUD);
+    SIM_AdvanceTime_ns(frame_ns(3002));
+    n = UART_Rx_Peek(&p);
+    UART_Rx_GetStats(&st);
+    expect("lapped reader skips to the oldest bytes", st.Overruns == 1 && st.Lost == 3000 - UART_RX_BUF_SIZE &&
+           UART_Rx_Available() == UART_RX_BUF_SIZE && memcmp(p, line + 3000 - UART_RX_BUF_SIZE, n) == 0);
+    off = 3000 - UART_RX_BUF_SIZE;
+    expect("  and reads on from there", drain(&off) == 0 && off == 3000);
+
+    /* A span overwritten while held */
+    SIM_USART_Feed(2, line, UART_RX_BUF_SIZE / 2, BAUD);
+    SIM_AdvanceTime_ns(frame_ns(UART_RX_BUF_SIZE / 2 + 2));
+    n = UART_Rx_Peek(&p);
+    SIM_USART_Feed(2, line, UART_RX_BUF_SIZE / 2 + 10, BAUD);
+    SIM_AdvanceTime_ns(frame_ns(UART_RX_BUF_SIZE / 2 + 12));
+    expect("span overwritten while held reported", n == UART_RX_BUF_SIZE / 2 && UART_Rx_Consume(n) == ERROR);
+    UART_Rx_GetStats(&st);
+    expect("  counted", st.Overruns == 2 && st.Lost == 3000 - UART_RX_BUF_SIZE + 10);
+    UART_Rx_Consume(UART_Rx_Available());
+
+    /* DMA stopped: the USART overruns */
+    DMA_Chan_Regs(6)->CFGR &= ~DMA_CFGR1_EN;
+    SIM_USART_Feed(2, line, 3, BAUD);
+    SIM_AdvanceTime_ns(frame_ns(4));
+    UART_Rx_GetStats(&st);
+    expect("USART overrun counted by the handler", st.HwOverruns >= 1 && !(USART2->STATR & USART_FLAG_ORE));
+
+    /* Channel given back */
+    UART_Rx_DeInit();
+    n = DMA_Chan_Alloc(DMA_REQ_USART2_RX, NULL, NULL);
+    expect("deinit gives the channel back", n == 6 && UART_Rx_Available() == 0);
+    DMA_Chan_Free(n);
+    expect("init again", UART_Rx_Init(BAUD, NULL, NULL) == SUCCESS);
+    SIM_USART_Feed(2, line, 10, BAUD);
+    SIM_AdvanceTime_ns(frame_ns(12));
+    n = UART_Rx_Peek(&p);
+    expect("  receives from the start", n == 10 && memcmp(p, line, 10) == 0);
+
+    return fails ? 1 : 0;
+}
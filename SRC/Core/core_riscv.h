@@ -138,6 +138,42 @@ RV_STATIC_INLINE void __disable_irq()
   __asm volatile ("csrw 0x800, %0" : : "r" (0x6000) );
 }
 
+/*********************************************************************
+ * @fn      __irq_save
+ *
+ * @brief   Disable Global Interrupt, for a critical section that may be
+ *          entered with interrupts already disabled
+ *
+ * @return  previous state, for __irq_restore
+ */
+RV_STATIC_INLINE uint32_t __irq_save()
+{
+#ifdef SIM_HOST
+  return 0;
+#else
+  uint32_t result;
+
+  __asm volatile ("csrrw %0, 0x800, %1" : "=r" (result) : "r" (0x6000) );
+  return result;
+#endif
+}
+
+/*********************************************************************
+ * @fn      __irq_restore
+ *
+ * @brief   Restore Global Interrupt state saved by __irq_save
+ *
+ * @return  none
+ */
+RV_STATIC_INLINE void __irq_restore(uint32_t state)
+{
+#ifdef SIM_HOST
+  (void)state;
+#else
+  __asm volatile ("csrw 0x800, %0" : : "r" (state) );
+#endif
+}
+
 /*********************************************************************
  * @fn      __NOP
  *
@@ -360,6 +396,10 @@ extern uint32_t __get_MARCHID(void);
 extern uint32_t __get_MIMPID(void);
 extern uint32_t __get_MHARTID(void);
 extern uint32_t __get_SP(void);
+extern uint32_t __get_MCYCLE(void);
+extern uint32_t __get_MCYCLEH(void);
+extern uint32_t __get_MINSTRET(void);
+extern uint32_t __get_MINSTRETH(void);
 
 
 #endif
@@ -0,0 +1,133 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : binlog.c
+ * Author             : typetrade
+ * Version            : V1.0.0
+ * Date               : 2026/10/17
+ * Description        : Binary LOG() records, see binlog.h.
+ *                      A record is built on the stack and handed to the
+ *                      sink in one call: with the DMA printf transport
+ *                      logging costs a few dozen instructions plus the
+ *                      copy into the TX ring. Timestamps come from mcycle
+ *                      and follow SystemCoreClock changes.
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+#include "binlog.h"
+#include "debug.h"
+
+/* Start of the log_fmt section: the linker script defines it on the target,
+ * the host linker provides it for the orphan section */
+extern const char __start_log_fmt[];
+
+#ifndef SIM_HOST
+extern int _write(int fd, char *buf, int size);
+#endif
+
+static void log_default_sink(const uint8_t *Data, uint32_t Length);
+
+static LOG_SinkTypeDef log_sink = log_default_sink;
+static uint64_t        log_last = 0;   /* mcycle of the last timestamp */
+
+/*********************************************************************
+ * @fn      log_default_sink
+ *
+ * @brief   Sends a record through the printf transport.
+ *
+ * @return  none
+ */
+static void log_default_sink(const uint8_t *Data, uint32_t Length)
+{
+#ifdef SIM_HOST
+    fwrite(Data, 1, Length, stdout);
+#else
+    _write(1, (char *)Data, (int)Length);
+#endif
+}
+
+/*********************************************************************
+ * @fn      log_cycles
+ *
+ * @brief   Reads the 64-bit mcycle.
+ *
+ * @return  Cycles.
+ */
+static uint64_t log_cycles(void)
+{
+    uint32_t hi, lo;
+
+    do
+    {
+        hi = __get_MCYCLEH();
+        lo = __get_MCYCLE();
+    } while(hi != __get_MCYCLEH());
+
+    return ((uint64_t)hi << 32) | lo;
+}
+
+/*********************************************************************
+ * @fn      log_varint
+ *
+ * @brief   Appends Value as an unsigned LEB128 varint.
+ *
+ * @return  End of the appended bytes.
+ */
+static uint8_t *log_varint(uint8_t *p, uint32_t Value)
+{
+    while(Value >= 0x80)
+    {
+        *p++ = (uint8_t)(Value | 0x80);
+        Value >>= 7;
+    }
+    *p++ = (uint8_t)Value;
+    return p;
+}
+
+/*********************************************************************
+ * @fn      LOG_Init
+ *
+ * @brief   Selects the sink and starts the timestamps at 0.
+ *
+ * @param   Sink - record sink, NULL for the printf transport.
+ *
+ * @return  none
+ */
+void LOG_Init(LOG_SinkTypeDef Sink)
+{
+    log_sink = Sink ? Sink : log_default_sink;
+    log_last = log_cycles();
+}
+
+/*********************************************************************
+ * @fn      LOG_Write
+ *
+ * @brief   Sends one record, called by LOG(). Not reentrant.
+ *
+ * @param   Fmt - format string in the log_fmt section.
+ *          Nargs - number of arguments, at most LOG_MAX_ARGS.
+ *          Args - arguments.
+ *
+ * @return  none
+ */
+void LOG_Write(const char *Fmt, uint8_t Nargs, const uint32_t *Args)
+{
+    uint8_t  rec[LOG_RECORD_MAX], *p = rec;
+    uint64_t now, us;
+    uint32_t mhz;
+    uint8_t  i;
+
+    now = log_cycles();
+    mhz = SystemCoreClock / 1000000;
+    if(mhz == 0)
+        mhz = 1;
+    us = (now - log_last) / mhz;
+    log_last += us * mhz;   /* Keep the remainder for the next record */
+    if(us > 0xFFFFFFFF)
+        us = 0xFFFFFFFF;
+
+    *p++ = LOG_SYNC;
+    p = log_varint(p, (uint32_t)(Fmt - __start_log_fmt));
+    p = log_varint(p, (uint32_t)us);
+    for(i = 0; i < Nargs && i < LOG_MAX_ARGS; i++){
+        p = log_varint(p, Args[i]);
+    }
+    log_sink(rec, (uint32_t)(p - rec));
+}
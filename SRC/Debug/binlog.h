@@ -0,0 +1,65 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : binlog.h
+ * Author             : typetrade
+ * Version            : V1.0.0
+ * Date               : 2026/10/17
+ * Description        : LOG() calls that print as printf, or with LOG_BINARY
+ *                      send a compact binary record instead: format string
+ *                      ID, timestamp and raw arguments, no formatting on
+ *                      the target. The format strings stay in the ELF
+ *                      (log_fmt section, not loaded) and HOST/LogDecode
+ *                      rebuilds the text from it.
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+#ifndef __BINLOG_H
+#define __BINLOG_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdio.h>
+#include <stdint.h>
+
+/* Uncomment to send LOG() calls as binary records */
+//#define LOG_BINARY
+
+/* Record: LOG_SYNC, then unsigned LEB128 varints: format ID (offset in the
+ * log_fmt section), microseconds since the previous record, and one per
+ * argument. Arguments are integers of at most 32 bits: %d %i %u %x %X %o
+ * %c with the usual flags, width, precision and h/hh/l; no %s or floats. */
+#define LOG_SYNC                   0xA5
+#define LOG_MAX_ARGS               8
+#define LOG_RECORD_MAX             (1 + 5 * (LOG_MAX_ARGS + 2))
+
+/* Receives each record in one call, default the printf transport */
+typedef void (*LOG_SinkTypeDef)(const uint8_t *Data, uint32_t Length);
+
+void LOG_Init(LOG_SinkTypeDef Sink);
+void LOG_Write(const char *Fmt, uint8_t Nargs, const uint32_t *Args);
+
+#ifdef LOG_BINARY
+
+#define LOG_NARGS(...)             LOG_NARGS_(0, ##__VA_ARGS__, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define LOG_NARGS_(_0, _1, _2, _3, _4, _5, _6, _7, _8, N, ...) N
+
+/* Fmt must be a string literal */
+#define LOG(Fmt, ...)                                                                    \
+    do                                                                                   \
+    {                                                                                    \
+        static const char log_fmt[] __attribute__((section("log_fmt"), used)) = Fmt;    \
+        const uint32_t    log_args[LOG_MAX_ARGS + 1] = {0, ##__VA_ARGS__};              \
+        LOG_Write(log_fmt, LOG_NARGS(__VA_ARGS__), &log_args[1]);                       \
+    } while(0)
+
+#else
+
+#define LOG(Fmt, ...)              printf(Fmt, ##__VA_ARGS__)
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __BINLOG_H */
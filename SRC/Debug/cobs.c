@@ -0,0 +1,161 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : cobs.c
+ * Author             : typetrade
+ * Version            : V1.0.0
+ * Date               : 2026/10/17
+ * Description        : COBS framing. A frame is a run of blocks, each a
+ *                      code byte n (1 to 255) followed by n - 1 non-zero
+ *                      data bytes; a block with n < 255 stands for its
+ *                      data and a 0, except the last one. So the encoded
+ *                      frame holds no 0 and a 0 ends it: a receiver joins
+ *                      in at any delimiter, whatever it missed. The
+ *                      overhead is one byte per 254 plus the delimiter.
+ *                      The decoder keeps its place between calls, so a
+ *                      frame may arrive in any number of pieces (the spans
+ *                      of a receive ring), and stops at each delimiter for
+ *                      the caller to handle the frame before going on.
+ *                      Plain C, also built into the host tools.
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+#include "cobs.h"
+
+/*********************************************************************
+ * @fn      COBS_Encode
+ *
+ * @brief   Encodes one frame, delimiter included.
+ *
+ * @param   Data - frame contents.
+ *          Length - bytes.
+ *          Out - COBS_ENCODED_MAX(Length) bytes, not overlapping Data.
+ *
+ * @return  Encoded length.
+ */
+uint32_t COBS_Encode(const void *Data, uint32_t Length, uint8_t *Out)
+{
+    const uint8_t *p = (const uint8_t *)Data;
+    uint32_t       i, code_at = 0, o = 1;
+    uint8_t        code = 1;
+
+    for(i = 0; i < Length; i++){
+        if(p[i] == 0)
+        {
+            Out[code_at] = code;
+            code_at = o++;
+            code = 1;
+            continue;
+        }
+        Out[o++] = p[i];
+        if(++code == 0xFF)
+        {
+            Out[code_at] = code;
+            code_at = o++;
+            code = 1;
+        }
+    }
+    Out[code_at] = code;
+    Out[o++] = 0;
+
+    return o;
+}
+
+/*********************************************************************
+ * @fn      COBS_DecodeInit
+ *
+ * @brief   Sets up a decoder, waiting for the first frame.
+ *
+ * @param   Dec - decoder.
+ *          Buf - receives the decoded frames, one at a time.
+ *          Size - longest frame.
+ *
+ * @return  none
+ */
+void COBS_DecodeInit(COBS_DecoderTypeDef *Dec, void *Buf, uint32_t Size)
+{
+    Dec->Buf = (uint8_t *)Buf;
+    Dec->Size = Size;
+    Dec->Length = 0;
+    Dec->Code = 0;
+    Dec->Left = 0;
+    Dec->Zero = 0;
+    Dec->Error = 0;
+}
+
+/*********************************************************************
+ * @fn      COBS_Decode
+ *
+ * @brief   Decodes Data up to the first delimiter that ends a frame.
+ *          Empty frames (delimiters in a row) are skipped.
+ *
+ * @param   Dec - decoder.
+ *          Data - received bytes.
+ *          Length - bytes.
+ *          Frame - length of the frame in Dec->Buf, COBS_FRAME_NONE if
+ *                  no frame ended in the bytes taken, COBS_FRAME_BAD if
+ *                  one ended that was too long, cut short or aborted.
+ *
+ * @return  Bytes taken, up to and including that delimiter.
+ */
+uint32_t COBS_Decode(COBS_DecoderTypeDef *Dec, const uint8_t *Data, uint32_t Length, int32_t *Frame)
+{
+    uint32_t i;
+    uint8_t  b;
+
+    *Frame = COBS_FRAME_NONE;
+    for(i = 0; i < Length; i++){
+        b = Data[i];
+        if(b == 0)
+        {
+            if(Dec->Error || Dec->Left)
+                *Frame = COBS_FRAME_BAD;
+            else if(Dec->Length)
+                *Frame = (int32_t)Dec->Length;
+            Dec->Length = 0;
+            Dec->Left = 0;
+            Dec->Zero = 0;
+            Dec->Error = 0;
+            if(*Frame != COBS_FRAME_NONE)
+                return i + 1;
+            continue;
+        }
+
+        if(Dec->Left == 0)
+        {
+            if(Dec->Zero)
+            {
+                if(Dec->Length < Dec->Size)
+                    Dec->Buf[Dec->Length++] = 0;
+                else
+                    Dec->Error = 1;
+                Dec->Zero = 0;
+            }
+            Dec->Code = b;
+            Dec->Left = b - 1;
+        }
+        else
+        {
+            if(Dec->Length < Dec->Size)
+                Dec->Buf[Dec->Length++] = b;
+            else
+                Dec->Error = 1;
+            Dec->Left--;
+        }
+        if(Dec->Left == 0)
+            Dec->Zero = Dec->Code != 0xFF;
+    }
+    return Length;
+}
+
+/*********************************************************************
+ * @fn      COBS_DecodeAbort
+ *
+ * @brief   Drops the frame being decoded, e.g. when received bytes were
+ *          lost: its delimiter reports COBS_FRAME_BAD.
+ *
+ * @param   Dec - decoder.
+ *
+ * @return  none
+ */
+void COBS_DecodeAbort(COBS_DecoderTypeDef *Dec)
+{
+    Dec->Error = 1;
+}
@@ -0,0 +1,49 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : cobs.h
+ * Author             : typetrade
+ * Version            : V1.0.0
+ * Date               : 2026/10/17
+ * Description        : COBS (Consistent Overhead Byte Stuffing) framing,
+ *                      frames ended by a 0 byte, with a decoder that takes
+ *                      the stream in pieces.
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+#ifndef __COBS_H
+#define __COBS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/* Encoded size of n bytes, delimiter included */
+#define COBS_ENCODED_MAX(n)        ((n) + (n) / 254 + 2)
+
+/* COBS_Decode *Frame when no frame ended */
+#define COBS_FRAME_NONE            (-1)
+/* COBS_Decode *Frame for a frame too long, cut short or aborted */
+#define COBS_FRAME_BAD             (-2)
+
+/* Decoder of one stream */
+typedef struct
+{
+    uint8_t *Buf;               /* Decoded frame */
+    uint32_t Size;
+    uint32_t Length;            /* Bytes decoded so far */
+    uint8_t  Code;              /* Code byte of the current block */
+    uint8_t  Left;              /* Bytes left in it, 0: a code byte is next */
+    uint8_t  Zero;              /* A 0 is due before the next block */
+    uint8_t  Error;             /* Frame dropped at its delimiter */
+} COBS_DecoderTypeDef;
+
+uint32_t COBS_Encode(const void *Data, uint32_t Length, uint8_t *Out);
+void     COBS_DecodeInit(COBS_DecoderTypeDef *Dec, void *Buf, uint32_t Size);
+uint32_t COBS_Decode(COBS_DecoderTypeDef *Dec, const uint8_t *Data, uint32_t Length, int32_t *Frame);
+void     COBS_DecodeAbort(COBS_DecoderTypeDef *Dec);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __COBS_H */
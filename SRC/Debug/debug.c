@@ -8,27 +8,68 @@
  * Copyright (c) 2021 Nanjing Qinheng Microelectronics Co., Ltd.
  * SPDX-License-Identifier: Apache-2.0
  *******************************************************************************/
+#include <string.h>
 #include "debug.h"
+#include "timebase.h"
+#include "dma_chan.h"
+
+#if(DEBUG_TX_BUF_SIZE > 0)
+#if(DEBUG_TX_BUF_SIZE & (DEBUG_TX_BUF_SIZE - 1))
+#error "DEBUG_TX_BUF_SIZE must be a power of 2"
+#endif
+
+#if(DEBUG == DEBUG_UART1)
+#define DEBUG_USART          USART1
+#define DEBUG_TX_REQ         DMA_REQ_USART1_TX
+#elif(DEBUG == DEBUG_UART2)
+#define DEBUG_USART          USART2
+#define DEBUG_TX_REQ         DMA_REQ_USART2_TX
+#elif(DEBUG == DEBUG_UART3)
+#define DEBUG_USART          USART3
+#define DEBUG_TX_REQ         DMA_REQ_USART3_TX
+#endif
+#endif
+
+#ifdef DEBUG_TX_REQ
+/* The TX channel, from the channel manager (dma_chan.h) */
+#define DEBUG_TX_DMA         DMA_Chan_Regs(tx_ch)
+#define DEBUG_TX_IRQn        ((IRQn_Type)(DMA1_Channel1_IRQn + tx_ch - 1))
+#define DEBUG_TX_FLAG_TC     (DMA_CHAN_TC << (4 * (tx_ch - 1)))
+#define DEBUG_TX_FLAG_GL     ((uint32_t)0xF << (4 * (tx_ch - 1)))
+#define DEBUG_TX_MASK        ((uint32_t)(DEBUG_TX_BUF_SIZE - 1))
+
+/* Ring: _write advances tx_head, completed chunks advance tx_tail. The
+ * tx_busy bytes from tx_tail are being sent by the DMA. With tx_ch 0 (the
+ * channel was taken) output is sent polled. */
+static uint8_t           tx_ch = 0;
+static uint8_t           tx_buf[DEBUG_TX_BUF_SIZE];
+static volatile uint32_t tx_head = 0;
+static volatile uint32_t tx_tail = 0;
+static volatile uint32_t tx_busy = 0;
+static uint8_t           tx_policy = DEBUG_TX_POLICY;
+static uint32_t          tx_dropped = 0;
+
+static void tx_irq(void *Context, uint32_t Flags);
+#endif
 
-static uint8_t  p_us = 0;
-static uint16_t p_ms = 0;
 /*********************************************************************
  * @fn      Delay_Init
  *
- * @brief   Initializes Delay Funcation.
+ * @brief   Initializes Delay Funcation: starts the SysTick timebase, or
+ *          picks up a new HCLK when it already runs.
  *
  * @return  none
  */
 void Delay_Init(void)
 {
-    p_us = SystemCoreClock / 8000000;
-    p_ms = (uint16_t)p_us * 1000;
+    Timebase_Init();
 }
 
 /*********************************************************************
  * @fn      Delay_Us
  *
- * @brief   Microsecond Delay Time.
+ * @brief   Microsecond Delay Time. Waits on the timebase, SysTick keeps
+ *          running for everyone else.
  *
  * @param   n - Microsecond number.
  *
@@ -36,16 +77,9 @@ void Delay_Init(void)
  */
 void Delay_Us(uint32_t n)
 {
-    uint32_t i;
+    uint64_t end = now_cycles() + (uint64_t)n * Timebase_CyclesPerUs();
 
-    SysTick->SR &= ~(1 << 0);
-    i = (uint32_t)n * p_us;
-
-    SysTick->CMP = i;
-    SysTick->CTLR |= (1 << 4) | (1 << 5) | (1 << 0);
-
-    while((SysTick->SR & (1 << 0)) != (1 << 0));
-    SysTick->CTLR &= ~(1 << 0);
+    while(now_cycles() < end);
 }
 
 /*********************************************************************
@@ -59,16 +93,9 @@ void Delay_Us(uint32_t n)
  */
 void Delay_Ms(uint32_t n)
 {
-    uint32_t i;
-
-    SysTick->SR &= ~(1 << 0);
-    i = (uint32_t)n * p_ms;
+    uint64_t end = now_us() + (uint64_t)n * 1000;
 
-    SysTick->CMP = i;
-    SysTick->CTLR |= (1 << 4) | (1 << 5) | (1 << 0);
-
-    while((SysTick->SR & (1 << 0)) != (1 << 0));
-    SysTick->CTLR &= ~(1 << 0);
+    while(now_us() < end);
 }
 
 /*********************************************************************
@@ -84,6 +111,9 @@ void USART_Printf_Init(uint32_t baudrate)
 {
     GPIO_InitTypeDef  GPIO_InitStructure;
     USART_InitTypeDef USART_InitStructure;
+#ifdef DEBUG_TX_REQ
+    DMA_InitTypeDef   DMA_InitStructure;
+#endif
 
 #if(DEBUG == DEBUG_UART1)
     RCC_APB2PeriphClockCmd(RCC_APB2Periph_USART1 | RCC_APB2Periph_GPIOA, ENABLE);
@@ -133,8 +163,265 @@ void USART_Printf_Init(uint32_t baudrate)
     USART_Cmd(USART3, ENABLE);
 
 #endif
+
+#ifdef DEBUG_TX_REQ
+    if(tx_ch)
+        DMA_Chan_Free(tx_ch);
+    tx_head = 0;
+    tx_tail = 0;
+    tx_busy = 0;
+    tx_ch = DMA_Chan_Alloc(DEBUG_TX_REQ, tx_irq, NULL);
+    if(tx_ch == 0)
+        return;
+    NVIC_DisableIRQ(DEBUG_TX_IRQn);
+
+    DMA_InitStructure.DMA_PeripheralBaseAddr = (uint32_t)&DEBUG_USART->DATAR;
+    DMA_InitStructure.DMA_MemoryBaseAddr = (uint32_t)tx_buf;
+    DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralDST;
+    DMA_InitStructure.DMA_BufferSize = 0;
+    DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+    DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
+    DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Byte;
+    DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_Byte;
+    DMA_InitStructure.DMA_Mode = DMA_Mode_Normal;
+    DMA_InitStructure.DMA_Priority = DMA_Priority_Low;
+    DMA_InitStructure.DMA_M2M = DMA_M2M_Disable;
+    DMA_Init(DEBUG_TX_DMA, &DMA_InitStructure);
+    DMA_ClearFlag(DEBUG_TX_FLAG_GL);
+    DMA_ITConfig(DEBUG_TX_DMA, DMA_IT_TC, ENABLE);
+    USART_DMACmd(DEBUG_USART, USART_DMAReq_Tx, ENABLE);
+    NVIC_EnableIRQ(DEBUG_TX_IRQn);
+
+#endif
+}
+
+#ifdef DEBUG_TX_REQ
+/*********************************************************************
+ * @fn      tx_complete
+ *
+ * @brief   Retires the chunk in flight once the DMA has sent it.
+ *
+ * @return  none
+ */
+static void tx_complete(void)
+{
+    if(tx_busy && (DMA1->INTFR & DEBUG_TX_FLAG_TC))
+    {
+        DMA1->INTFCR = DEBUG_TX_FLAG_GL;
+        tx_tail += tx_busy;
+        tx_busy = 0;
+    }
+}
+
+/*********************************************************************
+ * @fn      tx_kick
+ *
+ * @brief   Hands the next contiguous chunk of the ring to the DMA when
+ *          it is idle.
+ *
+ * @return  none
+ */
+static void tx_kick(void)
+{
+    uint32_t n, offset;
+
+    n = tx_head - tx_tail;
+    if(tx_busy || n == 0)
+        return;
+
+    offset = tx_tail & DEBUG_TX_MASK;
+    if(n > DEBUG_TX_BUF_SIZE - offset)
+        n = DEBUG_TX_BUF_SIZE - offset;
+    if(n > DEBUG_TX_CHUNK)
+        n = DEBUG_TX_CHUNK;
+
+    tx_busy = n;
+    DEBUG_TX_DMA->CFGR &= ~DMA_CFGR1_EN;
+    DEBUG_TX_DMA->MADDR = (uint32_t)&tx_buf[offset];
+    DEBUG_TX_DMA->CNTR = n;
+    DEBUG_TX_DMA->CFGR |= DMA_CFGR1_EN;
+}
+
+/*********************************************************************
+ * @fn      tx_wait
+ *
+ * @brief   Waits for the chunk in flight and retires it. Polls, so it
+ *          also works with interrupts masked.
+ *
+ * @return  none
+ */
+static void tx_wait(void)
+{
+    while(tx_busy && !(DMA1->INTFR & DEBUG_TX_FLAG_TC));
+    tx_complete();
+}
+
+/*********************************************************************
+ * @fn      tx_irq
+ *
+ * @brief   TX channel handler, transfer complete: retires the chunk and
+ *          starts the next one.
+ *
+ * @return  none
+ */
+static void tx_irq(void *Context, uint32_t Flags)
+{
+    if(tx_busy && (Flags & DMA_CHAN_TC))
+    {
+        tx_tail += tx_busy;
+        tx_busy = 0;
+    }
+    tx_kick();
+}
+
+#endif
+/*********************************************************************
+ * @fn      USART_Printf_SetPolicy
+ *
+ * @brief   Selects what _write does when the TX ring is full.
+ *
+ * @param   Policy - DEBUG_TX_DROP, DEBUG_TX_BLOCK or DEBUG_TX_OVERWRITE.
+ *
+ * @return  none
+ */
+void USART_Printf_SetPolicy(uint8_t Policy)
+{
+#ifdef DEBUG_TX_REQ
+    tx_policy = Policy;
+#else
+    (void)Policy;
+#endif
+}
+
+/*********************************************************************
+ * @fn      USART_Printf_Flush
+ *
+ * @brief   Waits until everything written so far has left the USART.
+ *
+ * @return  none
+ */
+void USART_Printf_Flush(void)
+{
+#ifdef DEBUG_TX_REQ
+    uint32_t en;
+
+    if(tx_ch)
+    {
+        en = NVIC_GetStatusIRQ(DEBUG_TX_IRQn);
+        NVIC_DisableIRQ(DEBUG_TX_IRQn);
+        while(tx_head != tx_tail)
+        {
+            tx_kick();
+            tx_wait();
+        }
+        if(en)
+            NVIC_EnableIRQ(DEBUG_TX_IRQn);
+    }
+#endif
+
+#if(DEBUG == DEBUG_UART1)
+    while(USART_GetFlagStatus(USART1, USART_FLAG_TC) == RESET);
+#elif(DEBUG == DEBUG_UART2)
+    while(USART_GetFlagStatus(USART2, USART_FLAG_TC) == RESET);
+#elif(DEBUG == DEBUG_UART3)
+    while(USART_GetFlagStatus(USART3, USART_FLAG_TC) == RESET);
+#endif
+}
+
+/*********************************************************************
+ * @fn      USART_Printf_Dropped
+ *
+ * @brief   Bytes lost to DEBUG_TX_DROP or DEBUG_TX_OVERWRITE.
+ *
+ * @return  Byte count.
+ */
+uint32_t USART_Printf_Dropped(void)
+{
+#ifdef DEBUG_TX_REQ
+    return tx_dropped;
+#else
+    return 0;
+#endif
 }
 
+#ifdef DEBUG_TX_REQ
+/*********************************************************************
+ * @fn      _write
+ *
+ * @brief   Support Printf Function. Copies into the TX ring and returns,
+ *          the DMA sends it in the background. A full ring is handled
+ *          as set by USART_Printf_SetPolicy; DEBUG_TX_OVERWRITE first
+ *          waits for the chunk in flight (at most DEBUG_TX_CHUNK bytes).
+ *          Not reentrant: do not print from a handler that can interrupt
+ *          a print. Without a DMA channel it sends byte by byte on TXE.
+ *
+ * @param   *buf - UART send Data.
+ *          size - Data length
+ *
+ * @return  size: Data length
+ */
+__attribute__((used))
+int _write(int fd, char *buf, int size)
+{
+    uint32_t en, left = (uint32_t)size, room, offset, n;
+
+    if(tx_ch == 0)
+    {
+        for(n = 0; n < left; n++){
+            while(USART_GetFlagStatus(DEBUG_USART, USART_FLAG_TXE) == RESET);
+            USART_SendData(DEBUG_USART, buf[n]);
+        }
+        return size;
+    }
+    en = NVIC_GetStatusIRQ(DEBUG_TX_IRQn);
+    NVIC_DisableIRQ(DEBUG_TX_IRQn);
+    while(left)
+    {
+        room = DEBUG_TX_BUF_SIZE - (tx_head - tx_tail);
+        if(room == 0)
+        {
+            if(tx_policy == DEBUG_TX_DROP)
+            {
+                tx_dropped += left;
+                break;
+            }
+
+            tx_wait();
+            if(tx_policy == DEBUG_TX_OVERWRITE)
+            {
+                /* The DMA is idle: the oldest bytes sit right after the free space */
+                n = tx_head - tx_tail;
+                if(n > left)
+                    n = left;
+                tx_tail += n;
+                tx_dropped += n;
+            }
+            else
+            {
+                tx_kick();
+            }
+            continue;
+        }
+
+        offset = tx_head & DEBUG_TX_MASK;
+        n = DEBUG_TX_BUF_SIZE - offset;
+        if(n > room)
+            n = room;
+        if(n > left)
+            n = left;
+        memcpy(&tx_buf[offset], buf, n);
+        buf += n;
+        left -= n;
+        tx_head += n;
+    }
+    tx_kick();
+    if(en)
+        NVIC_EnableIRQ(DEBUG_TX_IRQn);
+
+    return size;
+}
+
+#else
 /*********************************************************************
  * @fn      _write
  *
@@ -166,6 +453,8 @@ int _write(int fd, char *buf, int size)
     return size;
 }
 
+#endif
+
 /*********************************************************************
  * @fn      _sbrk
  *
@@ -24,9 +24,36 @@
 //#define DEBUG   DEBUG_UART2
 //#define DEBUG   DEBUG_UART3
 
+/* Printf transport. With DEBUG_TX_BUF_SIZE non-zero _write copies into a
+ * RAM ring (power of 2 bytes) drained by the TX DMA channel of the DEBUG
+ * USART and returns at once; 0 keeps the byte-by-byte polled transport.
+ * The channel comes from dma_chan.h: held by another driver, printf
+ * falls back to the polled transport. */
+#ifndef DEBUG_TX_BUF_SIZE
+#define DEBUG_TX_BUF_SIZE    512
+#endif
+
+/* Largest chunk handed to the DMA at once, bounds how long
+ * DEBUG_TX_OVERWRITE waits for the chunk in flight */
+#ifndef DEBUG_TX_CHUNK
+#define DEBUG_TX_CHUNK       (DEBUG_TX_BUF_SIZE / 4)
+#endif
+
+/* What _write does when the ring is full */
+#define DEBUG_TX_DROP        0 /* Drop what does not fit */
+#define DEBUG_TX_BLOCK       1 /* Wait for room */
+#define DEBUG_TX_OVERWRITE   2 /* Drop the oldest bytes not yet sent */
+
+#ifndef DEBUG_TX_POLICY
+#define DEBUG_TX_POLICY      DEBUG_TX_BLOCK
+#endif
+
 void Delay_Init(void);
 void Delay_Us(uint32_t n);
 void Delay_Ms(uint32_t n);
 void USART_Printf_Init(uint32_t baudrate);
+void USART_Printf_SetPolicy(uint8_t Policy);
+void USART_Printf_Flush(void);
+uint32_t USART_Printf_Dropped(void);
 
 #endif
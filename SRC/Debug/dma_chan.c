@@ -0,0 +1,318 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : dma_chan.c
+ * Author             : typetrade
+ * Version            : V1.0.0
+ * Date               : 2026/10/17
+ * Description        : DMA1 channel manager. Drivers ask for a channel by
+ *                      the request line they use (DMA_REQ_USART1_TX, ...)
+ *                      instead of naming one: each line is wired to one
+ *                      channel, which is handed out to one owner at a
+ *                      time, and memory-to-memory users get any free
+ *                      channel, those of the seldom used lines first.
+ *                      The manager owns DMA1_Channel1..7_IRQHandler: each
+ *                      reads and clears its channel's flags and calls the
+ *                      owner's handler with them.
+ *                      DMA1 has no linked-list mode, so descriptor chains
+ *                      run in software: DMA_Chain_Start programs the first
+ *                      fragment, and the transfer complete interrupt of
+ *                      each one programs the next before anything else
+ *                      (RAM resident, __HIGH_CODE), so a header, payload
+ *                      and CRC in three buffers leave as one transfer with
+ *                      one re-arm gap of interrupt latency between them.
+ *                      Built with SIM_HOST the handlers are driven by the
+ *                      host DMA model (HOST/DmaChain).
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+#include "dma_chan.h"
+
+#ifdef SIM_HOST
+#include "sim_periph.h"
+#endif
+
+/* Channel registers and INTFR bits of channel index k (0-based) */
+#define DMA_CHAN_CH(k)             ((DMA_Channel_TypeDef *)(DMA1_Channel1_BASE + 0x14 * (k)))
+#define DMA_CHAN_FLAG_GL(k)        ((uint32_t)0xF << (4 * (k)))
+
+/* Bits the manager owns in a descriptor's CFGR */
+#define DMA_CHAIN_CFGR_CLEAR       (DMA_Mode_Circular | DMA_IT_HT | DMA_IT_TC | DMA_IT_TE | DMA_CFGR1_EN)
+#define DMA_CHAIN_CFGR_SET         (DMA_IT_TC | DMA_IT_TE | DMA_CFGR1_EN)
+
+#ifdef SIM_HOST
+#define DMA_CHAN_ISR
+#else
+#define DMA_CHAN_ISR               __attribute__((interrupt("WCH-Interrupt-fast")))
+#endif
+
+/* One channel and its owner */
+typedef struct
+{
+    DMA_ChanHandler        Handler;
+    void                  *Context;
+    const DMA_DescTypeDef *Desc;         /* Chain fragment running, or NULL */
+    DMA_ChainCallback      Done;
+    void                  *DoneContext;
+    uint8_t                Owner;        /* Request line + 1, 0 when free */
+} DMA_ChanStateTypeDef;
+
+/* Channel of each request line, 0 for any */
+static const uint8_t dma_chan_of_req[DMA_REQ_COUNT] = {
+    0, 1, 2, 3, 4, 5, 4, 5, 7, 6, 2, 3, 6, 7, 4, 5
+};
+
+/* Channels tried for DMA_REQ_MEM2MEM, the USART1 ones last */
+static const uint8_t dma_chan_m2m_order[DMA_CHAN_COUNT] = {
+    1, 3, 6, 2, 7, 5, 4
+};
+
+static DMA_ChanStateTypeDef dma_chan[DMA_CHAN_COUNT];
+
+/*********************************************************************
+ * @fn      dma_chan_irq
+ *
+ * @brief   Interrupt work of channel index k: the next fragment of a
+ *          chain, or the owner's handler.
+ *
+ * @return  none
+ */
+static __HIGH_CODE void dma_chan_irq(uint8_t k)
+{
+    DMA_ChanStateTypeDef  *s = &dma_chan[k];
+    DMA_Channel_TypeDef   *ch = DMA_CHAN_CH(k);
+    const DMA_DescTypeDef *d = s->Desc;
+    uint32_t               flags = (DMA1->INTFR >> (4 * k)) & (DMA_CHAN_TC | DMA_CHAN_HT | DMA_CHAN_TE);
+
+    if(!flags)
+        return;
+    DMA1->INTFCR = DMA_CHAN_FLAG_GL(k);
+
+    if(d == NULL)
+    {
+        if(s->Handler)
+            s->Handler(s->Context, flags);
+        return;
+    }
+
+    if(!(flags & DMA_CHAN_TE) && (d = d->Next) != NULL)
+    {
+        ch->CFGR = 0;
+        ch->PADDR = d->Periph;
+        ch->MADDR = d->Memory;
+        ch->CNTR = d->Count;
+        ch->CFGR = (d->Cfgr & ~DMA_CHAIN_CFGR_CLEAR) | DMA_CHAIN_CFGR_SET;
+        s->Desc = d;
+        return;
+    }
+
+    ch->CFGR = 0;
+    s->Desc = NULL;
+    if(s->Done)
+        s->Done(s->DoneContext, (flags & DMA_CHAN_TE) ? ERROR : SUCCESS);
+}
+
+/*********************************************************************
+ * @fn      DMA1_ChannelN_IRQHandler
+ *
+ * @brief   This function handles DMA1 channels 1 to 7.
+ *
+ * @return  none
+ */
+#define DMA_CHAN_HANDLER(n)                                    \
+    void DMA1_Channel##n##_IRQHandler(void) DMA_CHAN_ISR;      \
+    __HIGH_CODE void DMA1_Channel##n##_IRQHandler(void)        \
+    {                                                          \
+        dma_chan_irq(n - 1);                                   \
+    }
+
+DMA_CHAN_HANDLER(1)
+DMA_CHAN_HANDLER(2)
+DMA_CHAN_HANDLER(3)
+DMA_CHAN_HANDLER(4)
+DMA_CHAN_HANDLER(5)
+DMA_CHAN_HANDLER(6)
+DMA_CHAN_HANDLER(7)
+
+#ifdef SIM_HOST
+static void (*const dma_chan_vectors[DMA_CHAN_COUNT])(void) = {
+    DMA1_Channel1_IRQHandler, DMA1_Channel2_IRQHandler, DMA1_Channel3_IRQHandler,
+    DMA1_Channel4_IRQHandler, DMA1_Channel5_IRQHandler, DMA1_Channel6_IRQHandler,
+    DMA1_Channel7_IRQHandler
+};
+#endif
+
+/*********************************************************************
+ * @fn      DMA_Chan_Alloc
+ *
+ * @brief   Hands out the channel of a request line, disabled, flags
+ *          clear, its interrupt enabled in the NVIC (the channel's own
+ *          enables decide what reaches Handler).
+ *
+ * @param   Request - request line, DMA_REQ_MEM2MEM for any channel.
+ *          Handler - called with the channel's flags from its interrupt,
+ *                    may be NULL for a polled channel or a chain.
+ *          Context - passed to Handler.
+ *
+ * @return  Channel, 1 to 7, or 0 if it belongs to someone else (for
+ *          DMA_REQ_MEM2MEM: no channel is free).
+ */
+uint8_t DMA_Chan_Alloc(DMA_RequestTypeDef Request, DMA_ChanHandler Handler, void *Context)
+{
+    DMA_ChanStateTypeDef *s;
+    uint32_t              irq;
+    uint8_t               i, ch = 0;
+
+    if((uint32_t)Request >= DMA_REQ_COUNT)
+        return 0;
+
+    irq = __irq_save();
+    if(Request == DMA_REQ_MEM2MEM)
+    {
+        for(i = 0; i < DMA_CHAN_COUNT; i++){
+            if(dma_chan[dma_chan_m2m_order[i] - 1].Owner == 0)
+            {
+                ch = dma_chan_m2m_order[i];
+                break;
+            }
+        }
+    }
+    else if(dma_chan[dma_chan_of_req[Request] - 1].Owner == 0)
+    {
+        ch = dma_chan_of_req[Request];
+    }
+    if(ch)
+        dma_chan[ch - 1].Owner = (uint8_t)Request + 1;
+    __irq_restore(irq);
+    if(ch == 0)
+        return 0;
+
+    s = &dma_chan[ch - 1];
+    s->Handler = Handler;
+    s->Context = Context;
+    s->Desc = NULL;
+    s->Done = NULL;
+    RCC_AHBPeriphClockCmd(RCC_AHBPeriph_DMA1, ENABLE);
+    DMA_CHAN_CH(ch - 1)->CFGR = 0;
+    DMA1->INTFCR = DMA_CHAN_FLAG_GL(ch - 1);
+#ifdef SIM_HOST
+    SIM_DMA_SetIRQHandler(ch, dma_chan_vectors[ch - 1]);
+#else
+    NVIC_EnableIRQ((IRQn_Type)(DMA1_Channel1_IRQn + ch - 1));
+#endif
+
+    return ch;
+}
+
+/*********************************************************************
+ * @fn      DMA_Chan_Free
+ *
+ * @brief   Stops a channel and gives it back. A chain running on it is
+ *          dropped without its callback.
+ *
+ * @param   Channel - from DMA_Chan_Alloc.
+ *
+ * @return  none
+ */
+void DMA_Chan_Free(uint8_t Channel)
+{
+    DMA_ChanStateTypeDef *s;
+
+    if(Channel < 1 || Channel > DMA_CHAN_COUNT)
+        return;
+
+    s = &dma_chan[Channel - 1];
+#ifdef SIM_HOST
+    SIM_DMA_SetIRQHandler(Channel, NULL);
+#else
+    NVIC_DisableIRQ((IRQn_Type)(DMA1_Channel1_IRQn + Channel - 1));
+#endif
+    DMA_CHAN_CH(Channel - 1)->CFGR = 0;
+    DMA1->INTFCR = DMA_CHAN_FLAG_GL(Channel - 1);
+    s->Handler = NULL;
+    s->Desc = NULL;
+    s->Done = NULL;
+    s->Owner = 0;
+}
+
+/*********************************************************************
+ * @fn      DMA_Chan_Regs
+ *
+ * @brief   Registers of a channel.
+ *
+ * @param   Channel - 1 to 7.
+ *
+ * @return  DMA1_ChannelN.
+ */
+DMA_Channel_TypeDef *DMA_Chan_Regs(uint8_t Channel)
+{
+    return DMA_CHAN_CH(Channel - 1);
+}
+
+/*********************************************************************
+ * @fn      DMA_Chan_Service
+ *
+ * @brief   Does the work of the channel interrupt if its flags are set,
+ *          for owners waiting with the interrupt masked.
+ *
+ * @param   Channel - from DMA_Chan_Alloc.
+ *
+ * @return  none
+ */
+void DMA_Chan_Service(uint8_t Channel)
+{
+    if(Channel >= 1 && Channel <= DMA_CHAN_COUNT && dma_chan[Channel - 1].Owner)
+        dma_chan_irq(Channel - 1);
+}
+
+/*********************************************************************
+ * @fn      DMA_Chain_Start
+ *
+ * @brief   Runs a descriptor chain on an owned, idle channel. Done runs
+ *          from the interrupt of the last fragment, or of the first
+ *          that failed.
+ *
+ * @param   Channel - from DMA_Chan_Alloc.
+ *          First - first descriptor.
+ *          Done - completion callback, may be NULL.
+ *          Context - passed to Done.
+ *
+ * @return  SUCCESS, or ERROR if the channel is not owned or still runs.
+ */
+ErrorStatus DMA_Chain_Start(uint8_t Channel, const DMA_DescTypeDef *First, DMA_ChainCallback Done, void *Context)
+{
+    DMA_ChanStateTypeDef *s;
+    DMA_Channel_TypeDef  *ch;
+
+    if(Channel < 1 || Channel > DMA_CHAN_COUNT || First == NULL)
+        return ERROR;
+    s = &dma_chan[Channel - 1];
+    ch = DMA_CHAN_CH(Channel - 1);
+    if(s->Owner == 0 || s->Desc != NULL || (ch->CFGR & DMA_CFGR1_EN))
+        return ERROR;
+
+    s->Done = Done;
+    s->DoneContext = Context;
+    s->Desc = First;
+    ch->CFGR = 0;
+    DMA1->INTFCR = DMA_CHAN_FLAG_GL(Channel - 1);
+    ch->PADDR = First->Periph;
+    ch->MADDR = First->Memory;
+    ch->CNTR = First->Count;
+    ch->CFGR = (First->Cfgr & ~DMA_CHAIN_CFGR_CLEAR) | DMA_CHAIN_CFGR_SET;
+
+    return SUCCESS;
+}
+
+/*********************************************************************
+ * @fn      DMA_Chain_Busy
+ *
+ * @brief   Whether a chain still runs on a channel.
+ *
+ * @param   Channel - from DMA_Chan_Alloc.
+ *
+ * @return  1 until its callback ran.
+ */
+uint8_t DMA_Chain_Busy(uint8_t Channel)
+{
+    if(Channel < 1 || Channel > DMA_CHAN_COUNT)
+        return 0;
+    return dma_chan[Channel - 1].Desc != NULL;
+}
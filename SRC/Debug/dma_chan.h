@@ -0,0 +1,84 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : dma_chan.h
+ * Author             : typetrade
+ * Version            : V1.0.0
+ * Date               : 2026/10/17
+ * Description        : DMA1 channel manager: channels handed out by request
+ *                      line, interrupt dispatch, and software descriptor
+ *                      chains.
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+#ifndef __DMA_CHAN_H
+#define __DMA_CHAN_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "debug.h"
+
+/* Channels managed, DMA1_Channel1 to DMA1_Channel7 */
+#define DMA_CHAN_COUNT             7
+
+/* Request lines. Each is wired to one channel; DMA_REQ_MEM2MEM takes
+ * any free channel. */
+typedef enum
+{
+    DMA_REQ_MEM2MEM = 0,
+    DMA_REQ_ADC1,               /* Channel 1 */
+    DMA_REQ_SPI1_RX,            /* Channel 2 */
+    DMA_REQ_SPI1_TX,            /* Channel 3 */
+    DMA_REQ_SPI2_RX,            /* Channel 4 */
+    DMA_REQ_SPI2_TX,            /* Channel 5 */
+    DMA_REQ_USART1_TX,          /* Channel 4 */
+    DMA_REQ_USART1_RX,          /* Channel 5 */
+    DMA_REQ_USART2_TX,          /* Channel 7 */
+    DMA_REQ_USART2_RX,          /* Channel 6 */
+    DMA_REQ_USART3_TX,          /* Channel 2 */
+    DMA_REQ_USART3_RX,          /* Channel 3 */
+    DMA_REQ_I2C1_TX,            /* Channel 6 */
+    DMA_REQ_I2C1_RX,            /* Channel 7 */
+    DMA_REQ_I2C2_TX,            /* Channel 4 */
+    DMA_REQ_I2C2_RX,            /* Channel 5 */
+    DMA_REQ_COUNT
+} DMA_RequestTypeDef;
+
+/* Flags passed to a channel handler, as in INTFR for channel 1 */
+#define DMA_CHAN_TC                ((uint32_t)0x00000002)
+#define DMA_CHAN_HT                ((uint32_t)0x00000004)
+#define DMA_CHAN_TE                ((uint32_t)0x00000008)
+
+/* Channel interrupt handler, runs in DMA1_ChannelX_IRQHandler (or in
+ * DMA_Chan_Service) with the channel's flags already cleared */
+typedef void (*DMA_ChanHandler)(void *Context, uint32_t Flags);
+
+/* One fragment of a chain. Cfgr holds direction, sizes, increments,
+ * priority and MEM2MEM as for DMA_Init; the manager adds the interrupt
+ * enables and EN, and drops circular mode. Descriptors are only read,
+ * and must stay valid until the chain completes. */
+typedef struct DMA_DescTypeDef
+{
+    uint32_t                      Cfgr;
+    uint32_t                      Periph;   /* PADDR */
+    uint32_t                      Memory;   /* MADDR */
+    uint16_t                      Count;    /* Items, 1 to 65535 */
+    const struct DMA_DescTypeDef *Next;     /* NULL ends the chain */
+} DMA_DescTypeDef;
+
+/* Chain completion, runs in the channel interrupt handler: Status is
+ * ERROR after a transfer error, which ends the chain */
+typedef void (*DMA_ChainCallback)(void *Context, ErrorStatus Status);
+
+uint8_t              DMA_Chan_Alloc(DMA_RequestTypeDef Request, DMA_ChanHandler Handler, void *Context);
+void                 DMA_Chan_Free(uint8_t Channel);
+DMA_Channel_TypeDef *DMA_Chan_Regs(uint8_t Channel);
+void                 DMA_Chan_Service(uint8_t Channel);
+
+ErrorStatus DMA_Chain_Start(uint8_t Channel, const DMA_DescTypeDef *First, DMA_ChainCallback Done, void *Context);
+uint8_t     DMA_Chain_Busy(uint8_t Channel);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __DMA_CHAN_H */
@@ -0,0 +1,146 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : hexdump.c
+ * Author             : typetrade
+ * Version            : V1.0.0
+ * Date               : 2026/10/17
+ * Description        : Bulk hex dump of memory words without printf.
+ *                      Words are formatted through a nibble table into a
+ *                      line buffer, and each line goes to _write in one
+ *                      call, so the polled and the DMA printf transport
+ *                      both see whole lines. Words are lowercase "%08x"
+ *                      separated by spaces, HEXDUMP_WORDS_PER_LINE per
+ *                      line. With HEXDUMP_RLE, a run of HEXDUMP_RLE_MIN
+ *                      or more equal words (erased flash) prints once as
+ *                      "wwwwwwww*n" and takes one place on the line.
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+#include <stdio.h>
+#include "hexdump.h"
+
+#ifndef SIM_HOST
+extern int _write(int fd, char *buf, int size);
+#endif
+
+/* "aaaaaaaa: " + per word "wwwwwwww*4294967295 " */
+#define HEXDUMP_LINE_MAX           (10 + HEXDUMP_WORDS_PER_LINE * 20)
+
+static const char hexdump_nibble[16] = {'0', '1', '2', '3', '4', '5', '6', '7',
+                                        '8', '9', 'a', 'b', 'c', 'd', 'e', 'f'};
+
+/*********************************************************************
+ * @fn      hexdump_word
+ *
+ * @brief   Appends Value as 8 hex digits.
+ *
+ * @return  End of the appended characters.
+ */
+static char *hexdump_word(char *p, uint32_t Value)
+{
+    p[0] = hexdump_nibble[(Value >> 28) & 0xF];
+    p[1] = hexdump_nibble[(Value >> 24) & 0xF];
+    p[2] = hexdump_nibble[(Value >> 20) & 0xF];
+    p[3] = hexdump_nibble[(Value >> 16) & 0xF];
+    p[4] = hexdump_nibble[(Value >> 12) & 0xF];
+    p[5] = hexdump_nibble[(Value >> 8) & 0xF];
+    p[6] = hexdump_nibble[(Value >> 4) & 0xF];
+    p[7] = hexdump_nibble[Value & 0xF];
+    return p + 8;
+}
+
+/*********************************************************************
+ * @fn      hexdump_dec
+ *
+ * @brief   Appends Value in decimal.
+ *
+ * @return  End of the appended characters.
+ */
+static char *hexdump_dec(char *p, uint32_t Value)
+{
+    char     tmp[10];
+    uint8_t  n = 0;
+
+    do
+    {
+        tmp[n++] = (char)('0' + Value % 10);
+        Value /= 10;
+    } while(Value);
+
+    while(n)
+        *p++ = tmp[--n];
+    return p;
+}
+
+/*********************************************************************
+ * @fn      hexdump_out
+ *
+ * @brief   Sends one line through the printf transport.
+ *
+ * @return  none
+ */
+static void hexdump_out(const char *Line, uint32_t Length)
+{
+#ifdef SIM_HOST
+    fwrite(Line, 1, Length, stdout);
+#else
+    _write(1, (char *)Line, (int)Length);
+#endif
+}
+
+/*********************************************************************
+ * @fn      HexDump_Words
+ *
+ * @brief   Dumps Count words from Address, see the file description.
+ *
+ * @param   Address - word aligned start address.
+ *          Count - number of words.
+ *          Flags - HEXDUMP_ADDR, HEXDUMP_RLE.
+ *
+ * @return  none
+ */
+void HexDump_Words(uint32_t Address, uint32_t Count, uint8_t Flags)
+{
+    const uint32_t *w = (const uint32_t *)Address;
+    char            line[HEXDUMP_LINE_MAX], *p = line;
+    uint32_t        i = 0, n, v;
+    uint8_t         slot = 0;
+
+    /* Text printf still holds goes first */
+    fflush(stdout);
+
+    while(i < Count)
+    {
+        if(slot == 0 && (Flags & HEXDUMP_ADDR))
+        {
+            p = hexdump_word(p, Address + 4 * i);
+            *p++ = ':';
+            *p++ = ' ';
+        }
+
+        v = w[i];
+        n = 1;
+        if(Flags & HEXDUMP_RLE)
+        {
+            while(i + n < Count && w[i + n] == v)
+                n++;
+            if(n < HEXDUMP_RLE_MIN)
+                n = 1;
+        }
+
+        p = hexdump_word(p, v);
+        if(n > 1)
+        {
+            *p++ = '*';
+            p = hexdump_dec(p, n);
+        }
+        *p++ = ' ';
+        i += n;
+
+        if(++slot == HEXDUMP_WORDS_PER_LINE || i == Count)
+        {
+            p[-1] = '\n';
+            hexdump_out(line, (uint32_t)(p - line));
+            p = line;
+            slot = 0;
+        }
+    }
+}
@@ -0,0 +1,38 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : hexdump.h
+ * Author             : typetrade
+ * Version            : V1.0.0
+ * Date               : 2026/10/17
+ * Description        : Bulk hex dump of memory words without printf.
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+#ifndef __HEXDUMP_H
+#define __HEXDUMP_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/* Words (or runs) per output line */
+#ifndef HEXDUMP_WORDS_PER_LINE
+#define HEXDUMP_WORDS_PER_LINE     8
+#endif
+
+/* Shortest run of equal words HEXDUMP_RLE folds */
+#ifndef HEXDUMP_RLE_MIN
+#define HEXDUMP_RLE_MIN            3
+#endif
+
+/* HexDump_Words flags */
+#define HEXDUMP_ADDR               0x01 /* Start each line with "aaaaaaaa: " */
+#define HEXDUMP_RLE                0x02 /* Print runs of equal words as "wwwwwwww*n" */
+
+void HexDump_Words(uint32_t Address, uint32_t Count, uint8_t Flags);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __HEXDUMP_H */
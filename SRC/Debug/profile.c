@@ -0,0 +1,142 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : profile.c
+ * Author             : typetrade
+ * Version            : V1.0.0
+ * Date               : 2026/10/17
+ * Description        : Opt-in cycle/instruction counters for driver functions.
+ *                      Functions marked with PROF_FUNC() (flash, CRC, DMA
+ *                      and USART drivers, not the RAM resident .highcode
+ *                      ones) link their counters into a RAM
+ *                      table on first call, with interrupts masked. Times
+ *                      are inclusive: a driver function calling another
+ *                      instrumented one is charged for both. Counters are
+ *                      not interrupt safe; a call interrupted by an
+ *                      instrumented handler is charged for the handler
+ *                      too.
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+#include "debug.h"
+#include "profile.h"
+
+#ifdef PROF_ENABLE
+
+static PROF_EntryTypeDef *prof_head = NULL;
+static uint8_t            prof_paused = 0;
+
+/*********************************************************************
+ * @fn      PROF_Enter
+ *
+ * @brief   Links Entry in on its first call and snapshots the counters.
+ *
+ * @param   Entry - counters of the calling function.
+ *
+ * @return  Frame passed back to PROF_Leave.
+ */
+PROF_FrameTypeDef PROF_Enter(PROF_EntryTypeDef *Entry)
+{
+    PROF_FrameTypeDef frame;
+    uint32_t          irq;
+
+    if(!Entry->Linked)
+    {
+        /* An instrumented handler may link its own entry in between */
+        irq = __irq_save();
+        if(!Entry->Linked)
+        {
+            Entry->Next = prof_head;
+            prof_head = Entry;
+            Entry->Linked = 1;
+        }
+        __irq_restore(irq);
+    }
+    frame.Entry = Entry;
+    frame.Instret = __get_MINSTRET();
+    frame.Cycles = __get_MCYCLE();
+    return frame;
+}
+
+/*********************************************************************
+ * @fn      PROF_Leave
+ *
+ * @brief   Charges the call to its entry. Runs on every return path of
+ *          the instrumented function.
+ *
+ * @param   Frame - snapshot taken by PROF_Enter.
+ *
+ * @return  none
+ */
+void PROF_Leave(PROF_FrameTypeDef *Frame)
+{
+    uint32_t           cycles = __get_MCYCLE() - Frame->Cycles;
+    uint32_t           instret = __get_MINSTRET() - Frame->Instret;
+    PROF_EntryTypeDef *e = Frame->Entry;
+
+    if(prof_paused)
+        return;
+
+    e->Calls++;
+    e->Cycles += cycles;
+    e->Instret += instret;
+    if(cycles > e->MaxCycles)
+        e->MaxCycles = cycles;
+}
+
+/*********************************************************************
+ * @fn      prof_print_u64
+ *
+ * @brief   Prints a 64-bit counter (newlib-nano printf has no %llu).
+ *
+ * @return  none
+ */
+static void prof_print_u64(uint64_t Value)
+{
+    if(Value >= 1000000000ULL)
+        printf(",%lu%09lu", (unsigned long)(Value / 1000000000ULL), (unsigned long)(Value % 1000000000ULL));
+    else
+        printf(",%lu", (unsigned long)Value);
+}
+
+/*********************************************************************
+ * @fn      PROF_Dump
+ *
+ * @brief   Prints the table as CSV over the debug UART. The USART calls
+ *          made by printf are not counted while it runs.
+ *
+ * @return  none
+ */
+void PROF_Dump(void)
+{
+    PROF_EntryTypeDef *e;
+
+    prof_paused = 1;
+    printf("function,calls,cycles,max_cycles,avg_cycles,instret,cpi_x100\r\n");
+    for(e = prof_head; e != NULL; e = e->Next){
+        printf("%s,%lu", e->Name, (unsigned long)e->Calls);
+        prof_print_u64(e->Cycles);
+        printf(",%lu,%lu", (unsigned long)e->MaxCycles, e->Calls ? (unsigned long)(e->Cycles / e->Calls) : 0UL);
+        prof_print_u64(e->Instret);
+        printf(",%lu\r\n", e->Instret ? (unsigned long)(e->Cycles * 100 / e->Instret) : 0UL);
+    }
+    prof_paused = 0;
+}
+
+/*********************************************************************
+ * @fn      PROF_Reset
+ *
+ * @brief   Clears every counter, the table keeps its entries.
+ *
+ * @return  none
+ */
+void PROF_Reset(void)
+{
+    PROF_EntryTypeDef *e;
+
+    for(e = prof_head; e != NULL; e = e->Next){
+        e->Calls = 0;
+        e->MaxCycles = 0;
+        e->Cycles = 0;
+        e->Instret = 0;
+    }
+}
+
+#endif
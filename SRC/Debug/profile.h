@@ -0,0 +1,68 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : profile.h
+ * Author             : typetrade
+ * Version            : V1.0.0
+ * Date               : 2026/10/17
+ * Description        : Opt-in cycle/instruction counters for driver functions.
+ *                      Build with PROF_ENABLE defined to record them;
+ *                      without it PROF_FUNC() expands to nothing.
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+#ifndef __PROFILE_H
+#define __PROFILE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#ifdef PROF_ENABLE
+
+/* Counters of one instrumented function, linked in on its first call */
+typedef struct PROF_Entry
+{
+    const char        *Name;
+    struct PROF_Entry *Next;
+    uint8_t            Linked;
+    uint32_t           Calls;
+    uint32_t           MaxCycles;
+    uint64_t           Cycles;      /* Inclusive of instrumented callees */
+    uint64_t           Instret;
+} PROF_EntryTypeDef;
+
+/* Counter snapshot taken on entry */
+typedef struct
+{
+    PROF_EntryTypeDef *Entry;
+    uint32_t           Cycles;
+    uint32_t           Instret;
+} PROF_FrameTypeDef;
+
+PROF_FrameTypeDef PROF_Enter(PROF_EntryTypeDef *Entry);
+void              PROF_Leave(PROF_FrameTypeDef *Frame);
+
+/* First statement of an instrumented function: counts the call and, on
+ * every return path, its cycles and retired instructions. Not for
+ * __HIGH_CODE functions: PROF_Enter/PROF_Leave run from flash and would
+ * stall on it while an erase or program runs. */
+#define PROF_FUNC()                                                   \
+    static PROF_EntryTypeDef prof_entry_ = {__func__, 0, 0, 0, 0, 0, 0}; \
+    PROF_FrameTypeDef prof_frame_ __attribute__((cleanup(PROF_Leave))) = PROF_Enter(&prof_entry_)
+
+void PROF_Dump(void);
+void PROF_Reset(void);
+
+#else
+
+#define PROF_FUNC()
+#define PROF_Dump()
+#define PROF_Reset()
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __PROFILE_H */
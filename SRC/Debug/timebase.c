@@ -0,0 +1,148 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : timebase.c
+ * Author             : typetrade
+ * Version            : V1.0.0
+ * Date               : 2026/10/17
+ * Description        : Free-running 64-bit timebase on SysTick.
+ *                      SysTick counts up at HCLK from Timebase_Init on and
+ *                      is never reloaded, so 64 bits never wrap and no
+ *                      interrupt is needed. now_cycles() returns the raw
+ *                      count, in HCLK cycles of whatever HCLK was at the
+ *                      time. now_us() stays continuous across clock
+ *                      changes: Timebase_Rebase, called by Delay_Init after
+ *                      every change, restarts the conversion from the
+ *                      current count and time.
+ *                      Built with SIM_HOST the count is the simulated
+ *                      mcycle.
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+#include "timebase.h"
+#include "debug.h"
+
+/* SysTick CTLR bits */
+#define STK_STE                    ((uint32_t)0x00000001) /* Counter enable */
+#define STK_STCLK                  ((uint32_t)0x00000004) /* HCLK, not HCLK/8 */
+#define STK_MODE                   ((uint32_t)0x00000010) /* Count down */
+#define STK_INIT                   ((uint32_t)0x00000020) /* Reload the counter */
+
+static uint64_t tb_base_cycles = 0;  /* Count at the last rebase */
+static uint64_t tb_base_us = 0;      /* now_us() at the last rebase */
+static uint32_t tb_cycles_per_us = 1;
+
+/*********************************************************************
+ * @fn      tb_hclk
+ *
+ * @brief   Current HCLK from the RCC registers, so an HCLK divider
+ *          SystemCoreClock does not reflect is taken into account.
+ *
+ * @return  HCLK in Hz.
+ */
+static uint32_t tb_hclk(void)
+{
+#ifdef SIM_HOST
+    return SystemCoreClock;
+#else
+    RCC_ClocksTypeDef clocks;
+
+    RCC_GetClocksFreq(&clocks);
+    return clocks.HCLK_Frequency;
+#endif
+}
+
+/*********************************************************************
+ * @fn      Timebase_Init
+ *
+ * @brief   Starts the SysTick counter once, later calls only rebase.
+ *
+ * @return  none
+ */
+void Timebase_Init(void)
+{
+#ifndef SIM_HOST
+    if((SysTick->CTLR & STK_STE) == 0 || (SysTick->CTLR & STK_MODE))
+    {
+        SysTick->CMP = 0xFFFFFFFFFFFFFFFFULL;
+        SysTick->CTLR = STK_INIT | STK_STCLK | STK_STE;
+        tb_base_cycles = 0;
+        tb_base_us = 0;
+    }
+#endif
+    Timebase_Rebase();
+}
+
+/*********************************************************************
+ * @fn      Timebase_Rebase
+ *
+ * @brief   Picks up the current HCLK. Call after every clock change,
+ *          Delay_Init does.
+ *
+ * @return  none
+ */
+void Timebase_Rebase(void)
+{
+    uint64_t c = now_cycles();
+    uint32_t mhz = tb_hclk() / 1000000;
+
+    tb_base_us += (c - tb_base_cycles) / tb_cycles_per_us;
+    tb_base_cycles = c;
+    tb_cycles_per_us = mhz ? mhz : 1;
+}
+
+/*********************************************************************
+ * @fn      Timebase_CyclesPerUs
+ *
+ * @brief   now_cycles() ticks per microsecond at the current HCLK.
+ *
+ * @return  Cycles.
+ */
+uint32_t Timebase_CyclesPerUs(void)
+{
+    return tb_cycles_per_us;
+}
+
+/*********************************************************************
+ * @fn      now_cycles
+ *
+ * @brief   Reads the 64-bit count.
+ *
+ * @return  HCLK cycles since Timebase_Init.
+ */
+uint64_t now_cycles(void)
+{
+    uint32_t hi, lo;
+
+#ifdef SIM_HOST
+    do
+    {
+        hi = __get_MCYCLEH();
+        lo = __get_MCYCLE();
+    } while(hi != __get_MCYCLEH());
+#else
+    __IO uint32_t *cnt = (__IO uint32_t *)&SysTick->CNT;
+
+    do
+    {
+        hi = cnt[1];
+        lo = cnt[0];
+    } while(hi != cnt[1]);
+#endif
+
+    return ((uint64_t)hi << 32) | lo;
+}
+
+/*********************************************************************
+ * @fn      now_us
+ *
+ * @brief   Monotonic time.
+ *
+ * @return  Microseconds since Timebase_Init.
+ */
+uint64_t now_us(void)
+{
+    uint64_t d = now_cycles() - tb_base_cycles;
+
+    /* 32-bit division while the last rebase is under 2^32 cycles back */
+    if((d >> 32) == 0)
+        return tb_base_us + (uint32_t)d / tb_cycles_per_us;
+    return tb_base_us + d / tb_cycles_per_us;
+}
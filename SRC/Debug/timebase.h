@@ -0,0 +1,52 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : timebase.h
+ * Author             : typetrade
+ * Version            : V1.0.0
+ * Date               : 2026/10/17
+ * Description        : Free-running 64-bit timebase on SysTick.
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+#ifndef __TIMEBASE_H
+#define __TIMEBASE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+void     Timebase_Init(void);
+void     Timebase_Rebase(void);
+uint32_t Timebase_CyclesPerUs(void);
+uint64_t now_cycles(void);
+uint64_t now_us(void);
+
+/*********************************************************************
+ * @fn      deadline_us
+ *
+ * @brief   Deadline Timeout_us from now, for deadline_passed.
+ *
+ * @return  Deadline.
+ */
+static inline uint64_t deadline_us(uint32_t Timeout_us)
+{
+    return now_us() + Timeout_us;
+}
+
+/*********************************************************************
+ * @fn      deadline_passed
+ *
+ * @brief   Checks a deadline_us deadline.
+ *
+ * @return  1 once it has passed.
+ */
+static inline uint8_t deadline_passed(uint64_t Deadline)
+{
+    return now_us() >= Deadline;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TIMEBASE_H */
@@ -97,6 +97,39 @@ typedef enum
 #define FLASH_Access_SYSTEM_HALF      ((uint32_t)0x00000000) /* FLASH Enhance Clock = SYSTEM */
 #define FLASH_Access_SYSTEM           ((uint32_t)0x02000000) /* Enhance_CLK = SYSTEM/2 */
 
+/* Operation kinds with their own busy time budget and telemetry */
+typedef enum
+{
+    FLASH_OP_PROGRAM = 0,        /* Standard halfword program */
+    FLASH_OP_PAGE_PROGRAM_FAST,  /* Fast 256B page program */
+    FLASH_OP_PAGE_ERASE,         /* Standard 4K page erase */
+    FLASH_OP_PAGE_ERASE_FAST,    /* Fast 256B page erase */
+    FLASH_OP_BLOCK_ERASE_FAST,   /* Fast 32K/64K block erase */
+    FLASH_OP_MASS_ERASE,         /* Whole bank erase */
+    FLASH_OP_OB_ERASE,           /* Option byte erase */
+    FLASH_OP_OB_PROGRAM,         /* Option byte halfword program */
+    FLASH_OP_NUM
+} FLASH_OpTypeDef;
+
+/* Observed busy time of one operation kind */
+typedef struct
+{
+    uint32_t Count;              /* Operations waited for */
+    uint32_t Timeouts;           /* Still busy when the budget ran out */
+    uint32_t Last_us;
+    uint32_t Max_us;
+    uint32_t Total_us;
+} FLASH_OpStatsTypeDef;
+
+/* RAM-resident code: the .highcode section of Link.ld, copied by handle_reset.
+ * The core stalls on any instruction fetched from flash while an erase or
+ * program runs, code placed here keeps running. */
+#ifdef SIM_HOST
+#define __HIGH_CODE
+#else
+#define __HIGH_CODE                   __attribute__((section(".highcode"), noinline))
+#endif
+
 /*Functions used for all devices*/
 void         FLASH_Unlock(void);
 void         FLASH_Lock(void);
@@ -126,6 +159,18 @@ void         FLASH_ProgramPage_Fast(uint32_t Page_Address, uint32_t *pbuf);
 void         FLASH_Access_Clock_Cfg(uint32_t FLASH_Access_CLK);
 void         FLASH_Enhance_Mode(FunctionalState NewState);
 
+/* Cache in front of the EEPROM emulation area (eeprom_cache.c). Once set,
+ * EEPROM_READ, EEPROM_WRITE and EEPROM_ERASE are run by Read, Write and
+ * Erase, on the area the hook defines instead of EEPROM_ADDRESS. */
+typedef struct
+{
+    FLASH_Status (*Read)(uint32_t StartAddr, void *Buffer, uint32_t Length);
+    FLASH_Status (*Write)(uint32_t StartAddr, void *Buffer, uint32_t Length);
+    FLASH_Status (*Erase)(uint32_t StartAddr, uint32_t Length);
+} EEPROM_HookTypeDef;
+
+void         EEPROM_SetHook(const EEPROM_HookTypeDef *Hook);
+
 #if defined(CH32V20x_D8) || defined(CH32V20x_D8W)
 FLASH_Status EEPROM_READ(uint32_t StartAddr, void *Buffer, uint32_t Length);
 FLASH_Status EEPROM_ERASE(uint32_t StartAddr, uint32_t Length);
@@ -141,6 +186,12 @@ FLASH_Status FLASH_EraseAllBank1Pages(void);
 FLASH_Status FLASH_GetBank1Status(void);
 FLASH_Status FLASH_WaitForLastBank1Operation(uint32_t Timeout);
 
+/* Busy time budgets and telemetry */
+void         FLASH_SetOpTimeout(FLASH_OpTypeDef Op, uint32_t Timeout_us);
+uint32_t     FLASH_GetOpTimeout(FLASH_OpTypeDef Op);
+void         FLASH_GetOpStats(FLASH_OpTypeDef Op, FLASH_OpStatsTypeDef *Stats);
+void         FLASH_ClearOpStats(void);
+
 #ifdef __cplusplus
 }
 #endif
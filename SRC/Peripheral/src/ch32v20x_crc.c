@@ -8,6 +8,7 @@
  * SPDX-License-Identifier: Apache-2.0
  *******************************************************************************/
 #include "ch32v20x_crc.h"
+#include "profile.h"
 
 /*********************************************************************
  * @fn      CRC_ResetDR
@@ -18,6 +19,8 @@
  */
 void CRC_ResetDR(void)
 {
+    PROF_FUNC();
+
     CRC->CTLR = CRC_CTLR_RESET;
 }
 
@@ -32,6 +35,8 @@ void CRC_ResetDR(void)
  */
 uint32_t CRC_CalcCRC(uint32_t Data)
 {
+    PROF_FUNC();
+
     CRC->DATAR = Data;
 
     return (CRC->DATAR);
@@ -51,6 +56,8 @@ uint32_t CRC_CalcBlockCRC(uint32_t pBuffer[], uint32_t BufferLength)
 {
     uint32_t index = 0;
 
+    PROF_FUNC();
+
     for(index = 0; index < BufferLength; index++){
         CRC->DATAR = pBuffer[index];
     }
@@ -67,6 +74,8 @@ uint32_t CRC_CalcBlockCRC(uint32_t pBuffer[], uint32_t BufferLength)
  */
 uint32_t CRC_GetCRC(void)
 {
+    PROF_FUNC();
+
     return (CRC->DATAR);
 }
 
@@ -81,6 +90,8 @@ uint32_t CRC_GetCRC(void)
  */
 void CRC_SetIDRegister(uint8_t IDValue)
 {
+    PROF_FUNC();
+
     CRC->IDATAR = IDValue;
 }
 
@@ -93,5 +104,7 @@ void CRC_SetIDRegister(uint8_t IDValue)
  */
 uint8_t CRC_GetIDRegister(void)
 {
+    PROF_FUNC();
+
     return (CRC->IDATAR);
 }
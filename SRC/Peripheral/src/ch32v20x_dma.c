@@ -8,6 +8,7 @@
  * SPDX-License-Identifier: Apache-2.0
  *******************************************************************************/
 #include "ch32v20x_dma.h"
+#include "profile.h"
 #include "ch32v20x_rcc.h"
 
 /* DMA1 Channelx interrupt pending bit masks */
@@ -39,6 +40,8 @@
  */
 void DMA_DeInit(DMA_Channel_TypeDef *DMAy_Channelx)
 {
+    PROF_FUNC();
+
     DMAy_Channelx->CFGR &= (uint16_t)(~DMA_CFGR1_EN);
     DMAy_Channelx->CFGR = 0;
     DMAy_Channelx->CNTR = 0;
@@ -99,6 +102,8 @@ void DMA_Init(DMA_Channel_TypeDef *DMAy_Channelx, DMA_InitTypeDef *DMA_InitStruc
 {
     uint32_t tmpreg = 0;
 
+    PROF_FUNC();
+
     tmpreg = DMAy_Channelx->CFGR;
     tmpreg &= CFGR_CLEAR_Mask;
     tmpreg |= DMA_InitStruct->DMA_DIR | DMA_InitStruct->DMA_Mode |
@@ -126,6 +131,8 @@ void DMA_Init(DMA_Channel_TypeDef *DMAy_Channelx, DMA_InitTypeDef *DMA_InitStruc
  */
 void DMA_StructInit(DMA_InitTypeDef *DMA_InitStruct)
 {
+    PROF_FUNC();
+
     DMA_InitStruct->DMA_PeripheralBaseAddr = 0;
     DMA_InitStruct->DMA_MemoryBaseAddr = 0;
     DMA_InitStruct->DMA_DIR = DMA_DIR_PeripheralSRC;
@@ -152,6 +159,8 @@ void DMA_StructInit(DMA_InitTypeDef *DMA_InitStruct)
  */
 void DMA_Cmd(DMA_Channel_TypeDef *DMAy_Channelx, FunctionalState NewState)
 {
+    PROF_FUNC();
+
     if(NewState != DISABLE)
     {
         DMAy_Channelx->CFGR |= DMA_CFGR1_EN;
@@ -180,6 +189,8 @@ void DMA_Cmd(DMA_Channel_TypeDef *DMAy_Channelx, FunctionalState NewState)
  */
 void DMA_ITConfig(DMA_Channel_TypeDef *DMAy_Channelx, uint32_t DMA_IT, FunctionalState NewState)
 {
+    PROF_FUNC();
+
     if(NewState != DISABLE)
     {
         DMAy_Channelx->CFGR |= DMA_IT;
@@ -204,6 +215,8 @@ void DMA_ITConfig(DMA_Channel_TypeDef *DMAy_Channelx, uint32_t DMA_IT, Functiona
  */
 void DMA_SetCurrDataCounter(DMA_Channel_TypeDef *DMAy_Channelx, uint16_t DataNumber)
 {
+    PROF_FUNC();
+
     DMAy_Channelx->CNTR = DataNumber;
 }
 
@@ -221,6 +234,8 @@ void DMA_SetCurrDataCounter(DMA_Channel_TypeDef *DMAy_Channelx, uint16_t DataNum
  */
 uint16_t DMA_GetCurrDataCounter(DMA_Channel_TypeDef *DMAy_Channelx)
 {
+    PROF_FUNC();
+
     return ((uint16_t)(DMAy_Channelx->CNTR));
 }
 
@@ -270,6 +285,8 @@ FlagStatus DMA_GetFlagStatus(uint32_t DMAy_FLAG)
     FlagStatus bitstatus = RESET;
     uint32_t   tmpreg = 0;
 
+    PROF_FUNC();
+
     tmpreg = DMA1->INTFR;
 
     if((tmpreg & DMAy_FLAG) != (uint32_t)RESET)
@@ -326,6 +343,8 @@ FlagStatus DMA_GetFlagStatus(uint32_t DMAy_FLAG)
  */
 void DMA_ClearFlag(uint32_t DMAy_FLAG)
 {
+    PROF_FUNC();
+
     DMA1->INTFCR = DMAy_FLAG;
 }
 
@@ -375,6 +394,8 @@ ITStatus DMA_GetITStatus(uint32_t DMAy_IT)
     ITStatus bitstatus = RESET;
     uint32_t tmpreg = 0;
 
+    PROF_FUNC();
+
     tmpreg = DMA1->INTFR;
 
     if((tmpreg & DMAy_IT) != (uint32_t)RESET)
@@ -430,5 +451,7 @@ ITStatus DMA_GetITStatus(uint32_t DMAy_IT)
  */
 void DMA_ClearITPendingBit(uint32_t DMAy_IT)
 {
+    PROF_FUNC();
+
     DMA1->INTFCR = DMAy_IT;
 }
@@ -8,6 +8,7 @@
  * SPDX-License-Identifier: Apache-2.0
  ***************************************************************************************/
 #include "ch32v20x_flash.h"
+#include "profile.h"
 
 /* Flash Control Register bits */
 #define CR_PG_Set                  ((uint32_t)0x00000001)
@@ -32,6 +33,7 @@
 /* FLASH Status Register bits */
 #define SR_BSY                     ((uint32_t)0x00000001)
 #define SR_WR_BSY                  ((uint32_t)0x00000002)
+#define SR_PGERR                   ((uint32_t)0x00000004)
 #define SR_WRPRTERR                ((uint32_t)0x00000010)
 #define SR_EOP                     ((uint32_t)0x00000020)
 
@@ -54,9 +56,113 @@
 /* EEPROM address */
 #define EEPROM_ADDRESS             ((uint32_t)0x8070000)
 
-/* Delay definition */
-#define EraseTimeout               ((uint32_t)0x000B0000)
-#define ProgramTimeout             ((uint32_t)0x00005000)
+/* Busy time budgets in microseconds for a previous operation to end */
+#define EraseTimeout               ((uint32_t)100000)
+#define ProgramTimeout             ((uint32_t)2000)
+
+/* Busy time budget of each FLASH_OpTypeDef in microseconds, about ten times
+ * the typical time. Kept in RAM, read by the .highcode poll loop. */
+static uint32_t flash_op_timeout[FLASH_OP_NUM] = {
+    1000,       /* FLASH_OP_PROGRAM */
+    20000,      /* FLASH_OP_PAGE_PROGRAM_FAST */
+    50000,      /* FLASH_OP_PAGE_ERASE */
+    30000,      /* FLASH_OP_PAGE_ERASE_FAST */
+    150000,     /* FLASH_OP_BLOCK_ERASE_FAST */
+    1000000,    /* FLASH_OP_MASS_ERASE */
+    50000,      /* FLASH_OP_OB_ERASE */
+    1000,       /* FLASH_OP_OB_PROGRAM */
+};
+
+static FLASH_OpStatsTypeDef flash_op_stats[FLASH_OP_NUM];
+
+/*********************************************************************
+ * @fn      flash_cycles
+ *
+ * @brief   Core cycle counter (mcycle), read inline so that the poll loop
+ *          stays in RAM.
+ *
+ * @return  Cycle count.
+ */
+__attribute__((always_inline)) static inline uint32_t flash_cycles(void)
+{
+#ifdef SIM_HOST
+    return __get_MCYCLE();
+#else
+    uint32_t cycles;
+
+    __asm volatile("csrr %0, mcycle" : "=r"(cycles));
+    return cycles;
+#endif
+}
+
+/*********************************************************************
+ * @fn      flash_poll
+ *
+ * @brief   Polls BSY until it clears or Timeout microseconds pass. The
+ *          budget is counted in mcycle at SystemCoreClock, so it is the
+ *          same at every clock setting (it doubles while HCLK runs at
+ *          SYSCLK/2 and SystemCoreClock is left at SYSCLK).
+ *
+ * @param   Timeout - budget in microseconds.
+ *          Elapsed - receives the busy time in microseconds.
+ *
+ * @return  FLASH Status - The returned value can be: FLASH_ERROR_PG,
+ *        FLASH_ERROR_WRP, FLASH_COMPLETE or FLASH_TIMEOUT.
+ */
+static __HIGH_CODE FLASH_Status flash_poll(uint32_t Timeout, uint32_t *Elapsed)
+{
+    uint32_t mhz = SystemCoreClock / 1000000;
+    uint32_t budget, start, cycles, statr;
+
+    if(mhz == 0)
+        mhz = 1;
+    budget = Timeout < 0xFFFFFFFF / mhz ? Timeout * mhz : 0xFFFFFFFF;
+
+    start = flash_cycles();
+    do
+    {
+        statr = FLASH->STATR;
+        cycles = flash_cycles() - start;
+    } while((statr & SR_BSY) && cycles < budget);
+    *Elapsed = cycles / mhz;
+
+    if(statr & SR_BSY)
+        return FLASH_TIMEOUT;
+    if(statr & SR_PGERR)
+        return FLASH_ERROR_PG;
+    if(statr & SR_WRPRTERR)
+        return FLASH_ERROR_WRP;
+    return FLASH_COMPLETE;
+}
+
+/*********************************************************************
+ * @fn      flash_wait
+ *
+ * @brief   Waits for an operation just started, within its budget, and
+ *          records its busy time.
+ *
+ * @param   Op - operation kind.
+ *
+ * @return  FLASH Status - The returned value can be: FLASH_ERROR_PG,
+ *        FLASH_ERROR_WRP, FLASH_COMPLETE or FLASH_TIMEOUT.
+ */
+static __HIGH_CODE FLASH_Status flash_wait(FLASH_OpTypeDef Op)
+{
+    FLASH_OpStatsTypeDef *stats = &flash_op_stats[Op];
+    FLASH_Status          status;
+    uint32_t              elapsed;
+
+    status = flash_poll(flash_op_timeout[Op], &elapsed);
+
+    stats->Count++;
+    stats->Last_us = elapsed;
+    stats->Total_us += elapsed;
+    if(elapsed > stats->Max_us)
+        stats->Max_us = elapsed;
+    if(status == FLASH_TIMEOUT)
+        stats->Timeouts++;
+    return status;
+}
 
 /*********************************************************************
  * @fn      FLASH_Unlock
@@ -67,6 +173,8 @@
  */
 void FLASH_Unlock(void)
 {
+    PROF_FUNC();
+
     /* Authorize the FPEC of Bank1 Access */
     FLASH->KEYR = FLASH_KEY1;
     FLASH->KEYR = FLASH_KEY2;
@@ -82,6 +190,8 @@ void FLASH_Unlock(void)
  */
 void FLASH_UnlockBank1(void)
 {
+    PROF_FUNC();
+
     FLASH->KEYR = FLASH_KEY1;
     FLASH->KEYR = FLASH_KEY2;
 }
@@ -95,6 +205,8 @@ void FLASH_UnlockBank1(void)
  */
 void FLASH_Lock(void)
 {
+    PROF_FUNC();
+
     FLASH->CTLR |= CR_LOCK_Set;
 }
 
@@ -107,6 +219,8 @@ void FLASH_Lock(void)
  */
 void FLASH_LockBank1(void)
 {
+    PROF_FUNC();
+
     FLASH->CTLR |= CR_LOCK_Set;
 }
 
@@ -124,6 +238,8 @@ FLASH_Status FLASH_ErasePage(uint32_t Page_Address)
 {
     FLASH_Status status = FLASH_COMPLETE;
 
+    PROF_FUNC();
+
     status = FLASH_WaitForLastOperation(EraseTimeout);
 
     if(status == FLASH_COMPLETE)
@@ -132,7 +248,7 @@ FLASH_Status FLASH_ErasePage(uint32_t Page_Address)
         FLASH->ADDR = Page_Address;
         FLASH->CTLR |= CR_STRT_Set;
 
-        status = FLASH_WaitForLastOperation(EraseTimeout);
+        status = flash_wait(FLASH_OP_PAGE_ERASE);
 
         FLASH->CTLR &= CR_PER_Reset;
     }
@@ -152,13 +268,15 @@ FLASH_Status FLASH_EraseAllPages(void)
 {
     FLASH_Status status = FLASH_COMPLETE;
 
+    PROF_FUNC();
+
     status = FLASH_WaitForLastOperation(EraseTimeout);
     if(status == FLASH_COMPLETE)
     {
         FLASH->CTLR |= CR_MER_Set;
         FLASH->CTLR |= CR_STRT_Set;
 
-        status = FLASH_WaitForLastOperation(EraseTimeout);
+        status = flash_wait(FLASH_OP_MASS_ERASE);
 
         FLASH->CTLR &= CR_MER_Reset;
     }
@@ -177,6 +295,9 @@ FLASH_Status FLASH_EraseAllPages(void)
 FLASH_Status FLASH_EraseAllBank1Pages(void)
 {
     FLASH_Status status = FLASH_COMPLETE;
+
+    PROF_FUNC();
+
     status = FLASH_WaitForLastBank1Operation(EraseTimeout);
 
     if(status == FLASH_COMPLETE)
@@ -184,7 +305,7 @@ FLASH_Status FLASH_EraseAllBank1Pages(void)
         FLASH->CTLR |= CR_MER_Set;
         FLASH->CTLR |= CR_STRT_Set;
 
-        status = FLASH_WaitForLastBank1Operation(EraseTimeout);
+        status = flash_wait(FLASH_OP_MASS_ERASE);
 
         FLASH->CTLR &= CR_MER_Reset;
     }
@@ -206,6 +327,9 @@ FLASH_Status FLASH_EraseOptionBytes(void)
     __IO uint8_t i;
 
     FLASH_Status status = FLASH_COMPLETE;
+
+    PROF_FUNC();
+
     if(FLASH_GetReadOutProtectionStatus() != RESET)
     {
         rdptmp = 0x00;
@@ -218,14 +342,14 @@ FLASH_Status FLASH_EraseOptionBytes(void)
 
         FLASH->CTLR |= CR_OPTER_Set;
         FLASH->CTLR |= CR_STRT_Set;
-        status = FLASH_WaitForLastOperation(EraseTimeout);
+        status = flash_wait(FLASH_OP_OB_ERASE);
 
         if(status == FLASH_COMPLETE)
         {
             FLASH->CTLR &= CR_OPTER_Reset;
             FLASH->CTLR |= CR_OPTPG_Set;
             OB->RDPR = (uint16_t)rdptmp;
-            status = FLASH_WaitForLastOperation(ProgramTimeout);
+            status = flash_wait(FLASH_OP_OB_PROGRAM);
 
             if(status != FLASH_TIMEOUT)
             {
@@ -243,9 +367,9 @@ FLASH_Status FLASH_EraseOptionBytes(void)
         /* Write 0xFF */
         FLASH->CTLR |= CR_OPTPG_Set;
 
-        for(i = 0; i < 8; i++){
+        for(i = 0; i < 8 && status == FLASH_COMPLETE; i++){
             *(uint16_t *)(Address + 2 * i) = 0x00FF;
-            while(FLASH->STATR & SR_BSY);
+            status = flash_wait(FLASH_OP_OB_PROGRAM);
         }
 
         FLASH->CTLR &= ~CR_OPTPG_Set;
@@ -269,6 +393,8 @@ FLASH_Status FLASH_ProgramWord(uint32_t Address, uint32_t Data)
     FLASH_Status  status = FLASH_COMPLETE;
     __IO uint32_t tmp = 0;
 
+    PROF_FUNC();
+
     status = FLASH_WaitForLastOperation(ProgramTimeout);
 
     if(status == FLASH_COMPLETE)
@@ -276,13 +402,13 @@ FLASH_Status FLASH_ProgramWord(uint32_t Address, uint32_t Data)
         FLASH->CTLR |= CR_PG_Set;
 
         *(__IO uint16_t *)Address = (uint16_t)Data;
-        status = FLASH_WaitForLastOperation(ProgramTimeout);
+        status = flash_wait(FLASH_OP_PROGRAM);
 
         if(status == FLASH_COMPLETE)
         {
             tmp = Address + 2;
             *(__IO uint16_t *)tmp = Data >> 16;
-            status = FLASH_WaitForLastOperation(ProgramTimeout);
+            status = flash_wait(FLASH_OP_PROGRAM);
             FLASH->CTLR &= CR_PG_Reset;
         }
         else
@@ -309,13 +435,15 @@ FLASH_Status FLASH_ProgramHalfWord(uint32_t Address, uint16_t Data)
 {
     FLASH_Status status = FLASH_COMPLETE;
 
+    PROF_FUNC();
+
     status = FLASH_WaitForLastOperation(ProgramTimeout);
 
     if(status == FLASH_COMPLETE)
     {
         FLASH->CTLR |= CR_PG_Set;
         *(__IO uint16_t *)Address = Data;
-        status = FLASH_WaitForLastOperation(ProgramTimeout);
+        status = flash_wait(FLASH_OP_PROGRAM);
         FLASH->CTLR &= CR_PG_Reset;
     }
 
@@ -340,6 +468,8 @@ FLASH_Status FLASH_ProgramOptionByteData(uint32_t Address, uint8_t Data)
     __IO uint8_t i;
     uint16_t     pbuf[8];
 
+    PROF_FUNC();
+
     status = FLASH_WaitForLastOperation(ProgramTimeout);
     if(status == FLASH_COMPLETE)
     {
@@ -354,7 +484,7 @@ FLASH_Status FLASH_ProgramOptionByteData(uint32_t Address, uint8_t Data)
         /* Erase optionbytes */
         FLASH->CTLR |= CR_OPTER_Set;
         FLASH->CTLR |= CR_STRT_Set;
-        while(FLASH->STATR & SR_BSY);
+        status = flash_wait(FLASH_OP_OB_ERASE);
         FLASH->CTLR &= ~CR_OPTER_Set;
 
         /* Write optionbytes */
@@ -362,9 +492,9 @@ FLASH_Status FLASH_ProgramOptionByteData(uint32_t Address, uint8_t Data)
 
         FLASH->CTLR |= CR_OPTPG_Set;
 
-        for(i = 0; i < 8; i++){
+        for(i = 0; i < 8 && status == FLASH_COMPLETE; i++){
             *(uint16_t *)(Addr + 2 * i) = pbuf[i];
-            while(FLASH->STATR & SR_BSY) ;
+            status = flash_wait(FLASH_OP_OB_PROGRAM);
         }
 
         FLASH->CTLR &= ~CR_OPTPG_Set;
@@ -391,6 +521,8 @@ FLASH_Status FLASH_EnableWriteProtection(uint32_t FLASH_Sectors)
     __IO uint8_t i;
     uint16_t     pbuf[8];
 
+    PROF_FUNC();
+
     FLASH_Sectors = (uint32_t)(~FLASH_Sectors);
     WRP0_Data = (uint16_t)(FLASH_Sectors & WRP0_Mask);
     WRP1_Data = (uint16_t)((FLASH_Sectors & WRP1_Mask) >> 8);
@@ -412,7 +544,7 @@ FLASH_Status FLASH_EnableWriteProtection(uint32_t FLASH_Sectors)
         /* Erase optionbytes */
         FLASH->CTLR |= CR_OPTER_Set;
         FLASH->CTLR |= CR_STRT_Set;
-        while(FLASH->STATR & SR_BSY);
+        status = flash_wait(FLASH_OP_OB_ERASE);
         FLASH->CTLR &= ~CR_OPTER_Set;
 
         /* Write optionbytes */
@@ -422,9 +554,9 @@ FLASH_Status FLASH_EnableWriteProtection(uint32_t FLASH_Sectors)
         pbuf[7] = WRP3_Data;
 
         FLASH->CTLR |= CR_OPTPG_Set;
-        for(i = 0; i < 8; i++){
+        for(i = 0; i < 8 && status == FLASH_COMPLETE; i++){
             *(uint16_t *)(Addr + 2 * i) = pbuf[i];
-            while(FLASH->STATR & SR_BSY);
+            status = flash_wait(FLASH_OP_OB_PROGRAM);
         }
         FLASH->CTLR &= ~CR_OPTPG_Set;
     }
@@ -448,6 +580,8 @@ FLASH_Status FLASH_ReadOutProtection(FunctionalState NewState)
     __IO uint8_t i;
     uint16_t     pbuf[8];
 
+    PROF_FUNC();
+
     status = FLASH_WaitForLastOperation(EraseTimeout);
     if(status == FLASH_COMPLETE)
     {
@@ -462,7 +596,7 @@ FLASH_Status FLASH_ReadOutProtection(FunctionalState NewState)
         /* Erase optionbytes */
         FLASH->CTLR |= CR_OPTER_Set;
         FLASH->CTLR |= CR_STRT_Set;
-        while(FLASH->STATR & SR_BSY);
+        status = flash_wait(FLASH_OP_OB_ERASE);
         FLASH->CTLR &= ~CR_OPTER_Set;
 
         /* Write optionbytes */
@@ -472,9 +606,9 @@ FLASH_Status FLASH_ReadOutProtection(FunctionalState NewState)
             pbuf[0] = 0x00FF;
 
         FLASH->CTLR |= CR_OPTPG_Set;
-        for(i = 0; i < 8; i++){
+        for(i = 0; i < 8 && status == FLASH_COMPLETE; i++){
             *(uint16_t *)(Addr + 2 * i) = pbuf[i];
-            while(FLASH->STATR & SR_BSY);
+            status = flash_wait(FLASH_OP_OB_PROGRAM);
         }
         FLASH->CTLR &= ~CR_OPTPG_Set;
     }
@@ -506,6 +640,8 @@ FLASH_Status FLASH_UserOptionByteConfig(uint16_t OB_IWDG, uint16_t OB_STOP, uint
     __IO uint8_t i;
     uint16_t     pbuf[8];
 
+    PROF_FUNC();
+
     FLASH->OBKEYR = FLASH_KEY1;
     FLASH->OBKEYR = FLASH_KEY2;
     status = FLASH_WaitForLastOperation(ProgramTimeout);
@@ -520,16 +656,16 @@ FLASH_Status FLASH_UserOptionByteConfig(uint16_t OB_IWDG, uint16_t OB_STOP, uint
         /* Erase optionbytes */
         FLASH->CTLR |= CR_OPTER_Set;
         FLASH->CTLR |= CR_STRT_Set;
-        while(FLASH->STATR & SR_BSY);
+        status = flash_wait(FLASH_OP_OB_ERASE);
         FLASH->CTLR &= ~CR_OPTER_Set;
 
         /* Write optionbytes */
         pbuf[1] = OB_IWDG | (uint16_t)(OB_STOP | (uint16_t)(OB_STDBY | ((uint16_t)0xF8)));
 
         FLASH->CTLR |= CR_OPTPG_Set;
-        for(i = 0; i < 8; i++){
+        for(i = 0; i < 8 && status == FLASH_COMPLETE; i++){
             *(uint16_t *)(Addr + 2 * i) = pbuf[i];
-            while(FLASH->STATR & SR_BSY);
+            status = flash_wait(FLASH_OP_OB_PROGRAM);
         }
         FLASH->CTLR &= ~CR_OPTPG_Set;
     }
@@ -546,6 +682,8 @@ FLASH_Status FLASH_UserOptionByteConfig(uint16_t OB_IWDG, uint16_t OB_STOP, uint
  */
 uint32_t FLASH_GetUserOptionByte(void)
 {
+    PROF_FUNC();
+
     return (uint32_t)(FLASH->OBR >> 2);
 }
 
@@ -558,6 +696,8 @@ uint32_t FLASH_GetUserOptionByte(void)
  */
 uint32_t FLASH_GetWriteProtectionOptionByte(void)
 {
+    PROF_FUNC();
+
     return (uint32_t)(FLASH->WPR);
 }
 
@@ -571,6 +711,9 @@ uint32_t FLASH_GetWriteProtectionOptionByte(void)
 FlagStatus FLASH_GetReadOutProtectionStatus(void)
 {
     FlagStatus readoutstatus = RESET;
+
+    PROF_FUNC();
+
     if((FLASH->OBR & RDPRT_Mask) != (uint32_t)RESET)
     {
         readoutstatus = SET;
@@ -596,6 +739,8 @@ FlagStatus FLASH_GetReadOutProtectionStatus(void)
  */
 void FLASH_ITConfig(uint32_t FLASH_IT, FunctionalState NewState)
 {
+    PROF_FUNC();
+
     if(NewState != DISABLE)
     {
         FLASH->CTLR |= FLASH_IT;
@@ -624,6 +769,8 @@ FlagStatus FLASH_GetFlagStatus(uint32_t FLASH_FLAG)
 {
     FlagStatus bitstatus = RESET;
 
+    PROF_FUNC();
+
     if(FLASH_FLAG == FLASH_FLAG_OPTERR)
     {
         if((FLASH->OBR & FLASH_FLAG_OPTERR) != (uint32_t)RESET)
@@ -663,6 +810,8 @@ FlagStatus FLASH_GetFlagStatus(uint32_t FLASH_FLAG)
  */
 void FLASH_ClearFlag(uint32_t FLASH_FLAG)
 {
+    PROF_FUNC();
+
     FLASH->STATR = FLASH_FLAG;
 }
 
@@ -678,6 +827,8 @@ FLASH_Status FLASH_GetStatus(void)
 {
     FLASH_Status flashstatus = FLASH_COMPLETE;
 
+    PROF_FUNC();
+
     if((FLASH->STATR & FLASH_FLAG_BSY) == FLASH_FLAG_BSY)
     {
         flashstatus = FLASH_BUSY;
@@ -711,7 +862,7 @@ FLASH_Status FLASH_GetStatus(void)
  * @return  FLASH Status - The returned value can be: FLASH_BUSY, FLASH_ERROR_PG,
  *        FLASH_ERROR_WRP or FLASH_COMPLETE.
  */
-FLASH_Status FLASH_GetBank1Status(void)
+__HIGH_CODE FLASH_Status FLASH_GetBank1Status(void)
 {
     FLASH_Status flashstatus = FLASH_COMPLETE;
 
@@ -745,26 +896,16 @@ FLASH_Status FLASH_GetBank1Status(void)
  *
  * @brief   Waits for a Flash operation to complete or a TIMEOUT to occur.
  *
- * @param   Timeout - FLASH programming Timeout
+ * @param   Timeout - FLASH programming Timeout in microseconds
  *
- * @return  FLASH Status - The returned value can be: FLASH_BUSY, FLASH_ERROR_PG,
- *        FLASH_ERROR_WRP or FLASH_COMPLETE.
+ * @return  FLASH Status - The returned value can be: FLASH_ERROR_PG,
+ *        FLASH_ERROR_WRP, FLASH_COMPLETE or FLASH_TIMEOUT.
  */
-FLASH_Status FLASH_WaitForLastOperation(uint32_t Timeout)
+__HIGH_CODE FLASH_Status FLASH_WaitForLastOperation(uint32_t Timeout)
 {
-    FLASH_Status status = FLASH_COMPLETE;
+    uint32_t elapsed;
 
-    status = FLASH_GetBank1Status();
-    while((status == FLASH_BUSY) && (Timeout != 0x00))
-    {
-        status = FLASH_GetBank1Status();
-        Timeout--;
-    }
-    if(Timeout == 0x00)
-    {
-        status = FLASH_TIMEOUT;
-    }
-    return status;
+    return flash_poll(Timeout, &elapsed);
 }
 
 /*********************************************************************
@@ -772,26 +913,93 @@ FLASH_Status FLASH_WaitForLastOperation(uint32_t Timeout)
  *
  * @brief   Waits for a Flash operation on Bank1 to complete or a TIMEOUT to occur.
  *
- * @param   Timeout - FLASH programming Timeout
+ * @param   Timeout - FLASH programming Timeout in microseconds
  *
- * @return  FLASH Status - The returned value can be: FLASH_BUSY, FLASH_ERROR_PG,
- *        FLASH_ERROR_WRP or FLASH_COMPLETE.
+ * @return  FLASH Status - The returned value can be: FLASH_ERROR_PG,
+ *        FLASH_ERROR_WRP, FLASH_COMPLETE or FLASH_TIMEOUT.
  */
-FLASH_Status FLASH_WaitForLastBank1Operation(uint32_t Timeout)
+__HIGH_CODE FLASH_Status FLASH_WaitForLastBank1Operation(uint32_t Timeout)
 {
-    FLASH_Status status = FLASH_COMPLETE;
+    uint32_t elapsed;
 
-    status = FLASH_GetBank1Status();
-    while((status == FLASH_FLAG_BANK1_BSY) && (Timeout != 0x00))
-    {
-        status = FLASH_GetBank1Status();
-        Timeout--;
-    }
-    if(Timeout == 0x00)
-    {
-        status = FLASH_TIMEOUT;
+    return flash_poll(Timeout, &elapsed);
+}
+
+/*********************************************************************
+ * @fn      FLASH_SetOpTimeout
+ *
+ * @brief   Sets the busy time budget of one operation kind. An operation
+ *          still busy after it returns FLASH_TIMEOUT; the void fast mode
+ *          functions then return with BSY set (FLASH_GetStatus reports
+ *          FLASH_BUSY).
+ *
+ * @param   Op - operation kind.
+ *          Timeout_us - budget in microseconds.
+ *
+ * @return  none
+ */
+void FLASH_SetOpTimeout(FLASH_OpTypeDef Op, uint32_t Timeout_us)
+{
+    PROF_FUNC();
+
+    if(Op < FLASH_OP_NUM)
+        flash_op_timeout[Op] = Timeout_us;
+}
+
+/*********************************************************************
+ * @fn      FLASH_GetOpTimeout
+ *
+ * @brief   Returns the busy time budget of one operation kind.
+ *
+ * @param   Op - operation kind.
+ *
+ * @return  Budget in microseconds.
+ */
+uint32_t FLASH_GetOpTimeout(FLASH_OpTypeDef Op)
+{
+    PROF_FUNC();
+
+    return Op < FLASH_OP_NUM ? flash_op_timeout[Op] : 0;
+}
+
+/*********************************************************************
+ * @fn      FLASH_GetOpStats
+ *
+ * @brief   Copies the observed busy times of one operation kind.
+ *
+ * @param   Op - operation kind.
+ *          Stats - destination.
+ *
+ * @return  none
+ */
+void FLASH_GetOpStats(FLASH_OpTypeDef Op, FLASH_OpStatsTypeDef *Stats)
+{
+    PROF_FUNC();
+
+    if(Op < FLASH_OP_NUM)
+        *Stats = flash_op_stats[Op];
+}
+
+/*********************************************************************
+ * @fn      FLASH_ClearOpStats
+ *
+ * @brief   Clears the busy time telemetry of every operation kind.
+ *
+ * @return  none
+ */
+void FLASH_ClearOpStats(void)
+{
+    uint8_t i;
+
+    PROF_FUNC();
+
+    for(i = 0; i < FLASH_OP_NUM; i++){
+        flash_op_stats[i].Count = 0;
+        flash_op_stats[i].Timeouts = 0;
+        flash_op_stats[i].Last_us = 0;
+        flash_op_stats[i].Max_us = 0;
+        flash_op_stats[i].Total_us = 0;
     }
-    return status;
 }
 
 /*********************************************************************
@@ -803,6 +1011,8 @@ FLASH_Status FLASH_WaitForLastBank1Operation(uint32_t Timeout)
  */
 void FLASH_Unlock_Fast(void)
 {
+    PROF_FUNC();
+
     /* Authorize the FPEC of Bank1 Access */
     FLASH->KEYR = FLASH_KEY1;
     FLASH->KEYR = FLASH_KEY2;
@@ -821,6 +1031,8 @@ void FLASH_Unlock_Fast(void)
  */
 void FLASH_Lock_Fast(void)
 {
+    PROF_FUNC();
+
     FLASH->CTLR |= CR_LOCK_Set;
 }
 
@@ -833,14 +1045,14 @@ void FLASH_Lock_Fast(void)
  *
  * @return  none
  */
-void FLASH_ErasePage_Fast(uint32_t Page_Address)
+__HIGH_CODE void FLASH_ErasePage_Fast(uint32_t Page_Address)
 {
     Page_Address &= 0xFFFFFF00;
 
     FLASH->CTLR |= CR_PAGE_ER;
     FLASH->ADDR = Page_Address;
     FLASH->CTLR |= CR_STRT_Set;
-    while(FLASH->STATR & SR_BSY);
+    flash_wait(FLASH_OP_PAGE_ERASE_FAST);
     FLASH->CTLR &= ~CR_PAGE_ER;
 }
 
@@ -853,14 +1065,14 @@ void FLASH_ErasePage_Fast(uint32_t Page_Address)
  *
  * @return  none
  */
-void FLASH_EraseBlock_32K_Fast(uint32_t Block_Address)
+__HIGH_CODE void FLASH_EraseBlock_32K_Fast(uint32_t Block_Address)
 {
     Block_Address &= 0xFFFF8000;
 
     FLASH->CTLR |= CR_BER32;
     FLASH->ADDR = Block_Address;
     FLASH->CTLR |= CR_STRT_Set;
-    while(FLASH->STATR & SR_BSY);
+    flash_wait(FLASH_OP_BLOCK_ERASE_FAST);
     FLASH->CTLR &= ~CR_BER32;
 }
 
@@ -873,14 +1085,14 @@ void FLASH_EraseBlock_32K_Fast(uint32_t Block_Address)
  *
  * @return  none
  */
-void FLASH_EraseBlock_64K_Fast(uint32_t Block_Address)
+__HIGH_CODE void FLASH_EraseBlock_64K_Fast(uint32_t Block_Address)
 {
     Block_Address &= 0xFFFF0000;
 
     FLASH->CTLR |= CR_BER64;
     FLASH->ADDR = Block_Address;
     FLASH->CTLR |= CR_STRT_Set;
-    while(FLASH->STATR & SR_BSY);
+    flash_wait(FLASH_OP_BLOCK_ERASE_FAST);
     FLASH->CTLR &= ~CR_BER64;
 }
 
@@ -893,7 +1105,7 @@ void FLASH_EraseBlock_64K_Fast(uint32_t Block_Address)
  *
  * @return  none
  */
-void FLASH_ProgramPage_Fast(uint32_t Page_Address, uint32_t *pbuf)
+__HIGH_CODE void FLASH_ProgramPage_Fast(uint32_t Page_Address, uint32_t *pbuf)
 {
     uint8_t size = 64;
 
@@ -913,7 +1125,7 @@ void FLASH_ProgramPage_Fast(uint32_t Page_Address, uint32_t *pbuf)
     }
 
     FLASH->CTLR |= CR_PG_STRT;
-    while(FLASH->STATR & SR_BSY);
+    flash_wait(FLASH_OP_PAGE_PROGRAM_FAST);
     FLASH->CTLR &= ~CR_PAGE_PG;
 }
 
@@ -930,6 +1142,8 @@ void FLASH_ProgramPage_Fast(uint32_t Page_Address, uint32_t *pbuf)
  */
 void FLASH_Access_Clock_Cfg(uint32_t FLASH_Access_CLK)
 {
+    PROF_FUNC();
+
     FLASH->CTLR &= ~(1 << 25);
     FLASH->CTLR |= FLASH_Access_CLK;
 }
@@ -946,6 +1160,8 @@ void FLASH_Access_Clock_Cfg(uint32_t FLASH_Access_CLK)
  */
 void FLASH_Enhance_Mode(FunctionalState NewState)
 {
+    PROF_FUNC();
+
     if(NewState)
     {
         FLASH->CTLR |= (1 << 24);
@@ -957,6 +1173,25 @@ void FLASH_Enhance_Mode(FunctionalState NewState)
     }
 }
 
+/* EEPROM_SetHook */
+static const EEPROM_HookTypeDef *eeprom_hook = NULL;
+
+/********************************************************************************
+ * @fn        EEPROM_SetHook
+ *
+ * @brief     Puts a cache in front of EEPROM_READ, EEPROM_WRITE and
+ *            EEPROM_ERASE, on the EEPROM area of the cache.
+ *
+ * @param     Hook: cache entry points, NULL to access the flash at
+ *            EEPROM_ADDRESS directly.
+ *
+ * @return None
+ */
+void EEPROM_SetHook(const EEPROM_HookTypeDef *Hook)
+{
+    eeprom_hook = Hook;
+}
+
 /********************************************************************************
  * @fn        EEPROM_READ
  *
@@ -974,6 +1209,14 @@ FLASH_Status EEPROM_READ(uint32_t StartAddr, void *Buffer, uint32_t Length)
     uint8_t  *pbuf;
     uint8_t   offset;
     uint32_t  value;
+
+    PROF_FUNC();
+
+    if(eeprom_hook)
+    {
+        return eeprom_hook->Read(StartAddr, Buffer, Length);
+    }
+
     offset = Length % 4;
     if(offset)
     {
@@ -1007,10 +1250,20 @@ FLASH_Status EEPROM_READ(uint32_t StartAddr, void *Buffer, uint32_t Length)
  */
 FLASH_Status EEPROM_ERASE(uint32_t StartAddr, uint32_t Length)
 {
-    FLASH_Status state;
-    uint8_t      i;
-    for(i = 0; i < (Length / 4096 + 1); i++){
-        state = FLASH_ErasePage(StartAddr + 4096 * i + EEPROM_ADDRESS);
+    FLASH_Status state = FLASH_COMPLETE;
+    uint32_t     addr;
+
+    PROF_FUNC();
+
+    if(eeprom_hook)
+    {
+        return eeprom_hook->Erase(StartAddr, Length);
+    }
+
+    /* Erases every 4K page overlapping [StartAddr, StartAddr + Length),
+     * including the bytes of those pages outside the range */
+    for(addr = StartAddr & ~(uint32_t)0xFFF; addr < StartAddr + Length; addr += 4096){
+        state = FLASH_ErasePage(addr + EEPROM_ADDRESS);
         if(state != FLASH_COMPLETE)
         {
             break;
@@ -1036,6 +1289,13 @@ FLASH_Status EEPROM_WRITE(uint32_t StartAddr, void *Buffer, uint32_t Length)
     uint8_t      offset;
     uint32_t    *src;
 
+    PROF_FUNC();
+
+    if(eeprom_hook)
+    {
+        return eeprom_hook->Write(StartAddr, Buffer, Length);
+    }
+
     offset = Length % 4;
     if(offset)
     {
@@ -1067,6 +1327,8 @@ void FLASH_GetMACAddress(uint8_t *Buffer)
 {
     uint32_t value;
 
+    PROF_FUNC();
+
     value = *(uint32_t *)(0x1FFFF7E8);
     Buffer[0] = value & 0xFF;
     Buffer[1] = (value >> 8) & 0xFF;
@@ -8,6 +8,7 @@
  * SPDX-License-Identifier: Apache-2.0
  *******************************************************************************/
 #include "ch32v20x_usart.h"
+#include "profile.h"
 #include "ch32v20x_rcc.h"
 
 /* USART_Private_Defines */
@@ -67,6 +68,8 @@
  */
 void USART_DeInit(USART_TypeDef *USARTx)
 {
+    PROF_FUNC();
+
     if(USARTx == USART1)
     {
         RCC_APB2PeriphResetCmd(RCC_APB2Periph_USART1, ENABLE);
@@ -110,6 +113,8 @@ void USART_Init(USART_TypeDef *USARTx, USART_InitTypeDef *USART_InitStruct)
     uint32_t          usartxbase = 0;
     RCC_ClocksTypeDef RCC_ClocksStatus;
 
+    PROF_FUNC();
+
     if(USART_InitStruct->USART_HardwareFlowControl != USART_HardwareFlowControl_None)
     {
     }
@@ -177,6 +182,8 @@ void USART_Init(USART_TypeDef *USARTx, USART_InitTypeDef *USART_InitStruct)
  */
 void USART_StructInit(USART_InitTypeDef *USART_InitStruct)
 {
+    PROF_FUNC();
+
     USART_InitStruct->USART_BaudRate = 9600;
     USART_InitStruct->USART_WordLength = USART_WordLength_8b;
     USART_InitStruct->USART_StopBits = USART_StopBits_1;
@@ -202,6 +209,8 @@ void USART_ClockInit(USART_TypeDef *USARTx, USART_ClockInitTypeDef *USART_ClockI
 {
     uint32_t tmpreg = 0x00;
 
+    PROF_FUNC();
+
     tmpreg = USARTx->CTLR2;
     tmpreg &= CTLR2_CLOCK_CLEAR_Mask;
     tmpreg |= (uint32_t)USART_ClockInitStruct->USART_Clock | USART_ClockInitStruct->USART_CPOL |
@@ -221,6 +230,8 @@ void USART_ClockInit(USART_TypeDef *USARTx, USART_ClockInitTypeDef *USART_ClockI
  */
 void USART_ClockStructInit(USART_ClockInitTypeDef *USART_ClockInitStruct)
 {
+    PROF_FUNC();
+
     USART_ClockInitStruct->USART_Clock = USART_Clock_Disable;
     USART_ClockInitStruct->USART_CPOL = USART_CPOL_Low;
     USART_ClockInitStruct->USART_CPHA = USART_CPHA_1Edge;
@@ -240,6 +251,8 @@ void USART_ClockStructInit(USART_ClockInitTypeDef *USART_ClockInitStruct)
  */
 void USART_Cmd(USART_TypeDef *USARTx, FunctionalState NewState)
 {
+    PROF_FUNC();
+
     if(NewState != DISABLE)
     {
         USARTx->CTLR1 |= CTLR1_UE_Set;
@@ -275,6 +288,8 @@ void USART_ITConfig(USART_TypeDef *USARTx, uint16_t USART_IT, FunctionalState Ne
     uint32_t usartreg = 0x00, itpos = 0x00, itmask = 0x00;
     uint32_t usartxbase = 0x00;
 
+    PROF_FUNC();
+
     if(USART_IT == USART_IT_CTS)
     {
     }
@@ -322,6 +337,8 @@ void USART_ITConfig(USART_TypeDef *USARTx, uint16_t USART_IT, FunctionalState Ne
  */
 void USART_DMACmd(USART_TypeDef *USARTx, uint16_t USART_DMAReq, FunctionalState NewState)
 {
+    PROF_FUNC();
+
     if(NewState != DISABLE)
     {
         USARTx->CTLR3 |= USART_DMAReq;
@@ -344,6 +361,8 @@ void USART_DMACmd(USART_TypeDef *USARTx, uint16_t USART_DMAReq, FunctionalState
  */
 void USART_SetAddress(USART_TypeDef *USARTx, uint8_t USART_Address)
 {
+    PROF_FUNC();
+
     USARTx->CTLR2 &= CTLR2_Address_Mask;
     USARTx->CTLR2 |= USART_Address;
 }
@@ -362,6 +381,8 @@ void USART_SetAddress(USART_TypeDef *USARTx, uint8_t USART_Address)
  */
 void USART_WakeUpConfig(USART_TypeDef *USARTx, uint16_t USART_WakeUp)
 {
+    PROF_FUNC();
+
     USARTx->CTLR1 &= CTLR1_WAKE_Mask;
     USARTx->CTLR1 |= USART_WakeUp;
 }
@@ -378,6 +399,8 @@ void USART_WakeUpConfig(USART_TypeDef *USARTx, uint16_t USART_WakeUp)
  */
 void USART_ReceiverWakeUpCmd(USART_TypeDef *USARTx, FunctionalState NewState)
 {
+    PROF_FUNC();
+
     if(NewState != DISABLE)
     {
         USARTx->CTLR1 |= CTLR1_RWU_Set;
@@ -402,6 +425,8 @@ void USART_ReceiverWakeUpCmd(USART_TypeDef *USARTx, FunctionalState NewState)
  */
 void USART_LINBreakDetectLengthConfig(USART_TypeDef *USARTx, uint16_t USART_LINBreakDetectLength)
 {
+    PROF_FUNC();
+
     USARTx->CTLR2 &= CTLR2_LBDL_Mask;
     USARTx->CTLR2 |= USART_LINBreakDetectLength;
 }
@@ -418,6 +443,8 @@ void USART_LINBreakDetectLengthConfig(USART_TypeDef *USARTx, uint16_t USART_LINB
  */
 void USART_LINCmd(USART_TypeDef *USARTx, FunctionalState NewState)
 {
+    PROF_FUNC();
+
     if(NewState != DISABLE)
     {
         USARTx->CTLR2 |= CTLR2_LINEN_Set;
@@ -440,6 +467,8 @@ void USART_LINCmd(USART_TypeDef *USARTx, FunctionalState NewState)
  */
 void USART_SendData(USART_TypeDef *USARTx, uint16_t Data)
 {
+    PROF_FUNC();
+
     USARTx->DATAR = (Data & (uint16_t)0x01FF);
 }
 
@@ -454,6 +483,8 @@ void USART_SendData(USART_TypeDef *USARTx, uint16_t Data)
  */
 uint16_t USART_ReceiveData(USART_TypeDef *USARTx)
 {
+    PROF_FUNC();
+
     return (uint16_t)(USARTx->DATAR & (uint16_t)0x01FF);
 }
 
@@ -468,6 +499,8 @@ uint16_t USART_ReceiveData(USART_TypeDef *USARTx)
  */
 void USART_SendBreak(USART_TypeDef *USARTx)
 {
+    PROF_FUNC();
+
     USARTx->CTLR1 |= CTLR1_SBK_Set;
 }
 
@@ -483,6 +516,8 @@ void USART_SendBreak(USART_TypeDef *USARTx)
  */
 void USART_SetGuardTime(USART_TypeDef *USARTx, uint8_t USART_GuardTime)
 {
+    PROF_FUNC();
+
     USARTx->GPR &= GPR_LSB_Mask;
     USARTx->GPR |= (uint16_t)((uint16_t)USART_GuardTime << 0x08);
 }
@@ -499,6 +534,8 @@ void USART_SetGuardTime(USART_TypeDef *USARTx, uint8_t USART_GuardTime)
  */
 void USART_SetPrescaler(USART_TypeDef *USARTx, uint8_t USART_Prescaler)
 {
+    PROF_FUNC();
+
     USARTx->GPR &= GPR_MSB_Mask;
     USARTx->GPR |= USART_Prescaler;
 }
@@ -515,6 +552,8 @@ void USART_SetPrescaler(USART_TypeDef *USARTx, uint8_t USART_Prescaler)
  */
 void USART_SmartCardCmd(USART_TypeDef *USARTx, FunctionalState NewState)
 {
+    PROF_FUNC();
+
     if(NewState != DISABLE)
     {
         USARTx->CTLR3 |= CTLR3_SCEN_Set;
@@ -537,6 +576,8 @@ void USART_SmartCardCmd(USART_TypeDef *USARTx, FunctionalState NewState)
  */
 void USART_SmartCardNACKCmd(USART_TypeDef *USARTx, FunctionalState NewState)
 {
+    PROF_FUNC();
+
     if(NewState != DISABLE)
     {
         USARTx->CTLR3 |= CTLR3_NACK_Set;
@@ -559,6 +600,8 @@ void USART_SmartCardNACKCmd(USART_TypeDef *USARTx, FunctionalState NewState)
  */
 void USART_HalfDuplexCmd(USART_TypeDef *USARTx, FunctionalState NewState)
 {
+    PROF_FUNC();
+
     if(NewState != DISABLE)
     {
         USARTx->CTLR3 |= CTLR3_HDSEL_Set;
@@ -581,6 +624,8 @@ void USART_HalfDuplexCmd(USART_TypeDef *USARTx, FunctionalState NewState)
  */
 void USART_OverSampling8Cmd(USART_TypeDef *USARTx, FunctionalState NewState)
 {
+    PROF_FUNC();
+
     if(NewState != DISABLE)
     {
         USARTx->CTLR1 |= CTLR1_OVER8_Set;
@@ -603,6 +648,8 @@ void USART_OverSampling8Cmd(USART_TypeDef *USARTx, FunctionalState NewState)
  */
 void USART_OneBitMethodCmd(USART_TypeDef *USARTx, FunctionalState NewState)
 {
+    PROF_FUNC();
+
     if(NewState != DISABLE)
     {
         USARTx->CTLR3 |= CTLR3_ONEBITE_Set;
@@ -627,6 +674,8 @@ void USART_OneBitMethodCmd(USART_TypeDef *USARTx, FunctionalState NewState)
  */
 void USART_IrDAConfig(USART_TypeDef *USARTx, uint16_t USART_IrDAMode)
 {
+    PROF_FUNC();
+
     USARTx->CTLR3 &= CTLR3_IRLP_Mask;
     USARTx->CTLR3 |= USART_IrDAMode;
 }
@@ -643,6 +692,8 @@ void USART_IrDAConfig(USART_TypeDef *USARTx, uint16_t USART_IrDAMode)
  */
 void USART_IrDACmd(USART_TypeDef *USARTx, FunctionalState NewState)
 {
+    PROF_FUNC();
+
     if(NewState != DISABLE)
     {
         USARTx->CTLR3 |= CTLR3_IREN_Set;
@@ -677,6 +728,8 @@ FlagStatus USART_GetFlagStatus(USART_TypeDef *USARTx, uint16_t USART_FLAG)
 {
     FlagStatus bitstatus = RESET;
 
+    PROF_FUNC();
+
     if(USART_FLAG == USART_FLAG_CTS)
     {
     }
@@ -708,6 +761,8 @@ FlagStatus USART_GetFlagStatus(USART_TypeDef *USARTx, uint16_t USART_FLAG)
  */
 void USART_ClearFlag(USART_TypeDef *USARTx, uint16_t USART_FLAG)
 {
+    PROF_FUNC();
+
     if((USART_FLAG & USART_FLAG_CTS) == USART_FLAG_CTS)
     {
     }
@@ -741,6 +796,8 @@ ITStatus USART_GetITStatus(USART_TypeDef *USARTx, uint16_t USART_IT)
     uint32_t bitpos = 0x00, itmask = 0x00, usartreg = 0x00;
     ITStatus bitstatus = RESET;
 
+    PROF_FUNC();
+
     if(USART_IT == USART_IT_CTS)
     {
     }
@@ -796,6 +853,8 @@ void USART_ClearITPendingBit(USART_TypeDef *USARTx, uint16_t USART_IT)
 {
     uint16_t bitpos = 0x00, itmask = 0x00;
 
+    PROF_FUNC();
+
     if(USART_IT == USART_IT_CTS)
     {
     }